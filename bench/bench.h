@@ -0,0 +1,202 @@
+/**
+ * bench.h — Microbenchmark harness
+ * Copyright 2026 Lumi Team. Apache-2.0
+ *
+ * Header-only; include it from the one file of a benchmark. A case is an
+ * operation run in timed samples of a calibrated number of calls, after
+ * an untimed reset. Each sample gives one ns/op figure; the percentiles
+ * are over samples, so they show run-to-run spread rather than single
+ * slow calls. Allocations are counted through a lumi_allocator_t, so they
+ * cover what the SDK allocates (see lumi_set_allocator), not malloc()
+ * calls of other code.
+ *
+ * Results go to stdout as opened at bench_init(), so a benchmark may point
+ * fd 1 elsewhere, e.g. to keep log output out of the table.
+ *
+ * Arguments: --json FILE writes the results as JSON, --filter TEXT runs
+ * only the cases whose name contains TEXT, --time MS sets how long each
+ * case is sampled (default 40).
+ */
+
+#ifndef LUMI_BENCH_H
+#define LUMI_BENCH_H
+
+#include "lumiapp.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define BENCH_MIN_SAMPLES   20
+#define BENCH_MAX_SAMPLES   4000
+#define BENCH_SAMPLE_NS     20000.0     /* batches grow until a sample takes this */
+
+typedef struct {
+    const char *name;
+    size_t      n;                          /* workload size, 0 if none */
+    size_t      max_batch;                  /* calls per sample at most, 0 for no limit */
+    void      (*reset)(void *ctx);          /* untimed, before each sample; may be NULL */
+    void      (*op)(void *ctx, size_t i);   /* i counts calls within the sample */
+    void       *ctx;
+} bench_case_t;
+
+static struct {
+    const char *suite;
+    const char *filter;
+    double      time_ns;
+    FILE       *out;                        /* stdout, even while fd 1 is redirected */
+    FILE       *json;
+    int         results;
+    size_t      allocs, alloc_bytes;        /* through the counting allocator */
+    double     *samples;
+} bench_g;
+
+static double bench_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+/* ── Counting allocator ────────────────────────────────────────── */
+
+static void *bench_alloc(void *ctx, size_t size) {
+    (void)ctx;
+    bench_g.allocs++;
+    bench_g.alloc_bytes += size;
+    return malloc(size);
+}
+
+static void *bench_realloc(void *ctx, void *p, size_t old_size, size_t size) {
+    (void)ctx;
+    bench_g.allocs++;
+    if (size > old_size) bench_g.alloc_bytes += size - old_size;
+    return realloc(p, size);
+}
+
+static void bench_free(void *ctx, void *p, size_t size) {
+    (void)ctx; (void)size;
+    free(p);
+}
+
+/* ── Running ───────────────────────────────────────────────────── */
+
+static int bench_cmp(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+static double bench_quantile(const double *sorted, size_t count, double q) {
+    return sorted[(size_t)(q * (double)(count - 1) + 0.5)];
+}
+
+static void bench_json_head(const char *name, size_t n) {
+    fprintf(bench_g.json, "%s\n    {\"name\": \"%s\", \"n\": %zu", bench_g.results ? "," : "",
+            name, n);
+    bench_g.results++;
+}
+
+static bool bench_selected(const char *name) {
+    return !bench_g.filter || strstr(name, bench_g.filter);
+}
+
+static double bench_sample(const bench_case_t *c, size_t batch, size_t *allocs, size_t *bytes) {
+    if (c->reset) c->reset(c->ctx);
+    size_t a0 = bench_g.allocs, b0 = bench_g.alloc_bytes;
+    double t0 = bench_now_ns();
+    for (size_t i = 0; i < batch; i++) c->op(c->ctx, i);
+    double ns = bench_now_ns() - t0;
+    *allocs += bench_g.allocs - a0;
+    *bytes  += bench_g.alloc_bytes - b0;
+    return ns;
+}
+
+static void bench_init(int argc, char **argv, const char *suite) {
+    bench_g.suite = suite;
+    bench_g.time_ns = 40e6;
+    const char *json = NULL;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (strcmp(argv[i], "--json") == 0) json = argv[i + 1];
+        else if (strcmp(argv[i], "--filter") == 0) bench_g.filter = argv[i + 1];
+        else if (strcmp(argv[i], "--time") == 0) bench_g.time_ns = atof(argv[i + 1]) * 1e6;
+    }
+    if (json && !(bench_g.json = fopen(json, "w"))) {
+        perror(json);
+        exit(1);
+    }
+    if (bench_g.json) {
+        fprintf(bench_g.json, "{\n  \"suite\": \"%s\",\n  \"version\": \"%s\",\n  \"results\": [",
+                suite, LUMIAPP_VERSION_STRING);
+    }
+    bench_g.samples = malloc(BENCH_MAX_SAMPLES * sizeof(double));
+    lumi_allocator_t counting = { bench_alloc, bench_realloc, bench_free, NULL };
+    if (!bench_g.samples || lumi_set_allocator(&counting) != LUMI_OK) {
+        fprintf(stderr, "%s: cannot set up the harness\n", suite);
+        exit(1);
+    }
+    fflush(stdout);
+    bench_g.out = fdopen(dup(STDOUT_FILENO), "w");
+    if (!bench_g.out) bench_g.out = stdout;
+    setvbuf(bench_g.out, NULL, _IOLBF, 0);
+    fprintf(bench_g.out, "%s (ns/op; percentiles over samples)\n", suite);
+    fprintf(bench_g.out, "  %-28s %8s %10s %10s %10s %10s\n", "case", "n", "mean", "p50", "p99",
+            "allocs/op");
+}
+
+static void bench_run(const bench_case_t *c) {
+    if (!bench_selected(c->name)) return;
+
+    /* Warm up while doubling the batch to about BENCH_SAMPLE_NS */
+    size_t batch = 1, allocs = 0, bytes = 0;
+    while (bench_sample(c, batch, &allocs, &bytes) < BENCH_SAMPLE_NS &&
+           (!c->max_batch || batch * 2 <= c->max_batch)) {
+        batch *= 2;
+    }
+
+    size_t count = 0;
+    double total = 0;
+    allocs = bytes = 0;
+    while (count < BENCH_MIN_SAMPLES || (total < bench_g.time_ns && count < BENCH_MAX_SAMPLES)) {
+        double ns = bench_sample(c, batch, &allocs, &bytes);
+        total += ns;
+        bench_g.samples[count++] = ns / (double)batch;
+    }
+    qsort(bench_g.samples, count, sizeof(double), bench_cmp);
+
+    double ops = (double)count * (double)batch;
+    const double *s = bench_g.samples;
+    fprintf(bench_g.out, "  %-28s %8zu %10.1f %10.1f %10.1f %10.2f\n", c->name, c->n, total / ops,
+            bench_quantile(s, count, 0.5), bench_quantile(s, count, 0.99), (double)allocs / ops);
+    if (bench_g.json) {
+        bench_json_head(c->name, c->n);
+        fprintf(bench_g.json,
+                ", \"ops\": %.0f, \"samples\": %zu, \"ns_per_op\": %.2f, \"min_ns\": %.2f, "
+                "\"p50_ns\": %.2f, \"p90_ns\": %.2f, \"p99_ns\": %.2f, \"max_ns\": %.2f, "
+                "\"allocs_per_op\": %.3f, \"alloc_bytes_per_op\": %.1f}",
+                ops, count, total / ops, s[0], bench_quantile(s, count, 0.5),
+                bench_quantile(s, count, 0.9), bench_quantile(s, count, 0.99), s[count - 1],
+                (double)allocs / ops, (double)bytes / ops);
+    }
+}
+
+/* Records a case that cannot run here, with the reason */
+static void bench_skip(const char *name, size_t n, const char *reason) {
+    if (!bench_selected(name)) return;
+    fprintf(bench_g.out, "  %-28s %8zu   skipped: %s\n", name, n, reason);
+    if (bench_g.json) {
+        bench_json_head(name, n);
+        fprintf(bench_g.json, ", \"skipped\": \"%s\"}", reason);
+    }
+}
+
+static int bench_finish(void) {
+    if (bench_g.json) {
+        fprintf(bench_g.json, "\n  ]\n}\n");
+        if (fclose(bench_g.json) != 0) return 1;
+    }
+    free(bench_g.samples);
+    if (bench_g.out != stdout) fclose(bench_g.out);
+    return 0;
+}
+
+#endif /* LUMI_BENCH_H */
@@ -0,0 +1,319 @@
+/**
+ * bench_alloc.c — SDK workloads under different allocators
+ * Copyright 2026 Lumi Team. Apache-2.0
+ *
+ * Runs three allocation-heavy workloads with each allocator installed
+ * through lumi_set_allocator():
+ *   views    build and destroy a 1 + 40 x 25 tree of text views with ids
+ *   storage  set, overwrite and remove 200 keys
+ *   intents  register 2000 handlers, send to each, unregister them
+ * "malloc" is the default, "tracking" counts bytes on top of malloc,
+ * "pool" keeps per-size-class free lists carved from 64 KiB slabs, and
+ * "bump" never frees and rewinds after each round. Times are per
+ * operation (a view, a storage call, a register/send/unregister).
+ */
+
+#include "lumiapp.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define ROUNDS      40
+#define ROWS        40
+#define COLS        25
+#define KEYS        200
+#define ACTIONS     2000
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+/* ── Allocators ────────────────────────────────────────────────── */
+
+typedef struct {
+    size_t live, peak, calls;
+} tracking_t;
+
+static void *tracking_alloc(void *ctx, size_t size) {
+    tracking_t *t = ctx;
+    void *p = malloc(size);
+    if (p && (t->live += size) > t->peak) t->peak = t->live;
+    t->calls++;
+    return p;
+}
+
+static void *tracking_realloc(void *ctx, void *p, size_t old_size, size_t size) {
+    tracking_t *t = ctx;
+    void *q = realloc(p, size);
+    if (q && (t->live += size - old_size) > t->peak) t->peak = t->live;
+    t->calls++;
+    return q;
+}
+
+static void tracking_free(void *ctx, void *p, size_t size) {
+    ((tracking_t *)ctx)->live -= size;
+    free(p);
+}
+
+#define POOL_CLASSES 10                 /* 16 B .. 8 KiB */
+#define POOL_SLAB    (64 * 1024)
+
+typedef struct pool_block { struct pool_block *next; } pool_block_t;
+
+typedef struct {
+    pool_block_t *free[POOL_CLASSES];
+    char *slab, *slab_end;
+    void **slabs;
+    size_t slab_count;
+} pool_t;
+
+static int pool_class(size_t size) {
+    int c = 0;
+    while (c < POOL_CLASSES && ((size_t)16 << c) < size) c++;
+    return c;
+}
+
+static void *pool_alloc(void *ctx, size_t size) {
+    pool_t *p = ctx;
+    int c = pool_class(size);
+    if (c == POOL_CLASSES) return malloc(size);
+    pool_block_t *b = p->free[c];
+    if (b) {
+        p->free[c] = b->next;
+        return b;
+    }
+    size_t bytes = (size_t)16 << c;
+    if ((size_t)(p->slab_end - p->slab) < bytes) {
+        void **slabs = realloc(p->slabs, (p->slab_count + 1) * sizeof(*slabs));
+        char *slab = malloc(POOL_SLAB);
+        if (!slabs || !slab) {
+            free(slab);
+            if (slabs) p->slabs = slabs;
+            return NULL;
+        }
+        p->slabs = slabs;
+        p->slabs[p->slab_count++] = slab;
+        p->slab = slab;
+        p->slab_end = slab + POOL_SLAB;
+    }
+    void *q = p->slab;
+    p->slab += bytes;
+    return q;
+}
+
+static void *pool_realloc(void *ctx, void *q, size_t old_size, size_t size) {
+    if (pool_class(old_size) == POOL_CLASSES && pool_class(size) == POOL_CLASSES) {
+        return realloc(q, size);
+    }
+    if (q && pool_class(old_size) == pool_class(size)) return q;
+    void *r = pool_alloc(ctx, size);
+    if (r && q) {
+        memcpy(r, q, old_size < size ? old_size : size);
+        int c = pool_class(old_size);
+        if (c == POOL_CLASSES) {
+            free(q);
+        } else {
+            pool_t *p = ctx;
+            ((pool_block_t *)q)->next = p->free[c];
+            p->free[c] = q;
+        }
+    }
+    return r;
+}
+
+static void pool_free(void *ctx, void *q, size_t size) {
+    pool_t *p = ctx;
+    int c = pool_class(size);
+    if (c == POOL_CLASSES) {
+        free(q);
+        return;
+    }
+    ((pool_block_t *)q)->next = p->free[c];
+    p->free[c] = q;
+}
+
+#define BUMP_CHUNK (4 * 1024 * 1024)
+
+typedef struct {
+    char **chunks;
+    size_t count, used;                 /* chunks filled, and of the last one */
+    size_t cap;
+} bump_t;
+
+static void *bump_alloc(void *ctx, size_t size) {
+    bump_t *b = ctx;
+    size = (size + 15) & ~(size_t)15;
+    if (size > BUMP_CHUNK) return NULL;
+    if (!b->count || b->used + size > BUMP_CHUNK) {
+        if (b->count == b->cap) {
+            size_t cap = b->cap ? b->cap * 2 : 8;
+            char **chunks = realloc(b->chunks, cap * sizeof(*chunks));
+            if (!chunks) return NULL;
+            b->chunks = chunks;
+            for (size_t i = b->cap; i < cap; i++) b->chunks[i] = NULL;
+            b->cap = cap;
+        }
+        if (!b->chunks[b->count] && !(b->chunks[b->count] = malloc(BUMP_CHUNK))) return NULL;
+        b->count++;
+        b->used = 0;
+    }
+    void *p = b->chunks[b->count - 1] + b->used;
+    b->used += size;
+    return p;
+}
+
+static void bump_free(void *ctx, void *p, size_t size) {
+    (void)ctx; (void)p; (void)size;
+}
+
+/* Called with nothing live; chunks are kept for the next round */
+static void bump_rewind(bump_t *b) {
+    b->count = 0;
+    b->used = 0;
+}
+
+/* ── Workloads ─────────────────────────────────────────────────── */
+
+static void on_intent(const lumi_intent_t *intent, void *ud) {
+    (void)intent;
+    ++*(unsigned long *)ud;
+}
+
+static double run_views(void) {
+    char id[32];
+    double t0 = now_ns();
+    lumi_view_t *root = lumi_column();
+    for (int r = 0; r < ROWS; r++) {
+        lumi_view_t *row = lumi_row();
+        snprintf(id, sizeof(id), "row-%d", r);
+        lumi_view_set_id(row, id);
+        for (int c = 0; c < COLS; c++) {
+            lumi_view_t *text = lumi_text("cell text");
+            snprintf(id, sizeof(id), "cell-%d-%d", r, c);
+            lumi_view_set_id(text, id);
+            lumi_view_add_child(row, text);
+        }
+        lumi_view_add_child(root, row);
+    }
+    lumi_view_destroy(root);
+    return (now_ns() - t0) / (1 + ROWS * (1 + COLS));
+}
+
+static double run_storage(void) {
+    char key[32], value[64];
+    double t0 = now_ns();
+    for (int i = 0; i < KEYS; i++) {
+        snprintf(key, sizeof(key), "key.%d", i);
+        snprintf(value, sizeof(value), "value %d", i);
+        lumi_storage_set(key, value);
+    }
+    for (int i = 0; i < KEYS; i++) {
+        snprintf(key, sizeof(key), "key.%d", i);
+        snprintf(value, sizeof(value), "a longer replacement value %d", i);
+        lumi_storage_set(key, value);
+    }
+    for (int i = 0; i < KEYS; i++) {
+        snprintf(key, sizeof(key), "key.%d", i);
+        lumi_storage_remove(key);
+    }
+    return (now_ns() - t0) / (3 * KEYS);
+}
+
+static char g_actions[ACTIONS][32];
+
+static double run_intents(void) {
+    unsigned long calls = 0;
+    double t0 = now_ns();
+    for (int i = 0; i < ACTIONS; i++) lumi_intent_register(g_actions[i], on_intent, &calls);
+    for (int i = 0; i < ACTIONS; i++) {
+        lumi_intent_t intent = { .action = g_actions[i] };
+        lumi_intent_send(&intent);
+    }
+    for (int i = 0; i < ACTIONS; i++) lumi_intent_unregister(g_actions[i], on_intent, &calls);
+    double ns = (now_ns() - t0) / (3 * ACTIONS);
+    if (calls != ACTIONS) fprintf(stderr, "intents: %lu calls\n", calls);
+    return ns;
+}
+
+typedef double (*workload_fn)(void);
+
+static size_t live_total(void) {
+    size_t total = 0;
+    for (int i = 0; i < LUMI_MEM_SUBSYSTEM_COUNT; i++) {
+        lumi_mem_usage_t u;
+        lumi_mem_get_usage((lumi_mem_subsystem_t)i, &u);
+        total += u.live;
+    }
+    return total;
+}
+
+/* Best round of ROUNDS, after one warm-up */
+static double measure(workload_fn fn, bump_t *bump) {
+    double best = 1e30;
+    for (int r = 0; r <= ROUNDS; r++) {
+        double ns = fn();
+        if (r && ns < best) best = ns;
+        if (bump && live_total() == 0) bump_rewind(bump);
+    }
+    return best;
+}
+
+int main(void) {
+    for (int i = 0; i < ACTIONS; i++) {
+        snprintf(g_actions[i], sizeof(g_actions[i]), "bench.alloc.%d", i);
+    }
+    lumi_log_set_level(LUMI_LOG_WARN);
+
+    tracking_t tracking = { 0 };
+    pool_t pool = { 0 };
+    bump_t bump = { 0 };
+    const struct {
+        const char *name;
+        lumi_allocator_t allocator;
+        bump_t *bump;
+    } allocators[] = {
+        { "malloc",   { 0 }, NULL },
+        { "tracking", { tracking_alloc, tracking_realloc, tracking_free, &tracking }, NULL },
+        { "pool",     { pool_alloc, pool_realloc, pool_free, &pool }, NULL },
+        { "bump",     { bump_alloc, NULL, bump_free, &bump }, &bump },
+    };
+    const struct {
+        const char *name;
+        workload_fn fn;
+    } workloads[] = {
+        { "views",   run_views },
+        { "storage", run_storage },
+        { "intents", run_intents },
+    };
+
+    printf("Allocators, best of %d rounds (ns/op)\n", ROUNDS);
+    printf("  %-10s", "");
+    for (size_t w = 0; w < sizeof(workloads) / sizeof(workloads[0]); w++) {
+        printf(" %9s", workloads[w].name);
+    }
+    printf("\n");
+    for (size_t a = 0; a < sizeof(allocators) / sizeof(allocators[0]); a++) {
+        const lumi_allocator_t *allocator = allocators[a].allocator.alloc
+                                                ? &allocators[a].allocator : NULL;
+        if (lumi_set_allocator(allocator) != LUMI_OK) {
+            fprintf(stderr, "%s: SDK memory still live\n", allocators[a].name);
+            return 1;
+        }
+        printf("  %-10s", allocators[a].name);
+        for (size_t w = 0; w < sizeof(workloads) / sizeof(workloads[0]); w++) {
+            printf(" %9.1f", measure(workloads[w].fn, allocators[a].bump));
+        }
+        printf("\n");
+    }
+    lumi_set_allocator(NULL);
+    printf("  tracking peak %zu bytes over %zu calls\n", tracking.peak, tracking.calls);
+
+    for (size_t i = 0; i < pool.slab_count; i++) free(pool.slabs[i]);
+    free(pool.slabs);
+    for (size_t i = 0; i < bump.cap; i++) free(bump.chunks[i]);
+    free(bump.chunks);
+    return 0;
+}
@@ -0,0 +1,296 @@
+/**
+ * bench_core.c — Microbenchmarks of the core library
+ * Copyright 2026 Lumi Team. Apache-2.0
+ *
+ * One case per public operation that apps call in bulk: storage, timers,
+ * intent fan-out, view construction, deep and wide trees, toolkit lists,
+ * file I/O and logging. Meant for comparing releases: run with
+ * --json FILE (make bench BENCH_JSON=dir) and diff the ns_per_op and
+ * allocs_per_op of each case.
+ */
+
+#include "bench.h"
+#include "lumi_toolkit.h"
+#include <fcntl.h>
+
+#define TIMER_BATCH 200                 /* of the 256 timer slots */
+#define TREE_DEPTH  100
+#define TREE_WIDTH  256                 /* a container's limit */
+
+/* ── Storage ───────────────────────────────────────────────────── */
+
+typedef struct {
+    size_t n;
+    char (*keys)[16];
+    size_t next;                        /* rotation over keys */
+    size_t removed;                     /* from next onwards, for reset */
+} storage_ctx_t;
+
+static void storage_fill(storage_ctx_t *s) {
+    for (size_t i = 0; i < s->n; i++) lumi_storage_set(s->keys[i], "stored value");
+}
+
+static void storage_get(void *ctx, size_t i) {
+    storage_ctx_t *s = ctx;
+    (void)i;
+    s->next = (s->next + 7) % s->n;
+    if (!lumi_storage_get(s->keys[s->next])) abort();
+}
+
+static void storage_set(void *ctx, size_t i) {
+    storage_ctx_t *s = ctx;
+    s->next = (s->next + 7) % s->n;
+    lumi_storage_set(s->keys[s->next], i & 1 ? "a replacement value" : "stored value");
+}
+
+/* Puts back the keys the previous sample removed */
+static void storage_refill(void *ctx) {
+    storage_ctx_t *s = ctx;
+    for (size_t i = 0; i < s->removed; i++) {
+        lumi_storage_set(s->keys[(s->next + i) % s->n], "stored value");
+    }
+    s->next = (s->next + s->removed) % s->n;
+    s->removed = 0;
+}
+
+static void storage_remove(void *ctx, size_t i) {
+    storage_ctx_t *s = ctx;
+    lumi_storage_remove(s->keys[(s->next + i) % s->n]);
+    s->removed++;
+}
+
+static void bench_storage(size_t n) {
+    storage_ctx_t s = { .n = n, .keys = malloc(n * sizeof(*s.keys)) };
+    if (!s.keys) abort();
+    for (size_t i = 0; i < n; i++) snprintf(s.keys[i], sizeof(s.keys[i]), "key.%zu", i);
+    storage_fill(&s);
+
+    bench_run(&(bench_case_t){ "storage.get", n, 0, NULL, storage_get, &s });
+    bench_run(&(bench_case_t){ "storage.set", n, 0, NULL, storage_set, &s });
+    bench_run(&(bench_case_t){ "storage.remove", n, n, storage_refill, storage_remove, &s });
+
+    storage_refill(&s);
+    lumi_storage_clear();
+    free(s.keys);
+}
+
+/* ── Timers ────────────────────────────────────────────────────── */
+
+typedef struct {
+    int ids[TIMER_BATCH];
+    size_t count;
+} timer_ctx_t;
+
+static void timer_noop(void *ud) {
+    (void)ud;
+}
+
+static void timer_cancel_all(void *ctx) {
+    timer_ctx_t *t = ctx;
+    for (size_t i = 0; i < t->count; i++) lumi_timer_cancel(t->ids[i]);
+    t->count = 0;
+}
+
+static void timer_set(void *ctx, size_t i) {
+    timer_ctx_t *t = ctx;
+    t->ids[i] = lumi_timer_set(60000, false, timer_noop, NULL);
+    t->count = i + 1;
+}
+
+static void timer_refill(void *ctx) {
+    timer_ctx_t *t = ctx;
+    timer_cancel_all(t);
+    for (size_t i = 0; i < TIMER_BATCH; i++) {
+        t->ids[i] = lumi_timer_set(60000, false, timer_noop, NULL);
+    }
+    t->count = TIMER_BATCH;
+}
+
+static void timer_cancel(void *ctx, size_t i) {
+    lumi_timer_cancel(((timer_ctx_t *)ctx)->ids[i]);
+}
+
+/* ── Intents ───────────────────────────────────────────────────── */
+
+static unsigned long g_delivered;
+
+static void on_intent(const lumi_intent_t *intent, void *ud) {
+    (void)intent; (void)ud;
+    g_delivered++;
+}
+
+static void intent_send(void *ctx, size_t i) {
+    (void)i;
+    lumi_intent_send(ctx);
+}
+
+static void bench_fanout(size_t handlers) {
+    static int tokens[256];
+    lumi_intent_t intent = { .action = "bench.fanout" };
+    for (size_t h = 0; h < handlers; h++) lumi_intent_register(intent.action, on_intent, &tokens[h]);
+    bench_run(&(bench_case_t){ "intent.send_fanout", handlers, 0, NULL, intent_send, &intent });
+    for (size_t h = 0; h < handlers; h++) lumi_intent_unregister(intent.action, on_intent, &tokens[h]);
+}
+
+/* ── Views ─────────────────────────────────────────────────────── */
+
+static void view_create_destroy(void *ctx, size_t i) {
+    (void)ctx; (void)i;
+    lumi_view_destroy(lumi_text("label"));
+}
+
+static lumi_view_t *deep_tree(void) {
+    lumi_view_t *root = lumi_column(), *v = root;
+    for (int d = 1; d < TREE_DEPTH; d++) {
+        lumi_view_t *child = lumi_column();
+        lumi_view_set_padding(child, 1, 1, 1, 1);
+        lumi_view_add_child(v, child);
+        v = child;
+    }
+    lumi_view_add_child(v, lumi_text("leaf"));
+    return root;
+}
+
+static lumi_view_t *wide_tree(void) {
+    lumi_view_t *root = lumi_column();
+    for (int i = 0; i < TREE_WIDTH; i++) lumi_view_add_child(root, lumi_text("item"));
+    return root;
+}
+
+typedef struct {
+    lumi_view_t *(*build)(void);
+} tree_ctx_t;
+
+static void tree_build(void *ctx, size_t i) {
+    (void)i;
+    lumi_view_destroy(((tree_ctx_t *)ctx)->build());
+}
+
+static void tree_layout(void *ctx, size_t i) {
+    lumi_view_layout(ctx, 480.0f, i & 1 ? 800.0f : 801.0f);
+}
+
+static lumi_view_t *list_item(int index, void *item, void *userdata) {
+    (void)index; (void)userdata;
+    return lumi_text(item);
+}
+
+static void *g_list_items[TREE_WIDTH];
+
+static void tk_list(void *ctx, size_t i) {
+    (void)i;
+    lumi_view_destroy(lumi_tk_list(g_list_items, *(int *)ctx, list_item, NULL));
+}
+
+/* ── Files ─────────────────────────────────────────────────────── */
+
+typedef struct {
+    const char *path;
+    char *data;
+    size_t len;
+} file_ctx_t;
+
+static void file_write(void *ctx, size_t i) {
+    file_ctx_t *f = ctx;
+    (void)i;
+    if (lumi_file_write(f->path, f->data, f->len) != LUMI_OK) abort();
+}
+
+static void file_read(void *ctx, size_t i) {
+    file_ctx_t *f = ctx;
+    char *data;
+    size_t len;
+    (void)i;
+    if (lumi_file_read(f->path, &data, &len) != LUMI_OK || len != f->len) abort();
+    free(data);
+}
+
+static void bench_file(size_t len) {
+    file_ctx_t f = { "/tmp/lumi_bench_core.dat", malloc(len), len };
+    if (!f.data) abort();
+    memset(f.data, 'x', len);
+    bench_run(&(bench_case_t){ "file.write", len, 0, NULL, file_write, &f });
+    bench_run(&(bench_case_t){ "file.read", len, 0, NULL, file_read, &f });
+    lumi_file_remove(f.path);
+    free(f.data);
+}
+
+/* ── Logging ───────────────────────────────────────────────────── */
+
+static void log_line(void *ctx, size_t i) {
+    lumi_log(*(lumi_log_level_t *)ctx, "bench", "request %zu took %d ms", i, 42);
+}
+
+static void log_drain(void *ctx) {
+    (void)ctx;
+    lumi_log_flush();
+}
+
+static void bench_log(void) {
+    static lumi_log_level_t debug = LUMI_LOG_DEBUG, info = LUMI_LOG_INFO;
+
+    /* Lines go to /dev/null; the table is on the harness's own stdout */
+    fflush(stdout);
+    int saved = dup(STDOUT_FILENO), null = open("/dev/null", O_WRONLY);
+    dup2(null, STDOUT_FILENO);
+    close(null);
+
+    lumi_log_set_level(LUMI_LOG_INFO);
+    bench_run(&(bench_case_t){ "log.filtered", 0, 0, NULL, log_line, &debug });
+    bench_run(&(bench_case_t){ "log.sync", 0, 0, NULL, log_line, &info });
+    lumi_log_set_mode(LUMI_LOG_ASYNC_BLOCK);
+    bench_run(&(bench_case_t){ "log.async", 0, 0, log_drain, log_line, &info });
+    lumi_log_set_deferred(true);
+    bench_run(&(bench_case_t){ "log.async_deferred", 0, 0, log_drain, log_line, &info });
+    lumi_log_set_deferred(false);
+    lumi_log_set_mode(LUMI_LOG_SYNC);
+    lumi_log_set_level(LUMI_LOG_WARN);
+
+    fflush(stdout);
+    dup2(saved, STDOUT_FILENO);
+    close(saved);
+}
+
+int main(int argc, char **argv) {
+    lumi_log_set_level(LUMI_LOG_WARN);
+    bench_init(argc, argv, "core");
+
+    bench_storage(100);
+    bench_storage(1000);
+    bench_skip("storage.get", 100000, "storage holds at most 1024 keys");
+    bench_skip("storage.set", 100000, "storage holds at most 1024 keys");
+    bench_skip("storage.remove", 100000, "storage holds at most 1024 keys");
+
+    timer_ctx_t timers = { .count = 0 };
+    bench_run(&(bench_case_t){ "timer.set", 0, TIMER_BATCH, timer_cancel_all, timer_set, &timers });
+    bench_run(&(bench_case_t){ "timer.cancel", 0, TIMER_BATCH, timer_refill, timer_cancel, &timers });
+    timer_cancel_all(&timers);
+
+    bench_fanout(1);
+    bench_fanout(16);
+    bench_fanout(256);
+
+    bench_run(&(bench_case_t){ "view.create_destroy", 1, 0, NULL, view_create_destroy, NULL });
+    tree_ctx_t deep_build = { deep_tree }, wide_build = { wide_tree };
+    bench_run(&(bench_case_t){ "tree.deep.build", TREE_DEPTH + 1, 0, NULL, tree_build, &deep_build });
+    bench_run(&(bench_case_t){ "tree.wide.build", TREE_WIDTH + 1, 0, NULL, tree_build, &wide_build });
+    lumi_view_t *deep = deep_tree(), *wide = wide_tree();
+    bench_run(&(bench_case_t){ "tree.deep.layout", TREE_DEPTH + 1, 0, NULL, tree_layout, deep });
+    bench_run(&(bench_case_t){ "tree.wide.layout", TREE_WIDTH + 1, 0, NULL, tree_layout, wide });
+    lumi_view_destroy(deep);
+    lumi_view_destroy(wide);
+
+    static int list_sizes[] = { 16, 64, TREE_WIDTH };
+    for (int i = 0; i < TREE_WIDTH; i++) g_list_items[i] = "list item";
+    for (size_t i = 0; i < sizeof(list_sizes) / sizeof(list_sizes[0]); i++) {
+        bench_run(&(bench_case_t){ "tk.list", (size_t)list_sizes[i], 0, NULL, tk_list,
+                                   &list_sizes[i] });
+    }
+
+    bench_file(1024);
+    bench_file(64 * 1024);
+    bench_file(1024 * 1024);
+
+    bench_log();
+    return bench_finish();
+}
@@ -0,0 +1,139 @@
+/**
+ * bench_extras.c — Typed extras against JSON strings in intent payloads
+ * Copyright 2026 Lumi Team. Apache-2.0
+ *
+ * A "now playing" update of eight fields goes from sender to handler the
+ * way apps did it before extras (snprintf into JSON, then scanning the
+ * text for the fields the handler needs) and with typed extras (a reused
+ * builder, then lookups on the encoded map). The wide case has 64 fields
+ * of which the handler reads two, which is where not decoding pays off.
+ * Handlers read an int, a float and a string; the JSON side copies the
+ * string out, as unescaping would.
+ */
+
+#include "lumiapp.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define ROUNDS 200000
+#define WIDE   64
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+/* Just enough JSON scanning for flat objects without escapes */
+static const char *json_find(const char *json, const char *key) {
+    char pat[48];
+    snprintf(pat, sizeof(pat), "\"%s\":", key);
+    const char *p = strstr(json, pat);
+    return p ? p + strlen(pat) : NULL;
+}
+
+static long long json_int(const char *json, const char *key) {
+    const char *p = json_find(json, key);
+    return p ? strtoll(p, NULL, 10) : 0;
+}
+
+static double json_float(const char *json, const char *key) {
+    const char *p = json_find(json, key);
+    return p ? strtod(p, NULL) : 0.0;
+}
+
+static size_t json_string(const char *json, const char *key, char *out, size_t size) {
+    const char *p = json_find(json, key);
+    if (!p || *p != '"') return 0;
+    const char *end = strchr(++p, '"');
+    size_t n = end && (size_t)(end - p) < size ? (size_t)(end - p) : 0;
+    memcpy(out, p, n);
+    out[n] = '\0';
+    return n;
+}
+
+static size_t json_build(char *buf, size_t size, int i, int fields) {
+    int n = snprintf(buf, size,
+                     "{\"track\":%d,\"position_ms\":%d,\"duration_ms\":215000,"
+                     "\"volume\":%.3f,\"playing\":1,\"title\":\"Harbour Lights\","
+                     "\"artist\":\"The Lumi Ensemble\",\"album\":\"Night Ferry\"",
+                     i % 12, i * 40, 0.25 + (i % 4) * 0.125);
+    for (int f = 8; f < fields; f++) {
+        n += snprintf(buf + n, size - (size_t)n, ",\"field_%02d\":%d", f, f * i);
+    }
+    n += snprintf(buf + n, size - (size_t)n, "}");
+    return (size_t)n;
+}
+
+static void extras_build(lumi_extras_t *ex, int i, int fields) {
+    char key[16];
+    lumi_extras_clear(ex);
+    lumi_extras_put_int(ex, "track", i % 12);
+    lumi_extras_put_int(ex, "position_ms", i * 40);
+    lumi_extras_put_int(ex, "duration_ms", 215000);
+    lumi_extras_put_float(ex, "volume", 0.25 + (i % 4) * 0.125);
+    lumi_extras_put_int(ex, "playing", 1);
+    lumi_extras_put_string(ex, "title", "Harbour Lights");
+    lumi_extras_put_string(ex, "artist", "The Lumi Ensemble");
+    lumi_extras_put_string(ex, "album", "Night Ferry");
+    for (int f = 8; f < fields; f++) {
+        snprintf(key, sizeof(key), "field_%02d", f);
+        lumi_extras_put_int(ex, key, f * i);
+    }
+}
+
+static void run(const char *name, int fields) {
+    static char json[4096];
+    char title[64];
+    volatile double sink = 0;
+
+    double t0 = now_ns();
+    for (int i = 0; i < ROUNDS; i++) json_build(json, sizeof(json), i, fields);
+    double json_enc = (now_ns() - t0) / ROUNDS;
+    t0 = now_ns();
+    for (int i = 0; i < ROUNDS; i++) {
+        sink += (double)json_int(json, "position_ms") + json_float(json, "volume");
+        sink += (double)json_string(json, "title", title, sizeof(title));
+    }
+    double json_dec = (now_ns() - t0) / ROUNDS;
+    size_t json_len = strlen(json);
+
+    lumi_extras_t *ex = lumi_extras_create();
+    const void *data;
+    size_t len = 0;
+    t0 = now_ns();
+    for (int i = 0; i < ROUNDS; i++) {
+        extras_build(ex, i, fields);
+        lumi_extras_encode(ex, &data, &len);
+    }
+    double ex_enc = (now_ns() - t0) / ROUNDS;
+    t0 = now_ns();
+    for (int i = 0; i < ROUNDS; i++) {
+        lumi_extras_view_t v;
+        int64_t pos = 0;
+        double volume = 0;
+        const char *s = "";
+        lumi_extras_open(&v, data, len);
+        lumi_extras_get_int(&v, "position_ms", &pos);
+        lumi_extras_get_float(&v, "volume", &volume);
+        lumi_extras_get_string(&v, "title", &s);
+        sink += (double)pos + volume + (double)(s[0]);
+    }
+    double ex_dec = (now_ns() - t0) / ROUNDS;
+    lumi_extras_destroy(ex);
+
+    printf("%s (%d fields)\n", name, fields);
+    printf("  json    %4zu bytes  encode %7.1f ns  read 3 fields %7.1f ns\n",
+           json_len, json_enc, json_dec);
+    printf("  extras  %4zu bytes  encode %7.1f ns  read 3 fields %7.1f ns\n",
+           len, ex_enc, ex_dec);
+    (void)sink;
+}
+
+int main(void) {
+    run("now playing", 8);
+    run("wide", WIDE);
+    return 0;
+}
@@ -0,0 +1,97 @@
+/**
+ * bench_hittest.c — Hit-test latency on a 10k-node view tree
+ * Copyright 2026 Lumi Team. Apache-2.0
+ *
+ * Compares lumi_view_hit_test (per-container sorted index) against a
+ * naive recursive walk over the public tree API.
+ */
+
+#include "lumiapp.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define ROWS     100
+#define COLS     99      /* 1 + ROWS + ROWS * COLS = 10001 nodes */
+#define CELL     40.0f
+#define QUERIES  200000
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+static lumi_view_t *build_tree(void) {
+    lumi_view_t *root = lumi_column();
+    for (int r = 0; r < ROWS; r++) {
+        lumi_view_t *row = lumi_row();
+        for (int c = 0; c < COLS; c++) {
+            lumi_view_t *cell = lumi_button("x");
+            lumi_view_set_width(cell, CELL);
+            lumi_view_set_height(cell, CELL);
+            lumi_view_add_child(row, cell);
+        }
+        lumi_view_add_child(root, row);
+    }
+    return root;
+}
+
+static lumi_view_t *naive_hit(lumi_view_t *v, float x, float y) {
+    float fx, fy, fw, fh;
+    lumi_view_get_frame(v, &fx, &fy, &fw, &fh);
+    if (!lumi_view_get_visible(v) || x < fx || y < fy || x >= fx + fw || y >= fy + fh) {
+        return NULL;
+    }
+    for (int i = lumi_view_get_child_count(v) - 1; i >= 0; i--) {
+        lumi_view_t *hit = naive_hit(lumi_view_get_child(v, i), x - fx, y - fy);
+        if (hit) return hit;
+    }
+    return v;
+}
+
+int main(void) {
+    float extent = ROWS * CELL;
+    lumi_view_t *root = build_tree();
+    lumi_view_layout(root, COLS * CELL, extent);
+
+    float *xs = malloc(QUERIES * sizeof(float));
+    float *ys = malloc(QUERIES * sizeof(float));
+    srand(42);
+    for (int i = 0; i < QUERIES; i++) {
+        xs[i] = (float)rand() / (float)RAND_MAX * (COLS * CELL - 1.0f);
+        ys[i] = (float)rand() / (float)RAND_MAX * (extent - 1.0f);
+    }
+
+    double t0 = now_ns();
+    lumi_view_hit_test(root, xs[0], ys[0]);     /* builds the indexes */
+    double build = now_ns() - t0;
+
+    volatile uintptr_t sink = 0;
+    t0 = now_ns();
+    for (int i = 0; i < QUERIES; i++) sink ^= (uintptr_t)lumi_view_hit_test(root, xs[i], ys[i]);
+    double indexed = (now_ns() - t0) / QUERIES;
+
+    int naive_n = QUERIES / 20;
+    t0 = now_ns();
+    for (int i = 0; i < naive_n; i++) sink ^= (uintptr_t)naive_hit(root, xs[i], ys[i]);
+    double naive = (now_ns() - t0) / naive_n;
+
+    for (int i = 0; i < 1000; i++) {
+        if (lumi_view_hit_test(root, xs[i], ys[i]) != naive_hit(root, xs[i], ys[i])) {
+            fprintf(stderr, "mismatch at (%.1f, %.1f)\n", xs[i], ys[i]);
+            return 1;
+        }
+    }
+
+    printf("hit_test nodes=%d\n", 1 + ROWS + ROWS * COLS);
+    printf("  index build (first query)  %10.1f us\n", build / 1000.0);
+    printf("  indexed                    %10.1f ns/op\n", indexed);
+    printf("  naive walk                 %10.1f ns/op\n", naive);
+
+    (void)sink;
+    free(xs);
+    free(ys);
+    lumi_view_destroy(root);
+    return 0;
+}
@@ -0,0 +1,64 @@
+/**
+ * bench_intent.c — Intent dispatch cost with many registered actions
+ * Copyright 2026 Lumi Team. Apache-2.0
+ *
+ * Registers a few thousand distinct actions plus some wildcard patterns,
+ * then broadcasts to a handful of them. Compares lumi_intent_send against
+ * a linear strcmp scan over the same registrations.
+ */
+
+#include "lumiapp.h"
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#define ACTIONS  4000
+#define SENDS    200000
+
+static char g_names[ACTIONS][48];
+static unsigned long g_calls;
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+static void on_intent(const lumi_intent_t *intent, void *ud) {
+    (void)intent;
+    (void)ud;
+    g_calls++;
+}
+
+/* The dispatch this replaced: one strcmp per registration */
+static void naive_send(const lumi_intent_t *intent) {
+    for (int i = 0; i < ACTIONS; i++) {
+        if (strcmp(g_names[i], intent->action) == 0) on_intent(intent, NULL);
+    }
+}
+
+int main(void) {
+    lumi_log_set_level(LUMI_LOG_WARN);
+    for (int i = 0; i < ACTIONS; i++) {
+        snprintf(g_names[i], sizeof(g_names[i]), "com.lumios.app%d.event.UPDATE%d", i % 40, i);
+        lumi_intent_register(g_names[i], on_intent, NULL);
+    }
+    lumi_intent_register("com.lumios.media.*", on_intent, NULL);
+    lumi_intent_register("com.lumios.app7.*", on_intent, NULL);
+
+    lumi_intent_t intents[4];
+    for (int i = 0; i < 4; i++) intents[i] = (lumi_intent_t){ .action = g_names[i * 997] };
+
+    double t0 = now_ns();
+    for (int i = 0; i < SENDS; i++) lumi_intent_send(&intents[i & 3]);
+    double hashed = (now_ns() - t0) / SENDS;
+
+    t0 = now_ns();
+    for (int i = 0; i < SENDS; i++) naive_send(&intents[i & 3]);
+    double naive = (now_ns() - t0) / SENDS;
+
+    printf("intent send (%d actions, 2 wildcard patterns)\n", ACTIONS);
+    printf("  hashed                       %7.1f ns/op\n", hashed);
+    printf("  linear scan                  %7.1f ns/op\n", naive);
+    return g_calls ? 0 : 1;
+}
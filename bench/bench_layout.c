@@ -0,0 +1,105 @@
+/**
+ * bench_layout.c — Full layout and paint passes, pointer vs packed trees
+ * Copyright 2026 Lumi Team. Apache-2.0
+ *
+ * Two identical long lists (card rows with icon, two labels, spacer and
+ * button) are built interleaved, as an app heap would be, and one of them
+ * is packed. Layout is timed at a fixed size (every node visited, no frame
+ * changes) and while resizing (every frame changes); paint records the
+ * whole tree with no repaint boundaries.
+ */
+
+#include "lumiapp.h"
+#include <stdio.h>
+#include <time.h>
+
+#define ROWS   2000
+#define ROUNDS 50
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+static lumi_view_t *make_row(int i) {
+    static const char *titles[] = { "Inbox", "Drafts", "Sent messages", "Archive" };
+    lumi_view_t *row = lumi_row();
+    lumi_view_set_padding(row, 8, 12, 8, 12);
+    lumi_view_set_background(row, i % 2 ? 0xFFFFFFFF : 0xFAFAFAFF);
+
+    lumi_view_t *icon = lumi_image("res://icons/folder.png");
+    lumi_view_set_width(icon, 24.0f);
+    lumi_view_set_height(icon, 24.0f);
+    lumi_view_add_child(row, icon);
+
+    lumi_view_t *labels = lumi_column();
+    lumi_view_add_child(labels, lumi_text(titles[i % 4]));
+    lumi_view_t *sub = lumi_text("Updated just now");
+    lumi_view_set_font_size(sub, 12.0f);
+    lumi_view_add_child(labels, sub);
+    lumi_view_add_child(row, labels);
+
+    lumi_view_add_child(row, lumi_spacer());
+    lumi_view_add_child(row, lumi_button("Open"));
+    return row;
+}
+
+typedef struct {
+    double layout, resize, paint;
+} timing_t;
+
+static timing_t run(lumi_view_t *root, lumi_display_list_t *dl) {
+    timing_t t;
+    lumi_view_layout(root, 360.0f, 640.0f);
+
+    double t0 = now_ns();
+    for (int r = 0; r < ROUNDS; r++) lumi_view_layout(root, 360.0f, 640.0f);
+    t.layout = (now_ns() - t0) / ROUNDS;
+
+    t0 = now_ns();
+    for (int r = 0; r < ROUNDS; r++) lumi_view_layout(root, 360.0f + (float)(r % 2), 640.0f);
+    t.resize = (now_ns() - t0) / ROUNDS;
+
+    t0 = now_ns();
+    for (int r = 0; r < ROUNDS; r++) lumi_view_paint(root, dl);
+    t.paint = (now_ns() - t0) / ROUNDS;
+    return t;
+}
+
+int main(void) {
+    lumi_view_t *plain = lumi_scroll();
+    lumi_view_t *packed = lumi_scroll();
+    lumi_view_t *plain_list = NULL, *packed_list = NULL;
+    int views = 1;
+
+    /* MAX_CHILDREN caps a container, so rows are grouped in sections */
+    for (int i = 0; i < ROWS; i++) {
+        if (i % 200 == 0) {
+            plain_list = lumi_column();
+            packed_list = lumi_column();
+            lumi_view_add_child(plain, plain_list);
+            lumi_view_add_child(packed, packed_list);
+            views++;
+        }
+        lumi_view_add_child(plain_list, make_row(i));
+        lumi_view_add_child(packed_list, make_row(i));
+        views += 7;
+    }
+    if (lumi_view_set_packed(packed, true) != LUMI_OK) return 1;
+
+    lumi_display_list_t *dl = lumi_display_list_create();
+    timing_t a = run(plain, dl);
+    timing_t b = run(packed, dl);
+
+    printf("layout & paint (%d views, %zu draw ops)\n", views, lumi_display_list_count(dl));
+    printf("                               pointer      packed\n");
+    printf("  layout, same size          %7.1f us  %7.1f us\n", a.layout / 1000.0, b.layout / 1000.0);
+    printf("  layout, resizing           %7.1f us  %7.1f us\n", a.resize / 1000.0, b.resize / 1000.0);
+    printf("  paint                      %7.1f us  %7.1f us\n", a.paint / 1000.0, b.paint / 1000.0);
+
+    lumi_display_list_destroy(dl);
+    lumi_view_destroy(plain);
+    lumi_view_destroy(packed);
+    return 0;
+}
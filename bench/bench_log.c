@@ -0,0 +1,122 @@
+/**
+ * bench_log.c — Synchronous against async logging on the caller's thread
+ * Copyright 2026 Lumi Team. Apache-2.0
+ *
+ * One and four threads each log a short formatted line in a loop with
+ * stdout pointed at /dev/null. "call" is what a lumi_log() costs the
+ * thread that makes it; "total" adds the time until lumi_log_flush()
+ * returns, i.e. until the writer has caught up, both per line. With four
+ * threads "call" adds up their time, so on fewer cores it includes
+ * waiting for the CPU. The async rows also show how many writev() calls
+ * the lines took and how many were dropped. "deferred" only stores the
+ * arguments on the caller's thread and leaves the formatting to the
+ * writer; "binary" leaves it to lumi-logdump by writing a binary log.
+ * The last rows time a LUMI_LOGD() that its level filters out, with no
+ * tag levels set and with 48 tags set, one of them to DEBUG.
+ */
+
+#include "lumiapp.h"
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <time.h>
+#include <unistd.h>
+
+#define LINES 200000
+
+typedef struct {
+    int    id, lines;
+    double ns;
+} job_t;
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+static void *worker(void *arg) {
+    job_t *job = arg;
+    double t0 = now_ns();
+    for (int i = 0; i < job->lines; i++) {
+        lumi_log(LUMI_LOG_INFO, "bench", "frame %d took %.3f ms (thread %d)", i, (i % 977) * 0.017,
+                 job->id);
+    }
+    job->ns = now_ns() - t0;
+    return NULL;
+}
+
+static void run(const char *name, lumi_log_mode_t mode, int threads, bool deferred,
+                const char *file) {
+    job_t jobs[4];
+    pthread_t t[4];
+    lumi_log_stats_t before, after;
+    lumi_log_set_mode(mode);
+    lumi_log_set_deferred(deferred);
+    if (file) lumi_log_set_binary_file(file);
+    lumi_log_get_stats(&before);
+
+    double t0 = now_ns();
+    for (int i = 0; i < threads; i++) {
+        jobs[i] = (job_t){ .id = i, .lines = LINES / threads };
+        pthread_create(&t[i], NULL, worker, &jobs[i]);
+    }
+    double call = 0;
+    for (int i = 0; i < threads; i++) {
+        pthread_join(t[i], NULL);
+        call += jobs[i].ns;
+    }
+    lumi_log_flush();
+    double total = now_ns() - t0;
+    lumi_log_get_stats(&after);
+    if (file) {
+        lumi_log_set_binary_file(NULL);
+        unlink(file);
+    }
+    lumi_log_set_deferred(false);
+    lumi_log_set_mode(LUMI_LOG_SYNC);
+
+    fprintf(stderr, "  %-12s %d thread%s  call %7.1f ns  total %7.1f ns/line", name, threads,
+            threads > 1 ? "s" : " ", call / LINES, total / LINES);
+    if (mode != LUMI_LOG_SYNC) {
+        fprintf(stderr, "  %6zu writes  %6zu dropped", after.writes - before.writes,
+                after.dropped - before.dropped);
+    }
+    fprintf(stderr, "\n");
+}
+
+static void filtered(const char *name, const char *tag) {
+    volatile int sink = 0;
+    double t0 = now_ns();
+    for (int i = 0; i < LINES * 10; i++) LUMI_LOGD(tag, "frame %d", sink++);
+    fprintf(stderr, "  %-22s %5.1f ns/call  (%d logged)\n", name, (now_ns() - t0) / (LINES * 10),
+            sink);
+}
+
+int main(void) {
+    fflush(stdout);
+    int null = open("/dev/null", O_WRONLY);
+    dup2(null, STDOUT_FILENO);
+    close(null);
+
+    fprintf(stderr, "lumi_log of %d lines to /dev/null\n", LINES);
+    for (int threads = 1; threads <= 4; threads *= 4) {
+        run("sync", LUMI_LOG_SYNC, threads, false, NULL);
+        run("async block", LUMI_LOG_ASYNC_BLOCK, threads, false, NULL);
+        run("async drop", LUMI_LOG_ASYNC_DROP, threads, false, NULL);
+        run("deferred", LUMI_LOG_ASYNC_BLOCK, threads, true, NULL);
+        run("binary", LUMI_LOG_ASYNC_BLOCK, threads, true, "/tmp/lumi-bench-log.bin");
+    }
+
+    fprintf(stderr, "LUMI_LOGD below the level, %d calls\n", LINES * 10);
+    filtered("no tag levels", "bench");
+    char tags[48][16];
+    for (int i = 0; i < 48; i++) {
+        snprintf(tags[i], sizeof(tags[i]), "subsystem%d", i);
+        lumi_log_set_tag_level(tags[i], i ? LUMI_LOG_WARN : LUMI_LOG_DEBUG);
+    }
+    filtered("48 tag levels, unset", "bench");
+    filtered("48 tag levels, WARN", tags[7]);
+    return 0;
+}
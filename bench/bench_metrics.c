@@ -0,0 +1,75 @@
+/**
+ * bench_metrics.c — Cost of metric updates, alone and from four threads
+ * Copyright 2026 Lumi Team. Apache-2.0
+ *
+ * "counter" is lumi_metric_add() on one sharded counter, "atomic" the
+ * same loop on a single shared atomic for comparison, and "histogram"
+ * lumi_metric_record(). Times are per update on each thread; on fewer
+ * cores than threads they include waiting for the CPU.
+ */
+
+#include "lumiapp.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <time.h>
+
+#define UPDATES 2000000
+
+typedef enum { COUNTER, ATOMIC, HISTOGRAM } kind_t;
+
+typedef struct {
+    kind_t kind;
+    double ns;
+} job_t;
+
+static lumi_metric_t *g_counter, *g_hist;
+static _Atomic uint64_t g_atomic;
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+static void *worker(void *arg) {
+    job_t *job = arg;
+    double t0 = now_ns();
+    for (uint64_t i = 0; i < UPDATES; i++) {
+        switch (job->kind) {
+            case COUNTER:   lumi_metric_add(g_counter, 1); break;
+            case ATOMIC:    atomic_fetch_add_explicit(&g_atomic, 1, memory_order_relaxed); break;
+            case HISTOGRAM: lumi_metric_record(g_hist, i & 0xfffff); break;
+        }
+    }
+    job->ns = now_ns() - t0;
+    return NULL;
+}
+
+static void run(const char *name, kind_t kind, int threads) {
+    job_t jobs[4];
+    pthread_t t[4];
+    for (int i = 0; i < threads; i++) {
+        jobs[i] = (job_t){ .kind = kind };
+        pthread_create(&t[i], NULL, worker, &jobs[i]);
+    }
+    double ns = 0;
+    for (int i = 0; i < threads; i++) {
+        pthread_join(t[i], NULL);
+        ns += jobs[i].ns;
+    }
+    printf("  %-10s %d thread%s  %6.1f ns/update\n", name, threads, threads > 1 ? "s" : " ",
+           ns / ((double)threads * UPDATES));
+}
+
+int main(void) {
+    g_counter = lumi_metric_counter("bench_updates_total", "Updates");
+    g_hist = lumi_metric_histogram("bench_values", "Values");
+    printf("Metric updates, %d per thread\n", UPDATES);
+    for (int threads = 1; threads <= 4; threads *= 4) {
+        run("counter", COUNTER, threads);
+        run("atomic", ATOMIC, threads);
+        run("histogram", HISTOGRAM, threads);
+    }
+    return 0;
+}
@@ -0,0 +1,91 @@
+/**
+ * bench_snapshot.c — Inflating a first screen from a snapshot
+ * Copyright 2026 Lumi Team. Apache-2.0
+ *
+ * Builds a typical settings screen (header plus sections of rows with
+ * icon, title, subtitle and switch) with the constructors and setters,
+ * then times rebuilding it that way against loading its snapshot.
+ */
+
+#include "lumiapp.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define ROUNDS   2000
+#define SECTIONS 6
+#define ROWS     8
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+static lumi_view_t *build_screen(void) {
+    char id[32];
+    lumi_view_t *root = lumi_column();
+    lumi_view_t *title = lumi_text("Settings");
+    lumi_view_set_id(title, "title");
+    lumi_view_set_font_size(title, 22.0f);
+    lumi_view_set_padding(title, 16, 16, 8, 16);
+    lumi_view_add_child(root, title);
+
+    for (int s = 0; s < SECTIONS; s++) {
+        lumi_view_t *card = lumi_card();
+        lumi_view_set_margin(card, 8, 12, 8, 12);
+        lumi_view_set_border_radius(card, 12.0f);
+        for (int r = 0; r < ROWS; r++) {
+            lumi_view_t *row = lumi_row();
+            snprintf(id, sizeof(id), "row-%d-%d", s, r);
+            lumi_view_set_id(row, id);
+            lumi_view_set_padding(row, 12, 16, 12, 16);
+
+            lumi_view_t *icon = lumi_image("res://icons/setting.png");
+            lumi_view_set_width(icon, 24.0f);
+            lumi_view_set_height(icon, 24.0f);
+            lumi_view_add_child(row, icon);
+
+            lumi_view_t *labels = lumi_column();
+            lumi_view_add_child(labels, lumi_text("Option title"));
+            lumi_view_t *sub = lumi_text("A short description of what this does");
+            lumi_view_set_font_size(sub, 12.0f);
+            lumi_view_set_foreground(sub, 0x757575FF);
+            lumi_view_add_child(labels, sub);
+            lumi_view_add_child(row, labels);
+
+            lumi_view_add_child(row, lumi_spacer());
+            lumi_view_add_child(row, lumi_button("On"));
+            lumi_view_add_child(card, row);
+        }
+        lumi_view_add_child(root, card);
+    }
+    return root;
+}
+
+int main(void) {
+    lumi_view_t *screen = build_screen();
+    uint8_t *data;
+    size_t len;
+    if (lumi_view_serialize(screen, &data, &len) != LUMI_OK) return 1;
+    lumi_view_destroy(screen);
+
+    double t0 = now_ns();
+    for (int r = 0; r < ROUNDS; r++) lumi_view_destroy(build_screen());
+    double build = (now_ns() - t0) / ROUNDS;
+
+    t0 = now_ns();
+    for (int r = 0; r < ROUNDS; r++) {
+        lumi_view_t *root;
+        if (lumi_view_deserialize(data, len, &root) != LUMI_OK) return 1;
+        lumi_view_destroy(root);
+    }
+    double load = (now_ns() - t0) / ROUNDS;
+
+    int views = 1 + SECTIONS * (1 + ROWS * 7);
+    printf("view snapshot (%d views, %zu bytes)\n", views, len);
+    printf("  build with constructors      %7.1f us/screen\n", build / 1000.0);
+    printf("  load from snapshot           %7.1f us/screen\n", load / 1000.0);
+    free(data);
+    return 0;
+}
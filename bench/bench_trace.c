@@ -0,0 +1,57 @@
+/**
+ * bench_trace.c — What a trace span costs, stopped and recording
+ * Copyright 2026 Lumi Team. Apache-2.0
+ *
+ * Times lumi_trace_begin()/end() pairs and an instrumented SDK call
+ * (lumi_storage_get) with tracing stopped and started. Recording starts
+ * a new trace every 10000 spans so the buffer never fills and drops.
+ */
+
+#include "lumiapp.h"
+#include <stdio.h>
+#include <time.h>
+
+#define SPANS 2000000
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+static void spans(const char *name, bool on) {
+    if (on) lumi_trace_start();
+    double t0 = now_ns();
+    for (int i = 0; i < SPANS; i++) {
+        if (on && i % 10000 == 0) lumi_trace_start();
+        lumi_trace_begin("bench");
+        lumi_trace_end();
+    }
+    double ns = now_ns() - t0;
+    lumi_trace_stop();
+    printf("  %-22s %6.1f ns/span\n", name, ns / SPANS);
+}
+
+static void storage_get(const char *name, bool on) {
+    if (on) lumi_trace_start();
+    double t0 = now_ns();
+    size_t found = 0;
+    for (int i = 0; i < SPANS; i++) {
+        if (on && i % 10000 == 0) lumi_trace_start();
+        found += lumi_storage_get("key") != NULL;
+    }
+    double ns = now_ns() - t0;
+    lumi_trace_stop();
+    printf("  %-22s %6.1f ns/call  (%zu found)\n", name, ns / SPANS, found);
+}
+
+int main(void) {
+    lumi_storage_set("key", "value");
+    printf("Trace spans, %d each\n", SPANS);
+    spans("begin/end, stopped", false);
+    spans("begin/end, recording", true);
+    storage_get("storage_get, stopped", false);
+    storage_get("storage_get, recording", true);
+    lumi_storage_clear();
+    return 0;
+}
@@ -14,7 +14,11 @@
 #include <functional>
 #include <memory>
 #include <vector>
+#include <optional>
 #include <stdexcept>
+#include <string_view>
+#include <type_traits>
+#include <cstdlib>
 
 namespace lumi {
 
@@ -33,24 +37,147 @@ inline void check(lumi_result_t r) {
 // ── Log ────────────────────────────────────────────────────────
 
 namespace log {
-    inline void verbose(const std::string &tag, const std::string &msg) {
-        lumi_log(LUMI_LOG_VERBOSE, tag.c_str(), "%s", msg.c_str());
+    inline void set_level(lumi_log_level_t level) {
+        lumi_log_set_level(level);
     }
-    inline void debug(const std::string &tag, const std::string &msg) {
-        lumi_log(LUMI_LOG_DEBUG, tag.c_str(), "%s", msg.c_str());
+    inline void set_tag_level(const char *tag, lumi_log_level_t level) {
+        check(lumi_log_set_tag_level(tag, level));
     }
-    inline void info(const std::string &tag, const std::string &msg) {
-        lumi_log(LUMI_LOG_INFO, tag.c_str(), "%s", msg.c_str());
+    inline void clear_tag_level(const char *tag) { check(lumi_log_clear_tag_level(tag)); }
+    inline bool enabled(lumi_log_level_t level, const char *tag) {
+        return lumi_log_enabled(level, tag);
     }
-    inline void warn(const std::string &tag, const std::string &msg) {
-        lumi_log(LUMI_LOG_WARN, tag.c_str(), "%s", msg.c_str());
+
+    /* printf-style lines whose argument types are captured at compile
+     * time: log::info("net", "got %d bytes from %s", n, host) hands the
+     * values to lumi_log_args() as they are, so in deferred mode nothing
+     * is formatted on the calling thread. %d of a double or %s of an int
+     * is converted rather than undefined. The format must be a literal.
+     * Levels below LUMI_LOG_COMPILE_LEVEL compile to nothing, and nothing
+     * is captured for a line its tag's level filters out. */
+    namespace detail {
+        template <typename T>
+        inline lumi_log_arg_t arg(const T &v) {
+            lumi_log_arg_t a{};
+            if constexpr (std::is_same_v<T, bool>) {
+                a.type = LUMI_LOG_ARG_INT;
+                a.v.i = v;
+            } else if constexpr (std::is_enum_v<T>) {
+                a.type = LUMI_LOG_ARG_INT;
+                a.v.i = static_cast<int64_t>(v);
+            } else if constexpr (std::is_integral_v<T> && std::is_signed_v<T>) {
+                a.type = LUMI_LOG_ARG_INT;
+                a.v.i = v;
+            } else if constexpr (std::is_integral_v<T>) {
+                a.type = LUMI_LOG_ARG_UINT;
+                a.v.u = v;
+            } else if constexpr (std::is_floating_point_v<T>) {
+                a.type = LUMI_LOG_ARG_DOUBLE;
+                a.v.d = static_cast<double>(v);
+            } else if constexpr (std::is_same_v<T, const char *> ||
+                                 std::is_same_v<T, char *>) {
+                a.type = LUMI_LOG_ARG_STRING;   /* NULL prints as (null) */
+                a.v.s = v;
+                a.len = v ? std::char_traits<char>::length(v) : 0;
+            } else if constexpr (std::is_convertible_v<const T &, std::string_view>) {
+                std::string_view s(v);
+                a.type = LUMI_LOG_ARG_STRING;
+                a.v.s = s.data();
+                a.len = s.size();
+            } else {
+                static_assert(std::is_pointer_v<T>, "lumi::log cannot format this type");
+                a.type = LUMI_LOG_ARG_POINTER;
+                a.v.p = static_cast<const void *>(v);
+            }
+            return a;
+        }
+
+        template <lumi_log_level_t L, size_t N, typename... Args>
+        inline void write(const char *tag, const char (&fmt)[N], const Args &...args) {
+            if constexpr (L >= LUMI_LOG_COMPILE_LEVEL) {
+                if (!lumi_log_enabled(L, tag)) return;
+                const lumi_log_arg_t list[] = { arg(args)... };
+                lumi_log_args(L, tag, fmt, list, sizeof...(Args));
+            }
+        }
+
+        /* Either kind of tag, without building a std::string */
+        struct tag_ref {
+            const char *s;
+            tag_ref(const char *tag) : s(tag) {}
+            tag_ref(const std::string &tag) : s(tag.c_str()) {}
+        };
+
+        template <lumi_log_level_t L>
+        inline void text(const char *tag, std::string_view msg) {
+            if constexpr (L >= LUMI_LOG_COMPILE_LEVEL) {
+                if (lumi_log_enabled(L, tag)) {
+                    lumi_log(L, tag, "%.*s", static_cast<int>(msg.size()), msg.data());
+                }
+            }
+        }
     }
-    inline void error(const std::string &tag, const std::string &msg) {
-        lumi_log(LUMI_LOG_ERROR, tag.c_str(), "%s", msg.c_str());
+
+    inline void verbose(detail::tag_ref tag, std::string_view msg) {
+        detail::text<LUMI_LOG_VERBOSE>(tag.s, msg);
     }
-    inline void set_level(lumi_log_level_t level) {
-        lumi_log_set_level(level);
+    inline void debug(detail::tag_ref tag, std::string_view msg) {
+        detail::text<LUMI_LOG_DEBUG>(tag.s, msg);
+    }
+    inline void info(detail::tag_ref tag, std::string_view msg) {
+        detail::text<LUMI_LOG_INFO>(tag.s, msg);
+    }
+    inline void warn(detail::tag_ref tag, std::string_view msg) {
+        detail::text<LUMI_LOG_WARN>(tag.s, msg);
+    }
+    inline void error(detail::tag_ref tag, std::string_view msg) {
+        detail::text<LUMI_LOG_ERROR>(tag.s, msg);
+    }
+
+    template <size_t N, typename A, typename... Rest>
+    inline void verbose(const char *tag, const char (&fmt)[N], const A &a, const Rest &...rest) {
+        detail::write<LUMI_LOG_VERBOSE>(tag, fmt, a, rest...);
+    }
+    template <size_t N, typename A, typename... Rest>
+    inline void debug(const char *tag, const char (&fmt)[N], const A &a, const Rest &...rest) {
+        detail::write<LUMI_LOG_DEBUG>(tag, fmt, a, rest...);
+    }
+    template <size_t N, typename A, typename... Rest>
+    inline void info(const char *tag, const char (&fmt)[N], const A &a, const Rest &...rest) {
+        detail::write<LUMI_LOG_INFO>(tag, fmt, a, rest...);
     }
+    template <size_t N, typename A, typename... Rest>
+    inline void warn(const char *tag, const char (&fmt)[N], const A &a, const Rest &...rest) {
+        detail::write<LUMI_LOG_WARN>(tag, fmt, a, rest...);
+    }
+    template <size_t N, typename A, typename... Rest>
+    inline void error(const char *tag, const char (&fmt)[N], const A &a, const Rest &...rest) {
+        detail::write<LUMI_LOG_ERROR>(tag, fmt, a, rest...);
+    }
+
+    inline void set_mode(lumi_log_mode_t mode) { check(lumi_log_set_mode(mode)); }
+    inline void set_deferred(bool deferred) { check(lumi_log_set_deferred(deferred)); }
+    inline void set_binary_file(const char *path) { check(lumi_log_set_binary_file(path)); }
+    inline void flush() { lumi_log_flush(); }
+}
+
+// ── Trace ──────────────────────────────────────────────────────
+
+namespace trace {
+    inline void start() { lumi_trace_start(); }
+    inline void stop() { lumi_trace_stop(); }
+    inline bool enabled() { return lumi_trace_enabled(); }
+    inline void save(const std::string &path) { check(lumi_trace_export(path.c_str())); }
+
+    /* A span for the rest of the enclosing block:
+     *   lumi::trace::Scope span("decode"); */
+    class Scope {
+    public:
+        explicit Scope(const char *name) { lumi_trace_begin(name); }
+        ~Scope() { lumi_trace_end(); }
+        Scope(const Scope &) = delete;
+        Scope &operator=(const Scope &) = delete;
+    };
 }
 
 // ── View (RAII wrapper) ────────────────────────────────────────
@@ -90,11 +217,38 @@ public:
     void set_foreground(uint32_t rgba) { lumi_view_set_foreground(handle_, rgba); }
     void set_font_size(float s) { lumi_view_set_font_size(handle_, s); }
     void set_border_radius(float r) { lumi_view_set_border_radius(handle_, r); }
+    void set_style(const lumi_style_t *style) { lumi_view_set_style(handle_, style); }
+    void set_style_class(lumi_style_sheet_t *sheet, const std::string &name) {
+        check(lumi_view_set_style_class(handle_, sheet, name.c_str()));
+    }
 
     void add_child(View &child) { lumi_view_add_child(handle_, child.release()); }
+    void set_packed(bool packed) { check(lumi_view_set_packed(handle_, packed)); }
+
+    /* Non-owning handle to a descendant (or this view) with the given id */
+    std::optional<View> find_by_id(const std::string &id) const {
+        lumi_view_t *v = lumi_view_find_by_id(handle_, id.c_str());
+        if (!v) return std::nullopt;
+        return View(v, false);
+    }
 
     void on_click(lumi_click_cb cb, void *ud = nullptr) { lumi_view_on_click(handle_, cb, ud); }
 
+    /* Snapshots */
+    std::vector<uint8_t> serialize() const {
+        uint8_t *data = nullptr;
+        size_t len = 0;
+        check(lumi_view_serialize(handle_, &data, &len));
+        std::vector<uint8_t> out(data, data + len);
+        std::free(data);
+        return out;
+    }
+    static View deserialize(const std::vector<uint8_t> &data) {
+        lumi_view_t *root = nullptr;
+        check(lumi_view_deserialize(data.data(), data.size(), &root));
+        return View(root);
+    }
+
     /* Text-specific */
     void set_text(const std::string &t) { lumi_text_set_content(handle_, t.c_str()); }
     std::string get_text() const { auto s = lumi_text_get_content(handle_); return s ? s : ""; }
@@ -156,6 +310,10 @@ public:
     int run() { return lumi_app_run(handle_); }
     void quit() { lumi_app_quit(handle_); }
     void set_content(View &root) { lumi_app_set_content(handle_, root.release()); }
+    /* Patch the mounted tree to match root, keyed by view ids */
+    void update_content(View &root, lumi_mutation_cb cb = nullptr, void *ud = nullptr) {
+        lumi_app_update_content(handle_, root.release(), cb, ud);
+    }
 
     lumi_app_t *raw() { return handle_; }
 };
@@ -169,6 +327,109 @@ namespace storage {
     inline void clear() { check(lumi_storage_clear()); }
 }
 
+// ── Intents ────────────────────────────────────────────────────
+
+/* Builder for typed intent extras (RAII wrapper) */
+class Extras {
+    lumi_extras_t *handle_;
+public:
+    Extras() : handle_(lumi_extras_create()) { if (!handle_) throw Error(LUMI_ERR_NOMEM); }
+    ~Extras() { lumi_extras_destroy(handle_); }
+
+    Extras(const Extras &) = delete;
+    Extras &operator=(const Extras &) = delete;
+    Extras(Extras &&o) noexcept : handle_(o.handle_) { o.handle_ = nullptr; }
+    Extras &operator=(Extras &&o) noexcept {
+        if (this != &o) { lumi_extras_destroy(handle_); handle_ = o.handle_; o.handle_ = nullptr; }
+        return *this;
+    }
+
+    Extras &put(const std::string &key, int64_t v) { check(lumi_extras_put_int(handle_, key.c_str(), v)); return *this; }
+    Extras &put(const std::string &key, int v) { return put(key, (int64_t)v); }
+    Extras &put(const std::string &key, double v) { check(lumi_extras_put_float(handle_, key.c_str(), v)); return *this; }
+    Extras &put(const std::string &key, const std::string &v) { check(lumi_extras_put_string(handle_, key.c_str(), v.c_str())); return *this; }
+    Extras &put(const std::string &key, const char *v) { check(lumi_extras_put_string(handle_, key.c_str(), v)); return *this; }
+    Extras &put(const std::string &key, const std::vector<uint8_t> &v) {
+        check(lumi_extras_put_bytes(handle_, key.c_str(), v.data(), v.size()));
+        return *this;
+    }
+    Extras &put(const std::string &key, Extras &map) { check(lumi_extras_put_map(handle_, key.c_str(), map.handle_)); return *this; }
+    void clear() { lumi_extras_clear(handle_); }
+
+    /* Encoded form; valid until the next put or destruction */
+    std::pair<const void *, size_t> encode() {
+        const void *data = nullptr;
+        size_t len = 0;
+        check(lumi_extras_encode(handle_, &data, &len));
+        return { data, len };
+    }
+
+    lumi_extras_t *raw() { return handle_; }
+};
+
+/* Lazy reader over encoded extras; borrows the data it was opened on */
+class ExtrasView {
+    lumi_extras_view_t v_{};
+public:
+    struct Bytes {
+        const uint8_t *data;
+        size_t size;
+    };
+
+    ExtrasView() = default;
+    ExtrasView(const void *data, size_t len) { check(lumi_extras_open(&v_, data, len)); }
+    explicit ExtrasView(const lumi_intent_t &intent) : ExtrasView(intent.extras, intent.extras_len) {}
+
+    size_t size() const { return v_.count; }
+    lumi_extra_type_t type(const std::string &key) const { return lumi_extras_type(&v_, key.c_str()); }
+    bool contains(const std::string &key) const { return type(key) != LUMI_EXTRA_NONE; }
+
+    std::optional<int64_t> get_int(const std::string &key) const {
+        int64_t v;
+        if (lumi_extras_get_int(&v_, key.c_str(), &v) != LUMI_OK) return std::nullopt;
+        return v;
+    }
+    std::optional<double> get_float(const std::string &key) const {
+        double v;
+        if (lumi_extras_get_float(&v_, key.c_str(), &v) != LUMI_OK) return std::nullopt;
+        return v;
+    }
+    std::optional<std::string_view> get_string(const std::string &key) const {
+        const char *s;
+        if (lumi_extras_get_string(&v_, key.c_str(), &s) != LUMI_OK) return std::nullopt;
+        return std::string_view(s);
+    }
+    std::optional<Bytes> get_bytes(const std::string &key) const {
+        const void *data;
+        size_t len;
+        if (lumi_extras_get_bytes(&v_, key.c_str(), &data, &len) != LUMI_OK) return std::nullopt;
+        return Bytes{ static_cast<const uint8_t *>(data), len };
+    }
+    std::optional<ExtrasView> get_map(const std::string &key) const {
+        ExtrasView m;
+        if (lumi_extras_get_map(&v_, key.c_str(), &m.v_) != LUMI_OK) return std::nullopt;
+        return m;
+    }
+
+    void validate(const std::vector<lumi_extra_field_t> &schema) const {
+        check(lumi_extras_validate(&v_, schema.data(), schema.size()));
+    }
+
+    const lumi_extras_view_t *raw() const { return &v_; }
+};
+
+namespace intent {
+    inline void send(const std::string &action, Extras &extras, const std::string &target_app = "") {
+        auto [data, len] = extras.encode();
+        lumi_intent_t in = {};
+        in.action = action.c_str();
+        in.target_app = target_app.empty() ? nullptr : target_app.c_str();
+        in.extras = data;
+        in.extras_len = len;
+        check(lumi_intent_send(&in));
+    }
+}
+
 // ── Notify ─────────────────────────────────────────────────────
 
 inline void notify(const std::string &title, const std::string &body) {
@@ -59,6 +59,17 @@ Java_com_lumios_sdk_LumiApp_nativeDestroy(JNIEnv *env, jclass cls, jlong handle)
     lumi_app_destroy((lumi_app_t *)(intptr_t)handle);
 }
 
+/* ── LumiView native methods ──────────────────────────────────── */
+
+JNIEXPORT jlong JNICALL
+Java_com_lumios_sdk_LumiView_nativeFindById(JNIEnv *env, jclass cls, jlong handle, jstring id) {
+    (void)cls;
+    const char *c_id = jstring_to_cstr(env, id);
+    lumi_view_t *v = lumi_view_find_by_id((lumi_view_t *)(intptr_t)handle, c_id);
+    release_cstr(env, id, c_id);
+    return (jlong)(intptr_t)v;
+}
+
 /* ── Log ───────────────────────────────────────────────────────── */
 
 JNIEXPORT void JNICALL
@@ -26,6 +26,12 @@ public class LumiView {
     public void addChild(LumiView child) { nativeAddChild(nativeHandle, child.nativeHandle); }
     public void removeChild(LumiView child) { nativeRemoveChild(nativeHandle, child.nativeHandle); }
 
+    /** Looks up a view in this subtree through the native id index (one JNI call). */
+    public LumiView findViewById(String id) {
+        long handle = nativeFindById(nativeHandle, id);
+        return handle != 0 ? new LumiView(handle) : null;
+    }
+
     /* ── Properties ────────────────────────────────────────────── */
     public void setId(String id)        { nativeSetId(nativeHandle, id); }
     public void setVisible(boolean v)   { nativeSetVisible(nativeHandle, v); }
@@ -63,6 +69,7 @@ public class LumiView {
     private static native long nativeDivider();
     private static native void nativeAddChild(long parent, long child);
     private static native void nativeRemoveChild(long parent, long child);
+    private static native long nativeFindById(long handle, String id);
     private static native void nativeDestroyView(long handle);
     private static native void nativeSetId(long handle, String id);
     private static native void nativeSetVisible(long handle, boolean v);
@@ -1,5 +1,8 @@
 // build.rs — link against liblumiapp
 fn main() {
+    let dir = format!("{}/../../liblumiapp/build", env!("CARGO_MANIFEST_DIR"));
     println!("cargo:rustc-link-lib=lumiapp");
-    println!("cargo:rustc-link-search=native=../../liblumiapp/build");
+    println!("cargo:rustc-link-search=native={}", dir);
+    // So `cargo test` runs against the library in the tree without LD_LIBRARY_PATH
+    println!("cargo:rustc-link-arg=-Wl,-rpath,{}", dir);
 }
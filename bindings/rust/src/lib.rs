@@ -45,6 +45,40 @@ pub struct lumi_lifecycle_t {
 
 pub enum lumi_app_t {}
 pub enum lumi_view_t {}
+pub enum lumi_extras_t {}
+
+#[repr(C)]
+pub struct lumi_intent_t {
+    pub action: *const c_char,
+    pub data: *const c_char,
+    pub mime_type: *const c_char,
+    pub target_app: *const c_char,
+    pub extras: *const c_void,
+    pub extras_len: usize,
+}
+
+pub type lumi_extra_type_t = c_int;
+pub const LUMI_EXTRA_NONE: lumi_extra_type_t = 0;
+pub const LUMI_EXTRA_INT: lumi_extra_type_t = 1;
+pub const LUMI_EXTRA_FLOAT: lumi_extra_type_t = 2;
+pub const LUMI_EXTRA_BYTES: lumi_extra_type_t = 3;
+pub const LUMI_EXTRA_STRING: lumi_extra_type_t = 4;
+pub const LUMI_EXTRA_MAP: lumi_extra_type_t = 5;
+
+#[repr(C)]
+#[derive(Clone, Copy)]
+pub struct lumi_extras_view_t {
+    pub data: *const u8,
+    pub size: u32,
+    pub count: u32,
+}
+
+#[repr(C)]
+pub struct lumi_extra_field_t {
+    pub key: *const c_char,
+    pub type_: lumi_extra_type_t,
+    pub required: bool,
+}
 
 extern "C" {
     pub fn lumi_result_str(code: lumi_result_t) -> *const c_char;
@@ -65,6 +99,8 @@ extern "C" {
     pub fn lumi_view_add_child(parent: *mut lumi_view_t, child: *mut lumi_view_t);
     pub fn lumi_view_destroy(view: *mut lumi_view_t);
     pub fn lumi_view_set_id(view: *mut lumi_view_t, id: *const c_char);
+    pub fn lumi_view_get_id(view: *mut lumi_view_t) -> *const c_char;
+    pub fn lumi_view_find_by_id(view: *mut lumi_view_t, id: *const c_char) -> *mut lumi_view_t;
     pub fn lumi_text_set_content(view: *mut lumi_view_t, text: *const c_char);
     pub fn lumi_text_get_content(view: *mut lumi_view_t) -> *const c_char;
     pub fn lumi_app_set_content(app: *mut lumi_app_t, root: *mut lumi_view_t);
@@ -75,6 +111,25 @@ extern "C" {
     pub fn lumi_storage_clear() -> lumi_result_t;
 
     pub fn lumi_notify_simple(title: *const c_char, body: *const c_char) -> lumi_result_t;
+
+    pub fn lumi_intent_send(intent: *const lumi_intent_t) -> lumi_result_t;
+
+    pub fn lumi_extras_create() -> *mut lumi_extras_t;
+    pub fn lumi_extras_destroy(ex: *mut lumi_extras_t);
+    pub fn lumi_extras_clear(ex: *mut lumi_extras_t);
+    pub fn lumi_extras_put_int(ex: *mut lumi_extras_t, key: *const c_char, value: i64) -> lumi_result_t;
+    pub fn lumi_extras_put_float(ex: *mut lumi_extras_t, key: *const c_char, value: f64) -> lumi_result_t;
+    pub fn lumi_extras_put_bytes(ex: *mut lumi_extras_t, key: *const c_char, data: *const c_void, len: usize) -> lumi_result_t;
+    pub fn lumi_extras_put_string(ex: *mut lumi_extras_t, key: *const c_char, value: *const c_char) -> lumi_result_t;
+    pub fn lumi_extras_put_map(ex: *mut lumi_extras_t, key: *const c_char, map: *mut lumi_extras_t) -> lumi_result_t;
+    pub fn lumi_extras_encode(ex: *mut lumi_extras_t, data: *mut *const c_void, len: *mut usize) -> lumi_result_t;
+    pub fn lumi_extras_open(out: *mut lumi_extras_view_t, data: *const c_void, len: usize) -> lumi_result_t;
+    pub fn lumi_extras_type(v: *const lumi_extras_view_t, key: *const c_char) -> lumi_extra_type_t;
+    pub fn lumi_extras_get_int(v: *const lumi_extras_view_t, key: *const c_char, out: *mut i64) -> lumi_result_t;
+    pub fn lumi_extras_get_float(v: *const lumi_extras_view_t, key: *const c_char, out: *mut f64) -> lumi_result_t;
+    pub fn lumi_extras_get_bytes(v: *const lumi_extras_view_t, key: *const c_char, data: *mut *const c_void, len: *mut usize) -> lumi_result_t;
+    pub fn lumi_extras_get_string(v: *const lumi_extras_view_t, key: *const c_char, out: *mut *const c_char) -> lumi_result_t;
+    pub fn lumi_extras_get_map(v: *const lumi_extras_view_t, key: *const c_char, out: *mut lumi_extras_view_t) -> lumi_result_t;
 }
 
 // ── Safe Rust wrappers ──────────────────────────────────────────
@@ -88,23 +143,18 @@ pub enum LumiError {
     Unknown(i32),
 }
 
-impl From<lumi_result_t> for Result<(), LumiError> {
-    fn from(code: lumi_result_t) -> Self {
-        match code {
-            0 => Ok(()),
-            -1 => Err(LumiError::OutOfMemory),
-            -2 => Err(LumiError::InvalidArgument),
-            -3 => Err(LumiError::NotFound),
-            -4 => Err(LumiError::IoError),
-            c => Err(LumiError::Unknown(c)),
-        }
+/// Maps a result code to `Ok(())` or the matching `LumiError`.
+pub fn check(code: lumi_result_t) -> Result<(), LumiError> {
+    match code {
+        LUMI_OK => Ok(()),
+        LUMI_ERR_NOMEM => Err(LumiError::OutOfMemory),
+        LUMI_ERR_INVALID => Err(LumiError::InvalidArgument),
+        LUMI_ERR_NOT_FOUND => Err(LumiError::NotFound),
+        LUMI_ERR_IO => Err(LumiError::IoError),
+        c => Err(LumiError::Unknown(c)),
     }
 }
 
-fn check(r: lumi_result_t) -> Result<(), LumiError> {
-    r.into()
-}
-
 /// Safe wrapper for key-value storage.
 pub mod storage {
     use super::*;
@@ -132,6 +182,197 @@ pub mod storage {
     }
 }
 
+/// Helpers for raw view handles.
+pub mod view {
+    use super::*;
+
+    /// Looks up a view by id in the subtree rooted at `root` (O(1) via the native index).
+    pub fn find_by_id(root: *mut lumi_view_t, id: &str) -> Option<*mut lumi_view_t> {
+        let c = CString::new(id).ok()?;
+        let v = unsafe { lumi_view_find_by_id(root, c.as_ptr()) };
+        if v.is_null() { None } else { Some(v) }
+    }
+}
+
+/// Typed intent extras: a builder and a lazy, zero-copy reader.
+pub mod extras {
+    use super::*;
+    use std::marker::PhantomData;
+
+    /// Builds a key -> typed value map for `lumi_intent_t.extras`.
+    pub struct Extras {
+        raw: *mut lumi_extras_t,
+    }
+
+    impl Extras {
+        pub fn new() -> Result<Extras, LumiError> {
+            let raw = unsafe { lumi_extras_create() };
+            if raw.is_null() { Err(LumiError::OutOfMemory) } else { Ok(Extras { raw }) }
+        }
+
+        pub fn put_int(&mut self, key: &str, value: i64) -> Result<&mut Self, LumiError> {
+            let k = CString::new(key).map_err(|_| LumiError::InvalidArgument)?;
+            check(unsafe { lumi_extras_put_int(self.raw, k.as_ptr(), value) })?;
+            Ok(self)
+        }
+
+        pub fn put_float(&mut self, key: &str, value: f64) -> Result<&mut Self, LumiError> {
+            let k = CString::new(key).map_err(|_| LumiError::InvalidArgument)?;
+            check(unsafe { lumi_extras_put_float(self.raw, k.as_ptr(), value) })?;
+            Ok(self)
+        }
+
+        pub fn put_bytes(&mut self, key: &str, value: &[u8]) -> Result<&mut Self, LumiError> {
+            let k = CString::new(key).map_err(|_| LumiError::InvalidArgument)?;
+            check(unsafe { lumi_extras_put_bytes(self.raw, k.as_ptr(), value.as_ptr() as *const c_void, value.len()) })?;
+            Ok(self)
+        }
+
+        pub fn put_string(&mut self, key: &str, value: &str) -> Result<&mut Self, LumiError> {
+            let k = CString::new(key).map_err(|_| LumiError::InvalidArgument)?;
+            let v = CString::new(value).map_err(|_| LumiError::InvalidArgument)?;
+            check(unsafe { lumi_extras_put_string(self.raw, k.as_ptr(), v.as_ptr()) })?;
+            Ok(self)
+        }
+
+        /// Copies `map` in as it is now.
+        pub fn put_map(&mut self, key: &str, map: &mut Extras) -> Result<&mut Self, LumiError> {
+            let k = CString::new(key).map_err(|_| LumiError::InvalidArgument)?;
+            check(unsafe { lumi_extras_put_map(self.raw, k.as_ptr(), map.raw) })?;
+            Ok(self)
+        }
+
+        /// Empties the builder but keeps its memory.
+        pub fn clear(&mut self) {
+            unsafe { lumi_extras_clear(self.raw) }
+        }
+
+        /// The binary encoding, borrowed until the builder changes.
+        pub fn encode(&mut self) -> Result<&[u8], LumiError> {
+            let mut data: *const c_void = ptr::null();
+            let mut len = 0usize;
+            check(unsafe { lumi_extras_encode(self.raw, &mut data, &mut len) })?;
+            Ok(unsafe { std::slice::from_raw_parts(data as *const u8, len) })
+        }
+    }
+
+    impl Drop for Extras {
+        fn drop(&mut self) {
+            unsafe { lumi_extras_destroy(self.raw) }
+        }
+    }
+
+    /// Read-only view over encoded extras; nothing is decoded until asked for.
+    #[derive(Clone, Copy)]
+    pub struct ExtrasView<'a> {
+        raw: lumi_extras_view_t,
+        _data: PhantomData<&'a [u8]>,
+    }
+
+    impl<'a> ExtrasView<'a> {
+        pub fn open(data: &'a [u8]) -> Result<ExtrasView<'a>, LumiError> {
+            let mut raw = lumi_extras_view_t { data: ptr::null(), size: 0, count: 0 };
+            let p = if data.is_empty() { ptr::null() } else { data.as_ptr() as *const c_void };
+            check(unsafe { lumi_extras_open(&mut raw, p, data.len()) })?;
+            Ok(ExtrasView { raw, _data: PhantomData })
+        }
+
+        /// The extras of an intent received in a handler.
+        ///
+        /// # Safety
+        /// `intent.extras` must point to `intent.extras_len` readable bytes for `'a`.
+        pub unsafe fn from_intent(intent: &'a lumi_intent_t) -> Result<ExtrasView<'a>, LumiError> {
+            if intent.extras.is_null() {
+                return Self::open(&[]);
+            }
+            Self::open(std::slice::from_raw_parts(intent.extras as *const u8, intent.extras_len))
+        }
+
+        pub fn len(&self) -> usize {
+            self.raw.count as usize
+        }
+
+        pub fn is_empty(&self) -> bool {
+            self.raw.count == 0
+        }
+
+        pub fn type_of(&self, key: &str) -> lumi_extra_type_t {
+            match CString::new(key) {
+                Ok(k) => unsafe { lumi_extras_type(&self.raw, k.as_ptr()) },
+                Err(_) => LUMI_EXTRA_NONE,
+            }
+        }
+
+        pub fn get_int(&self, key: &str) -> Option<i64> {
+            let k = CString::new(key).ok()?;
+            let mut v = 0i64;
+            check(unsafe { lumi_extras_get_int(&self.raw, k.as_ptr(), &mut v) }).ok()?;
+            Some(v)
+        }
+
+        pub fn get_float(&self, key: &str) -> Option<f64> {
+            let k = CString::new(key).ok()?;
+            let mut v = 0f64;
+            check(unsafe { lumi_extras_get_float(&self.raw, k.as_ptr(), &mut v) }).ok()?;
+            Some(v)
+        }
+
+        pub fn get_bytes(&self, key: &str) -> Option<&'a [u8]> {
+            let k = CString::new(key).ok()?;
+            let mut data: *const c_void = ptr::null();
+            let mut len = 0usize;
+            check(unsafe { lumi_extras_get_bytes(&self.raw, k.as_ptr(), &mut data, &mut len) }).ok()?;
+            if len == 0 { return Some(&[]); }
+            Some(unsafe { std::slice::from_raw_parts(data as *const u8, len) })
+        }
+
+        /// None if absent, of another type, or not UTF-8.
+        pub fn get_str(&self, key: &str) -> Option<&'a str> {
+            let k = CString::new(key).ok()?;
+            let mut s: *const c_char = ptr::null();
+            check(unsafe { lumi_extras_get_string(&self.raw, k.as_ptr(), &mut s) }).ok()?;
+            unsafe { CStr::from_ptr(s) }.to_str().ok()
+        }
+
+        pub fn get_map(&self, key: &str) -> Option<ExtrasView<'a>> {
+            let k = CString::new(key).ok()?;
+            let mut raw = lumi_extras_view_t { data: ptr::null(), size: 0, count: 0 };
+            check(unsafe { lumi_extras_get_map(&self.raw, k.as_ptr(), &mut raw) }).ok()?;
+            Some(ExtrasView { raw, _data: PhantomData })
+        }
+    }
+}
+
+/// Sending intents.
+pub mod intent {
+    use super::*;
+
+    /// Sends `action` with optional target app and extras.
+    pub fn send(action: &str, target_app: Option<&str>, extras: Option<&mut extras::Extras>) -> Result<(), LumiError> {
+        let a = CString::new(action).map_err(|_| LumiError::InvalidArgument)?;
+        let t = match target_app {
+            Some(t) => Some(CString::new(t).map_err(|_| LumiError::InvalidArgument)?),
+            None => None,
+        };
+        let (data, len) = match extras {
+            Some(ex) => {
+                let bytes = ex.encode()?;
+                (bytes.as_ptr() as *const c_void, bytes.len())
+            }
+            None => (ptr::null(), 0),
+        };
+        let intent = lumi_intent_t {
+            action: a.as_ptr(),
+            data: ptr::null(),
+            mime_type: ptr::null(),
+            target_app: t.as_ref().map_or(ptr::null(), |t| t.as_ptr()),
+            extras: data,
+            extras_len: len,
+        };
+        check(unsafe { lumi_intent_send(&intent) })
+    }
+}
+
 /// Safe wrapper for logging.
 pub mod log {
     use super::*;
@@ -139,15 +380,13 @@ pub mod log {
     pub fn info(tag: &str, msg: &str) {
         let t = CString::new(tag).unwrap_or_default();
         let m = CString::new(msg).unwrap_or_default();
-        let fmt = CString::new("%s").unwrap();
-        unsafe { lumi_log(LUMI_LOG_INFO, t.as_ptr(), fmt.as_ptr(), m.as_ptr()); }
+        unsafe { lumi_log(LUMI_LOG_INFO, t.as_ptr(), c"%s".as_ptr(), m.as_ptr()); }
     }
 
     pub fn error(tag: &str, msg: &str) {
         let t = CString::new(tag).unwrap_or_default();
         let m = CString::new(msg).unwrap_or_default();
-        let fmt = CString::new("%s").unwrap();
-        unsafe { lumi_log(LUMI_LOG_ERROR, t.as_ptr(), fmt.as_ptr(), m.as_ptr()); }
+        unsafe { lumi_log(LUMI_LOG_ERROR, t.as_ptr(), c"%s".as_ptr(), m.as_ptr()); }
     }
 }
 
@@ -164,9 +403,27 @@ mod tests {
 
     #[test]
     fn test_error_conversion() {
-        let ok: Result<(), LumiError> = LUMI_OK.into();
-        assert!(ok.is_ok());
-        let err: Result<(), LumiError> = LUMI_ERR_NOMEM.into();
-        assert!(matches!(err, Err(LumiError::OutOfMemory)));
+        assert!(check(LUMI_OK).is_ok());
+        assert!(matches!(check(LUMI_ERR_NOMEM), Err(LumiError::OutOfMemory)));
+        assert!(matches!(check(-99), Err(LumiError::Unknown(-99))));
+    }
+
+    #[test]
+    fn test_extras_round_trip() {
+        let mut inner = extras::Extras::new().unwrap();
+        inner.put_string("title", "Song").unwrap();
+        let mut ex = extras::Extras::new().unwrap();
+        ex.put_int("track", 3).unwrap().put_float("gain", 0.5).unwrap();
+        ex.put_bytes("raw", &[1, 2, 3]).unwrap().put_map("meta", &mut inner).unwrap();
+
+        let data = ex.encode().unwrap().to_vec();
+        let v = extras::ExtrasView::open(&data).unwrap();
+        assert_eq!(v.len(), 4);
+        assert_eq!(v.get_int("track"), Some(3));
+        assert_eq!(v.get_float("gain"), Some(0.5));
+        assert_eq!(v.get_bytes("raw"), Some(&[1u8, 2, 3][..]));
+        assert_eq!(v.get_map("meta").and_then(|m| m.get_str("title")), Some("Song"));
+        assert_eq!(v.get_int("gain"), None);
+        assert_eq!(v.type_of("missing"), LUMI_EXTRA_NONE);
     }
 }
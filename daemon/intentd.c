@@ -0,0 +1,305 @@
+/**
+ * intentd.c — lumi-intentd, the local intent broker
+ * Copyright 2026 Lumi Team. Apache-2.0
+ *
+ * Accepts apps on an AF_UNIX SOCK_SEQPACKET socket and routes the intents
+ * they send (see liblumiapp/src/bus_proto.h). A subscription registers the
+ * client in liblumiapp's own hashed intent table, so routing by action and
+ * wildcard costs the same as in-process dispatch. Intents with a target_app
+ * go to that app's connections only. Frames for a client are batched and
+ * leave once per poll round; a client that stops reading is dropped once
+ * its backlog passes MAX_BACKLOG. Shared-memory payloads are never touched:
+ * each recipient gets a duplicate of the sealed descriptor.
+ *
+ * Usage: lumi-intentd [-s socket_path]
+ */
+
+#include "bus_proto.h"
+#include "lumiapp.h"
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/un.h>
+
+#define MAX_CLIENTS     256
+#define MAX_BACKLOG     (8u << 20)
+#define MAX_RECV        64              /* packets per client per round */
+#define MAX_PENDING_FDS 1024
+
+typedef struct {
+    int       fd;
+    char     *app_id;
+    char    **patterns;
+    int       pattern_count, pattern_cap;
+    uint8_t  *out;
+    size_t    out_len, out_cap;
+    bus_fds_t out_fds;
+    uint64_t  seq;                      /* last intent routed here */
+    bool      dead;
+} client_t;
+
+static client_t *g_clients[MAX_CLIENTS];
+static int       g_client_count;
+static uint8_t   g_in[BUS_MAX_PACKET];
+
+/* The intent being routed */
+static client_t      *g_sender;
+static const uint8_t *g_frame;
+static size_t         g_frame_len;
+static int            g_frame_fd;       /* payload of an INTENT_SHM, else -1 */
+static uint64_t       g_seq;
+
+static volatile sig_atomic_t g_quit;
+
+static void on_signal(int sig) {
+    (void)sig;
+    g_quit = 1;
+}
+
+static void enqueue(client_t *c) {
+    if (c == g_sender || c->dead || c->seq == g_seq) return;
+    c->seq = g_seq;                     /* several matching patterns, one copy */
+    if (c->out_len + g_frame_len > MAX_BACKLOG || c->out_fds.count >= MAX_PENDING_FDS) {
+        lumi_log(LUMI_LOG_WARN, "intentd", "Dropping %s: not reading",
+                 c->app_id ? c->app_id : "(anonymous)");
+        c->dead = true;
+        return;
+    }
+    if (c->out_len + g_frame_len > c->out_cap) {
+        size_t cap = c->out_cap ? c->out_cap * 2 : BUS_MAX_PACKET;
+        while (cap < c->out_len + g_frame_len) cap *= 2;
+        uint8_t *out = realloc(c->out, cap);
+        if (!out) {
+            c->dead = true;
+            return;
+        }
+        c->out = out;
+        c->out_cap = cap;
+    }
+    if (g_frame_fd >= 0) {
+        int fd = fcntl(g_frame_fd, F_DUPFD_CLOEXEC, 0);
+        if (fd < 0 || !bus_fds_push(&c->out_fds, fd)) {
+            if (fd >= 0) close(fd);
+            return;
+        }
+    }
+    memcpy(c->out + c->out_len, g_frame, g_frame_len);
+    c->out_len += g_frame_len;
+}
+
+static void route_cb(const lumi_intent_t *intent, void *userdata) {
+    (void)intent;
+    enqueue(userdata);
+}
+
+static int find_pattern(const client_t *c, const char *pattern) {
+    for (int i = 0; i < c->pattern_count; i++) {
+        if (strcmp(c->patterns[i], pattern) == 0) return i;
+    }
+    return -1;
+}
+
+static void subscribe(client_t *c, const char *pattern) {
+    if (find_pattern(c, pattern) >= 0) return;
+    if (c->pattern_count == c->pattern_cap) {
+        int cap = c->pattern_cap ? c->pattern_cap * 2 : 8;
+        char **p = realloc(c->patterns, (size_t)cap * sizeof(*p));
+        if (!p) return;
+        c->patterns = p;
+        c->pattern_cap = cap;
+    }
+    char *copy = strdup(pattern);
+    if (!copy) return;
+    if (lumi_intent_register(pattern, route_cb, c) != LUMI_OK) {
+        free(copy);
+        return;
+    }
+    c->patterns[c->pattern_count++] = copy;
+}
+
+static void unsubscribe(client_t *c, const char *pattern) {
+    int i = find_pattern(c, pattern);
+    if (i < 0) return;
+    lumi_intent_unregister(pattern, route_cb, c);
+    free(c->patterns[i]);
+    c->patterns[i] = c->patterns[--c->pattern_count];
+}
+
+static void route(client_t *from, const uint8_t *frame, size_t len, int fd,
+                  const char *const s[4]) {
+    g_sender = from;
+    g_frame = frame;
+    g_frame_len = len;
+    g_frame_fd = fd;
+    g_seq++;
+
+    if (s[3]) {
+        for (int i = 0; i < g_client_count; i++) {
+            client_t *c = g_clients[i];
+            if (c->app_id && strcmp(c->app_id, s[3]) == 0) enqueue(c);
+        }
+    } else {
+        lumi_intent_t intent = { .action = s[0], .data = s[1], .mime_type = s[2] };
+        lumi_intent_send(&intent);
+    }
+    g_sender = NULL;
+}
+
+static void handle_packet(client_t *c, const uint8_t *packet, size_t len,
+                          const int *fds, int nfds) {
+    const uint8_t *p = packet, *end = packet + len, *body, *body_end;
+    uint8_t type;
+    int used = 0;
+    while (bus_next_frame(&p, end, &type, &body, &body_end)) {
+        const uint8_t *frame = body - 5;
+        const uint8_t *q = body;
+        const char *s[4] = { NULL };
+        switch (type) {
+            case BUS_HELLO:
+                if (!bus_get_str(&q, body_end, &s[0])) break;
+                free(c->app_id);
+                c->app_id = s[0] ? strdup(s[0]) : NULL;
+                break;
+            case BUS_SUBSCRIBE:
+            case BUS_UNSUBSCRIBE:
+                if (!bus_get_str(&q, body_end, &s[0]) || !s[0]) break;
+                if (type == BUS_SUBSCRIBE) subscribe(c, s[0]); else unsubscribe(c, s[0]);
+                break;
+            case BUS_INTENT: {
+                bool ok = true;
+                for (int i = 0; i < 4 && ok; i++) ok = bus_get_str(&q, body_end, &s[i]);
+                if (ok && s[0]) route(c, frame, (size_t)(body_end - frame), -1, s);
+                break;
+            }
+            case BUS_INTENT_SHM: {
+                int fd = used < nfds ? fds[used++] : -1;
+                const void *extras;
+                size_t extras_len;
+                bool ok = fd >= 0 && bus_get_str(&q, body_end, &s[0]) &&
+                          bus_get_str(&q, body_end, &s[2]) && bus_get_str(&q, body_end, &s[3]) &&
+                          bus_get_blob(&q, body_end, &extras, &extras_len) &&
+                          body_end - q == 8;
+                if (ok && s[0]) route(c, frame, (size_t)(body_end - frame), fd, s);
+                if (fd >= 0) close(fd);
+                break;
+            }
+        }
+    }
+    while (used < nfds) close(fds[used++]);
+}
+
+static void client_close(int index) {
+    client_t *c = g_clients[index];
+    while (c->pattern_count) unsubscribe(c, c->patterns[c->pattern_count - 1]);
+    close(c->fd);
+    bus_fds_close(&c->out_fds);
+    free(c->out_fds.fds);
+    free(c->patterns);
+    free(c->out);
+    free(c->app_id);
+    free(c);
+    g_clients[index] = g_clients[--g_client_count];
+}
+
+static void client_accept(int listen_fd) {
+    int fd = accept(listen_fd, NULL, NULL);
+    if (fd < 0) return;
+    client_t *c = g_client_count < MAX_CLIENTS ? calloc(1, sizeof(*c)) : NULL;
+    if (!c) {
+        close(fd);
+        return;
+    }
+    fcntl(fd, F_SETFD, FD_CLOEXEC);
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+    c->fd = fd;
+    g_clients[g_client_count++] = c;
+}
+
+static void client_read(client_t *c) {
+    for (int i = 0; i < MAX_RECV && !c->dead; i++) {
+        int fds[BUS_MAX_FDS], nfds;
+        ssize_t len = bus_recv(c->fd, g_in, sizeof(g_in), fds, &nfds);
+        if (len < 0) return;
+        if (len == 0) {
+            c->dead = true;
+            return;
+        }
+        handle_packet(c, g_in, (size_t)len, fds, nfds);
+    }
+}
+
+static int listen_on(const char *path) {
+    struct sockaddr_un addr = { .sun_family = AF_UNIX };
+    if (strlen(path) >= sizeof(addr.sun_path)) return -1;
+    memcpy(addr.sun_path, path, strlen(path) + 1);
+
+    int fd = socket(AF_UNIX, SOCK_SEQPACKET, 0);
+    if (fd < 0) return -1;
+    unlink(path);                       /* a stale socket from a previous run */
+    if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0 || listen(fd, 64) != 0) {
+        close(fd);
+        return -1;
+    }
+    fcntl(fd, F_SETFD, FD_CLOEXEC);
+    return fd;
+}
+
+int main(int argc, char **argv) {
+    char path[sizeof(((struct sockaddr_un *)0)->sun_path)];
+    bus_default_path(path, sizeof(path));
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-s") == 0 && i + 1 < argc) {
+            snprintf(path, sizeof(path), "%s", argv[++i]);
+        } else {
+            fprintf(stderr, "usage: %s [-s socket_path]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    int listen_fd = listen_on(path);
+    if (listen_fd < 0) {
+        lumi_log(LUMI_LOG_ERROR, "intentd", "Cannot listen on %s: %s", path, strerror(errno));
+        return 1;
+    }
+    struct sigaction sa = { .sa_handler = on_signal };
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGTERM, &sa, NULL);
+    signal(SIGPIPE, SIG_IGN);
+    lumi_log(LUMI_LOG_INFO, "intentd", "Listening on %s", path);
+
+    struct pollfd fds[MAX_CLIENTS + 1];
+    while (!g_quit) {
+        fds[0] = (struct pollfd){ .fd = listen_fd, .events = POLLIN };
+        for (int i = 0; i < g_client_count; i++) {
+            client_t *c = g_clients[i];
+            fds[i + 1] = (struct pollfd){ .fd = c->fd,
+                                          .events = POLLIN | (c->out_len ? POLLOUT : 0) };
+        }
+        int clients = g_client_count;
+        if (poll(fds, (nfds_t)clients + 1, -1) < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+
+        for (int i = 0; i < clients; i++) {
+            if (fds[i + 1].revents & (POLLIN | POLLHUP | POLLERR)) client_read(g_clients[i]);
+        }
+        /* Everything routed this round leaves in as few packets as fit */
+        for (int i = 0; i < g_client_count; i++) {
+            client_t *c = g_clients[i];
+            if (!c->dead && c->out_len && bus_send_frames(c->fd, c->out, &c->out_len, &c->out_fds) < 0) {
+                c->dead = true;
+            }
+        }
+        for (int i = g_client_count - 1; i >= 0; i--) {
+            if (g_clients[i]->dead) client_close(i);
+        }
+        if (fds[0].revents & POLLIN) client_accept(listen_fd);
+    }
+
+    while (g_client_count) client_close(g_client_count - 1);
+    close(listen_fd);
+    unlink(path);
+    lumi_log(LUMI_LOG_INFO, "intentd", "Stopped");
+    return 0;
+}
@@ -0,0 +1,124 @@
+/**
+ * logdump.c — lumi-logdump, turns binary logs back into text
+ * Copyright 2026 Lumi Team. Apache-2.0
+ *
+ * Reads files written by lumi_log_set_binary_file() (the format is in
+ * liblumiapp/src/log_proto.h) and prints one line per record:
+ *
+ *   [2026-01-31 12:00:00.123] I/tag: message
+ *
+ * Deferred lines are formatted here, with the arguments the app stored.
+ *
+ * Usage: lumi-logdump file...
+ */
+
+#include "log_proto.h"
+#include <time.h>
+
+static const char LEVELS[] = "VDIWE";
+
+typedef struct {
+    const char **fmts;                  /* by id */
+    size_t count, cap;
+} formats_t;
+
+static bool define(formats_t *f, uint32_t id, const char *fmt) {
+    if (id >= f->cap) {
+        size_t cap = f->cap ? f->cap : 64;
+        while (cap <= id) cap *= 2;
+        const char **fmts = realloc(f->fmts, cap * sizeof(*fmts));
+        if (!fmts) return false;
+        memset(fmts + f->cap, 0, (cap - f->cap) * sizeof(*fmts));
+        f->fmts = fmts;
+        f->cap = cap;
+    }
+    f->fmts[id] = fmt;
+    if (id >= f->count) f->count = id + 1;
+    return true;
+}
+
+static void print_line(uint64_t ns, uint8_t level, const char *tag, const char *msg) {
+    time_t sec = (time_t)(ns / 1000000000u);
+    struct tm tm;
+    char when[32];
+    localtime_r(&sec, &tm);
+    strftime(when, sizeof(when), "%Y-%m-%d %H:%M:%S", &tm);
+    printf("[%s.%03u] %c/%s: %s\n", when, (unsigned)(ns / 1000000u % 1000u),
+           level < sizeof(LEVELS) - 1 ? LEVELS[level] : '?', tag ? tag : "lumi", msg);
+}
+
+/* False if the file is not a binary log or ends in a broken frame */
+static bool dump(const uint8_t *data, size_t len) {
+    if (len < LOG_MAGIC_LEN || memcmp(data, LOG_MAGIC, LOG_MAGIC_LEN) != 0) return false;
+    formats_t formats = { 0 };
+    static char text[64 * 1024];
+    const uint8_t *p = data + LOG_MAGIC_LEN, *end = data + len, *body, *body_end;
+    uint8_t type;
+    bool ok = true;
+
+    while (p < end) {
+        if (!bus_next_frame(&p, end, &type, &body, &body_end)) {
+            ok = false;
+            break;
+        }
+        const uint8_t *q = body;
+        const char *tag, *msg;
+        if (type == LOG_FRAME_FORMAT) {
+            const char *fmt;
+            if (body_end - q < 4) continue;
+            uint32_t id = get_u32(q);
+            q += 4;
+            if (bus_get_str(&q, body_end, &fmt) && fmt && !define(&formats, id, fmt)) {
+                ok = false;
+                break;
+            }
+        } else if (type == LOG_FRAME_LINE) {
+            if (body_end - q < 13) continue;
+            uint64_t ns = get_u64(q);
+            uint8_t level = q[8];
+            uint32_t id = get_u32(q + 9);
+            q += 13;
+            if (!bus_get_str(&q, body_end, &tag)) continue;
+            const char *fmt = id < formats.count ? formats.fmts[id] : NULL;
+            if (fmt) {
+                log_format(text, sizeof(text), fmt, q, body_end);
+            } else {
+                snprintf(text, sizeof(text), "<format %u missing>", (unsigned)id);
+            }
+            print_line(ns, level, tag, text);
+        } else if (type == LOG_FRAME_TEXT) {
+            if (body_end - q < 9) continue;
+            uint64_t ns = get_u64(q);
+            uint8_t level = q[8];
+            q += 9;
+            if (bus_get_str(&q, body_end, &tag) && bus_get_str(&q, body_end, &msg)) {
+                print_line(ns, level, tag, msg ? msg : "");
+            }
+        }
+    }
+    free(formats.fmts);
+    return ok;
+}
+
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s file...\n", argv[0]);
+        return 2;
+    }
+    int rc = 0;
+    for (int i = 1; i < argc; i++) {
+        char *data = NULL;
+        size_t len = 0;
+        if (lumi_file_read(argv[i], &data, &len) != LUMI_OK) {
+            fprintf(stderr, "%s: cannot read %s\n", argv[0], argv[i]);
+            rc = 1;
+            continue;
+        }
+        if (!dump((const uint8_t *)data, len)) {
+            fprintf(stderr, "%s: %s is not a complete binary log\n", argv[0], argv[i]);
+            rc = 1;
+        }
+        free(data);
+    }
+    return rc;
+}
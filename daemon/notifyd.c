@@ -0,0 +1,191 @@
+/**
+ * notifyd.c — lumi-notifyd, a local stand-in for the notification daemon
+ * Copyright 2026 Lumi Team. Apache-2.0
+ *
+ * Accepts apps on an AF_UNIX SOCK_SEQPACKET socket and shows what they
+ * post (see liblumiapp/src/notify_proto.h) as one line per notification
+ * on stdout:
+ *
+ *   <id> new|update [<channel>] <title>: <body>
+ *
+ * A post with the channel and key of one the same app already showed
+ * updates that notification and keeps its id. Enough to develop and test
+ * apps against, and to see how many updates actually reach the screen.
+ *
+ * Usage: lumi-notifyd [-s socket_path]
+ */
+
+#include "notify_proto.h"
+#include "lumiapp.h"
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/un.h>
+
+#define MAX_CLIENTS 64
+#define MAX_KEYED   256                 /* remembered per client */
+
+typedef struct {
+    char    *channel, *key;
+    unsigned id;
+} shown_t;
+
+typedef struct {
+    int     fd;
+    shown_t shown[MAX_KEYED];
+    int     shown_count, shown_next;    /* the oldest is forgotten first */
+} client_t;
+
+static client_t *g_clients[MAX_CLIENTS];
+static int       g_client_count;
+static uint8_t   g_in[BUS_MAX_PACKET];
+static unsigned  g_next_id = 1;
+
+static volatile sig_atomic_t g_quit;
+
+static void on_signal(int sig) {
+    (void)sig;
+    g_quit = 1;
+}
+
+/* Id of the notification channel/key replaces, or 0 for a new one. */
+static unsigned remember(client_t *c, const char *channel, const char *key) {
+    if (!key) return 0;
+    for (int i = 0; i < c->shown_count; i++) {
+        shown_t *s = &c->shown[i];
+        if (strcmp(s->channel, channel) == 0 && strcmp(s->key, key) == 0) return s->id;
+    }
+    char *ch = strdup(channel), *k = strdup(key);
+    if (!ch || !k) {
+        free(ch);
+        free(k);
+        return 0;
+    }
+    shown_t *s = &c->shown[c->shown_next];
+    if (c->shown_count == MAX_KEYED) {
+        free(s->channel);
+        free(s->key);
+    } else {
+        c->shown_count++;
+    }
+    c->shown_next = (c->shown_next + 1) % MAX_KEYED;
+    *s = (shown_t){ ch, k, g_next_id };
+    return 0;
+}
+
+static void show(client_t *c, const uint8_t *body, const uint8_t *body_end) {
+    const char *s[NOTIFY_STRINGS];
+    const uint8_t *q = body;
+    for (int i = 0; i < NOTIFY_STRINGS; i++) {
+        if (!bus_get_str(&q, body_end, &s[i])) return;
+    }
+    if (!s[0] || !s[2] || body_end - q != 4) return;
+
+    unsigned id = remember(c, s[0], s[1]);
+    bool update = id != 0;
+    if (!update) id = g_next_id++;
+    printf("%u %s [%s] %s: %s\n", id, update ? "update" : "new", s[0], s[2], s[3] ? s[3] : "");
+}
+
+static void client_close(int index) {
+    client_t *c = g_clients[index];
+    for (int i = 0; i < c->shown_count; i++) {
+        free(c->shown[i].channel);
+        free(c->shown[i].key);
+    }
+    close(c->fd);
+    free(c);
+    g_clients[index] = g_clients[--g_client_count];
+}
+
+static void client_accept(int listen_fd) {
+    int fd = accept(listen_fd, NULL, NULL);
+    if (fd < 0) return;
+    client_t *c = g_client_count < MAX_CLIENTS ? calloc(1, sizeof(*c)) : NULL;
+    if (!c) {
+        close(fd);
+        return;
+    }
+    fcntl(fd, F_SETFD, FD_CLOEXEC);
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+    c->fd = fd;
+    g_clients[g_client_count++] = c;
+}
+
+/* False once the client is gone */
+static bool client_read(client_t *c) {
+    for (;;) {
+        ssize_t len = recv(c->fd, g_in, sizeof(g_in), MSG_DONTWAIT);
+        if (len < 0) return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+        if (len == 0) return false;
+
+        const uint8_t *p = g_in, *end = g_in + len, *body, *body_end;
+        uint8_t type;
+        while (bus_next_frame(&p, end, &type, &body, &body_end)) {
+            if (type == NOTIFY_POST) show(c, body, body_end);
+        }
+        fflush(stdout);
+    }
+}
+
+static int listen_on(const char *path) {
+    struct sockaddr_un addr = { .sun_family = AF_UNIX };
+    if (strlen(path) >= sizeof(addr.sun_path)) return -1;
+    memcpy(addr.sun_path, path, strlen(path) + 1);
+
+    int fd = socket(AF_UNIX, SOCK_SEQPACKET, 0);
+    if (fd < 0) return -1;
+    unlink(path);                       /* a stale socket from a previous run */
+    if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0 || listen(fd, 16) != 0) {
+        close(fd);
+        return -1;
+    }
+    fcntl(fd, F_SETFD, FD_CLOEXEC);
+    return fd;
+}
+
+int main(int argc, char **argv) {
+    char path[sizeof(((struct sockaddr_un *)0)->sun_path)];
+    notify_default_path(path, sizeof(path));
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-s") == 0 && i + 1 < argc) {
+            snprintf(path, sizeof(path), "%s", argv[++i]);
+        } else {
+            fprintf(stderr, "usage: %s [-s socket_path]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    int listen_fd = listen_on(path);
+    if (listen_fd < 0) {
+        lumi_log(LUMI_LOG_ERROR, "notifyd", "Cannot listen on %s: %s", path, strerror(errno));
+        return 1;
+    }
+    struct sigaction sa = { .sa_handler = on_signal };
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGTERM, &sa, NULL);
+
+    struct pollfd fds[MAX_CLIENTS + 1];
+    while (!g_quit) {
+        fds[0] = (struct pollfd){ .fd = listen_fd, .events = POLLIN };
+        for (int i = 0; i < g_client_count; i++) {
+            fds[i + 1] = (struct pollfd){ .fd = g_clients[i]->fd, .events = POLLIN };
+        }
+        int clients = g_client_count;
+        if (poll(fds, (nfds_t)clients + 1, -1) < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        for (int i = clients - 1; i >= 0; i--) {
+            if ((fds[i + 1].revents & (POLLIN | POLLHUP | POLLERR)) && !client_read(g_clients[i])) {
+                client_close(i);
+            }
+        }
+        if (fds[0].revents & POLLIN) client_accept(listen_fd);
+    }
+
+    while (g_client_count) client_close(g_client_count - 1);
+    close(listen_fd);
+    unlink(path);
+    return 0;
+}
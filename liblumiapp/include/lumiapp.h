@@ -52,6 +52,167 @@ typedef enum {
 void lumi_log(lumi_log_level_t level, const char *tag, const char *fmt, ...);
 void lumi_log_set_level(lumi_log_level_t min_level);
 
+/* A tag's own level overrides lumi_log_set_level() in either direction,
+ * e.g. DEBUG for one subsystem while the rest stays at INFO. Up to 64
+ * tags; LUMI_ERR_NOMEM beyond. Clearing goes back to the global level. */
+lumi_result_t lumi_log_set_tag_level(const char *tag, lumi_log_level_t level);
+lumi_result_t lumi_log_clear_tag_level(const char *tag);
+
+/* Whether a line at level with tag would be logged */
+bool lumi_log_enabled(lumi_log_level_t level, const char *tag);
+
+/* The LUMI_LOG* macros check the level before the arguments are
+ * evaluated, and calls below LUMI_LOG_COMPILE_LEVEL are compiled out.
+ * Define it (0 = VERBOSE ... 4 = ERROR) before including this header;
+ * it defaults to INFO with NDEBUG and VERBOSE without. */
+#ifndef LUMI_LOG_COMPILE_LEVEL
+#  ifdef NDEBUG
+#    define LUMI_LOG_COMPILE_LEVEL 2
+#  else
+#    define LUMI_LOG_COMPILE_LEVEL 0
+#  endif
+#endif
+
+#define LUMI_LOG_AT(level, tag, ...)                                                  \
+    do {                                                                              \
+        if ((int)(level) >= LUMI_LOG_COMPILE_LEVEL && lumi_log_enabled((level), (tag))) \
+            lumi_log((level), (tag), __VA_ARGS__);                                    \
+    } while (0)
+
+#define LUMI_LOGV(tag, ...) LUMI_LOG_AT(LUMI_LOG_VERBOSE, tag, __VA_ARGS__)
+#define LUMI_LOGD(tag, ...) LUMI_LOG_AT(LUMI_LOG_DEBUG, tag, __VA_ARGS__)
+#define LUMI_LOGI(tag, ...) LUMI_LOG_AT(LUMI_LOG_INFO, tag, __VA_ARGS__)
+#define LUMI_LOGW(tag, ...) LUMI_LOG_AT(LUMI_LOG_WARN, tag, __VA_ARGS__)
+#define LUMI_LOGE(tag, ...) LUMI_LOG_AT(LUMI_LOG_ERROR, tag, __VA_ARGS__)
+
+/* LUMI_LOG_SYNC (the default) writes each line on the caller's thread.
+ * The async modes format the message into a 64 KB ring of the calling
+ * thread and leave timestamps and output to a writer thread, which sends
+ * whole batches with writev(). When a ring is full, a line is either
+ * dropped and counted or the caller waits for the writer. Lines still
+ * buffered when the process exits are lost; call lumi_log_flush() first
+ * (lumi_app_destroy() does). Switch modes while no other thread logs. */
+typedef enum {
+    LUMI_LOG_SYNC        = 0,
+    LUMI_LOG_ASYNC_DROP  = 1,
+    LUMI_LOG_ASYNC_BLOCK = 2,
+} lumi_log_mode_t;
+
+lumi_result_t lumi_log_set_mode(lumi_log_mode_t mode);
+
+/* In the async modes, defer formatting as well: the caller only copies
+ * the format, a timestamp and the arguments, and the writer does the
+ * printf work. %s arguments are copied, up to 512 bytes. */
+lumi_result_t lumi_log_set_deferred(bool deferred);
+
+/* Have the async writer append binary records to a new file at path
+ * instead of writing text; lumi-logdump turns it back into text. Lines
+ * logged before the call still go where they were going. NULL closes
+ * the file. */
+lumi_result_t lumi_log_set_binary_file(const char *path);
+
+/* Arguments with their types already known, as the C++ front end passes
+ * them; fmt is the same printf format, each conversion taking the next
+ * argument and converting it when the types differ. */
+typedef enum {
+    LUMI_LOG_ARG_INT     = 1,
+    LUMI_LOG_ARG_UINT    = 2,
+    LUMI_LOG_ARG_DOUBLE  = 3,
+    LUMI_LOG_ARG_STRING  = 4,
+    LUMI_LOG_ARG_POINTER = 5,
+} lumi_log_arg_type_t;
+
+typedef struct {
+    lumi_log_arg_type_t type;
+    size_t len;                 /* LUMI_LOG_ARG_STRING: bytes at v.s */
+    union {
+        int64_t     i;
+        uint64_t    u;
+        double      d;
+        const char *s;
+        const void *p;
+    } v;
+} lumi_log_arg_t;
+
+void lumi_log_args(lumi_log_level_t level, const char *tag, const char *fmt,
+                   const lumi_log_arg_t *args, size_t count);
+
+/* Returns once every line logged before the call has been written. */
+void lumi_log_flush(void);
+
+typedef struct {
+    size_t written;             /* lines written by the async writer */
+    size_t dropped;             /* lines lost to full rings */
+    size_t waited;              /* lines that had to wait for room */
+    size_t writes;              /* writev() calls */
+    size_t rings;               /* threads that logged asynchronously */
+} lumi_log_stats_t;
+
+void lumi_log_get_stats(lumi_log_stats_t *out);
+
+/* ── Tracing ─────────────────────────────────────────────────────── */
+
+/* Nested spans per thread, exported as Chrome trace-event JSON that
+ * chrome://tracing and Perfetto open. The SDK traces its lifecycle
+ * callbacks, intent dispatch, storage, file I/O and view tree work, and
+ * apps can add their own. Names are not copied: use string literals, or
+ * strings that outlive the export. While tracing is stopped a begin/end
+ * pair costs two relaxed loads. Each thread records up to 32768 events
+ * per trace; later spans are dropped and counted in the export. */
+void lumi_trace_start(void);    /* also discards the previous trace */
+void lumi_trace_stop(void);
+bool lumi_trace_enabled(void);
+void lumi_trace_begin(const char *name);
+void lumi_trace_end(void);      /* ends the thread's innermost span */
+
+/* Writes what every thread recorded since lumi_trace_start(); spans
+ * still open have no end there. Tracing may go on meanwhile. */
+lumi_result_t lumi_trace_export(const char *path);
+
+/* ── Metrics ─────────────────────────────────────────────────────── */
+
+/* Named counters, gauges and histograms of uint64_t values (durations in
+ * ns, sizes in bytes) for scraping. Getting a metric creates it on first
+ * use and returns the same one after; NULL for a name that is not
+ * [a-zA-Z_:][a-zA-Z0-9_:]* or already has another type. Metrics last for
+ * the process. Updates never lock: counters and histograms are sharded
+ * per thread. The SDK keeps its own lumi_storage_*, lumi_intent_*,
+ * lumi_timer_*, lumi_view_*, lumi_log_* and lumi_file_* metrics. */
+typedef struct lumi_metric lumi_metric_t;
+
+typedef enum {
+    LUMI_METRIC_COUNTER   = 0,
+    LUMI_METRIC_GAUGE     = 1,
+    LUMI_METRIC_HISTOGRAM = 2,
+} lumi_metric_type_t;
+
+lumi_metric_t *lumi_metric_counter(const char *name, const char *help);
+lumi_metric_t *lumi_metric_gauge(const char *name, const char *help);
+lumi_metric_t *lumi_metric_histogram(const char *name, const char *help);
+
+void lumi_metric_add(lumi_metric_t *m, uint64_t n);        /* counters and gauges */
+void lumi_metric_set(lumi_metric_t *m, int64_t value);     /* gauges */
+void lumi_metric_record(lumi_metric_t *m, uint64_t value); /* histograms */
+
+/* Histogram quantiles come from buckets 1/32 of a power of two wide, so
+ * they are within about 3% of the recorded values. */
+typedef struct {
+    const char *name, *help;
+    lumi_metric_type_t type;
+    int64_t  value;             /* counter total, gauge value, histogram count */
+    uint64_t sum, min, max;     /* histograms */
+    uint64_t p50, p90, p99, p999;
+} lumi_metric_value_t;
+
+lumi_result_t lumi_metric_read(const lumi_metric_t *m, lumi_metric_value_t *out);
+
+/* Reads up to max metrics, the SDK's first, and returns how many exist */
+size_t lumi_metrics_snapshot(lumi_metric_value_t *out, size_t max);
+
+/* Writes every metric to fd (a file or a socket) in the Prometheus text
+ * exposition format, histograms as summaries */
+lumi_result_t lumi_metrics_write(int fd);
+
 /* ── Application lifecycle ───────────────────────────────────────── */
 
 typedef struct lumi_app lumi_app_t;
@@ -123,6 +284,13 @@ lumi_view_t *lumi_card(void);
 void lumi_view_add_child(lumi_view_t *parent, lumi_view_t *child);
 void lumi_view_remove_child(lumi_view_t *parent, lumi_view_t *child);
 void lumi_view_destroy(lumi_view_t *view);
+int          lumi_view_get_child_count(lumi_view_t *view);
+lumi_view_t *lumi_view_get_child(lumi_view_t *view, int index);
+lumi_view_t *lumi_view_get_parent(lumi_view_t *view);
+
+/* O(1) lookup through a per-tree hash index, built on first use and kept
+ * current by tree edits. Searches the subtree rooted at view. */
+lumi_view_t *lumi_view_find_by_id(lumi_view_t *view, const char *id);
 
 /* View properties */
 void lumi_view_set_id(lumi_view_t *view, const char *id);
@@ -140,6 +308,51 @@ void lumi_view_set_background(lumi_view_t *view, uint32_t rgba);
 void lumi_view_set_foreground(lumi_view_t *view, uint32_t rgba);
 void lumi_view_set_font_size(lumi_view_t *view, float size);
 void lumi_view_set_border_radius(lumi_view_t *view, float radius);
+void lumi_view_set_opacity(lumi_view_t *view, float opacity);     /* 0..1, applies to the subtree */
+
+/* Shared styles. A style is an immutable, interned value: interning equal
+ * descriptions yields the same pointer, so equal styles compare with ==.
+ * Views hold a reference to one style; the setters above are
+ * copy-on-write and intern a modified copy for that view alone. */
+typedef struct lumi_style lumi_style_t;
+
+typedef struct {
+    float    width, height;         /* <= 0 = intrinsic */
+    float    padding[4];            /* top, right, bottom, left */
+    float    margin[4];             /* top, right, bottom, left */
+    uint32_t background;            /* RGBA */
+    uint32_t foreground;            /* RGBA */
+    float    font_size;
+    float    border_radius;
+    float    opacity;               /* 1 = opaque */
+} lumi_style_desc_t;
+
+void lumi_style_desc_init(lumi_style_desc_t *desc);     /* view defaults */
+
+/* Returns a new reference; release it with lumi_style_release(). */
+const lumi_style_t *lumi_style_intern(const lumi_style_desc_t *desc);
+const lumi_style_t *lumi_style_retain(const lumi_style_t *style);
+void lumi_style_release(const lumi_style_t *style);
+void lumi_style_get(const lumi_style_t *style, lumi_style_desc_t *out);
+
+/* Replace a view's whole style (dropping any style class binding).
+ * get_style returns a borrowed pointer valid while the view keeps it. */
+void lumi_view_set_style(lumi_view_t *view, const lumi_style_t *style);
+const lumi_style_t *lumi_view_get_style(lumi_view_t *view);
+
+/* Style sheets map class names to styles. Views bound to a class follow
+ * it: redefining the class restyles all of them in O(1), resolved lazily
+ * at their next layout or paint. Properties set on a bound view with the
+ * setters above override the class until the view is rebound. */
+typedef struct lumi_style_sheet lumi_style_sheet_t;
+
+lumi_style_sheet_t *lumi_style_sheet_create(void);
+void lumi_style_sheet_destroy(lumi_style_sheet_t *sheet);  /* bound views keep their class */
+lumi_result_t lumi_style_sheet_set(lumi_style_sheet_t *sheet, const char *name,
+                                   const lumi_style_t *style);
+const lumi_style_t *lumi_style_sheet_get(lumi_style_sheet_t *sheet, const char *name);
+lumi_result_t lumi_view_set_style_class(lumi_view_t *view, lumi_style_sheet_t *sheet,
+                                        const char *name);
 
 /* Event handlers */
 void lumi_view_on_click(lumi_view_t *view, lumi_click_cb cb, void *userdata);
@@ -154,9 +367,306 @@ const char *lumi_text_get_content(lumi_view_t *view);
 const char *lumi_text_field_get_value(lumi_view_t *view);
 void lumi_text_field_set_value(lumi_view_t *view, const char *value);
 
+/* Scroll-specific */
+void lumi_scroll_set_offset(lumi_view_t *view, float x, float y);
+void lumi_scroll_get_offset(lumi_view_t *view, float *x, float *y);
+
 /* App root view */
 void lumi_app_set_content(lumi_app_t *app, lumi_view_t *root);
 
+/* ── Layout & painting ───────────────────────────────────────────── */
+
+/* Lay out a tree inside a width x height viewport. Frames are relative
+ * to the parent's origin and exclude margins. */
+void lumi_view_layout(lumi_view_t *root, float width, float height);
+void lumi_view_get_frame(lumi_view_t *view, float *x, float *y, float *w, float *h);
+
+/* Text metrics in the bundled UI font. Lines wrap at spaces to fit
+ * max_width (<= 0 = no wrapping) and break at '\n'. If breaks is given
+ * it receives up to max_breaks byte offsets at which lines 2..n start.
+ * Results are cached per (text, font size, max width). */
+typedef struct {
+    float width;            /* widest line */
+    float height;           /* line_count * line_height */
+    float line_height;
+    int   line_count;
+} lumi_text_metrics_t;
+
+lumi_result_t lumi_text_measure(const char *text, float font_size, float max_width,
+                                lumi_text_metrics_t *out, uint32_t *breaks, int max_breaks);
+void lumi_text_cache_clear(void);
+void lumi_text_cache_stats(size_t *hits, size_t *misses);
+
+typedef struct lumi_display_list lumi_display_list_t;
+
+typedef enum {
+    LUMI_DRAW_RECT,         /* fill x,y,w,h with color, rounded by radius */
+    LUMI_DRAW_TEXT,         /* text in x,y,w,h with color and font_size */
+    LUMI_DRAW_IMAGE,        /* image source text into x,y,w,h, rounded by radius,
+                               with color's alpha as opacity */
+    LUMI_DRAW_CLIP_PUSH,    /* intersect clip with x,y,w,h */
+    LUMI_DRAW_CLIP_POP,
+} lumi_draw_op_type_t;
+
+typedef struct {
+    lumi_draw_op_type_t type;
+    float       x, y, w, h;     /* absolute, in root coordinates */
+    uint32_t    color;          /* RGBA */
+    float       radius;
+    float       font_size;
+    const char *text;           /* text content or image source, may be NULL */
+} lumi_draw_op_t;
+
+typedef void (*lumi_draw_cb)(const lumi_draw_op_t *op, void *userdata);
+
+lumi_display_list_t *lumi_display_list_create(void);
+void   lumi_display_list_destroy(lumi_display_list_t *list);
+void   lumi_display_list_clear(lumi_display_list_t *list);
+size_t lumi_display_list_count(const lumi_display_list_t *list);
+void   lumi_display_list_replay(const lumi_display_list_t *list, lumi_draw_cb cb, void *userdata);
+
+/* Flat, little-endian wire format for handing a frame to a compositor.
+ * *out_data is malloc'd; release it with free(). */
+lumi_result_t lumi_display_list_serialize(const lumi_display_list_t *list,
+                                          uint8_t **out_data, size_t *out_len);
+lumi_result_t lumi_display_list_deserialize(lumi_display_list_t *list,
+                                            const uint8_t *data, size_t len);
+
+/* Record the draw ops of a laid-out tree into out (cleared first).
+ * Clean repaint boundaries are spliced from their cached list. */
+lumi_result_t lumi_view_paint(lumi_view_t *root, lumi_display_list_t *out);
+void lumi_view_set_repaint_boundary(lumi_view_t *view, bool boundary);
+
+/* Packed storage for a root (a view without parent): the fields layout
+ * and paint visit on every node are mirrored in contiguous pre-order
+ * arrays, which both passes then stream through. Views and their handles
+ * work as usual; edits that add, remove or move views cost one rebuild
+ * walk at the next pass. Attaching a packed root to a parent unpacks it. */
+lumi_result_t lumi_view_set_packed(lumi_view_t *root, bool packed);
+bool lumi_view_is_packed(lumi_view_t *root);
+
+/* ── Reconciliation ──────────────────────────────────────────────── */
+
+typedef enum {
+    LUMI_MUTATION_INSERT,   /* view (from the new tree) inserted at index */
+    LUMI_MUTATION_REMOVE,   /* view removed from index; destroyed after the callback */
+    LUMI_MUTATION_MOVE,     /* mounted view moved to index */
+    LUMI_MUTATION_UPDATE,   /* properties in `changed` patched in place */
+    LUMI_MUTATION_REPLACE,  /* incompatible root; view replaces the mounted one */
+} lumi_mutation_type_t;
+
+/* Bits of lumi_mutation_t.changed */
+#define LUMI_PROP_TEXT          (1u << 0)
+#define LUMI_PROP_VISIBLE       (1u << 1)
+#define LUMI_PROP_SIZE          (1u << 2)
+#define LUMI_PROP_PADDING       (1u << 3)
+#define LUMI_PROP_MARGIN        (1u << 4)
+#define LUMI_PROP_BACKGROUND    (1u << 5)
+#define LUMI_PROP_FOREGROUND    (1u << 6)
+#define LUMI_PROP_FONT_SIZE     (1u << 7)
+#define LUMI_PROP_BORDER_RADIUS (1u << 8)
+#define LUMI_PROP_HANDLERS      (1u << 9)
+#define LUMI_PROP_OPACITY       (1u << 10)
+
+typedef struct {
+    lumi_mutation_type_t type;
+    lumi_view_t *view;
+    lumi_view_t *parent;
+    int          index;     /* position in parent after the mutation */
+    uint32_t     changed;   /* LUMI_PROP_* for UPDATE */
+} lumi_mutation_t;
+
+typedef void (*lumi_mutation_cb)(const lumi_mutation_t *mutation, void *userdata);
+
+/* Patch `mounted` in place to match `next`, using view ids as keys, and
+ * consume `next` (a detached tree). Returns the tree to keep: `mounted`,
+ * or `next` if the roots differ in type or id. cb may be NULL. */
+lumi_view_t *lumi_view_reconcile(lumi_view_t *mounted, lumi_view_t *next,
+                                 lumi_mutation_cb cb, void *userdata);
+
+/* Like lumi_app_set_content, but reconciles against the current root. */
+void lumi_app_update_content(lumi_app_t *app, lumi_view_t *root,
+                             lumi_mutation_cb cb, void *userdata);
+
+/* ── View snapshots ──────────────────────────────────────────────── */
+
+/* Flat, little-endian image of a view tree: types, ids, text, visibility,
+ * repaint boundaries and resolved styles (class bindings and handlers are
+ * not recorded). *out_data is malloc'd; release it with free(). */
+lumi_result_t lumi_view_serialize(lumi_view_t *root, uint8_t **out_data, size_t *out_len);
+
+/* Build a detached tree from a snapshot in one pass. All of its views and
+ * strings share a single allocation, freed when the last view is destroyed. */
+lumi_result_t lumi_view_deserialize(const uint8_t *data, size_t len, lumi_view_t **out_root);
+
+/* ── Animation ───────────────────────────────────────────────────── */
+
+typedef enum {
+    LUMI_ANIM_WIDTH,            /* from the current frame if the size is intrinsic */
+    LUMI_ANIM_HEIGHT,
+    LUMI_ANIM_BACKGROUND,       /* colors: use lumi_animate_color */
+    LUMI_ANIM_FOREGROUND,
+    LUMI_ANIM_BORDER_RADIUS,
+    LUMI_ANIM_OPACITY,
+    LUMI_ANIM_FONT_SIZE,
+} lumi_anim_prop_t;
+
+typedef enum {
+    LUMI_EASE_LINEAR,
+    LUMI_EASE_IN,               /* cubic */
+    LUMI_EASE_OUT,
+    LUMI_EASE_IN_OUT,
+} lumi_easing_t;
+
+typedef void (*lumi_anim_cb)(lumi_view_t *view, void *userdata);
+
+/* Animate a property from its current value. Starting another animation
+ * of the same property replaces the running one; a spring retargeted by
+ * lumi_animate_spring keeps its velocity. Animations start counting at
+ * the next step. Return an animation id, or -1. */
+int lumi_animate(lumi_view_t *view, lumi_anim_prop_t prop, float to,
+                 uint32_t duration_ms, lumi_easing_t easing);
+int lumi_animate_color(lumi_view_t *view, lumi_anim_prop_t prop, uint32_t rgba,
+                       uint32_t duration_ms, lumi_easing_t easing);
+/* Damped spring, unit mass: stiffness in 1/s^2, damping in 1/s
+ * (170 and 26 give a quick, barely overshooting settle). */
+int lumi_animate_spring(lumi_view_t *view, lumi_anim_prop_t prop, float to,
+                        float stiffness, float damping);
+
+/* cb runs from lumi_anim_step once the animation completes; cancelled
+ * animations (and those of destroyed views) end silently. */
+void lumi_anim_on_end(int anim_id, lumi_anim_cb cb, void *userdata);
+void lumi_anim_cancel(int anim_id);
+void lumi_anim_cancel_view(lumi_view_t *view);
+
+/* Advance every animation to now_ms (any monotonic millisecond clock) in
+ * one batched pass and write the values to their views; call once per
+ * frame before layout. Returns the number of animations still running. */
+int lumi_anim_step(uint64_t now_ms);
+
+/* ── Hit testing ─────────────────────────────────────────────────── */
+
+/* Coordinates are in the same space as display-list ops. Hidden views,
+ * points outside a parent's frame and scroll offsets are respected; in
+ * overlapping children (stacks) the last child is on top. */
+lumi_view_t *lumi_view_hit_test(lumi_view_t *root, float x, float y);
+
+/* Invoke the click handler of the hit view or its nearest ancestor that
+ * has one. Returns true if a handler ran. */
+bool lumi_view_dispatch_click(lumi_view_t *root, float x, float y);
+bool lumi_view_dispatch_long_click(lumi_view_t *root, float x, float y);
+
+/* ── Images ──────────────────────────────────────────────────────── */
+
+/* Decoded, immutable RGBA8888 bitmap (rows of width * 4 bytes). */
+typedef struct lumi_bitmap lumi_bitmap_t;
+
+int            lumi_bitmap_width(const lumi_bitmap_t *bitmap);
+int            lumi_bitmap_height(const lumi_bitmap_t *bitmap);
+const uint8_t *lumi_bitmap_pixels(const lumi_bitmap_t *bitmap);
+lumi_bitmap_t *lumi_bitmap_retain(lumi_bitmap_t *bitmap);
+void           lumi_bitmap_release(lumi_bitmap_t *bitmap);
+
+/* Decode PNG (non-interlaced) or PPM/PGM data. If max_w/max_h are > 0 the
+ * image is box-filtered down to fit them; it is never scaled up. Images
+ * over 16384 pixels a side or 64 Mpx in all are LUMI_ERR_INVALID. */
+lumi_result_t lumi_image_decode(const uint8_t *data, size_t len, int max_w, int max_h,
+                                lumi_bitmap_t **out);
+
+/* bitmap is only valid during the callback; retain it to keep it. */
+typedef void (*lumi_image_cb)(const char *source, lumi_bitmap_t *bitmap,
+                              lumi_result_t result, void *userdata);
+
+/* Load a file on the decoder threads at width x height (0 = natural
+ * size). Cached bitmaps are delivered before this returns; otherwise cb
+ * runs from a later lumi_image_poll(). Concurrent requests for the same
+ * source and size share one decode. cb may be NULL to just warm the cache. */
+lumi_result_t lumi_image_request(const char *source, int width, int height,
+                                 lumi_image_cb cb, void *userdata);
+
+/* Cached bitmap or NULL, without loading; release the result. Renderers
+ * use this to resolve LUMI_DRAW_IMAGE ops at replay time. */
+lumi_bitmap_t *lumi_image_lookup(const char *source, int width, int height);
+
+/* Publish finished decodes and run their callbacks on the calling (UI)
+ * thread. Returns the number of loads completed; repaint if non-zero. */
+int lumi_image_poll(void);
+
+/* Request every visible image view of a laid-out tree at its content size. */
+void lumi_view_load_images(lumi_view_t *root);
+
+typedef struct {
+    size_t bytes, limit;        /* cached pixel bytes and the cache bound */
+    size_t entries;
+    size_t pending;             /* queued or decoding */
+    size_t decodes;             /* finished decodes, including failures */
+    size_t hits;
+} lumi_image_stats_t;
+
+void lumi_image_cache_set_limit(size_t bytes);      /* default 64 MiB */
+void lumi_image_get_stats(lumi_image_stats_t *out);
+
+/* Stop the decoder threads, dropping pending requests, and empty the
+ * cache. Called by lumi_app_destroy(). */
+void lumi_image_shutdown(void);
+
+/* ── Memory accounting ───────────────────────────────────────────── */
+
+/* Heap bytes the SDK holds, by subsystem and for the app created last
+ * (allocations made while no app exists count only per subsystem). With
+ * a budget set, an allocation that would take live bytes past it fails
+ * and the call making it reports LUMI_ERR_NOMEM, or NULL for the view
+ * constructors. Budgets of 0 mean none; lowering one below live bytes
+ * refuses growth until enough is freed. */
+typedef enum {
+    LUMI_MEM_VIEWS   = 0,     /* nodes, snapshot blocks, hit-test indexes */
+    LUMI_MEM_STRINGS = 1,     /* view ids and texts */
+    LUMI_MEM_STORAGE = 2,     /* keys and values */
+    LUMI_MEM_INTENTS = 3,     /* handler tables */
+    LUMI_MEM_FILES   = 4,     /* lumi_file_read() buffers, until returned */
+    LUMI_MEM_SUBSYSTEM_COUNT
+} lumi_mem_subsystem_t;
+
+typedef struct {
+    size_t live;
+    size_t peak;              /* high-water mark of live */
+    size_t budget;
+    size_t refused;           /* allocations failed for the budget */
+} lumi_mem_usage_t;
+
+lumi_result_t lumi_mem_get_usage(lumi_mem_subsystem_t sys, lumi_mem_usage_t *out);
+lumi_result_t lumi_mem_set_budget(lumi_mem_subsystem_t sys, size_t bytes);
+lumi_result_t lumi_app_get_mem_usage(lumi_app_t *app, lumi_mem_usage_t *out);
+lumi_result_t lumi_app_set_mem_budget(lumi_app_t *app, size_t bytes);
+
+/* Bytes held by view and its descendants: nodes, strings, hit-test and
+ * id indexes, packed storage and cached display lists */
+size_t lumi_view_get_footprint(const lumi_view_t *view);
+
+/* Where that memory comes from. Frees pass the size that was allocated,
+ * so an allocator needs no block headers; realloc may be NULL, in which
+ * case the SDK allocates, copies and frees. The SDK copies the struct;
+ * ctx must stay valid while the allocator can be called.
+ *
+ * The process allocator serves the SDK unless the current app has its
+ * own. A block is always freed by the allocator that made it, so either
+ * can only be changed while the SDK holds no accounted memory (every
+ * lumi_mem_get_usage() live is 0); otherwise LUMI_ERR_INVALID. An app's
+ * allocator stays in effect after lumi_app_destroy() while memory it
+ * served is still held, e.g. storage entries. An app struct comes from
+ * the process allocator at its creation. Display lists, images, logs and
+ * other caches use malloc(), as do the buffers that lumi_file_read() and
+ * lumi_view_serialize() hand out. */
+typedef struct {
+    void *(*alloc)(void *ctx, size_t size);
+    void *(*realloc)(void *ctx, void *p, size_t old_size, size_t size);
+    void  (*free)(void *ctx, void *p, size_t size);
+    void  *ctx;
+} lumi_allocator_t;
+
+lumi_result_t lumi_set_allocator(const lumi_allocator_t *allocator);  /* NULL: malloc */
+lumi_result_t lumi_app_set_allocator(lumi_app_t *app, const lumi_allocator_t *allocator);
+
 /* ── Storage (key-value) ─────────────────────────────────────────── */
 
 lumi_result_t lumi_storage_set(const char *key, const char *value);
@@ -172,11 +682,43 @@ typedef struct {
     const char *icon;
     const char *channel;
     int priority;   /* 0=default, 1=high, -1=low */
+    const char *key;    /* same channel and key: replaces the earlier one */
 } lumi_notification_t;
 
+/* Queues the notification for the notification daemon (lumi-notifyd) and
+ * returns without waiting for it. A queued notification with the same
+ * channel and key is updated instead of queued again. Each channel is
+ * rate limited; notifications over the limit wait, and keep collapsing by
+ * key, until the channel may send again. Without a daemon they go to the
+ * log. LUMI_ERR_NOMEM once 1024 notifications are waiting;
+ * LUMI_ERR_INVALID if its strings do not fit in one 64 KiB packet. */
 lumi_result_t lumi_notify(const lumi_notification_t *notif);
 lumi_result_t lumi_notify_simple(const char *title, const char *body);
 
+/* Token bucket of a channel, or with channel NULL the default for every
+ * channel without its own: per_second sustained, burst at once. The
+ * default is 5 per second with a burst of 5. */
+lumi_result_t lumi_notify_set_rate(const char *channel, double per_second, int burst);
+
+/* Daemon socket; NULL means $LUMI_NOTIFY_SOCKET, else lumi-notify.sock in
+ * $XDG_RUNTIME_DIR. Takes effect with the next delivery. */
+lumi_result_t lumi_notify_set_socket(const char *socket_path);
+
+typedef struct {
+    size_t posted;              /* accepted by lumi_notify() */
+    size_t coalesced;           /* of those, updates to a waiting one */
+    size_t delivered;           /* sent to the daemon, or logged without one */
+    size_t pending;
+    size_t dropped;             /* refused with the queue full */
+    size_t writes;              /* packets written to the daemon */
+} lumi_notify_stats_t;
+
+void lumi_notify_get_stats(lumi_notify_stats_t *out);
+
+/* Deliver everything still waiting, ignoring rate limits, and stop the
+ * sender thread. Called by lumi_app_destroy(). */
+void lumi_notify_shutdown(void);
+
 /* ── Intents / IPC ───────────────────────────────────────────────── */
 
 typedef struct {
@@ -184,12 +726,136 @@ typedef struct {
     const char *data;
     const char *mime_type;
     const char *target_app;
+    const void *extras;         /* encoded typed extras (see below), or NULL */
+    size_t      extras_len;
 } lumi_intent_t;
 
+/* Delivers to matching handlers before returning. A send made from
+ * handlers nested more than 8 deep is posted at normal priority instead. */
 lumi_result_t lumi_intent_send(const lumi_intent_t *intent);
 
+typedef enum {
+    LUMI_INTENT_PRIORITY_HIGH,
+    LUMI_INTENT_PRIORITY_NORMAL,
+    LUMI_INTENT_PRIORITY_LOW,
+} lumi_intent_priority_t;
+
+/* Copies the intent into a queue and returns without running handlers;
+ * safe to call from any thread. Delivery happens in lumi_intent_poll(). */
+lumi_result_t lumi_intent_post(const lumi_intent_t *intent, lumi_intent_priority_t priority);
+
+/* Deliver the intents posted so far on the calling (UI) thread, high
+ * priority first and in post order within a priority. High-priority
+ * intents posted while lower ones are being delivered jump ahead of them;
+ * others posted meanwhile wait for the next poll. Returns the number
+ * delivered. */
+int lumi_intent_poll(void);
+
+/* Number of posted intents not yet taken by a poll. */
+int lumi_intent_pending(void);
+
+/* Join the local intent bus served by lumi-intentd, as app_id (which
+ * receives intents whose target_app names it). socket_path NULL means
+ * $LUMI_BUS_SOCKET, else lumi-intent.sock in $XDG_RUNTIME_DIR. Once
+ * connected, registered patterns are subscribed at the broker and every
+ * send is also delivered to the other apps whose patterns match it.
+ * Data too large for one packet (64 KiB) travels as a sealed, read-only
+ * shared-memory segment, so payloads of any size can be sent.
+ * Returns LUMI_ERR_IO if the broker is not reachable yet; lumi_bus_poll()
+ * keeps retrying, and reconnects the same way if the broker restarts. */
+lumi_result_t lumi_bus_connect(const char *socket_path, const char *app_id);
+void          lumi_bus_disconnect(void);
+bool          lumi_bus_connected(void);
+
+/* Socket to watch for readability, or -1 while disconnected. */
+int           lumi_bus_fd(void);
+
+/* Send what is batched, reconnect if needed and run the handlers of
+ * intents received from other apps. Returns the number received. */
+int           lumi_bus_poll(void);
+
 typedef void (*lumi_intent_cb)(const lumi_intent_t *intent, void *userdata);
+
+/* action is an exact action name, or a pattern whose last segment is "*":
+ * "com.lumios.media.*" matches every action under that prefix and "*"
+ * matches all of them. Wildcard handlers run before exact ones, broadest
+ * first, each group in registration order. Handlers may register and
+ * unregister from inside a callback. */
 lumi_result_t lumi_intent_register(const char *action, lumi_intent_cb cb, void *userdata);
+/* Removes one registration made with the same action, cb and userdata. */
+lumi_result_t lumi_intent_unregister(const char *action, lumi_intent_cb cb, void *userdata);
+
+/* ── Typed intent extras ─────────────────────────────────────────── */
+
+typedef enum {
+    LUMI_EXTRA_NONE,
+    LUMI_EXTRA_INT,             /* int64_t */
+    LUMI_EXTRA_FLOAT,           /* double */
+    LUMI_EXTRA_BYTES,
+    LUMI_EXTRA_STRING,
+    LUMI_EXTRA_MAP,             /* nested extras */
+} lumi_extra_type_t;
+
+/* Builds a key -> typed value map. Putting a key again replaces it. */
+typedef struct lumi_extras lumi_extras_t;
+
+lumi_extras_t *lumi_extras_create(void);
+void          lumi_extras_destroy(lumi_extras_t *ex);
+/* Empties the builder but keeps its memory, for building the next intent. */
+void          lumi_extras_clear(lumi_extras_t *ex);
+lumi_result_t lumi_extras_put_int(lumi_extras_t *ex, const char *key, int64_t value);
+lumi_result_t lumi_extras_put_float(lumi_extras_t *ex, const char *key, double value);
+lumi_result_t lumi_extras_put_bytes(lumi_extras_t *ex, const char *key,
+                                    const void *data, size_t len);
+lumi_result_t lumi_extras_put_string(lumi_extras_t *ex, const char *key, const char *value);
+/* Copies map in as it is now; it can be changed or destroyed afterwards. */
+lumi_result_t lumi_extras_put_map(lumi_extras_t *ex, const char *key, lumi_extras_t *map);
+
+/* The binary encoding, for lumi_intent_t.extras. Valid until the next put
+ * or lumi_extras_destroy(); encoding again without changes is free. */
+lumi_result_t lumi_extras_encode(lumi_extras_t *ex, const void **data, size_t *len);
+
+/* Read-only view of encoded extras. Nothing is decoded up front: each
+ * lookup is a binary search over the sorted keys, and strings, bytes and
+ * nested maps point into the encoded data. */
+typedef struct {
+    const uint8_t *data;
+    uint32_t       size;
+    uint32_t       count;
+} lumi_extras_view_t;
+
+/* data NULL with len 0 (an intent without extras) opens as an empty map.
+ * LUMI_ERR_INVALID if the header does not fit in len. */
+lumi_result_t lumi_extras_open(lumi_extras_view_t *out, const void *data, size_t len);
+
+/* LUMI_EXTRA_NONE if key is absent or its value is malformed. */
+lumi_extra_type_t lumi_extras_type(const lumi_extras_view_t *v, const char *key);
+/* Entry by index, in key order, for iterating over all of them. */
+lumi_extra_type_t lumi_extras_at(const lumi_extras_view_t *v, uint32_t index, const char **key);
+
+/* LUMI_ERR_NOT_FOUND if key is absent, LUMI_ERR_INVALID if it holds
+ * another type. Pointers stay valid as long as the encoded data. */
+lumi_result_t lumi_extras_get_int(const lumi_extras_view_t *v, const char *key, int64_t *out);
+lumi_result_t lumi_extras_get_float(const lumi_extras_view_t *v, const char *key, double *out);
+lumi_result_t lumi_extras_get_bytes(const lumi_extras_view_t *v, const char *key,
+                                    const void **data, size_t *len);
+lumi_result_t lumi_extras_get_string(const lumi_extras_view_t *v, const char *key,
+                                     const char **out);
+lumi_result_t lumi_extras_get_map(const lumi_extras_view_t *v, const char *key,
+                                  lumi_extras_view_t *out);
+
+typedef struct {
+    const char       *key;
+    lumi_extra_type_t type;
+    bool              required;
+} lumi_extra_field_t;
+
+/* Checks v against a schema: every required key is present and every
+ * listed key that is present has its type. Keys not in the schema are
+ * allowed. LUMI_ERR_NOT_FOUND for a missing key, LUMI_ERR_INVALID for a
+ * wrong type. */
+lumi_result_t lumi_extras_validate(const lumi_extras_view_t *v, const lumi_extra_field_t *schema,
+                                   size_t count);
 
 /* ── File utilities ──────────────────────────────────────────────── */
 
@@ -206,6 +872,11 @@ typedef void (*lumi_timer_cb)(void *userdata);
 int  lumi_timer_set(uint32_t delay_ms, bool repeat, lumi_timer_cb cb, void *userdata);
 void lumi_timer_cancel(int timer_id);
 
+/* Runs the callbacks of timers that are due and returns how many ran.
+ * lumi_app_run() polls from its loop. A repeating timer that fell behind
+ * runs once and is rescheduled from now. */
+int  lumi_timer_poll(void);
+
 #ifdef __cplusplus
 }
 #endif
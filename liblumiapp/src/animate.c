@@ -0,0 +1,523 @@
+/**
+ * animate.c — Batched property animation
+ * Copyright 2026 Lumi Team. Apache-2.0
+ *
+ * Animations are not callbacks: each is a handful of float lanes (one per
+ * property, four for RGBA colors) in structure-of-arrays pools, one pool
+ * for tweens and one for springs. lumi_anim_step() advances every lane of
+ * a pool in a single branch-free loop, four lanes at a time with SSE2,
+ * then writes the values back with one style commit per animated view.
+ * Cancelled animations are only marked dead and swept at the next step,
+ * so tearing down a large animated tree stays linear.
+ *
+ * Easing curves are cubic polynomials e(p) = c1 p + c2 p^2 + c3 p^3, so
+ * every tween runs the same arithmetic whatever its curve. Springs use
+ * semi-implicit Euler at a fixed 240 Hz substep.
+ */
+
+#include "view_internal.h"
+#include <stdlib.h>
+#include <string.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#define SPRING_HZ       240.0f
+#define SPRING_MAX_DT   (1.0f / 15.0f)      /* after a stall, resume gently */
+
+/* Lane fields of each pool */
+enum { T_ELAPSED, T_RATE, T_C1, T_C2, T_C3, T_FROM, T_DELTA, T_VALUE, T_GAIN, T_FIELDS };
+enum { S_X, S_V, S_TARGET, S_K, S_C, S_EPS, S_FIELDS };
+#define MAX_FIELDS T_FIELDS
+
+enum { ANIM_RUNNING, ANIM_ENDED, ANIM_DEAD };
+
+typedef struct {
+    int           id;
+    lumi_view_t  *view;
+    uint8_t       prop;
+    uint8_t       lanes;        /* 1, or 4 for colors */
+    uint8_t       state;        /* ANIM_* */
+    uint32_t      first;        /* index of the first lane */
+    lumi_anim_cb  cb;
+    void         *userdata;
+} anim_t;
+
+typedef struct {
+    anim_t   *anims;
+    int       count, cap;
+    uint32_t  lanes, lane_cap;  /* lane_cap is a multiple of 4 */
+    int       fields;
+    bool      garbage;          /* holds animations that are no longer running */
+    float    *lane[MAX_FIELDS];
+} pool_t;
+
+/* One view's merged writes for the current step */
+typedef struct {
+    lumi_view_t       *view;
+    uint32_t           props;
+    lumi_style_desc_t  desc;
+} staged_t;
+
+static pool_t g_tweens  = { .fields = T_FIELDS };
+static pool_t g_springs = { .fields = S_FIELDS };
+static int      g_next_id = 1;
+static uint64_t g_last_ms;
+static bool     g_started;
+
+/* Finished animations whose callbacks are being dispatched */
+static anim_t  *g_ended;
+static int      g_ended_count;
+
+/* Per-step staging: an open-addressed map from view to staged_t */
+static staged_t *g_stage;
+static int       g_stage_count, g_stage_cap;
+static int32_t  *g_stage_map;       /* staged index + 1, 0 when empty */
+static uint32_t  g_stage_mask;
+
+static const float EASE[][3] = {
+    [LUMI_EASE_LINEAR] = { 1.0f,  0.0f,  0.0f },
+    [LUMI_EASE_IN]     = { 0.0f,  0.0f,  1.0f },
+    [LUMI_EASE_OUT]    = { 3.0f, -3.0f,  1.0f },
+    [LUMI_EASE_IN_OUT] = { 0.0f,  3.0f, -2.0f },
+};
+
+static float absf(float f) { return f < 0.0f ? -f : f; }
+
+static bool is_color(lumi_anim_prop_t prop) {
+    return prop == LUMI_ANIM_BACKGROUND || prop == LUMI_ANIM_FOREGROUND;
+}
+
+/* ── Pools ─────────────────────────────────────────────────────── */
+
+static bool pool_reserve(pool_t *p, int anims, uint32_t lanes) {
+    if (anims > p->cap) {
+        int cap = p->cap ? p->cap * 2 : 64;
+        while (cap < anims) cap *= 2;
+        anim_t *a = realloc(p->anims, (size_t)cap * sizeof(anim_t));
+        if (!a) return false;
+        p->anims = a;
+        p->cap = cap;
+    }
+    if (lanes > p->lane_cap) {
+        uint32_t cap = p->lane_cap ? p->lane_cap * 2 : 256;
+        while (cap < lanes) cap *= 2;
+        for (int f = 0; f < p->fields; f++) {
+            float *l = realloc(p->lane[f], cap * sizeof(float));
+            if (!l) return false;
+            memset(l + p->lane_cap, 0, (cap - p->lane_cap) * sizeof(float));
+            p->lane[f] = l;
+        }
+        p->lane_cap = cap;
+    }
+    return true;
+}
+
+/* Drops animations that stopped running, keeping lanes contiguous and in order. */
+static void pool_compact(pool_t *p) {
+    int n = 0;
+    uint32_t lanes = 0;
+    for (int i = 0; i < p->count; i++) {
+        anim_t *a = &p->anims[i];
+        if (a->state != ANIM_RUNNING) continue;
+        if (a->first != lanes) {
+            for (int f = 0; f < p->fields; f++) {
+                memmove(p->lane[f] + lanes, p->lane[f] + a->first, a->lanes * sizeof(float));
+            }
+            a->first = lanes;
+        }
+        lanes += a->lanes;
+        p->anims[n++] = *a;
+    }
+    p->count = n;
+    p->lanes = lanes;
+    p->garbage = false;
+}
+
+static anim_t *pool_add(pool_t *p, lumi_view_t *view, lumi_anim_prop_t prop) {
+    int lanes = is_color(prop) ? 4 : 1;
+    if (!pool_reserve(p, p->count + 1, p->lanes + lanes)) return NULL;
+
+    anim_t *a = &p->anims[p->count++];
+    *a = (anim_t){ .id = g_next_id, .view = view, .prop = (uint8_t)prop,
+                   .lanes = (uint8_t)lanes, .first = p->lanes };
+    g_next_id = g_next_id == INT32_MAX ? 1 : g_next_id + 1;
+    p->lanes += lanes;
+    view->anim_count++;
+    return a;
+}
+
+static anim_t *find_id(int id, pool_t **pool) {
+    pool_t *pools[] = { &g_tweens, &g_springs };
+    for (int k = 0; k < 2; k++) {
+        for (int i = 0; i < pools[k]->count; i++) {
+            anim_t *a = &pools[k]->anims[i];
+            if (a->id == id && a->state == ANIM_RUNNING) {
+                if (pool) *pool = pools[k];
+                return a;
+            }
+        }
+    }
+    return NULL;
+}
+
+static anim_t *find_prop(lumi_view_t *view, lumi_anim_prop_t prop, pool_t **pool) {
+    if (!view->anim_count) return NULL;
+    pool_t *pools[] = { &g_tweens, &g_springs };
+    for (int k = 0; k < 2; k++) {
+        for (int i = 0; i < pools[k]->count; i++) {
+            anim_t *a = &pools[k]->anims[i];
+            if (a->view == view && a->prop == prop && a->state == ANIM_RUNNING) {
+                *pool = pools[k];
+                return a;
+            }
+        }
+    }
+    return NULL;
+}
+
+static void retire(pool_t *p, anim_t *a) {
+    a->state = ANIM_DEAD;
+    a->view->anim_count--;
+    p->garbage = true;
+}
+
+/* ── Property access ───────────────────────────────────────────── */
+
+static void read_prop(lumi_view_t *v, lumi_anim_prop_t prop, float out[4]) {
+    const lumi_style_desc_t *st = view_style(v);
+    uint32_t rgba = 0;
+    switch (prop) {
+        case LUMI_ANIM_WIDTH:         out[0] = st->width > 0.0f ? st->width : v->frame_w; return;
+        case LUMI_ANIM_HEIGHT:        out[0] = st->height > 0.0f ? st->height : v->frame_h; return;
+        case LUMI_ANIM_BORDER_RADIUS: out[0] = st->border_radius; return;
+        case LUMI_ANIM_OPACITY:       out[0] = st->opacity; return;
+        case LUMI_ANIM_FONT_SIZE:     out[0] = st->font_size; return;
+        case LUMI_ANIM_BACKGROUND:    rgba = st->background; break;
+        case LUMI_ANIM_FOREGROUND:    rgba = st->foreground; break;
+    }
+    for (int c = 0; c < 4; c++) out[c] = (float)((rgba >> (24 - 8 * c)) & 0xFF);
+}
+
+static uint32_t pack_rgba(const float *ch) {
+    uint32_t rgba = 0;
+    for (int c = 0; c < 4; c++) {
+        float f = ch[c];
+        uint32_t b = f <= 0.0f ? 0 : f >= 255.0f ? 255 : (uint32_t)(f + 0.5f);
+        rgba |= b << (24 - 8 * c);
+    }
+    return rgba;
+}
+
+/* Stores an animation's lanes into d; returns the LUMI_PROP_* bit. */
+static uint32_t write_prop(lumi_style_desc_t *d, lumi_anim_prop_t prop, const float *value) {
+    switch (prop) {
+        case LUMI_ANIM_WIDTH:         d->width = value[0];              return LUMI_PROP_SIZE;
+        case LUMI_ANIM_HEIGHT:        d->height = value[0];             return LUMI_PROP_SIZE;
+        case LUMI_ANIM_BORDER_RADIUS: d->border_radius = value[0];      return LUMI_PROP_BORDER_RADIUS;
+        case LUMI_ANIM_FONT_SIZE:     d->font_size = value[0];          return LUMI_PROP_FONT_SIZE;
+        case LUMI_ANIM_OPACITY:
+            d->opacity = value[0] < 0.0f ? 0.0f : value[0] > 1.0f ? 1.0f : value[0];
+            return LUMI_PROP_OPACITY;
+        case LUMI_ANIM_BACKGROUND:    d->background = pack_rgba(value); return LUMI_PROP_BACKGROUND;
+        case LUMI_ANIM_FOREGROUND:    d->foreground = pack_rgba(value); return LUMI_PROP_FOREGROUND;
+    }
+    return 0;
+}
+
+/* ── Starting and stopping ─────────────────────────────────────── */
+
+static int start_tween(lumi_view_t *view, lumi_anim_prop_t prop, const float to[4],
+                       uint32_t duration_ms, lumi_easing_t easing) {
+    pool_t *pool;
+    anim_t *old = find_prop(view, prop, &pool);
+    if (old) retire(pool, old);
+
+    float from[4];
+    read_prop(view, prop, from);
+    anim_t *a = pool_add(&g_tweens, view, prop);
+    if (!a) return -1;
+
+    float **l = g_tweens.lane;
+    float rate = 1000.0f / (float)(duration_ms ? duration_ms : 1);
+    for (uint32_t c = 0; c < a->lanes; c++) {
+        uint32_t i = a->first + c;
+        l[T_ELAPSED][i] = 0.0f;
+        l[T_RATE][i]    = rate;
+        l[T_C1][i]      = EASE[easing][0];
+        l[T_C2][i]      = EASE[easing][1];
+        l[T_C3][i]      = EASE[easing][2];
+        l[T_FROM][i]    = from[c];
+        l[T_DELTA][i]   = to[c] - from[c];
+        l[T_VALUE][i]   = from[c];
+        l[T_GAIN][i]    = 0.0f;         /* starts counting at the next step */
+    }
+    return a->id;
+}
+
+int lumi_animate(lumi_view_t *view, lumi_anim_prop_t prop, float to,
+                 uint32_t duration_ms, lumi_easing_t easing) {
+    if (!view || is_color(prop) || prop > LUMI_ANIM_FONT_SIZE || easing > LUMI_EASE_IN_OUT) {
+        return -1;
+    }
+    float lanes[4] = { to, 0.0f, 0.0f, 0.0f };
+    return start_tween(view, prop, lanes, duration_ms, easing);
+}
+
+int lumi_animate_color(lumi_view_t *view, lumi_anim_prop_t prop, uint32_t rgba,
+                       uint32_t duration_ms, lumi_easing_t easing) {
+    if (!view || !is_color(prop) || easing > LUMI_EASE_IN_OUT) return -1;
+    float lanes[4];
+    for (int c = 0; c < 4; c++) lanes[c] = (float)((rgba >> (24 - 8 * c)) & 0xFF);
+    return start_tween(view, prop, lanes, duration_ms, easing);
+}
+
+int lumi_animate_spring(lumi_view_t *view, lumi_anim_prop_t prop, float to,
+                        float stiffness, float damping) {
+    if (!view || is_color(prop) || prop > LUMI_ANIM_FONT_SIZE) return -1;
+    if (!(stiffness > 0.0f) || !(damping >= 0.0f)) return -1;
+
+    pool_t *pool;
+    anim_t *a = find_prop(view, prop, &pool);
+    float **l = g_springs.lane;
+    if (a && pool == &g_springs) {
+        /* Retarget in flight, keeping the current velocity */
+        l[S_TARGET][a->first] = to;
+        l[S_K][a->first] = stiffness;
+        l[S_C][a->first] = damping;
+        return a->id;
+    }
+    if (a) retire(pool, a);
+
+    float from[4];
+    read_prop(view, prop, from);
+    if (!(a = pool_add(&g_springs, view, prop))) return -1;
+
+    uint32_t i = a->first;
+    float span = absf(to - from[0]);
+    l[S_X][i]      = from[0];
+    l[S_V][i]      = 0.0f;
+    l[S_TARGET][i] = to;
+    l[S_K][i]      = stiffness;
+    l[S_C][i]      = damping;
+    l[S_EPS][i]    = prop == LUMI_ANIM_OPACITY ? 0.001f : (span > 100.0f ? span * 1e-4f : 0.01f);
+    return a->id;
+}
+
+void lumi_anim_on_end(int anim_id, lumi_anim_cb cb, void *userdata) {
+    anim_t *a = find_id(anim_id, NULL);
+    if (!a) return;
+    a->cb = cb;
+    a->userdata = userdata;
+}
+
+void lumi_anim_cancel(int anim_id) {
+    pool_t *pool;
+    anim_t *a = find_id(anim_id, &pool);
+    if (a) retire(pool, a);
+}
+
+void lumi_anim_cancel_view(lumi_view_t *view) {
+    if (!view) return;
+    for (int i = 0; i < g_ended_count; i++) {
+        if (g_ended[i].view == view) g_ended[i].view = NULL;
+    }
+    if (!view->anim_count) return;
+
+    pool_t *pools[] = { &g_tweens, &g_springs };
+    for (int k = 0; k < 2 && view->anim_count; k++) {
+        for (int i = 0; i < pools[k]->count; i++) {
+            anim_t *a = &pools[k]->anims[i];
+            if (a->view != view || a->state != ANIM_RUNNING) continue;
+            retire(pools[k], a);
+            if (!view->anim_count) break;
+        }
+    }
+}
+
+/* ── Stepping ──────────────────────────────────────────────────── */
+
+static void step_tweens(pool_t *p, float dt) {
+    float *restrict elapsed = p->lane[T_ELAPSED], *restrict gain = p->lane[T_GAIN];
+    const float *restrict rate = p->lane[T_RATE];
+    const float *restrict c1 = p->lane[T_C1], *restrict c2 = p->lane[T_C2], *restrict c3 = p->lane[T_C3];
+    const float *restrict from = p->lane[T_FROM], *restrict delta = p->lane[T_DELTA];
+    float *restrict value = p->lane[T_VALUE];
+    uint32_t n = (p->lanes + 3) & ~3u;      /* padding lanes are harmless */
+    uint32_t i = 0;
+
+#ifdef __SSE2__
+    __m128 vdt = _mm_set1_ps(dt), one = _mm_set1_ps(1.0f);
+    for (; i < n; i += 4) {
+        __m128 e = _mm_add_ps(_mm_loadu_ps(elapsed + i), _mm_mul_ps(vdt, _mm_loadu_ps(gain + i)));
+        _mm_storeu_ps(elapsed + i, e);
+        _mm_storeu_ps(gain + i, one);
+        __m128 t = _mm_min_ps(_mm_mul_ps(e, _mm_loadu_ps(rate + i)), one);
+        __m128 ease = _mm_add_ps(_mm_loadu_ps(c2 + i), _mm_mul_ps(t, _mm_loadu_ps(c3 + i)));
+        ease = _mm_mul_ps(t, _mm_add_ps(_mm_loadu_ps(c1 + i), _mm_mul_ps(t, ease)));
+        _mm_storeu_ps(value + i, _mm_add_ps(_mm_loadu_ps(from + i),
+                                           _mm_mul_ps(_mm_loadu_ps(delta + i), ease)));
+    }
+#endif
+    for (; i < n; i++) {
+        float e = elapsed[i] + dt * gain[i];
+        elapsed[i] = e;
+        gain[i] = 1.0f;
+        float t = e * rate[i] < 1.0f ? e * rate[i] : 1.0f;
+        value[i] = from[i] + delta[i] * (t * (c1[i] + t * (c2[i] + t * c3[i])));
+    }
+
+    for (int k = 0; k < p->count; k++) {
+        anim_t *a = &p->anims[k];
+        if (elapsed[a->first] * rate[a->first] >= 1.0f) a->state = ANIM_ENDED;
+    }
+}
+
+static void step_springs(pool_t *p, float dt) {
+    float *restrict x = p->lane[S_X], *restrict v = p->lane[S_V];
+    const float *restrict target = p->lane[S_TARGET];
+    const float *restrict k = p->lane[S_K], *restrict c = p->lane[S_C];
+    uint32_t n = (p->lanes + 3) & ~3u;
+    if (dt > SPRING_MAX_DT) dt = SPRING_MAX_DT;
+    int steps = (int)(dt * SPRING_HZ);
+    if ((float)steps < dt * SPRING_HZ) steps++;
+    float h = steps ? dt / (float)steps : 0.0f;
+
+    for (int s = 0; s < steps; s++) {
+        uint32_t i = 0;
+#ifdef __SSE2__
+        __m128 vh = _mm_set1_ps(h);
+        for (; i < n; i += 4) {
+            __m128 xi = _mm_loadu_ps(x + i), vi = _mm_loadu_ps(v + i);
+            __m128 force = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(k + i), _mm_sub_ps(xi, _mm_loadu_ps(target + i))),
+                                      _mm_mul_ps(_mm_loadu_ps(c + i), vi));
+            vi = _mm_sub_ps(vi, _mm_mul_ps(force, vh));
+            _mm_storeu_ps(v + i, vi);
+            _mm_storeu_ps(x + i, _mm_add_ps(xi, _mm_mul_ps(vi, vh)));
+        }
+#endif
+        for (; i < n; i++) {
+            v[i] -= (k[i] * (x[i] - target[i]) + c[i] * v[i]) * h;
+            x[i] += v[i] * h;
+        }
+    }
+
+    const float *eps = p->lane[S_EPS];
+    for (int j = 0; j < p->count; j++) {
+        anim_t *a = &p->anims[j];
+        uint32_t i = a->first;
+        if (absf(x[i] - target[i]) < eps[i] && absf(v[i]) < eps[i] * SPRING_HZ) {
+            x[i] = target[i];
+            a->state = ANIM_ENDED;
+        }
+    }
+}
+
+/* Sizes the staging map for up to n views; false leaves staging off. */
+static bool stage_reserve(int n) {
+    g_stage_count = 0;
+    if (n == 0) return false;
+    if (n > g_stage_cap) {
+        int cap = g_stage_cap ? g_stage_cap : 64;
+        while (cap < n) cap *= 2;
+        staged_t *st = malloc((size_t)cap * sizeof(*st));
+        int32_t *map = malloc((size_t)cap * 2 * sizeof(*map));
+        if (!st || !map) {
+            free(st);
+            free(map);
+            return false;
+        }
+        free(g_stage);
+        free(g_stage_map);
+        g_stage = st;
+        g_stage_map = map;
+        g_stage_cap = cap;
+        g_stage_mask = (uint32_t)cap * 2 - 1;
+    }
+    memset(g_stage_map, 0, ((size_t)g_stage_mask + 1) * sizeof(*g_stage_map));
+    return true;
+}
+
+static staged_t *stage(lumi_view_t *view) {
+    uint32_t h = (uint32_t)(((uintptr_t)view >> 4) * 2654435761u) & g_stage_mask;
+    for (;; h = (h + 1) & g_stage_mask) {
+        int32_t slot = g_stage_map[h];
+        if (!slot) break;
+        if (g_stage[slot - 1].view == view) return &g_stage[slot - 1];
+    }
+    staged_t *st = &g_stage[g_stage_count++];
+    g_stage_map[h] = g_stage_count;
+    st->view = view;
+    st->props = 0;
+    st->desc = *view_style(view);
+    return st;
+}
+
+/* Merges the pool's values into the staged styles of their views. */
+static void apply(pool_t *p, const float *value, bool staged) {
+    for (int k = 0; k < p->count; k++) {
+        anim_t *a = &p->anims[k];
+        if (staged) {
+            staged_t *st = stage(a->view);
+            st->props |= write_prop(&st->desc, a->prop, value + a->first);
+        } else {
+            lumi_style_desc_t d = *view_style(a->view);
+            view_style_commit(a->view, &d, write_prop(&d, a->prop, value + a->first));
+        }
+    }
+}
+
+/* Moves finished animations out of p into g_ended. */
+static bool collect(pool_t *p, int *cap) {
+    bool any = false;
+    for (int k = 0; k < p->count; k++) {
+        anim_t *a = &p->anims[k];
+        if (a->state != ANIM_ENDED) continue;
+        any = true;
+        a->view->anim_count--;
+        if (!a->cb) continue;
+        if (g_ended_count == *cap) {
+            int n = *cap ? *cap * 2 : 16;
+            anim_t *e = realloc(g_ended, (size_t)n * sizeof(anim_t));
+            if (!e) continue;               /* the callback is lost, not the animation */
+            g_ended = e;
+            *cap = n;
+        }
+        g_ended[g_ended_count++] = *a;
+    }
+    if (any) pool_compact(p);
+    return any;
+}
+
+int lumi_anim_step(uint64_t now_ms) {
+    static int ended_cap;
+    float dt = g_started && now_ms > g_last_ms ? (float)(now_ms - g_last_ms) / 1000.0f : 0.0f;
+    g_last_ms = now_ms;
+    g_started = true;
+
+    if (g_tweens.garbage) pool_compact(&g_tweens);
+    if (g_springs.garbage) pool_compact(&g_springs);
+    step_tweens(&g_tweens, dt);
+    step_springs(&g_springs, dt);
+
+    /* A view animated in both pools still gets a single commit */
+    bool staged = stage_reserve(g_tweens.count + g_springs.count);
+    apply(&g_tweens, g_tweens.lane[T_VALUE], staged);
+    apply(&g_springs, g_springs.lane[S_X], staged);
+    for (int i = 0; staged && i < g_stage_count; i++) {
+        view_style_commit(g_stage[i].view, &g_stage[i].desc, g_stage[i].props);
+    }
+
+    g_ended_count = 0;
+    collect(&g_tweens, &ended_cap);
+    collect(&g_springs, &ended_cap);
+
+    /* Callbacks may start, cancel or destroy anything */
+    for (int i = 0; i < g_ended_count; i++) {
+        if (g_ended[i].view) g_ended[i].cb(g_ended[i].view, g_ended[i].userdata);
+    }
+    g_ended_count = 0;
+    if (g_tweens.garbage) pool_compact(&g_tweens);
+    if (g_springs.garbage) pool_compact(&g_springs);
+    return g_tweens.count + g_springs.count;
+}
@@ -3,7 +3,8 @@
  * Copyright 2026 Lumi Team. Apache-2.0
  */
 
-#include "lumiapp.h"
+#include "mem.h"
+#include "trace.h"
 #include <stdlib.h>
 #include <string.h>
 #include <signal.h>
@@ -15,10 +16,23 @@ struct lumi_app {
     lumi_view_t     *root_view;
     bool             running;
     bool             paused;
+    mem_account_t    mem;       /* charged while this is the newest app */
+    lumi_allocator_t heap;      /* the process allocator this came from */
 };
 
 static lumi_app_t *g_current_app = NULL;
 
+static void app_callback(lumi_app_t *app, void (*cb)(lumi_app_t *, void *), const char *span) {
+    if (!cb) return;
+    trace_begin(span);
+    cb(app, app->userdata);
+    trace_end();
+}
+
+static void manifest_free(lumi_app_t *app, const char *s) {
+    if (s) mem_raw_free(&app->heap, (char *)s, strlen(s) + 1);
+}
+
 static void sigint_handler(int sig) {
     (void)sig;
     if (g_current_app) {
@@ -31,18 +45,22 @@ lumi_app_t *lumi_app_create(const lumi_manifest_t *manifest,
                              void *userdata) {
     if (!manifest || !lifecycle) return NULL;
 
-    lumi_app_t *app = calloc(1, sizeof(lumi_app_t));
+    lumi_allocator_t heap = mem_process_allocator();
+    lumi_app_t *app = mem_raw_alloc(&heap, sizeof(lumi_app_t));
     if (!app) return NULL;
+    memset(app, 0, sizeof(*app));
+    app->heap = heap;
 
-    app->manifest.app_id  = manifest->app_id  ? strdup(manifest->app_id)  : NULL;
-    app->manifest.name    = manifest->name    ? strdup(manifest->name)    : NULL;
-    app->manifest.version = manifest->version ? strdup(manifest->version) : NULL;
-    app->manifest.icon    = manifest->icon    ? strdup(manifest->icon)    : NULL;
+    app->manifest.app_id  = manifest->app_id  ? mem_raw_strdup(&heap, manifest->app_id)  : NULL;
+    app->manifest.name    = manifest->name    ? mem_raw_strdup(&heap, manifest->name)    : NULL;
+    app->manifest.version = manifest->version ? mem_raw_strdup(&heap, manifest->version) : NULL;
+    app->manifest.icon    = manifest->icon    ? mem_raw_strdup(&heap, manifest->icon)    : NULL;
     app->lifecycle = *lifecycle;
     app->userdata  = userdata;
     app->running   = false;
     app->paused    = false;
     app->root_view = NULL;
+    mem_app_attach(&app->mem);
 
     lumi_log(LUMI_LOG_INFO, "app", "Created app: %s (%s) v%s",
              app->manifest.name ? app->manifest.name : "?",
@@ -55,19 +73,23 @@ lumi_app_t *lumi_app_create(const lumi_manifest_t *manifest,
 void lumi_app_destroy(lumi_app_t *app) {
     if (!app) return;
 
-    if (app->lifecycle.on_destroy) {
-        app->lifecycle.on_destroy(app, app->userdata);
-    }
+    app_callback(app, app->lifecycle.on_destroy, "app.on_destroy");
 
     if (app->root_view) {
         lumi_view_destroy(app->root_view);
     }
-
-    free((void *)app->manifest.app_id);
-    free((void *)app->manifest.name);
-    free((void *)app->manifest.version);
-    free((void *)app->manifest.icon);
-    free(app);
+    lumi_image_shutdown();
+    lumi_notify_shutdown();
+    lumi_bus_disconnect();
+    lumi_log_flush();
+    mem_app_detach(&app->mem);
+
+    manifest_free(app, app->manifest.app_id);
+    manifest_free(app, app->manifest.name);
+    manifest_free(app, app->manifest.version);
+    manifest_free(app, app->manifest.icon);
+    lumi_allocator_t heap = app->heap;
+    mem_raw_free(&heap, app, sizeof(*app));
 
     if (g_current_app == app) {
         g_current_app = NULL;
@@ -81,32 +103,28 @@ int lumi_app_run(lumi_app_t *app) {
     signal(SIGINT, sigint_handler);
 
     app->running = true;
+    trace_begin("app.run");
 
-    if (app->lifecycle.on_create) {
-        app->lifecycle.on_create(app, app->userdata);
-    }
-    if (app->lifecycle.on_start) {
-        app->lifecycle.on_start(app, app->userdata);
-    }
-    if (app->lifecycle.on_resume) {
-        app->lifecycle.on_resume(app, app->userdata);
-    }
+    app_callback(app, app->lifecycle.on_create, "app.on_create");
+    app_callback(app, app->lifecycle.on_start, "app.on_start");
+    app_callback(app, app->lifecycle.on_resume, "app.on_resume");
 
     lumi_log(LUMI_LOG_INFO, "app", "Entering main loop");
 
     /* Main event loop (simplified — real impl ties into Wayland) */
     while (app->running) {
         /* TODO: integrate with Wayland/display event loop */
+        lumi_intent_poll();
+        lumi_bus_poll();
+        lumi_timer_poll();
+        lumi_image_poll();
         /* For now, just a stub that breaks immediately in headless mode */
         break;
     }
 
-    if (app->lifecycle.on_pause) {
-        app->lifecycle.on_pause(app, app->userdata);
-    }
-    if (app->lifecycle.on_stop) {
-        app->lifecycle.on_stop(app, app->userdata);
-    }
+    app_callback(app, app->lifecycle.on_pause, "app.on_pause");
+    app_callback(app, app->lifecycle.on_stop, "app.on_stop");
+    trace_end();
 
     lumi_log(LUMI_LOG_INFO, "app", "App stopped");
     return 0;
@@ -133,3 +151,26 @@ void lumi_app_set_content(lumi_app_t *app, lumi_view_t *root) {
     }
     app->root_view = root;
 }
+
+void lumi_app_update_content(lumi_app_t *app, lumi_view_t *root,
+                             lumi_mutation_cb cb, void *userdata) {
+    if (!app) return;
+    app->root_view = lumi_view_reconcile(app->root_view, root, cb, userdata);
+}
+
+lumi_result_t lumi_app_get_mem_usage(lumi_app_t *app, lumi_mem_usage_t *out) {
+    if (!app || !out) return LUMI_ERR_INVALID;
+    mem_account_usage(&app->mem, out);
+    return LUMI_OK;
+}
+
+lumi_result_t lumi_app_set_mem_budget(lumi_app_t *app, size_t bytes) {
+    if (!app) return LUMI_ERR_INVALID;
+    atomic_store_explicit(&app->mem.budget, bytes, memory_order_relaxed);
+    return LUMI_OK;
+}
+
+lumi_result_t lumi_app_set_allocator(lumi_app_t *app, const lumi_allocator_t *allocator) {
+    if (!app) return LUMI_ERR_INVALID;
+    return mem_app_set_allocator(&app->mem, allocator);
+}
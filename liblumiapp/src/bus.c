@@ -0,0 +1,363 @@
+/**
+ * bus.c — Client side of the local intent bus
+ * Copyright 2026 Lumi Team. Apache-2.0
+ *
+ * Connects the app to the lumi-intentd broker over an AF_UNIX
+ * SOCK_SEQPACKET socket (see bus_proto.h). Outgoing frames collect in one
+ * buffer and leave as full packets, or at the next lumi_bus_poll(), so a
+ * burst of sends costs a few syscalls. If the broker goes away the buffer
+ * is kept, polls retry with backoff, and a new connection replays the
+ * app id and every registered pattern before the pending intents.
+ *
+ * An intent too large for one packet does not go through the socket: its
+ * data is written once into a memfd, sealed against any further change,
+ * and the descriptor rides along with the frame. Receivers map it
+ * read-only and the broker only passes the descriptor on, so one payload
+ * fanned out to several apps shares the same pages. Anything that fits a
+ * packet is still copied, which bench_intent_shm shows to be cheaper than
+ * setting up a fresh memfd.
+ *
+ * Everything here runs on the UI thread, like intent registration.
+ */
+
+#define _GNU_SOURCE                     /* memfd_create, file seals */
+#include "intent_internal.h"
+#include "bus_proto.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <time.h>
+
+#define RETRY_MIN_MS    50
+#define RETRY_MAX_MS    2000
+#define MAX_BACKLOG     (4u << 20)      /* bytes kept while disconnected */
+#define MAX_RECV        64              /* packets per poll */
+#define MAX_PENDING_FDS 256             /* shared payloads kept while disconnected */
+
+static bool     g_enabled;
+static int      g_fd = -1;
+static char    *g_path, *g_app_id;
+static uint8_t *g_out;
+static size_t   g_out_len, g_out_cap;
+static bus_fds_t g_out_fds;
+static uint64_t g_retry_at;
+static uint32_t g_retry_ms;
+static bool     g_polling;
+static uint8_t  g_in[BUS_MAX_PACKET];
+
+static uint64_t now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000u + (uint64_t)ts.tv_nsec / 1000000u;
+}
+
+/* Appends a frame with room for body bytes; returns where the body goes. */
+static uint8_t *frame_alloc(uint8_t type, size_t body, lumi_result_t *rc) {
+    size_t size = 5 + body;
+    *rc = size > BUS_MAX_PACKET ? LUMI_ERR_INVALID :
+          g_out_len + size > MAX_BACKLOG ? LUMI_ERR_NOMEM : LUMI_OK;
+    if (*rc != LUMI_OK) return NULL;
+
+    if (g_out_len + size > g_out_cap) {
+        size_t cap = g_out_cap ? g_out_cap * 2 : BUS_MAX_PACKET;
+        while (cap < g_out_len + size) cap *= 2;
+        uint8_t *out = realloc(g_out, cap);
+        if (!out) {
+            *rc = LUMI_ERR_NOMEM;
+            return NULL;
+        }
+        g_out = out;
+        g_out_cap = cap;
+    }
+    uint8_t *p = put_u32(g_out + g_out_len, (uint32_t)size - 4);
+    *p++ = type;
+    g_out_len += size;
+    return p;
+}
+
+static lumi_result_t queue_frame(uint8_t type, const char *const *strs, int count) {
+    size_t body = 0;
+    for (int i = 0; i < count; i++) body += bus_str_size(strs[i]);
+    lumi_result_t rc;
+    uint8_t *p = frame_alloc(type, body, &rc);
+    for (int i = 0; p && i < count; i++) p = bus_put_str(p, strs[i]);
+    return rc;
+}
+
+/* Writes data and its NUL into a memfd sealed against every change. */
+static int shm_create(const char *data, size_t len) {
+    int fd = memfd_create("lumi-intent", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+    if (fd < 0) return -1;
+    size_t done = 0;
+    while (done < len + 1) {
+        ssize_t n = pwrite(fd, data + done, len + 1 - done, (off_t)done);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) {
+            close(fd);
+            return -1;
+        }
+        done += (size_t)n;
+    }
+    if (fcntl(fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_WRITE | F_SEAL_SEAL) != 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+/* Read-only view of a received payload, or NULL unless the sender sealed
+ * it so that it can no longer change underneath us. */
+static const char *shm_map(int fd, uint64_t len) {
+    int seals = fcntl(fd, F_GET_SEALS);
+    int need = F_SEAL_SHRINK | F_SEAL_WRITE;
+    struct stat st;
+    if (seals < 0 || (seals & need) != need || fstat(fd, &st) != 0) return NULL;
+    if (len >= SIZE_MAX || (uint64_t)st.st_size < len + 1) return NULL;
+
+    const char *p = mmap(NULL, (size_t)len + 1, PROT_READ, MAP_SHARED, fd, 0);
+    if (p == MAP_FAILED) return NULL;
+    if (p[len] != '\0') {
+        munmap((void *)p, (size_t)len + 1);
+        return NULL;
+    }
+    return p;
+}
+
+static lumi_result_t queue_intent(const lumi_intent_t *intent) {
+    const char *s[4] = { intent->action, intent->data, intent->mime_type, intent->target_app };
+    size_t body = bus_blob_size(intent->extras, intent->extras_len);
+    for (int i = 0; i < 4; i++) body += bus_str_size(s[i]);
+    lumi_result_t rc;
+    uint8_t *p = frame_alloc(BUS_INTENT, body, &rc);
+    if (!p) return rc;
+    for (int i = 0; i < 4; i++) p = bus_put_str(p, s[i]);
+    bus_put_blob(p, intent->extras, intent->extras_len);
+    return LUMI_OK;
+}
+
+static lumi_result_t queue_shm(const lumi_intent_t *intent, size_t len) {
+    if (g_out_fds.count >= MAX_PENDING_FDS) return LUMI_ERR_NOMEM;
+    const char *s[3] = { intent->action, intent->mime_type, intent->target_app };
+    size_t body = bus_blob_size(intent->extras, intent->extras_len) + 8;
+    for (int i = 0; i < 3; i++) body += bus_str_size(s[i]);
+
+    int fd = shm_create(intent->data, len);
+    if (fd < 0) return LUMI_ERR_IO;
+    if (!bus_fds_push(&g_out_fds, fd)) {
+        close(fd);
+        return LUMI_ERR_NOMEM;
+    }
+    lumi_result_t rc;
+    uint8_t *p = frame_alloc(BUS_INTENT_SHM, body, &rc);
+    if (!p) {
+        close(fd);
+        g_out_fds.count--;
+        return rc;
+    }
+    for (int i = 0; i < 3; i++) p = bus_put_str(p, s[i]);
+    p = bus_put_blob(p, intent->extras, intent->extras_len);
+    put_u64(p, len);
+    return LUMI_OK;
+}
+
+static void queue_subscribe(const char *pattern) {
+    queue_frame(BUS_SUBSCRIBE, &pattern, 1);
+}
+
+/* Puts HELLO and the current patterns ahead of the intents still waiting
+ * from the last connection; stale (un)subscribe frames are dropped. */
+static void replay_state(void) {
+    uint8_t *pending = g_out;
+    size_t pending_len = g_out_len;
+    g_out = NULL;
+    g_out_len = g_out_cap = 0;
+
+    const char *id = g_app_id;
+    queue_frame(BUS_HELLO, &id, 1);
+    intent_for_each_pattern(queue_subscribe);
+
+    /* Descriptors stay queued in order: only intent frames carry them */
+    const uint8_t *p = pending, *end = pending + pending_len, *body, *body_end;
+    uint8_t type;
+    lumi_result_t rc;
+    size_t shm = 0;
+    while (bus_next_frame(&p, end, &type, &body, &body_end)) {
+        if (type != BUS_INTENT && type != BUS_INTENT_SHM) continue;
+        uint8_t *copy = frame_alloc(type, (size_t)(body_end - body), &rc);
+        if (!copy) {
+            /* Out of room: drop this intent and everything after it */
+            for (size_t i = shm; i < g_out_fds.count; i++) close(g_out_fds.fds[g_out_fds.head + i]);
+            g_out_fds.count = shm;
+            break;
+        }
+        memcpy(copy, body, (size_t)(body_end - body));
+        shm += type == BUS_INTENT_SHM;
+    }
+    free(pending);
+}
+
+static bool try_connect(void) {
+    int fd = socket(AF_UNIX, SOCK_SEQPACKET, 0);
+    if (fd < 0) return false;
+    fcntl(fd, F_SETFD, FD_CLOEXEC);
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+
+    struct sockaddr_un addr = { .sun_family = AF_UNIX };
+    memcpy(addr.sun_path, g_path, strlen(g_path) + 1);
+    if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+        close(fd);
+        return false;
+    }
+    g_fd = fd;
+    g_retry_ms = 0;
+    replay_state();
+    lumi_log(LUMI_LOG_INFO, "bus", "Connected to %s", g_path);
+    return true;
+}
+
+static void drop_connection(void) {
+    lumi_log(LUMI_LOG_WARN, "bus", "Lost connection to %s", g_path);
+    close(g_fd);
+    g_fd = -1;
+    g_retry_at = 0;                     /* first retry is immediate */
+}
+
+static void maybe_reconnect(void) {
+    if (g_fd >= 0 || now_ms() < g_retry_at || try_connect()) return;
+    g_retry_ms = g_retry_ms ? g_retry_ms * 2 : RETRY_MIN_MS;
+    if (g_retry_ms > RETRY_MAX_MS) g_retry_ms = RETRY_MAX_MS;
+    g_retry_at = now_ms() + g_retry_ms;
+}
+
+static void flush(void) {
+    if (g_fd >= 0 && g_out_len && bus_send_frames(g_fd, g_out, &g_out_len, &g_out_fds) < 0) {
+        drop_connection();
+    }
+}
+
+lumi_result_t bus_forward(const lumi_intent_t *intent) {
+    if (!g_enabled) return LUMI_OK;
+    const char *s[4] = { intent->action, intent->data, intent->mime_type, intent->target_app };
+    size_t frame = 5 + bus_blob_size(intent->extras, intent->extras_len);
+    for (int i = 0; i < 4; i++) frame += bus_str_size(s[i]);
+    lumi_result_t rc = frame > BUS_MAX_PACKET && intent->data
+                     ? queue_shm(intent, strlen(intent->data))
+                     : queue_intent(intent);
+    if (rc != LUMI_OK) {
+        lumi_log(LUMI_LOG_WARN, "bus", "Dropped %s: %s", intent->action, lumi_result_str(rc));
+    }
+    if (g_out_len >= BUS_MAX_PACKET) flush();
+    return rc;
+}
+
+void bus_subscription(const char *pattern, bool subscribed) {
+    /* While disconnected the next connection replays every pattern */
+    if (g_fd >= 0) queue_frame(subscribed ? BUS_SUBSCRIBE : BUS_UNSUBSCRIBE, &pattern, 1);
+}
+
+static int deliver(const uint8_t *packet, size_t len, const int *fds, int nfds) {
+    const uint8_t *p = packet, *end = packet + len, *body, *body_end;
+    uint8_t type;
+    int n = 0, used = 0;
+    while (bus_next_frame(&p, end, &type, &body, &body_end)) {
+        if (type != BUS_INTENT && type != BUS_INTENT_SHM) continue;
+        int fd = type == BUS_INTENT_SHM && used < nfds ? fds[used++] : -1;
+
+        const char *s[4] = { NULL };
+        const void *extras;
+        size_t extras_len;
+        const uint8_t *q = body;
+        bool ok;
+        uint64_t size = 0;
+        if (type == BUS_INTENT) {
+            ok = bus_get_str(&q, body_end, &s[0]) && bus_get_str(&q, body_end, &s[1]) &&
+                 bus_get_str(&q, body_end, &s[2]) && bus_get_str(&q, body_end, &s[3]) &&
+                 bus_get_blob(&q, body_end, &extras, &extras_len);
+        } else {
+            ok = fd >= 0 && bus_get_str(&q, body_end, &s[0]) && bus_get_str(&q, body_end, &s[2]) &&
+                 bus_get_str(&q, body_end, &s[3]) &&
+                 bus_get_blob(&q, body_end, &extras, &extras_len) && body_end - q == 8;
+            if (ok) size = get_u64(q);
+            if (ok && !(s[1] = shm_map(fd, size))) ok = false;
+        }
+        if (ok && s[0]) {
+            lumi_intent_t intent = { .action = s[0], .data = s[1], .mime_type = s[2],
+                                     .target_app = s[3], .extras = extras,
+                                     .extras_len = extras_len };
+            intent_dispatch_local(&intent);
+            n++;
+        }
+        if (type == BUS_INTENT_SHM && s[1]) munmap((void *)s[1], (size_t)size + 1);
+        if (fd >= 0) close(fd);
+    }
+    while (used < nfds) close(fds[used++]);
+    return n;
+}
+
+lumi_result_t lumi_bus_connect(const char *socket_path, const char *app_id) {
+    char path[sizeof(((struct sockaddr_un *)0)->sun_path)];
+    if (socket_path) {
+        if (strlen(socket_path) >= sizeof(path)) return LUMI_ERR_INVALID;
+        memcpy(path, socket_path, strlen(socket_path) + 1);
+    } else {
+        bus_default_path(path, sizeof(path));
+    }
+
+    lumi_bus_disconnect();
+    g_path = strdup(path);
+    g_app_id = app_id ? strdup(app_id) : NULL;
+    if (!g_path || (app_id && !g_app_id)) {
+        lumi_bus_disconnect();
+        return LUMI_ERR_NOMEM;
+    }
+    g_enabled = true;
+    g_retry_ms = 0;
+    g_retry_at = 0;
+    maybe_reconnect();
+    return g_fd >= 0 ? LUMI_OK : LUMI_ERR_IO;
+}
+
+void lumi_bus_disconnect(void) {
+    if (g_fd >= 0) {
+        flush();
+        if (g_fd >= 0) close(g_fd);
+    }
+    g_fd = -1;
+    g_enabled = false;
+    g_out_len = 0;
+    bus_fds_close(&g_out_fds);
+    free(g_path);
+    free(g_app_id);
+    g_path = g_app_id = NULL;
+}
+
+bool lumi_bus_connected(void) {
+    return g_fd >= 0;
+}
+
+int lumi_bus_fd(void) {
+    return g_fd;
+}
+
+int lumi_bus_poll(void) {
+    if (!g_enabled || g_polling) return 0;
+    g_polling = true;
+    maybe_reconnect();
+    flush();
+
+    int n = 0;
+    for (int i = 0; i < MAX_RECV && g_fd >= 0; i++) {
+        int fds[BUS_MAX_FDS], nfds;
+        ssize_t len = bus_recv(g_fd, g_in, sizeof(g_in), fds, &nfds);
+        if (len < 0) break;
+        if (len == 0) {
+            drop_connection();
+            break;
+        }
+        n += deliver(g_in, (size_t)len, fds, nfds);
+    }
+    if (g_enabled) flush();             /* replies sent by the handlers */
+    g_polling = false;
+    return n;
+}
@@ -0,0 +1,234 @@
+/**
+ * bus_proto.h — Wire protocol of the local intent bus
+ * Copyright 2026 Lumi Team. Apache-2.0
+ *
+ * Not installed; shared by bus.c (the client) and daemon/intentd.c (the
+ * broker). Peers talk over an AF_UNIX SOCK_SEQPACKET socket. Each packet
+ * carries one or more frames, so a batch of intents costs one syscall:
+ *
+ *   frame  = u32 length (type + body) | u8 type | body
+ *   string = u32 length (BUS_ABSENT for NULL) | bytes | NUL
+ *   blob   = u32 length (BUS_ABSENT for NULL) | bytes
+ *
+ * HELLO carries the app id, SUBSCRIBE and UNSUBSCRIBE an action pattern,
+ * INTENT the action, data, mime type and target app strings followed by
+ * the encoded extras as a blob. Strings keep their NUL on the wire so a
+ * receiver can point into the packet.
+ *
+ * INTENT_SHM is an intent whose data lives in a sealed memfd instead:
+ * action, mime type, target app, extras, then u64 data length. The descriptors
+ * travel as SCM_RIGHTS on the same packet, one per INTENT_SHM frame in
+ * frame order.
+ */
+
+#ifndef LUMI_BUS_PROTO_H
+#define LUMI_BUS_PROTO_H
+
+#include "wire.h"
+#include <errno.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#define BUS_MAX_PACKET  65536
+#define BUS_MAX_FDS     16              /* descriptors per packet */
+#define BUS_ABSENT      UINT32_MAX
+
+enum {
+    BUS_HELLO = 1,
+    BUS_SUBSCRIBE,
+    BUS_UNSUBSCRIBE,
+    BUS_INTENT,
+    BUS_INTENT_SHM,
+};
+
+/* Descriptors waiting to go out, in the order of their frames */
+typedef struct {
+    int    *fds;
+    size_t  head, count, cap;
+} bus_fds_t;
+
+static inline bool bus_fds_push(bus_fds_t *q, int fd) {
+    if (q->head + q->count == q->cap) {
+        if (q->head) {
+            memmove(q->fds, q->fds + q->head, q->count * sizeof(int));
+            q->head = 0;
+        }
+        if (q->count == q->cap) {
+            size_t cap = q->cap ? q->cap * 2 : 16;
+            int *fds = realloc(q->fds, cap * sizeof(int));
+            if (!fds) return false;
+            q->fds = fds;
+            q->cap = cap;
+        }
+    }
+    q->fds[q->head + q->count++] = fd;
+    return true;
+}
+
+static inline void bus_fds_close(bus_fds_t *q) {
+    for (size_t i = 0; i < q->count; i++) close(q->fds[q->head + i]);
+    q->head = q->count = 0;
+}
+
+/* $LUMI_BUS_SOCKET, else lumi-intent.sock in $XDG_RUNTIME_DIR or /tmp */
+static inline void bus_default_path(char *buf, size_t size) {
+    const char *env = getenv("LUMI_BUS_SOCKET");
+    if (env && *env) {
+        snprintf(buf, size, "%s", env);
+        return;
+    }
+    const char *dir = getenv("XDG_RUNTIME_DIR");
+    if (dir && *dir) {
+        snprintf(buf, size, "%s/lumi-intent.sock", dir);
+    } else {
+        snprintf(buf, size, "/tmp/lumi-intent-%u.sock", (unsigned)getuid());
+    }
+}
+
+static inline size_t bus_str_size(const char *s) {
+    return 4 + (s ? strlen(s) + 1 : 0);
+}
+
+static inline uint8_t *bus_put_str(uint8_t *p, const char *s) {
+    if (!s) return put_u32(p, BUS_ABSENT);
+    size_t n = strlen(s);
+    p = put_u32(p, (uint32_t)n);
+    memcpy(p, s, n + 1);
+    return p + n + 1;
+}
+
+/* Reads a string at *p, bounded by end; false if malformed. */
+static inline bool bus_get_str(const uint8_t **p, const uint8_t *end, const char **out) {
+    if (end - *p < 4) return false;
+    uint32_t n = get_u32(*p);
+    *p += 4;
+    if (n == BUS_ABSENT) {
+        *out = NULL;
+        return true;
+    }
+    if ((size_t)(end - *p) <= n || (*p)[n] != '\0') return false;
+    *out = (const char *)*p;
+    *p += n + 1;
+    return true;
+}
+
+static inline size_t bus_blob_size(const void *data, size_t len) {
+    return 4 + (data ? len : 0);
+}
+
+static inline uint8_t *bus_put_blob(uint8_t *p, const void *data, size_t len) {
+    if (!data) return put_u32(p, BUS_ABSENT);
+    p = put_u32(p, (uint32_t)len);
+    if (len) memcpy(p, data, len);
+    return p + len;
+}
+
+/* Reads a blob at *p, bounded by end; false if malformed. */
+static inline bool bus_get_blob(const uint8_t **p, const uint8_t *end,
+                                const void **data, size_t *len) {
+    if (end - *p < 4) return false;
+    uint32_t n = get_u32(*p);
+    *p += 4;
+    *data = NULL;
+    *len = 0;
+    if (n == BUS_ABSENT) return true;
+    if ((size_t)(end - *p) < n) return false;
+    *data = *p;
+    *len = n;
+    *p += n;
+    return true;
+}
+
+/* Splits the next frame off a packet; false at the end or if malformed. */
+static inline bool bus_next_frame(const uint8_t **p, const uint8_t *end, uint8_t *type,
+                                  const uint8_t **body, const uint8_t **body_end) {
+    if (end - *p < 5) return false;
+    uint32_t n = get_u32(*p);
+    if (n < 1 || (size_t)(end - *p - 4) < n) return false;
+    *type = (*p)[4];
+    *body = *p + 5;
+    *body_end = *p + 4 + n;
+    *p = *body_end;
+    return true;
+}
+
+/* Sends buf as packets of whole frames, each at most BUS_MAX_PACKET with
+ * at most BUS_MAX_FDS descriptors from q, and drops (and closes) what went
+ * out. Returns 1 when everything was sent, 0 when the socket is full and
+ * -1 when the connection is gone. */
+static inline int bus_send_frames(int fd, uint8_t *buf, size_t *len, bus_fds_t *q) {
+    size_t sent = 0;
+    int rc = 1;
+    while (sent < *len) {
+        size_t packet = 0;
+        int nfds = 0;
+        while (sent + packet < *len) {
+            size_t frame = 4 + get_u32(buf + sent + packet);
+            int shm = buf[sent + packet + 4] == BUS_INTENT_SHM;
+            if (packet && (packet + frame > BUS_MAX_PACKET || nfds + shm > BUS_MAX_FDS)) break;
+            packet += frame;
+            nfds += shm;
+        }
+
+        struct iovec iov = { .iov_base = buf + sent, .iov_len = packet };
+        union {
+            struct cmsghdr align;
+            char buf[CMSG_SPACE(BUS_MAX_FDS * sizeof(int))];
+        } control;
+        struct msghdr msg = { .msg_iov = &iov, .msg_iovlen = 1 };
+        if (nfds) {
+            if ((size_t)nfds > q->count) return -1;
+            msg.msg_control = control.buf;
+            msg.msg_controllen = CMSG_SPACE(nfds * sizeof(int));
+            struct cmsghdr *cm = CMSG_FIRSTHDR(&msg);
+            cm->cmsg_level = SOL_SOCKET;
+            cm->cmsg_type = SCM_RIGHTS;
+            cm->cmsg_len = CMSG_LEN(nfds * sizeof(int));
+            memcpy(CMSG_DATA(cm), q->fds + q->head, nfds * sizeof(int));
+        }
+        if (sendmsg(fd, &msg, MSG_NOSIGNAL | MSG_DONTWAIT) < 0) {
+            rc = errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR ? 0 : -1;
+            break;
+        }
+        for (int i = 0; i < nfds; i++) close(q->fds[q->head + i]);
+        q->head += nfds;
+        q->count -= nfds;
+        sent += packet;
+    }
+    memmove(buf, buf + sent, *len - sent);
+    *len -= sent;
+    return rc;
+}
+
+/* Receives one packet and the descriptors that came with it (close-on-exec).
+ * Returns the packet length, 0 when the peer is gone, -1 if nothing is
+ * waiting. */
+static inline ssize_t bus_recv(int fd, uint8_t *buf, size_t size, int *fds, int *nfds) {
+    struct iovec iov = { .iov_base = buf, .iov_len = size };
+    union {
+        struct cmsghdr align;
+        char buf[CMSG_SPACE(BUS_MAX_FDS * sizeof(int))];
+    } control;
+    struct msghdr msg = { .msg_iov = &iov, .msg_iovlen = 1,
+                          .msg_control = control.buf, .msg_controllen = sizeof(control.buf) };
+    *nfds = 0;
+    ssize_t n = recvmsg(fd, &msg, MSG_DONTWAIT | MSG_CMSG_CLOEXEC);
+    if (n < 0) return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR ? -1 : 0;
+
+    for (struct cmsghdr *cm = CMSG_FIRSTHDR(&msg); cm; cm = CMSG_NXTHDR(&msg, cm)) {
+        if (cm->cmsg_level != SOL_SOCKET || cm->cmsg_type != SCM_RIGHTS) continue;
+        int count = (int)((cm->cmsg_len - CMSG_LEN(0)) / sizeof(int));
+        for (int i = 0; i < count; i++) {
+            int got;
+            memcpy(&got, CMSG_DATA(cm) + i * sizeof(int), sizeof(int));
+            if (*nfds < BUS_MAX_FDS) fds[(*nfds)++] = got; else close(got);
+        }
+    }
+    return n;
+}
+
+#endif /* LUMI_BUS_PROTO_H */
@@ -0,0 +1,410 @@
+/**
+ * extras.c — Typed intent extras
+ * Copyright 2026 Lumi Team. Apache-2.0
+ *
+ * A builder keeps its entries sorted by key, with keys and values in one
+ * arena, and encodes them into a flat map whose entries sit behind an
+ * offset index. A reader never decodes the map: opening it checks the
+ * header, a lookup is a binary search over the index, and only the value
+ * asked for is bounds checked and read. Strings, bytes and nested maps
+ * are returned as pointers into the encoded data.
+ */
+
+#include "lumiapp.h"
+#include "wire.h"
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * Layout (all integers little-endian, floats as IEEE-754 bit patterns):
+ *   map   = u32 size | u32 count | count x u32 entry_offset | entries
+ *   entry = u32 key_len | key | NUL | u8 type | value
+ *   value = i64 (INT) | f64 (FLOAT) | u32 len | bytes (BYTES)
+ *         | u32 len | bytes | NUL (STRING) | map (MAP)
+ * Offsets count from the start of their own map, so a nested map is
+ * readable on its own. The index is in strcmp order of the keys.
+ */
+
+#define MAP_HEADER 8
+
+typedef struct {
+    size_t   key;                       /* arena offset, NUL-terminated */
+    uint32_t key_len;
+    uint8_t  type;
+    union {
+        int64_t i;
+        double  f;
+        size_t  bytes;                  /* arena offset of BYTES, STRING, MAP */
+    };
+    uint32_t len;                       /* of the bytes, a string's NUL excluded */
+} extra_t;
+
+struct lumi_extras {
+    extra_t *items;                     /* sorted by key */
+    uint32_t count, cap;
+    char    *arena;
+    size_t   arena_len, arena_cap;
+    uint8_t *encoded;
+    size_t   encoded_len, encoded_cap;
+    bool     dirty;
+};
+
+/* ── Building ──────────────────────────────────────────────────── */
+
+lumi_extras_t *lumi_extras_create(void) {
+    lumi_extras_t *ex = calloc(1, sizeof(*ex));
+    if (ex) ex->dirty = true;
+    return ex;
+}
+
+void lumi_extras_destroy(lumi_extras_t *ex) {
+    if (!ex) return;
+    free(ex->items);
+    free(ex->arena);
+    free(ex->encoded);
+    free(ex);
+}
+
+void lumi_extras_clear(lumi_extras_t *ex) {
+    if (!ex) return;
+    ex->count = 0;
+    ex->arena_len = 0;
+    ex->dirty = true;
+}
+
+/* Appends n bytes (and a NUL if nul) to the arena; returns their offset
+ * or SIZE_MAX if out of memory. */
+static size_t arena_add(lumi_extras_t *ex, const void *data, size_t n, bool nul) {
+    size_t need = ex->arena_len + n + nul;
+    if (need > ex->arena_cap) {
+        size_t cap = ex->arena_cap ? ex->arena_cap * 2 : 256;
+        while (cap < need) cap *= 2;
+        char *arena = realloc(ex->arena, cap);
+        if (!arena) return SIZE_MAX;
+        ex->arena = arena;
+        ex->arena_cap = cap;
+    }
+    size_t off = ex->arena_len;
+    if (n) memcpy(ex->arena + off, data, n);
+    if (nul) ex->arena[off + n] = '\0';
+    ex->arena_len = need;
+    return off;
+}
+
+/* The entry for key, inserted in key order if new. A replaced value's
+ * bytes stay in the arena until lumi_extras_clear(). */
+static extra_t *put(lumi_extras_t *ex, const char *key, uint8_t type) {
+    uint32_t lo = 0, hi = ex->count;
+    while (lo < hi) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        int c = strcmp(key, ex->arena + ex->items[mid].key);
+        if (c == 0) {
+            ex->items[mid].type = type;
+            ex->dirty = true;
+            return &ex->items[mid];
+        }
+        if (c < 0) hi = mid; else lo = mid + 1;
+    }
+
+    size_t key_len = strlen(key);
+    if (key_len >= UINT32_MAX) return NULL;
+    if (ex->count == ex->cap) {
+        uint32_t cap = ex->cap ? ex->cap * 2 : 8;
+        extra_t *items = realloc(ex->items, cap * sizeof(*items));
+        if (!items) return NULL;
+        ex->items = items;
+        ex->cap = cap;
+    }
+    size_t off = arena_add(ex, key, key_len, true);
+    if (off == SIZE_MAX) return NULL;
+    memmove(&ex->items[lo + 1], &ex->items[lo], (ex->count - lo) * sizeof(*ex->items));
+    ex->items[lo] = (extra_t){ .key = off, .key_len = (uint32_t)key_len, .type = type };
+    ex->count++;
+    ex->dirty = true;
+    return &ex->items[lo];
+}
+
+lumi_result_t lumi_extras_put_int(lumi_extras_t *ex, const char *key, int64_t value) {
+    if (!ex || !key) return LUMI_ERR_INVALID;
+    extra_t *e = put(ex, key, LUMI_EXTRA_INT);
+    if (!e) return LUMI_ERR_NOMEM;
+    e->i = value;
+    return LUMI_OK;
+}
+
+lumi_result_t lumi_extras_put_float(lumi_extras_t *ex, const char *key, double value) {
+    if (!ex || !key) return LUMI_ERR_INVALID;
+    extra_t *e = put(ex, key, LUMI_EXTRA_FLOAT);
+    if (!e) return LUMI_ERR_NOMEM;
+    e->f = value;
+    return LUMI_OK;
+}
+
+static lumi_result_t put_blob(lumi_extras_t *ex, const char *key, uint8_t type,
+                              const void *data, size_t len) {
+    /* Before put(), which may move a previous value's entry */
+    size_t off = arena_add(ex, data, len, type == LUMI_EXTRA_STRING);
+    if (off == SIZE_MAX) return LUMI_ERR_NOMEM;
+    extra_t *e = put(ex, key, type);
+    if (!e) return LUMI_ERR_NOMEM;
+    e->bytes = off;
+    e->len = (uint32_t)len;
+    return LUMI_OK;
+}
+
+lumi_result_t lumi_extras_put_bytes(lumi_extras_t *ex, const char *key,
+                                    const void *data, size_t len) {
+    if (!ex || !key || (len && !data) || len >= UINT32_MAX) return LUMI_ERR_INVALID;
+    return put_blob(ex, key, LUMI_EXTRA_BYTES, data, len);
+}
+
+lumi_result_t lumi_extras_put_string(lumi_extras_t *ex, const char *key, const char *value) {
+    if (!ex || !key || !value) return LUMI_ERR_INVALID;
+    size_t len = strlen(value);
+    if (len >= UINT32_MAX) return LUMI_ERR_INVALID;
+    return put_blob(ex, key, LUMI_EXTRA_STRING, value, len);
+}
+
+lumi_result_t lumi_extras_put_map(lumi_extras_t *ex, const char *key, lumi_extras_t *map) {
+    if (!ex || !key || !map || map == ex) return LUMI_ERR_INVALID;
+    const void *data;
+    size_t len;
+    lumi_result_t rc = lumi_extras_encode(map, &data, &len);
+    if (rc != LUMI_OK) return rc;
+    return put_blob(ex, key, LUMI_EXTRA_MAP, data, len);
+}
+
+static size_t value_size(const extra_t *e) {
+    switch (e->type) {
+        case LUMI_EXTRA_INT:
+        case LUMI_EXTRA_FLOAT:  return 8;
+        case LUMI_EXTRA_BYTES:  return 4 + (size_t)e->len;
+        case LUMI_EXTRA_STRING: return 4 + (size_t)e->len + 1;
+        default:                return e->len;      /* MAP */
+    }
+}
+
+lumi_result_t lumi_extras_encode(lumi_extras_t *ex, const void **data, size_t *len) {
+    if (!ex || !data || !len) return LUMI_ERR_INVALID;
+    if (!ex->dirty) {
+        *data = ex->encoded;
+        *len = ex->encoded_len;
+        return LUMI_OK;
+    }
+
+    size_t size = MAP_HEADER + (size_t)ex->count * 4;
+    for (uint32_t i = 0; i < ex->count; i++) {
+        size += 4 + ex->items[i].key_len + 1 + 1 + value_size(&ex->items[i]);
+    }
+    if (size > UINT32_MAX) return LUMI_ERR_INVALID;
+    if (size > ex->encoded_cap) {
+        uint8_t *out = realloc(ex->encoded, size);
+        if (!out) return LUMI_ERR_NOMEM;
+        ex->encoded = out;
+        ex->encoded_cap = size;
+    }
+
+    uint8_t *out = ex->encoded;
+    uint8_t *index = put_u32(put_u32(out, (uint32_t)size), ex->count);
+    uint8_t *p = index + (size_t)ex->count * 4;
+    for (uint32_t i = 0; i < ex->count; i++) {
+        const extra_t *e = &ex->items[i];
+        index = put_u32(index, (uint32_t)(p - out));
+        p = put_u32(p, e->key_len);
+        memcpy(p, ex->arena + e->key, e->key_len + 1);
+        p += e->key_len + 1;
+        *p++ = e->type;
+        switch (e->type) {
+            case LUMI_EXTRA_INT:   p = put_u64(p, (uint64_t)e->i); break;
+            case LUMI_EXTRA_FLOAT: {
+                uint64_t bits;
+                memcpy(&bits, &e->f, sizeof(bits));
+                p = put_u64(p, bits);
+                break;
+            }
+            case LUMI_EXTRA_BYTES:
+            case LUMI_EXTRA_STRING:
+                p = put_u32(p, e->len);
+                memcpy(p, ex->arena + e->bytes, value_size(e) - 4);
+                p += value_size(e) - 4;
+                break;
+            default:
+                memcpy(p, ex->arena + e->bytes, e->len);
+                p += e->len;
+                break;
+        }
+    }
+
+    ex->encoded_len = size;
+    ex->dirty = false;
+    *data = out;
+    *len = size;
+    return LUMI_OK;
+}
+
+/* ── Reading ───────────────────────────────────────────────────── */
+
+lumi_result_t lumi_extras_open(lumi_extras_view_t *out, const void *data, size_t len) {
+    if (!out) return LUMI_ERR_INVALID;
+    *out = (lumi_extras_view_t){ 0 };
+    if (!data && len == 0) return LUMI_OK;  /* no extras: an empty map */
+    if (!data || len < MAP_HEADER) return LUMI_ERR_INVALID;
+
+    const uint8_t *p = data;
+    uint32_t size = get_u32(p), count = get_u32(p + 4);
+    if (size < MAP_HEADER || size > len || count > (size - MAP_HEADER) / 4) {
+        return LUMI_ERR_INVALID;
+    }
+    *out = (lumi_extras_view_t){ .data = p, .size = size, .count = count };
+    return LUMI_OK;
+}
+
+/* Key of entry i and where its value starts; NULL if the entry is malformed. */
+static const char *entry_at(const lumi_extras_view_t *v, uint32_t i, const uint8_t **value) {
+    uint32_t off = get_u32(v->data + MAP_HEADER + (size_t)i * 4);
+    if (off > v->size || v->size - off < 4) return NULL;
+    uint32_t key_len = get_u32(v->data + off);
+    /* key, NUL and the type byte */
+    if ((size_t)v->size - off - 4 < (size_t)key_len + 2) return NULL;
+    const char *key = (const char *)v->data + off + 4;
+    if (key[key_len] != '\0') return NULL;
+    *value = v->data + off + 4 + key_len + 1;
+    return key;
+}
+
+typedef struct {
+    int64_t        i;
+    double         f;
+    const uint8_t *ptr;
+    uint32_t       len;
+} value_t;
+
+/* Type of the value at p, filled into val, or NONE if it does not fit in
+ * its map. */
+static lumi_extra_type_t read_value(const lumi_extras_view_t *v, const uint8_t *p, value_t *val) {
+    const uint8_t *end = v->data + v->size;
+    uint8_t type = *p++;
+    size_t room = (size_t)(end - p);
+    switch (type) {
+        case LUMI_EXTRA_INT:
+        case LUMI_EXTRA_FLOAT: {
+            if (room < 8) return LUMI_EXTRA_NONE;
+            uint64_t bits = get_u64(p);
+            val->i = (int64_t)bits;
+            memcpy(&val->f, &bits, sizeof(val->f));
+            return type;
+        }
+        case LUMI_EXTRA_BYTES:
+        case LUMI_EXTRA_STRING: {
+            if (room < 4) return LUMI_EXTRA_NONE;
+            uint32_t len = get_u32(p);
+            size_t need = 4 + (size_t)len + (type == LUMI_EXTRA_STRING);
+            if (room < need || (type == LUMI_EXTRA_STRING && p[4 + len] != '\0')) {
+                return LUMI_EXTRA_NONE;
+            }
+            val->ptr = p + 4;
+            val->len = len;
+            return type;
+        }
+        case LUMI_EXTRA_MAP:
+            if (room < MAP_HEADER || get_u32(p) > room) return LUMI_EXTRA_NONE;
+            val->ptr = p;
+            val->len = get_u32(p);
+            return type;
+        default:
+            return LUMI_EXTRA_NONE;
+    }
+}
+
+static lumi_extra_type_t lookup(const lumi_extras_view_t *v, const char *key, value_t *val) {
+    if (!v || !key) return LUMI_EXTRA_NONE;
+    uint32_t lo = 0, hi = v->count;
+    while (lo < hi) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        const uint8_t *value;
+        const char *k = entry_at(v, mid, &value);
+        if (!k) return LUMI_EXTRA_NONE;
+        int c = strcmp(key, k);
+        if (c == 0) return read_value(v, value, val);
+        if (c < 0) hi = mid; else lo = mid + 1;
+    }
+    return LUMI_EXTRA_NONE;
+}
+
+lumi_extra_type_t lumi_extras_type(const lumi_extras_view_t *v, const char *key) {
+    value_t val;
+    return lookup(v, key, &val);
+}
+
+lumi_extra_type_t lumi_extras_at(const lumi_extras_view_t *v, uint32_t index, const char **key) {
+    if (!v || index >= v->count) return LUMI_EXTRA_NONE;
+    const uint8_t *value;
+    const char *k = entry_at(v, index, &value);
+    value_t val;
+    lumi_extra_type_t type = k ? read_value(v, value, &val) : LUMI_EXTRA_NONE;
+    if (key) *key = type != LUMI_EXTRA_NONE ? k : NULL;
+    return type;
+}
+
+/* NOT_FOUND if key is absent or malformed, INVALID if it has another type */
+static lumi_result_t get(const lumi_extras_view_t *v, const char *key,
+                         lumi_extra_type_t want, value_t *val) {
+    if (!v || !key) return LUMI_ERR_INVALID;
+    lumi_extra_type_t type = lookup(v, key, val);
+    if (type == LUMI_EXTRA_NONE) return LUMI_ERR_NOT_FOUND;
+    return type == want ? LUMI_OK : LUMI_ERR_INVALID;
+}
+
+lumi_result_t lumi_extras_get_int(const lumi_extras_view_t *v, const char *key, int64_t *out) {
+    value_t val;
+    lumi_result_t rc = get(v, key, LUMI_EXTRA_INT, &val);
+    if (rc == LUMI_OK && out) *out = val.i;
+    return rc;
+}
+
+lumi_result_t lumi_extras_get_float(const lumi_extras_view_t *v, const char *key, double *out) {
+    value_t val;
+    lumi_result_t rc = get(v, key, LUMI_EXTRA_FLOAT, &val);
+    if (rc == LUMI_OK && out) *out = val.f;
+    return rc;
+}
+
+lumi_result_t lumi_extras_get_bytes(const lumi_extras_view_t *v, const char *key,
+                                    const void **data, size_t *len) {
+    value_t val;
+    lumi_result_t rc = get(v, key, LUMI_EXTRA_BYTES, &val);
+    if (rc != LUMI_OK) return rc;
+    if (data) *data = val.ptr;
+    if (len) *len = val.len;
+    return LUMI_OK;
+}
+
+lumi_result_t lumi_extras_get_string(const lumi_extras_view_t *v, const char *key,
+                                     const char **out) {
+    value_t val;
+    lumi_result_t rc = get(v, key, LUMI_EXTRA_STRING, &val);
+    if (rc == LUMI_OK && out) *out = (const char *)val.ptr;
+    return rc;
+}
+
+lumi_result_t lumi_extras_get_map(const lumi_extras_view_t *v, const char *key,
+                                  lumi_extras_view_t *out) {
+    value_t val;
+    lumi_result_t rc = get(v, key, LUMI_EXTRA_MAP, &val);
+    if (rc != LUMI_OK) return rc;
+    return lumi_extras_open(out, val.ptr, val.len);
+}
+
+lumi_result_t lumi_extras_validate(const lumi_extras_view_t *v, const lumi_extra_field_t *schema,
+                                   size_t count) {
+    if (!v || (count && !schema)) return LUMI_ERR_INVALID;
+    for (size_t i = 0; i < count; i++) {
+        lumi_extra_type_t type = lumi_extras_type(v, schema[i].key);
+        if (type == LUMI_EXTRA_NONE) {
+            if (schema[i].required) return LUMI_ERR_NOT_FOUND;
+        } else if (type != schema[i].type) {
+            return LUMI_ERR_INVALID;
+        }
+    }
+    return LUMI_OK;
+}
@@ -3,13 +3,15 @@
  * Copyright 2026 Lumi Team. Apache-2.0
  */
 
-#include "lumiapp.h"
+#include "mem.h"
+#include "metrics.h"
+#include "trace.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <sys/stat.h>
 
-lumi_result_t lumi_file_read(const char *path, char **out_data, size_t *out_len) {
+static lumi_result_t file_read(const char *path, char **out_data, size_t *out_len) {
     if (!path || !out_data || !out_len) return LUMI_ERR_INVALID;
 
     FILE *f = fopen(path, "rb");
@@ -24,8 +26,14 @@ lumi_result_t lumi_file_read(const char *path, char **out_data, size_t *out_len)
         return LUMI_ERR_IO;
     }
 
+    /* The caller frees it, so it comes from malloc() whatever the allocator */
+    if (!mem_charge(LUMI_MEM_FILES, (size_t)size + 1)) {
+        fclose(f);
+        return LUMI_ERR_NOMEM;
+    }
     char *buf = malloc((size_t)size + 1);
     if (!buf) {
+        mem_uncharge(LUMI_MEM_FILES, (size_t)size + 1);
         fclose(f);
         return LUMI_ERR_NOMEM;
     }
@@ -34,12 +42,14 @@ lumi_result_t lumi_file_read(const char *path, char **out_data, size_t *out_len)
     fclose(f);
 
     buf[read] = '\0';
+    mem_uncharge(LUMI_MEM_FILES, (size_t)size + 1);
+    metric_add(METRIC_FILE_READ_BYTES, read);
     *out_data = buf;
     *out_len  = read;
     return LUMI_OK;
 }
 
-lumi_result_t lumi_file_write(const char *path, const char *data, size_t len) {
+static lumi_result_t file_write(const char *path, const char *data, size_t len) {
     if (!path || !data) return LUMI_ERR_INVALID;
 
     FILE *f = fopen(path, "wb");
@@ -47,10 +57,25 @@ lumi_result_t lumi_file_write(const char *path, const char *data, size_t len) {
 
     size_t written = fwrite(data, 1, len, f);
     fclose(f);
+    metric_add(METRIC_FILE_WRITTEN_BYTES, written);
 
     return (written == len) ? LUMI_OK : LUMI_ERR_IO;
 }
 
+lumi_result_t lumi_file_read(const char *path, char **out_data, size_t *out_len) {
+    trace_begin("file.read");
+    lumi_result_t rc = file_read(path, out_data, out_len);
+    trace_end();
+    return rc;
+}
+
+lumi_result_t lumi_file_write(const char *path, const char *data, size_t len) {
+    trace_begin("file.write");
+    lumi_result_t rc = file_write(path, data, len);
+    trace_end();
+    return rc;
+}
+
 bool lumi_file_exists(const char *path) {
     if (!path) return false;
     struct stat st;
@@ -0,0 +1,145 @@
+/**
+ * hittest.c — Pointer hit testing and click dispatch
+ * Copyright 2026 Lumi Team. Apache-2.0
+ *
+ * Every container keeps an index of its children sorted by start on its
+ * main axis (x for rows, y for columns and scroll views) with a running
+ * maximum of child ends. A query binary-searches the last child starting
+ * at or before the point and walks back only while earlier children can
+ * still reach it, so a lookup is O(log n) per level for the usual
+ * non-overlapping layouts. The index is rebuilt per container, on first
+ * query after layout moved one of its children. Stacks overlap by design
+ * and are scanned top-down in z-order instead.
+ */
+
+#include "view_internal.h"
+#include <stdlib.h>
+
+typedef enum { AXIS_NONE, AXIS_X, AXIS_Y } hit_axis_t;
+
+static hit_axis_t main_axis(const lumi_view_t *v) {
+    switch (v->type) {
+        case LUMI_VIEW_ROW:
+            return AXIS_X;
+        case LUMI_VIEW_COLUMN:
+        case LUMI_VIEW_SCROLL:
+        case LUMI_VIEW_LIST:
+        case LUMI_VIEW_CARD:
+            return AXIS_Y;
+        default:
+            return AXIS_NONE;
+    }
+}
+
+static bool contains(const lumi_view_t *v, float x, float y) {
+    return x >= v->frame_x && x < v->frame_x + v->frame_w &&
+           y >= v->frame_y && y < v->frame_y + v->frame_h;
+}
+
+static bool rebuild_index(lumi_view_t *v, hit_axis_t axis) {
+    if (v->child_count > v->hit_cap || !v->hit_index) {
+        int cap = v->child_count ? v->child_count : 1;
+        view_hit_entry_t *idx = mem_realloc(LUMI_MEM_VIEWS, v->hit_index,
+                                            (size_t)v->hit_cap * sizeof(view_hit_entry_t),
+                                            (size_t)cap * sizeof(view_hit_entry_t));
+        if (!idx) return false;
+        v->hit_index = idx;
+        v->hit_cap = cap;
+    }
+
+    int n = 0;
+    for (int i = 0; i < v->child_count; i++) {
+        const lumi_view_t *c = v->children[i];
+        if (!c->visible || c->frame_w <= 0.0f || c->frame_h <= 0.0f) continue;
+
+        float start = axis == AXIS_X ? c->frame_x : c->frame_y;
+        /* Insertion sort: layout output is already ordered, so this is linear */
+        int j = n;
+        while (j > 0 && v->hit_index[j - 1].start > start) {
+            v->hit_index[j] = v->hit_index[j - 1];
+            j--;
+        }
+        v->hit_index[j].start = start;
+        v->hit_index[j].child = i;
+        n++;
+    }
+
+    float max_end = 0.0f;
+    for (int k = 0; k < n; k++) {
+        const lumi_view_t *c = v->children[v->hit_index[k].child];
+        float end = axis == AXIS_X ? c->frame_x + c->frame_w : c->frame_y + c->frame_h;
+        if (k == 0 || end > max_end) max_end = end;
+        v->hit_index[k].max_end = max_end;
+    }
+
+    v->hit_count = n;
+    v->hit_dirty = false;
+    return true;
+}
+
+/* Topmost child of v containing (x, y), in v's child coordinates. */
+static lumi_view_t *child_at(lumi_view_t *v, float x, float y) {
+    hit_axis_t axis = main_axis(v);
+
+    if (axis != AXIS_NONE && (!v->hit_dirty || rebuild_index(v, axis)) && v->hit_index) {
+        float p = axis == AXIS_X ? x : y;
+        int lo = 0, hi = v->hit_count;      /* first entry with start > p */
+        while (lo < hi) {
+            int mid = (lo + hi) / 2;
+            if (v->hit_index[mid].start <= p) lo = mid + 1;
+            else hi = mid;
+        }
+
+        int best = -1;
+        for (int k = lo - 1; k >= 0 && v->hit_index[k].max_end > p; k--) {
+            int ci = v->hit_index[k].child;
+            if (ci > best && contains(v->children[ci], x, y)) best = ci;
+        }
+        return best >= 0 ? v->children[best] : NULL;
+    }
+
+    for (int i = v->child_count - 1; i >= 0; i--) {
+        lumi_view_t *c = v->children[i];
+        if (c->visible && contains(c, x, y)) return c;
+    }
+    return NULL;
+}
+
+lumi_view_t *lumi_view_hit_test(lumi_view_t *root, float x, float y) {
+    if (!root || !root->visible || !contains(root, x, y)) return NULL;
+
+    lumi_view_t *hit = root;
+    x -= root->frame_x;
+    y -= root->frame_y;
+    for (;;) {
+        if (hit->type == LUMI_VIEW_SCROLL) {
+            x += hit->scroll_x;
+            y += hit->scroll_y;
+        }
+        lumi_view_t *c = child_at(hit, x, y);
+        if (!c) return hit;
+        x -= c->frame_x;
+        y -= c->frame_y;
+        hit = c;
+    }
+}
+
+bool lumi_view_dispatch_click(lumi_view_t *root, float x, float y) {
+    for (lumi_view_t *v = lumi_view_hit_test(root, x, y); v; v = v == root ? NULL : v->parent) {
+        if (v->on_click_cb) {
+            v->on_click_cb(v, v->on_click_data);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool lumi_view_dispatch_long_click(lumi_view_t *root, float x, float y) {
+    for (lumi_view_t *v = lumi_view_hit_test(root, x, y); v; v = v == root ? NULL : v->parent) {
+        if (v->on_long_click_cb) {
+            v->on_long_click_cb(v, v->on_long_click_data);
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,418 @@
+/**
+ * image.c — Asynchronous image loading and the shared bitmap cache
+ * Copyright 2026 Lumi Team. Apache-2.0
+ *
+ * Sources are read and decoded on a small worker pool, downsampled to
+ * the size they will be shown at, and kept in one byte-bounded LRU cache
+ * keyed by (source, width, height). Requests for an entry that is still
+ * decoding join it instead of starting another decode. Workers only hand
+ * results back; entries become visible, and callbacks run, in
+ * lumi_image_poll() on the UI thread.
+ */
+
+#include "image_internal.h"
+#include "view_internal.h"
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define MAX_WORKERS    4
+#define BUCKETS        1024
+#define DEFAULT_LIMIT  (64u * 1024 * 1024)
+
+typedef struct image_waiter {
+    lumi_image_cb cb;
+    void *userdata;
+    struct image_waiter *next;
+} image_waiter_t;
+
+typedef struct image_entry {
+    char *source;
+    int width, height;              /* requested size, 0 = natural */
+    uint32_t hash;
+    bool ready;                     /* false while queued or decoding */
+    bool busy;                      /* callbacks running; not evictable */
+
+    /* Written by the worker, read after the entry is on the done list */
+    lumi_bitmap_t *bitmap;
+    lumi_result_t result;
+
+    size_t bytes;
+    image_waiter_t *waiters;
+    struct image_entry *chain;      /* hash bucket */
+    struct image_entry *prev, *next;    /* LRU of ready entries, newest first */
+    struct image_entry *queue_next;     /* job or done queue */
+} image_entry_t;
+
+typedef struct {
+    image_entry_t *head, *tail;
+} entry_queue_t;
+
+/* Everything below is guarded by g_lock. */
+static pthread_mutex_t g_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t  g_work = PTHREAD_COND_INITIALIZER;
+static pthread_t g_workers[MAX_WORKERS];
+static int  g_nworkers;
+static bool g_stopping;
+
+static entry_queue_t g_jobs, g_done;
+static image_entry_t *g_buckets[BUCKETS];
+static image_entry_t *g_lru_head, *g_lru_tail;
+static size_t g_limit = DEFAULT_LIMIT;
+static size_t g_bytes, g_entries, g_pending, g_decodes, g_hits;
+
+/* ── Bitmaps ───────────────────────────────────────────────────── */
+
+int lumi_bitmap_width(const lumi_bitmap_t *bmp)  { return bmp ? bmp->width : 0; }
+int lumi_bitmap_height(const lumi_bitmap_t *bmp) { return bmp ? bmp->height : 0; }
+
+const uint8_t *lumi_bitmap_pixels(const lumi_bitmap_t *bmp) {
+    return bmp ? bmp->pixels : NULL;
+}
+
+lumi_bitmap_t *lumi_bitmap_retain(lumi_bitmap_t *bmp) {
+    if (bmp) atomic_fetch_add_explicit(&bmp->refs, 1, memory_order_relaxed);
+    return bmp;
+}
+
+void lumi_bitmap_release(lumi_bitmap_t *bmp) {
+    if (bmp && atomic_fetch_sub_explicit(&bmp->refs, 1, memory_order_acq_rel) == 1) free(bmp);
+}
+
+lumi_result_t lumi_image_decode(const uint8_t *data, size_t len, int max_w, int max_h,
+                                lumi_bitmap_t **out) {
+    if (!data || !out) return LUMI_ERR_INVALID;
+
+    lumi_bitmap_t *full = NULL;
+    lumi_result_t rc = len >= 8 && data[0] == 0x89 ? image_decode_png(data, len, &full)
+                                                   : image_decode_pnm(data, len, &full);
+    if (rc != LUMI_OK) return rc;
+
+    *out = bitmap_downsample(full, max_w, max_h);
+    lumi_bitmap_release(full);
+    return *out ? LUMI_OK : LUMI_ERR_NOMEM;
+}
+
+/* ── Cache ─────────────────────────────────────────────────────── */
+
+static uint32_t hash_key(const char *s, int w, int h) {
+    uint32_t hash = 2166136261u;   /* FNV-1a */
+    while (*s) {
+        hash ^= (uint8_t)*s++;
+        hash *= 16777619u;
+    }
+    hash ^= (uint32_t)w * 0x9E3779B1u;
+    hash ^= (uint32_t)h * 0x85EBCA77u;
+    return hash;
+}
+
+static image_entry_t *cache_find(const char *source, int w, int h, uint32_t hash) {
+    for (image_entry_t *e = g_buckets[hash % BUCKETS]; e; e = e->chain) {
+        if (e->hash == hash && e->width == w && e->height == h && strcmp(e->source, source) == 0) {
+            return e;
+        }
+    }
+    return NULL;
+}
+
+static void lru_unlink(image_entry_t *e) {
+    if (e->prev) e->prev->next = e->next; else g_lru_head = e->next;
+    if (e->next) e->next->prev = e->prev; else g_lru_tail = e->prev;
+    e->prev = e->next = NULL;
+}
+
+static void lru_push_front(image_entry_t *e) {
+    e->next = g_lru_head;
+    if (g_lru_head) g_lru_head->prev = e;
+    g_lru_head = e;
+    if (!g_lru_tail) g_lru_tail = e;
+}
+
+static void entry_unhash(image_entry_t *e) {
+    image_entry_t **pp = &g_buckets[e->hash % BUCKETS];
+    while (*pp && *pp != e) pp = &(*pp)->chain;
+    if (*pp) *pp = e->chain;
+}
+
+static void entry_free(image_entry_t *e) {
+    image_waiter_t *w = e->waiters;
+    while (w) {
+        image_waiter_t *next = w->next;
+        free(w);
+        w = next;
+    }
+    lumi_bitmap_release(e->bitmap);
+    free(e->source);
+    free(e);
+}
+
+static void evict(image_entry_t *e) {
+    lru_unlink(e);
+    entry_unhash(e);
+    g_bytes -= e->bytes;
+    g_entries--;
+    entry_free(e);
+}
+
+/* Evicts least recently used entries until under the limit. */
+static void evict_to_limit(void) {
+    image_entry_t *e = g_lru_tail;
+    while (g_bytes > g_limit && e) {
+        image_entry_t *prev = e->prev;
+        if (!e->busy) evict(e);
+        e = prev;
+    }
+}
+
+static void queue_push(entry_queue_t *q, image_entry_t *e) {
+    e->queue_next = NULL;
+    if (q->tail) q->tail->queue_next = e; else q->head = e;
+    q->tail = e;
+}
+
+/* ── Workers ───────────────────────────────────────────────────── */
+
+static lumi_result_t load(const image_entry_t *e, lumi_bitmap_t **out) {
+    char *data = NULL;
+    size_t len = 0;
+    lumi_result_t rc = lumi_file_read(e->source, &data, &len);
+    if (rc != LUMI_OK) return rc;
+    rc = lumi_image_decode((const uint8_t *)data, len, e->width, e->height, out);
+    free(data);
+    return rc;
+}
+
+static void *worker_main(void *arg) {
+    (void)arg;
+    pthread_mutex_lock(&g_lock);
+    for (;;) {
+        while (!g_jobs.head && !g_stopping) pthread_cond_wait(&g_work, &g_lock);
+        if (g_stopping) break;
+
+        image_entry_t *e = g_jobs.head;
+        g_jobs.head = e->queue_next;
+        if (!g_jobs.head) g_jobs.tail = NULL;
+        pthread_mutex_unlock(&g_lock);
+
+        lumi_bitmap_t *bmp = NULL;
+        lumi_result_t rc = load(e, &bmp);
+
+        pthread_mutex_lock(&g_lock);
+        e->bitmap = bmp;
+        e->result = rc;
+        g_decodes++;
+        queue_push(&g_done, e);
+    }
+    pthread_mutex_unlock(&g_lock);
+    return NULL;
+}
+
+static bool start_workers(void) {
+    if (g_nworkers) return true;
+
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    int n = cpus > 2 ? (int)cpus - 1 : 1;
+    if (n > MAX_WORKERS) n = MAX_WORKERS;
+
+    g_stopping = false;
+    for (int i = 0; i < n; i++) {
+        if (pthread_create(&g_workers[g_nworkers], NULL, worker_main, NULL) != 0) break;
+        g_nworkers++;
+    }
+    return g_nworkers > 0;
+}
+
+/* ── Public API ────────────────────────────────────────────────── */
+
+lumi_result_t lumi_image_request(const char *source, int width, int height,
+                                 lumi_image_cb cb, void *userdata) {
+    if (!source) return LUMI_ERR_INVALID;
+    if (width < 0) width = 0;
+    if (height < 0) height = 0;
+
+    uint32_t hash = hash_key(source, width, height);
+    image_waiter_t *w = NULL;
+    if (cb) {
+        if (!(w = malloc(sizeof(image_waiter_t)))) return LUMI_ERR_NOMEM;
+        w->cb = cb;
+        w->userdata = userdata;
+    }
+
+    pthread_mutex_lock(&g_lock);
+    image_entry_t *e = cache_find(source, width, height, hash);
+    if (e && e->ready) {
+        g_hits++;
+        lru_unlink(e);
+        lru_push_front(e);
+        lumi_bitmap_t *bmp = lumi_bitmap_retain(e->bitmap);
+        pthread_mutex_unlock(&g_lock);
+        free(w);
+        if (cb) cb(source, bmp, LUMI_OK, userdata);
+        lumi_bitmap_release(bmp);
+        return LUMI_OK;
+    }
+    if (e) {
+        /* Already decoding: wait on that decode */
+        if (w) {
+            w->next = e->waiters;
+            e->waiters = w;
+        }
+        pthread_mutex_unlock(&g_lock);
+        return LUMI_OK;
+    }
+
+    if (!start_workers()) {
+        pthread_mutex_unlock(&g_lock);
+        free(w);
+        return LUMI_ERR_UNKNOWN;
+    }
+    if (!(e = calloc(1, sizeof(image_entry_t))) || !(e->source = strdup(source))) {
+        pthread_mutex_unlock(&g_lock);
+        free(e);
+        free(w);
+        return LUMI_ERR_NOMEM;
+    }
+    e->width = width;
+    e->height = height;
+    e->hash = hash;
+    if (w) {
+        w->next = NULL;
+        e->waiters = w;
+    }
+    e->chain = g_buckets[hash % BUCKETS];
+    g_buckets[hash % BUCKETS] = e;
+    g_pending++;
+    queue_push(&g_jobs, e);
+    pthread_cond_signal(&g_work);
+    pthread_mutex_unlock(&g_lock);
+    return LUMI_OK;
+}
+
+lumi_bitmap_t *lumi_image_lookup(const char *source, int width, int height) {
+    if (!source) return NULL;
+    if (width < 0) width = 0;
+    if (height < 0) height = 0;
+
+    pthread_mutex_lock(&g_lock);
+    image_entry_t *e = cache_find(source, width, height, hash_key(source, width, height));
+    lumi_bitmap_t *bmp = NULL;
+    if (e && e->ready) {
+        g_hits++;
+        lru_unlink(e);
+        lru_push_front(e);
+        bmp = lumi_bitmap_retain(e->bitmap);
+    }
+    pthread_mutex_unlock(&g_lock);
+    return bmp;
+}
+
+int lumi_image_poll(void) {
+    pthread_mutex_lock(&g_lock);
+    image_entry_t *e = g_done.head;
+    g_done.head = g_done.tail = NULL;
+    pthread_mutex_unlock(&g_lock);
+
+    int completed = 0;
+    while (e) {
+        image_entry_t *next = e->queue_next;
+
+        pthread_mutex_lock(&g_lock);
+        image_waiter_t *w = e->waiters;
+        e->waiters = NULL;
+        g_pending--;
+        bool ok = e->result == LUMI_OK;
+        if (ok) {
+            e->ready = true;
+            e->busy = true;
+            e->bytes = (size_t)e->bitmap->width * (size_t)e->bitmap->height * 4;
+            g_bytes += e->bytes;
+            g_entries++;
+            lru_push_front(e);
+            evict_to_limit();
+        } else {
+            entry_unhash(e);
+        }
+        pthread_mutex_unlock(&g_lock);
+
+        while (w) {
+            image_waiter_t *wn = w->next;
+            w->cb(e->source, e->bitmap, e->result, w->userdata);
+            free(w);
+            w = wn;
+        }
+
+        if (ok) {
+            pthread_mutex_lock(&g_lock);
+            e->busy = false;
+            pthread_mutex_unlock(&g_lock);
+        } else {
+            entry_free(e);
+        }
+        completed++;
+        e = next;
+    }
+    return completed;
+}
+
+void lumi_image_cache_set_limit(size_t bytes) {
+    pthread_mutex_lock(&g_lock);
+    g_limit = bytes;
+    evict_to_limit();
+    pthread_mutex_unlock(&g_lock);
+}
+
+void lumi_image_get_stats(lumi_image_stats_t *out) {
+    if (!out) return;
+    pthread_mutex_lock(&g_lock);
+    out->bytes   = g_bytes;
+    out->limit   = g_limit;
+    out->entries = g_entries;
+    out->pending = g_pending;
+    out->decodes = g_decodes;
+    out->hits    = g_hits;
+    pthread_mutex_unlock(&g_lock);
+}
+
+void lumi_image_shutdown(void) {
+    pthread_mutex_lock(&g_lock);
+    g_stopping = true;
+    pthread_cond_broadcast(&g_work);
+    pthread_mutex_unlock(&g_lock);
+    for (int i = 0; i < g_nworkers; i++) pthread_join(g_workers[i], NULL);
+
+    pthread_mutex_lock(&g_lock);
+    g_nworkers = 0;
+    g_stopping = false;
+    for (image_entry_t *e = g_jobs.head, *next; e; e = next) {
+        next = e->queue_next;
+        entry_unhash(e);
+        entry_free(e);
+    }
+    for (image_entry_t *e = g_done.head, *next; e; e = next) {
+        next = e->queue_next;
+        entry_unhash(e);
+        entry_free(e);
+    }
+    g_jobs.head = g_jobs.tail = g_done.head = g_done.tail = NULL;
+    while (g_lru_tail) evict(g_lru_tail);
+    g_pending = g_decodes = g_hits = 0;
+    pthread_mutex_unlock(&g_lock);
+}
+
+/* ── Views ─────────────────────────────────────────────────────── */
+
+static void load_subtree(lumi_view_t *v) {
+    if (!v->visible) return;
+    if (v->type == LUMI_VIEW_IMAGE && v->text && v->text[0]) {
+        const lumi_style_desc_t *st = view_style(v);
+        int w = (int)(v->frame_w - st->padding[1] - st->padding[3] + 0.5f);
+        int h = (int)(v->frame_h - st->padding[0] - st->padding[2] + 0.5f);
+        if (w > 0 && h > 0) lumi_image_request(v->text, w, h, NULL, NULL);
+    }
+    for (int i = 0; i < v->child_count; i++) load_subtree(v->children[i]);
+}
+
+void lumi_view_load_images(lumi_view_t *root) {
+    if (root) load_subtree(root);
+}
@@ -0,0 +1,534 @@
+/**
+ * image_decode.c — PNG and PNM decoders, downsampling
+ * Copyright 2026 Lumi Team. Apache-2.0
+ *
+ * Self-contained so the SDK needs no zlib/libpng. PNG: all colour types
+ * and bit depths, non-interlaced; chunk CRCs and the zlib checksum are
+ * not verified. PNM: P2/P3/P5/P6 with any maxval. Everything decodes to
+ * RGBA8888.
+ */
+
+#include "image_internal.h"
+#include <stdlib.h>
+#include <string.h>
+
+lumi_bitmap_t *bitmap_alloc(int width, int height) {
+    if (width <= 0 || height <= 0 || !image_size_ok((uint32_t)width, (uint32_t)height)) {
+        return NULL;
+    }
+    lumi_bitmap_t *bmp = malloc(sizeof(lumi_bitmap_t) + (size_t)width * (size_t)height * 4);
+    if (!bmp) return NULL;
+    atomic_init(&bmp->refs, 1);
+    bmp->width = width;
+    bmp->height = height;
+    return bmp;
+}
+
+/* ── Inflate (RFC 1951) ────────────────────────────────────────── */
+
+#define INFLATE_MAX_RATIO 1032      /* 258-byte matches from 2-bit codes */
+
+typedef struct {
+    const uint8_t *in;
+    size_t in_len, in_pos;
+    uint32_t bitbuf;
+    int bitcnt;
+    uint8_t *out;
+    size_t out_len, out_pos;
+    bool err;
+} inflate_t;
+
+typedef struct {
+    short count[16];        /* codes per length */
+    short symbol[288];      /* symbols ordered by code */
+} huffman_t;
+
+static const short LEN_BASE[29] = {
+    3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+    35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+static const short LEN_EXTRA[29] = {
+    0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+    3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+static const short DIST_BASE[30] = {
+    1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+    257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+static const short DIST_EXTRA[30] = {
+    0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+    7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+
+static uint32_t getbits(inflate_t *s, int need) {
+    uint32_t val = s->bitbuf;
+    while (s->bitcnt < need) {
+        if (s->in_pos >= s->in_len) {
+            s->err = true;
+            return 0;
+        }
+        val |= (uint32_t)s->in[s->in_pos++] << s->bitcnt;
+        s->bitcnt += 8;
+    }
+    s->bitbuf = need < 32 ? val >> need : 0;
+    s->bitcnt -= need;
+    return need < 32 ? val & ((1u << need) - 1) : val;
+}
+
+static int decode_sym(inflate_t *s, const huffman_t *h) {
+    int code = 0, first = 0, index = 0;
+    for (int len = 1; len < 16; len++) {
+        code |= (int)getbits(s, 1);
+        int count = h->count[len];
+        if (code - count < first) return h->symbol[index + (code - first)];
+        index += count;
+        first += count;
+        first <<= 1;
+        code <<= 1;
+        if (s->err) return -1;
+    }
+    return -1;
+}
+
+/* Builds canonical code tables; false if the lengths are over-subscribed. */
+static bool build_huffman(huffman_t *h, const short *lengths, int n) {
+    short offs[16];
+    memset(h->count, 0, sizeof(h->count));
+    for (int i = 0; i < n; i++) h->count[lengths[i]]++;
+    if (h->count[0] == n) return true;
+
+    int left = 1;
+    for (int len = 1; len < 16; len++) {
+        left <<= 1;
+        left -= h->count[len];
+        if (left < 0) return false;
+    }
+    offs[1] = 0;
+    for (int len = 1; len < 15; len++) offs[len + 1] = (short)(offs[len] + h->count[len]);
+    for (int i = 0; i < n; i++) {
+        if (lengths[i]) h->symbol[offs[lengths[i]]++] = (short)i;
+    }
+    return true;
+}
+
+static bool inflate_stored(inflate_t *s) {
+    s->bitbuf = 0;
+    s->bitcnt = 0;
+    if (s->in_pos + 4 > s->in_len) return false;
+    unsigned len  = s->in[s->in_pos] | (unsigned)s->in[s->in_pos + 1] << 8;
+    unsigned nlen = s->in[s->in_pos + 2] | (unsigned)s->in[s->in_pos + 3] << 8;
+    s->in_pos += 4;
+    if (len != (~nlen & 0xFFFFu)) return false;
+    if (s->in_pos + len > s->in_len || s->out_pos + len > s->out_len) return false;
+    memcpy(s->out + s->out_pos, s->in + s->in_pos, len);
+    s->in_pos += len;
+    s->out_pos += len;
+    return true;
+}
+
+static bool inflate_codes(inflate_t *s, const huffman_t *lencode, const huffman_t *distcode) {
+    for (;;) {
+        int sym = decode_sym(s, lencode);
+        if (sym < 0 || s->err) return false;
+        if (sym < 256) {
+            if (s->out_pos >= s->out_len) return false;
+            s->out[s->out_pos++] = (uint8_t)sym;
+            continue;
+        }
+        if (sym == 256) return true;
+
+        sym -= 257;
+        if (sym >= 29) return false;
+        size_t len = (size_t)LEN_BASE[sym] + getbits(s, LEN_EXTRA[sym]);
+        int dsym = decode_sym(s, distcode);
+        if (dsym < 0 || dsym >= 30) return false;
+        size_t dist = (size_t)DIST_BASE[dsym] + getbits(s, DIST_EXTRA[dsym]);
+        if (s->err || dist > s->out_pos || s->out_pos + len > s->out_len) return false;
+        for (size_t i = 0; i < len; i++, s->out_pos++) {
+            s->out[s->out_pos] = s->out[s->out_pos - dist];
+        }
+    }
+}
+
+static bool inflate_fixed(inflate_t *s) {
+    /* Cheap enough to build per block, and keeps decoding thread-safe */
+    huffman_t lencode, distcode;
+    short lengths[288];
+    int i = 0;
+    for (; i < 144; i++) lengths[i] = 8;
+    for (; i < 256; i++) lengths[i] = 9;
+    for (; i < 280; i++) lengths[i] = 7;
+    for (; i < 288; i++) lengths[i] = 8;
+    build_huffman(&lencode, lengths, 288);
+    for (i = 0; i < 30; i++) lengths[i] = 5;
+    build_huffman(&distcode, lengths, 30);
+    return inflate_codes(s, &lencode, &distcode);
+}
+
+static bool inflate_dynamic(inflate_t *s) {
+    static const uint8_t ORDER[19] = { 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+    short lengths[320];
+    huffman_t lencode, distcode;
+
+    int nlen  = (int)getbits(s, 5) + 257;
+    int ndist = (int)getbits(s, 5) + 1;
+    int ncode = (int)getbits(s, 4) + 4;
+    if (s->err || nlen > 286 || ndist > 30) return false;
+
+    int i = 0;
+    for (; i < ncode; i++) lengths[ORDER[i]] = (short)getbits(s, 3);
+    for (; i < 19; i++) lengths[ORDER[i]] = 0;
+    if (s->err || !build_huffman(&lencode, lengths, 19)) return false;
+
+    for (i = 0; i < nlen + ndist;) {
+        int sym = decode_sym(s, &lencode);
+        if (sym < 0 || s->err) return false;
+        if (sym < 16) {
+            lengths[i++] = (short)sym;
+            continue;
+        }
+        short fill = 0;
+        int rep;
+        if (sym == 16) {
+            if (i == 0) return false;
+            fill = lengths[i - 1];
+            rep = 3 + (int)getbits(s, 2);
+        } else if (sym == 17) {
+            rep = 3 + (int)getbits(s, 3);
+        } else {
+            rep = 11 + (int)getbits(s, 7);
+        }
+        if (s->err || i + rep > nlen + ndist) return false;
+        while (rep--) lengths[i++] = fill;
+    }
+    if (lengths[256] == 0) return false;
+
+    if (!build_huffman(&lencode, lengths, nlen)) return false;
+    if (!build_huffman(&distcode, lengths + nlen, ndist)) return false;
+    return inflate_codes(s, &lencode, &distcode);
+}
+
+/* Inflates a zlib stream into exactly out_len bytes. */
+static bool zlib_inflate(const uint8_t *in, size_t in_len, uint8_t *out, size_t out_len) {
+    if (in_len < 2 || (in[0] & 0x0F) != 8 || ((in[0] << 8) | in[1]) % 31 != 0 || (in[1] & 0x20)) {
+        return false;
+    }
+    inflate_t s = { .in = in, .in_len = in_len, .in_pos = 2, .out = out, .out_len = out_len };
+
+    bool last;
+    do {
+        last = getbits(&s, 1);
+        uint32_t type = getbits(&s, 2);
+        bool ok;
+        switch (type) {
+            case 0:  ok = inflate_stored(&s); break;
+            case 1:  ok = inflate_fixed(&s); break;
+            case 2:  ok = inflate_dynamic(&s); break;
+            default: ok = false; break;
+        }
+        if (!ok || s.err) return false;
+    } while (!last);
+    return s.out_pos == out_len;
+}
+
+/* ── PNG ───────────────────────────────────────────────────────── */
+
+static uint32_t be32(const uint8_t *p) {
+    return (uint32_t)p[0] << 24 | (uint32_t)p[1] << 16 | (uint32_t)p[2] << 8 | p[3];
+}
+
+static uint8_t paeth(uint8_t a, uint8_t b, uint8_t c) {
+    int p = (int)a + b - c;
+    int pa = abs(p - a), pb = abs(p - b), pc = abs(p - c);
+    if (pa <= pb && pa <= pc) return a;
+    return pb <= pc ? b : c;
+}
+
+static bool unfilter(uint8_t *data, uint32_t height, size_t rowbytes, size_t bpp) {
+    uint8_t *prev = NULL;
+    for (uint32_t y = 0; y < height; y++) {
+        uint8_t *row = data + y * (rowbytes + 1);
+        uint8_t type = row[0];
+        uint8_t *cur = row + 1;
+        for (size_t i = 0; i < rowbytes; i++) {
+            uint8_t a = i >= bpp ? cur[i - bpp] : 0;
+            uint8_t b = prev ? prev[i] : 0;
+            uint8_t c = prev && i >= bpp ? prev[i - bpp] : 0;
+            switch (type) {
+                case 0: break;
+                case 1: cur[i] += a; break;
+                case 2: cur[i] += b; break;
+                case 3: cur[i] += (uint8_t)(((unsigned)a + b) / 2); break;
+                case 4: cur[i] += paeth(a, b, c); break;
+                default: return false;
+            }
+        }
+        prev = cur;
+    }
+    return true;
+}
+
+/* Sample n of a row at the given bit depth, unscaled. */
+static unsigned sample_at(const uint8_t *row, size_t n, int depth) {
+    switch (depth) {
+        case 16: return (unsigned)row[n * 2] << 8 | row[n * 2 + 1];
+        case 8:  return row[n];
+        default: {
+            size_t bit = n * (size_t)depth;
+            return (row[bit / 8] >> (8 - depth - (int)(bit % 8))) & ((1u << depth) - 1);
+        }
+    }
+}
+
+static uint8_t scale8(unsigned v, int depth) {
+    switch (depth) {
+        case 1:  return v ? 255 : 0;
+        case 2:  return (uint8_t)(v * 85);
+        case 4:  return (uint8_t)(v * 17);
+        case 16: return (uint8_t)(v >> 8);
+        default: return (uint8_t)v;
+    }
+}
+
+lumi_result_t image_decode_png(const uint8_t *data, size_t len, lumi_bitmap_t **out) {
+    static const uint8_t SIG[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+    if (len < 8 || memcmp(data, SIG, 8) != 0) return LUMI_ERR_INVALID;
+
+    uint32_t width = 0, height = 0;
+    int depth = 0, ctype = -1;
+    uint8_t palette[256][4];
+    int npalette = 0;
+    bool has_key = false;
+    unsigned key[3] = { 0, 0, 0 };
+    uint8_t *idat = NULL;
+    size_t idat_len = 0, idat_cap = 0;
+    lumi_result_t rc = LUMI_ERR_INVALID;
+
+    for (size_t pos = 8; pos + 12 <= len;) {
+        uint32_t clen = be32(data + pos);
+        const uint8_t *type = data + pos + 4;
+        const uint8_t *body = data + pos + 8;
+        if (clen > len - pos - 12) goto done;
+        pos += 12 + (size_t)clen;
+
+        if (memcmp(type, "IHDR", 4) == 0) {
+            if (clen < 13) goto done;
+            width = be32(body);
+            height = be32(body + 4);
+            depth = body[8];
+            ctype = body[9];
+            if (body[10] != 0 || body[11] != 0 || body[12] != 0) goto done;  /* interlaced */
+            for (int i = 0; i < 256; i++) {
+                palette[i][0] = palette[i][1] = palette[i][2] = 0;
+                palette[i][3] = 255;
+            }
+        } else if (memcmp(type, "PLTE", 4) == 0) {
+            npalette = (int)(clen / 3 > 256 ? 256 : clen / 3);
+            for (int i = 0; i < npalette; i++) memcpy(palette[i], body + i * 3, 3);
+        } else if (memcmp(type, "tRNS", 4) == 0) {
+            if (ctype == 3) {
+                for (uint32_t i = 0; i < clen && i < 256; i++) palette[i][3] = body[i];
+            } else if (ctype == 0 && clen >= 2) {
+                key[0] = (unsigned)body[0] << 8 | body[1];
+                has_key = true;
+            } else if (ctype == 2 && clen >= 6) {
+                for (int c = 0; c < 3; c++) key[c] = (unsigned)body[c * 2] << 8 | body[c * 2 + 1];
+                has_key = true;
+            }
+        } else if (memcmp(type, "IDAT", 4) == 0) {
+            if (idat_len + clen > idat_cap) {
+                size_t cap = idat_cap ? idat_cap : 4096;
+                while (cap < idat_len + clen) cap *= 2;
+                uint8_t *grown = realloc(idat, cap);
+                if (!grown) { rc = LUMI_ERR_NOMEM; goto done; }
+                idat = grown;
+                idat_cap = cap;
+            }
+            memcpy(idat + idat_len, body, clen);
+            idat_len += clen;
+        } else if (memcmp(type, "IEND", 4) == 0) {
+            break;
+        }
+    }
+
+    int channels;
+    switch (ctype) {
+        case 0: channels = 1; break;
+        case 2: channels = 3; break;
+        case 3: channels = 1; break;
+        case 4: channels = 2; break;
+        case 6: channels = 4; break;
+        default: goto done;
+    }
+    bool depth_ok = depth == 8 || depth == 16 ||
+                    ((ctype == 0 || ctype == 3) && (depth == 1 || depth == 2 || depth == 4));
+    if (!depth_ok || (ctype == 3 && depth == 16) || !idat || !image_size_ok(width, height)) {
+        goto done;
+    }
+
+    /* Deflate expands at most INFLATE_MAX_RATIO-fold, so IDAT that short
+     * cannot hold the image: refuse it before allocating for it */
+    size_t rowbytes = ((size_t)width * (size_t)channels * (size_t)depth + 7) / 8;
+    size_t bpp = (size_t)channels * (size_t)depth / 8;
+    if (bpp == 0) bpp = 1;
+    if ((rowbytes + 1) * height / INFLATE_MAX_RATIO > idat_len) goto done;
+
+    lumi_bitmap_t *bmp = bitmap_alloc((int)width, (int)height);
+    if (!bmp) { rc = LUMI_ERR_NOMEM; goto done; }
+    uint8_t *raw = malloc((rowbytes + 1) * height);
+    if (!raw) { lumi_bitmap_release(bmp); rc = LUMI_ERR_NOMEM; goto done; }
+    if (!zlib_inflate(idat, idat_len, raw, (rowbytes + 1) * height) ||
+        !unfilter(raw, height, rowbytes, bpp)) {
+        free(raw);
+        lumi_bitmap_release(bmp);
+        goto done;
+    }
+
+    for (uint32_t y = 0; y < height; y++) {
+        const uint8_t *row = raw + y * (rowbytes + 1) + 1;
+        uint8_t *px = bmp->pixels + (size_t)y * width * 4;
+        for (uint32_t x = 0; x < width; x++, px += 4) {
+            size_t n = (size_t)x * (size_t)channels;
+            switch (ctype) {
+                case 0: {
+                    unsigned g = sample_at(row, n, depth);
+                    px[0] = px[1] = px[2] = scale8(g, depth);
+                    px[3] = has_key && g == key[0] ? 0 : 255;
+                    break;
+                }
+                case 2: {
+                    unsigned r = sample_at(row, n, depth), g = sample_at(row, n + 1, depth),
+                             b = sample_at(row, n + 2, depth);
+                    px[0] = scale8(r, depth);
+                    px[1] = scale8(g, depth);
+                    px[2] = scale8(b, depth);
+                    px[3] = has_key && r == key[0] && g == key[1] && b == key[2] ? 0 : 255;
+                    break;
+                }
+                case 3:
+                    memcpy(px, palette[sample_at(row, n, depth)], 4);
+                    break;
+                case 4:
+                    px[0] = px[1] = px[2] = scale8(sample_at(row, n, depth), depth);
+                    px[3] = scale8(sample_at(row, n + 1, depth), depth);
+                    break;
+                default:
+                    for (int c = 0; c < 4; c++) px[c] = scale8(sample_at(row, n + (size_t)c, depth), depth);
+                    break;
+            }
+        }
+    }
+    free(raw);
+    *out = bmp;
+    rc = LUMI_OK;
+
+done:
+    free(idat);
+    return rc;
+}
+
+/* ── PNM ───────────────────────────────────────────────────────── */
+
+/* Reads the next ASCII integer, skipping whitespace and # comments. */
+static bool pnm_int(const uint8_t *d, size_t len, size_t *pos, unsigned *out) {
+    size_t p = *pos;
+    for (;;) {
+        while (p < len && (d[p] == ' ' || d[p] == '\t' || d[p] == '\r' || d[p] == '\n')) p++;
+        if (p < len && d[p] == '#') {
+            while (p < len && d[p] != '\n') p++;
+            continue;
+        }
+        break;
+    }
+    if (p >= len || d[p] < '0' || d[p] > '9') return false;
+    unsigned v = 0;
+    while (p < len && d[p] >= '0' && d[p] <= '9') {
+        if (v > 100000000u) return false;
+        v = v * 10 + (unsigned)(d[p++] - '0');
+    }
+    *pos = p;
+    *out = v;
+    return true;
+}
+
+lumi_result_t image_decode_pnm(const uint8_t *data, size_t len, lumi_bitmap_t **out) {
+    if (len < 3 || data[0] != 'P') return LUMI_ERR_INVALID;
+    char kind = (char)data[1];
+    if (kind != '2' && kind != '3' && kind != '5' && kind != '6') return LUMI_ERR_INVALID;
+
+    size_t pos = 2;
+    unsigned w, h, maxval;
+    if (!pnm_int(data, len, &pos, &w) || !pnm_int(data, len, &pos, &h) ||
+        !pnm_int(data, len, &pos, &maxval) || maxval == 0 || maxval > 65535) {
+        return LUMI_ERR_INVALID;
+    }
+    if (!image_size_ok(w, h)) return LUMI_ERR_INVALID;
+
+    int channels = (kind == '3' || kind == '6') ? 3 : 1;
+    bool binary = kind == '5' || kind == '6';
+    size_t sample_bytes = maxval > 255 ? 2 : 1;
+    size_t count = (size_t)w * h * (size_t)channels;
+
+    /* The payload must be there before the bitmap is allocated: binary
+     * samples are sample_bytes each, ASCII ones a digit and a separator */
+    if (binary) pos++;      /* single whitespace after maxval */
+    if (pos > len || len - pos < count * (binary ? sample_bytes : 2)) return LUMI_ERR_INVALID;
+
+    lumi_bitmap_t *bmp = bitmap_alloc((int)w, (int)h);
+    if (!bmp) return LUMI_ERR_NOMEM;
+
+    uint8_t *px = bmp->pixels;
+    for (size_t i = 0; i < count; i++) {
+        unsigned v;
+        if (binary) {
+            v = sample_bytes == 2 ? (unsigned)data[pos] << 8 | data[pos + 1] : data[pos];
+            pos += sample_bytes;
+        } else if (!pnm_int(data, len, &pos, &v)) {
+            lumi_bitmap_release(bmp);
+            return LUMI_ERR_INVALID;
+        }
+        uint8_t s = (uint8_t)((v > maxval ? maxval : v) * 255u / maxval);
+        size_t pixel = i / (size_t)channels;
+        if (channels == 1) {
+            px[pixel * 4] = px[pixel * 4 + 1] = px[pixel * 4 + 2] = s;
+        } else {
+            px[pixel * 4 + i % 3] = s;
+        }
+        px[pixel * 4 + 3] = 255;
+    }
+    *out = bmp;
+    return LUMI_OK;
+}
+
+/* ── Scaling ───────────────────────────────────────────────────── */
+
+lumi_bitmap_t *bitmap_downsample(lumi_bitmap_t *src, int max_w, int max_h) {
+    int sw = src->width, sh = src->height;
+    double scale = 1.0;
+    if (max_w > 0 && sw > max_w) scale = (double)max_w / sw;
+    if (max_h > 0 && sh * scale > max_h) scale = (double)max_h / sh;
+    if (scale >= 1.0) return lumi_bitmap_retain(src);
+
+    int dw = (int)(sw * scale + 0.5), dh = (int)(sh * scale + 0.5);
+    if (dw < 1) dw = 1;
+    if (dh < 1) dh = 1;
+    lumi_bitmap_t *dst = bitmap_alloc(dw, dh);
+    if (!dst) return NULL;
+
+    /* Each destination pixel averages the source block it covers */
+    for (int dy = 0; dy < dh; dy++) {
+        int y0 = (int)((int64_t)dy * sh / dh), y1 = (int)((int64_t)(dy + 1) * sh / dh);
+        if (y1 <= y0) y1 = y0 + 1;
+        for (int dx = 0; dx < dw; dx++) {
+            int x0 = (int)((int64_t)dx * sw / dw), x1 = (int)((int64_t)(dx + 1) * sw / dw);
+            if (x1 <= x0) x1 = x0 + 1;
+            uint64_t acc[4] = { 0, 0, 0, 0 };   /* a block may hold IMAGE_MAX_PIXELS */
+            for (int y = y0; y < y1; y++) {
+                const uint8_t *p = src->pixels + ((size_t)y * (size_t)sw + (size_t)x0) * 4;
+                for (int x = x0; x < x1; x++, p += 4) {
+                    acc[0] += p[0]; acc[1] += p[1]; acc[2] += p[2]; acc[3] += p[3];
+                }
+            }
+            uint64_t n = (uint64_t)(y1 - y0) * (uint64_t)(x1 - x0);
+            uint8_t *d = dst->pixels + ((size_t)dy * (size_t)dw + (size_t)dx) * 4;
+            for (int c = 0; c < 4; c++) d[c] = (uint8_t)((acc[c] + n / 2) / n);
+        }
+    }
+    return dst;
+}
@@ -0,0 +1,40 @@
+/**
+ * image_internal.h — Private bitmap and decoder definitions
+ * Copyright 2026 Lumi Team. Apache-2.0
+ *
+ * Not installed; shared by image.c and image_decode.c.
+ */
+
+#ifndef LUMI_IMAGE_INTERNAL_H
+#define LUMI_IMAGE_INTERNAL_H
+
+#include "lumiapp.h"
+#include <stdatomic.h>
+
+#define IMAGE_MAX_DIM    16384
+#define IMAGE_MAX_PIXELS (64u * 1024 * 1024)    /* 256 MiB as RGBA */
+
+/* Whether a decoder may allocate a width x height bitmap; checked against
+ * the header before anything is allocated. */
+static inline bool image_size_ok(uint32_t width, uint32_t height) {
+    return width && height && width <= IMAGE_MAX_DIM && height <= IMAGE_MAX_DIM &&
+           (uint64_t)width * height <= IMAGE_MAX_PIXELS;
+}
+
+struct lumi_bitmap {
+    atomic_int refs;
+    int width, height;
+    uint8_t pixels[];       /* RGBA8888, rows of width * 4 bytes */
+};
+
+lumi_bitmap_t *bitmap_alloc(int width, int height);
+
+/* Decoders produce a full-size RGBA bitmap. */
+lumi_result_t image_decode_png(const uint8_t *data, size_t len, lumi_bitmap_t **out);
+lumi_result_t image_decode_pnm(const uint8_t *data, size_t len, lumi_bitmap_t **out);
+
+/* Box-filters src down to fit max_w x max_h, keeping the aspect ratio.
+ * Returns a new reference; src itself if it already fits. */
+lumi_bitmap_t *bitmap_downsample(lumi_bitmap_t *src, int max_w, int max_h);
+
+#endif /* LUMI_IMAGE_INTERNAL_H */
@@ -1,51 +1,309 @@
 /**
  * intent.c — Inter-app communication (Intents / IPC)
  * Copyright 2026 Lumi Team. Apache-2.0
+ *
+ * Handlers live in a hash table keyed by action. A pattern ending in ".*"
+ * is stored under its prefix and flagged as a wildcard, so the table doubles
+ * as a flattened prefix trie: a send hashes the action once, left to right,
+ * and probes the wildcard entry for each dotted prefix on the way. Dispatch
+ * costs one probe per segment plus the handlers that match, however many
+ * other actions are registered.
+ *
+ * When the app is connected to the intent bus, each pattern's first and
+ * last handler subscribe and unsubscribe it at the broker, and sends are
+ * forwarded after the local handlers run.
  */
 
-#include "lumiapp.h"
+#include "intent_internal.h"
+#include "mem.h"
+#include "metrics.h"
+#include "trace.h"
 #include <stdlib.h>
 #include <string.h>
 
-#define MAX_HANDLERS 128
+#define FNV_OFFSET 2166136261u
+#define FNV_PRIME  16777619u
+
+/* Sends nested deeper than this from handlers are queued instead */
+#define MAX_SEND_DEPTH 8
 
 typedef struct {
-    char           *action;
-    lumi_intent_cb  callback;
+    lumi_intent_cb  callback;       /* NULL once unregistered mid-dispatch */
     void           *userdata;
 } intent_handler_t;
 
-static intent_handler_t g_handlers[MAX_HANDLERS];
-static int g_handler_count = 0;
+typedef struct intent_entry {
+    char                *key;       /* the pattern as registered */
+    size_t               key_len;   /* compared length; a wildcard's prefix */
+    uint32_t             hash;
+    bool                 wildcard;
+    bool                 dirty;     /* holds NULL handlers to sweep */
+    intent_handler_t    *handlers;
+    int                  count, cap;
+    struct intent_entry *chain;
+} intent_entry_t;
+
+static intent_entry_t **g_buckets;
+static uint32_t g_bucket_count;     /* power of two */
+static uint32_t g_entry_count;
+
+/* Wildcard patterns registered, and the deepest prefix among them */
+static int    g_wildcards;
+static size_t g_wild_max_len;
+
+/* Handlers may register and unregister while a send is running; entries
+ * and handler slots are only reclaimed once the outermost send returns. */
+static int  g_dispatch_depth;
+static bool g_sweep_pending;
+
+static uint32_t hash_bytes(uint32_t hash, const char *s, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        hash ^= (uint8_t)s[i];
+        hash *= FNV_PRIME;
+    }
+    return hash;
+}
+
+static uint32_t entry_hash(uint32_t hash, bool wildcard) {
+    return wildcard ? hash ^ 0x9E3779B1u : hash;
+}
+
+static intent_entry_t *entry_find(const char *key, size_t len, uint32_t hash, bool wildcard) {
+    if (!g_bucket_count) return NULL;
+    for (intent_entry_t *e = g_buckets[hash & (g_bucket_count - 1)]; e; e = e->chain) {
+        if (e->hash == hash && e->wildcard == wildcard && e->key_len == len &&
+            memcmp(e->key, key, len) == 0) {
+            return e;
+        }
+    }
+    return NULL;
+}
+
+static bool table_grow(void) {
+    uint32_t count = g_bucket_count ? g_bucket_count * 2 : 64;
+    intent_entry_t **buckets = mem_calloc(LUMI_MEM_INTENTS, count, sizeof(*buckets));
+    if (!buckets) return false;
+    for (uint32_t b = 0; b < g_bucket_count; b++) {
+        intent_entry_t *e = g_buckets[b];
+        while (e) {
+            intent_entry_t *next = e->chain;
+            e->chain = buckets[e->hash & (count - 1)];
+            buckets[e->hash & (count - 1)] = e;
+            e = next;
+        }
+    }
+    mem_free(LUMI_MEM_INTENTS, g_buckets, g_bucket_count * sizeof(*g_buckets));
+    g_buckets = buckets;
+    g_bucket_count = count;
+    return true;
+}
+
+/* An empty table gives its buckets back, so that registering and then
+ * unregistering every handler leaves no memory held. */
+static void table_trim(void) {
+    if (g_entry_count || g_dispatch_depth) return;
+    mem_free(LUMI_MEM_INTENTS, g_buckets, g_bucket_count * sizeof(*g_buckets));
+    g_buckets = NULL;
+    g_bucket_count = 0;
+}
+
+/* Finds or adds the entry of a pattern whose key is its first len bytes. */
+static intent_entry_t *entry_get(const char *pattern, size_t len, uint32_t hash, bool wildcard) {
+    intent_entry_t *e = entry_find(pattern, len, hash, wildcard);
+    if (e) return e;
+    if (g_entry_count >= g_bucket_count && !table_grow() && !g_bucket_count) return NULL;
+
+    e = mem_calloc(LUMI_MEM_INTENTS, 1, sizeof(*e));
+    if (!e || !(e->key = mem_strdup(LUMI_MEM_INTENTS, pattern))) {
+        mem_free(LUMI_MEM_INTENTS, e, sizeof(*e));
+        return NULL;
+    }
+    e->key_len = len;
+    e->hash = hash;
+    e->wildcard = wildcard;
+    e->chain = g_buckets[hash & (g_bucket_count - 1)];
+    g_buckets[hash & (g_bucket_count - 1)] = e;
+    g_entry_count++;
+    if (wildcard) {
+        g_wildcards++;
+        if (len > g_wild_max_len) g_wild_max_len = len;
+    }
+    bus_subscription(e->key, true);
+    return e;
+}
+
+static void entry_remove(intent_entry_t *e) {
+    intent_entry_t **pp = &g_buckets[e->hash & (g_bucket_count - 1)];
+    while (*pp != e) pp = &(*pp)->chain;
+    *pp = e->chain;
+    g_entry_count--;
+    if (e->wildcard) g_wildcards--;
+    bus_subscription(e->key, false);
+    mem_free(LUMI_MEM_INTENTS, e->handlers, (size_t)e->cap * sizeof(*e->handlers));
+    mem_free_str(LUMI_MEM_INTENTS, e->key);
+    mem_free(LUMI_MEM_INTENTS, e, sizeof(*e));
+}
+
+/* Drops unregistered handler slots, and entries left with none. */
+static void entry_sweep(intent_entry_t *e) {
+    int n = 0;
+    for (int i = 0; i < e->count; i++) {
+        if (e->handlers[i].callback) e->handlers[n++] = e->handlers[i];
+    }
+    e->count = n;
+    e->dirty = false;
+    if (n == 0) entry_remove(e);
+}
+
+static void sweep_all(void) {
+    for (uint32_t b = 0; b < g_bucket_count; b++) {
+        intent_entry_t *e = g_buckets[b];
+        while (e) {
+            intent_entry_t *next = e->chain;
+            if (e->dirty) entry_sweep(e);
+            e = next;
+        }
+    }
+    g_sweep_pending = false;
+    table_trim();
+}
+
+/* Splits a pattern into its table key; "a.b.*" and "*" are wildcards. */
+static bool parse_pattern(const char *action, size_t *len, bool *wildcard) {
+    size_t n = strlen(action);
+    *wildcard = false;
+    if (n >= 1 && action[n - 1] == '*') {
+        if (n == 1) {
+            *len = 0;
+            *wildcard = true;
+            return true;
+        }
+        if (action[n - 2] != '.') return false;
+        n -= 2;
+        *wildcard = true;
+    }
+    if (n == 0 || memchr(action, '*', n)) return false;
+    *len = n;
+    return true;
+}
+
+static void entry_dispatch(intent_entry_t *e, const lumi_intent_t *intent) {
+    /* Handlers added by a callback wait for the next send */
+    int count = e->count;
+    for (int i = 0; i < count; i++) {
+        intent_handler_t h = e->handlers[i];
+        if (h.callback) h.callback(intent, h.userdata);
+    }
+}
+
+void intent_dispatch_local(const lumi_intent_t *intent) {
+    const char *action = intent->action;
+    uint64_t start = g_dispatch_depth++ ? 0 : metric_now_ns();  /* nested sends are included */
+
+    /* Wildcards from the broadest prefix down, then exact handlers */
+    uint32_t hash = FNV_OFFSET;
+    size_t len = 0;
+    if (g_wildcards) {
+        intent_entry_t *e = entry_find(action, 0, entry_hash(hash, true), true);
+        if (e) entry_dispatch(e, intent);
+        for (const char *dot; len <= g_wild_max_len && (dot = strchr(action + len, '.')); ) {
+            size_t end = (size_t)(dot - action);
+            hash = hash_bytes(hash, action + len, end - len);
+            len = end;
+            if ((e = entry_find(action, len, entry_hash(hash, true), true))) {
+                entry_dispatch(e, intent);
+            }
+            hash = hash_bytes(hash, ".", 1);
+            len++;
+        }
+    }
+    size_t total = len + strlen(action + len);
+    hash = hash_bytes(hash, action + len, total - len);
+    intent_entry_t *e = entry_find(action, total, hash, false);
+    if (e) entry_dispatch(e, intent);
+
+    if (--g_dispatch_depth == 0) {
+        metric_record(METRIC_INTENT_DISPATCH_NS, metric_now_ns() - start);
+        if (g_sweep_pending) sweep_all();
+    }
+}
+
+void intent_for_each_pattern(void (*fn)(const char *pattern)) {
+    for (uint32_t b = 0; b < g_bucket_count; b++) {
+        for (intent_entry_t *e = g_buckets[b]; e; e = e->chain) fn(e->key);
+    }
+}
 
 lumi_result_t lumi_intent_send(const lumi_intent_t *intent) {
     if (!intent || !intent->action) return LUMI_ERR_INVALID;
+    if (g_dispatch_depth >= MAX_SEND_DEPTH) {
+        return lumi_intent_post(intent, LUMI_INTENT_PRIORITY_NORMAL);
+    }
 
-    lumi_log(LUMI_LOG_INFO, "intent", "Send: action=%s data=%s target=%s",
+    lumi_log(LUMI_LOG_DEBUG, "intent", "Send: action=%s data=%s target=%s",
              intent->action,
              intent->data ? intent->data : "(null)",
              intent->target_app ? intent->target_app : "(broadcast)");
 
-    /* Dispatch to local handlers that match the action */
-    for (int i = 0; i < g_handler_count; i++) {
-        if (strcmp(g_handlers[i].action, intent->action) == 0) {
-            g_handlers[i].callback(intent, g_handlers[i].userdata);
+    metric_add(METRIC_INTENT_SENT, 1);
+    trace_begin("intent.send");
+    intent_dispatch_local(intent);
+    lumi_result_t rc = bus_forward(intent);
+    trace_end();
+    return rc;
+}
+
+lumi_result_t lumi_intent_register(const char *action, lumi_intent_cb cb, void *userdata) {
+    if (!action || !cb) return LUMI_ERR_INVALID;
+
+    size_t len;
+    bool wildcard;
+    if (!parse_pattern(action, &len, &wildcard)) return LUMI_ERR_INVALID;
+
+    uint32_t hash = entry_hash(hash_bytes(FNV_OFFSET, action, len), wildcard);
+    intent_entry_t *e = entry_get(action, len, hash, wildcard);
+    if (!e) return LUMI_ERR_NOMEM;
+
+    if (e->count == e->cap) {
+        int cap = e->cap ? e->cap * 2 : 4;
+        intent_handler_t *h = mem_realloc(LUMI_MEM_INTENTS, e->handlers,
+                                          (size_t)e->cap * sizeof(*h), (size_t)cap * sizeof(*h));
+        if (!h) {
+            if (e->count == 0 && g_dispatch_depth == 0) {
+                entry_remove(e);
+                table_trim();
+            }
+            return LUMI_ERR_NOMEM;
         }
+        e->handlers = h;
+        e->cap = cap;
     }
-
-    /* TODO: send to IPC bus for cross-app dispatch */
+    e->handlers[e->count++] = (intent_handler_t){ cb, userdata };
     return LUMI_OK;
 }
 
-lumi_result_t lumi_intent_register(const char *action, lumi_intent_cb cb, void *userdata) {
+lumi_result_t lumi_intent_unregister(const char *action, lumi_intent_cb cb, void *userdata) {
     if (!action || !cb) return LUMI_ERR_INVALID;
-    if (g_handler_count >= MAX_HANDLERS) return LUMI_ERR_NOMEM;
 
-    g_handlers[g_handler_count].action   = strdup(action);
-    g_handlers[g_handler_count].callback = cb;
-    g_handlers[g_handler_count].userdata = userdata;
+    size_t len;
+    bool wildcard;
+    if (!parse_pattern(action, &len, &wildcard)) return LUMI_ERR_INVALID;
 
-    if (!g_handlers[g_handler_count].action) return LUMI_ERR_NOMEM;
-    g_handler_count++;
-    return LUMI_OK;
+    uint32_t hash = entry_hash(hash_bytes(FNV_OFFSET, action, len), wildcard);
+    intent_entry_t *e = entry_find(action, len, hash, wildcard);
+    if (!e) return LUMI_ERR_NOT_FOUND;
+
+    for (int i = 0; i < e->count; i++) {
+        intent_handler_t *h = &e->handlers[i];
+        if (h->callback != cb || h->userdata != userdata) continue;
+        h->callback = NULL;
+        if (g_dispatch_depth) {
+            e->dirty = g_sweep_pending = true;
+        } else {
+            entry_sweep(e);
+            table_trim();
+        }
+        return LUMI_OK;
+    }
+    return LUMI_ERR_NOT_FOUND;
 }
@@ -0,0 +1,26 @@
+/**
+ * intent_internal.h — Hooks between intent dispatch and the intent bus
+ * Copyright 2026 Lumi Team. Apache-2.0
+ *
+ * Not installed. intent.c owns the handler table; bus.c mirrors its
+ * patterns to the broker and delivers intents that arrive from it.
+ */
+
+#ifndef LUMI_INTENT_INTERNAL_H
+#define LUMI_INTENT_INTERNAL_H
+
+#include "lumiapp.h"
+
+/* Runs this process's matching handlers without forwarding to the bus. */
+void intent_dispatch_local(const lumi_intent_t *intent);
+
+/* Calls fn with every registered action pattern. */
+void intent_for_each_pattern(void (*fn)(const char *pattern));
+
+/* Queues an intent for the broker; LUMI_OK when not connected. */
+lumi_result_t bus_forward(const lumi_intent_t *intent);
+
+/* Tells the broker that a pattern gained its first or lost its last handler. */
+void bus_subscription(const char *pattern, bool subscribed);
+
+#endif /* LUMI_INTENT_INTERNAL_H */
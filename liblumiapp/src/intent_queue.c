@@ -0,0 +1,171 @@
+/**
+ * intent_queue.c — Queued intent delivery
+ * Copyright 2026 Lumi Team. Apache-2.0
+ *
+ * lumi_intent_post() copies an intent into the byte arena of its priority
+ * lane and returns; lumi_intent_poll() on the UI thread swaps every lane
+ * for an empty one under the lock and delivers the batch outside it, high
+ * lane first. A record is five lengths followed by the strings and the
+ * encoded extras, so a post is one append and a drained lane is reused
+ * without freeing anything.
+ * While a lower lane drains, every few records the poll checks for newly
+ * posted high-priority intents and delivers those first, so a backlog of
+ * bulk work never holds up an urgent intent for a whole batch.
+ */
+
+#include "lumiapp.h"
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define LANES       (LUMI_INTENT_PRIORITY_LOW + 1)
+#define FIELDS      4                   /* strings; the extras follow them */
+#define ABSENT      UINT32_MAX          /* length of a NULL field */
+#define ALIGN(n)    (((n) + 7) & ~(size_t)7)
+#define SLICE       32                  /* records between high-lane checks */
+
+typedef struct {
+    char   *data;
+    size_t  len, cap;
+    size_t  pos;                        /* delivery cursor while draining */
+    int     count;
+} lane_t;
+
+/* g_lanes is guarded by g_lock; g_draining belongs to the polling thread */
+static pthread_mutex_t g_lock = PTHREAD_MUTEX_INITIALIZER;
+static lane_t g_lanes[LANES];
+static lane_t g_draining[LANES];
+static bool   g_polling;
+static int    g_high_posted;            /* g_lanes[HIGH].count, readable unlocked */
+
+lumi_result_t lumi_intent_post(const lumi_intent_t *intent, lumi_intent_priority_t priority) {
+    if (!intent || !intent->action || priority > LUMI_INTENT_PRIORITY_LOW) {
+        return LUMI_ERR_INVALID;
+    }
+
+    if (intent->extras_len >= ABSENT || (intent->extras_len && !intent->extras)) {
+        return LUMI_ERR_INVALID;
+    }
+
+    const char *field[FIELDS] = { intent->action, intent->data, intent->mime_type,
+                                  intent->target_app };
+    uint32_t len[FIELDS + 1];
+    size_t size = sizeof(len);
+    for (int f = 0; f < FIELDS; f++) {
+        len[f] = field[f] ? (uint32_t)strlen(field[f]) : ABSENT;
+        if (field[f]) size += len[f] + 1;
+    }
+    len[FIELDS] = intent->extras ? (uint32_t)intent->extras_len : ABSENT;
+    size = ALIGN(size + intent->extras_len);
+
+    pthread_mutex_lock(&g_lock);
+    lane_t *lane = &g_lanes[priority];
+    if (lane->len + size > lane->cap) {
+        size_t cap = lane->cap ? lane->cap * 2 : 4096;
+        while (cap < lane->len + size) cap *= 2;
+        char *data = realloc(lane->data, cap);
+        if (!data) {
+            pthread_mutex_unlock(&g_lock);
+            return LUMI_ERR_NOMEM;
+        }
+        lane->data = data;
+        lane->cap = cap;
+    }
+
+    char *p = lane->data + lane->len;
+    memcpy(p, len, sizeof(len));
+    p += sizeof(len);
+    for (int f = 0; f < FIELDS; f++) {
+        if (!field[f]) continue;
+        memcpy(p, field[f], len[f] + 1);
+        p += len[f] + 1;
+    }
+    if (intent->extras_len) memcpy(p, intent->extras, intent->extras_len);
+    lane->len += size;
+    lane->count++;
+    if (priority == LUMI_INTENT_PRIORITY_HIGH) {
+        __atomic_store_n(&g_high_posted, lane->count, __ATOMIC_RELAXED);
+    }
+    pthread_mutex_unlock(&g_lock);
+    return LUMI_OK;
+}
+
+/* Moves the posted intents of a lane to its draining side; the caller
+ * holds g_lock and the draining side is empty. */
+static bool take(int i) {
+    if (!g_lanes[i].count) return false;
+    lane_t swap = g_draining[i];        /* an empty lane keeps its buffer */
+    g_draining[i] = g_lanes[i];
+    g_lanes[i] = swap;
+    if (i == LUMI_INTENT_PRIORITY_HIGH) __atomic_store_n(&g_high_posted, 0, __ATOMIC_RELAXED);
+    return true;
+}
+
+/* Delivers up to max records of a drained lane; empties it once done. */
+static int deliver(lane_t *lane, int max) {
+    int n = 0;
+    while (lane->pos < lane->len && n < max) {
+        const char *p = lane->data + lane->pos;
+        uint32_t len[FIELDS + 1];
+        memcpy(len, p, sizeof(len));
+        const char *q = p + sizeof(len);
+        const char *field[FIELDS];
+        for (int f = 0; f < FIELDS; f++) {
+            field[f] = len[f] == ABSENT ? NULL : q;
+            if (field[f]) q += len[f] + 1;
+        }
+        lumi_intent_t intent = { .action = field[0], .data = field[1],
+                                 .mime_type = field[2], .target_app = field[3] };
+        if (len[FIELDS] != ABSENT) {
+            intent.extras = q;
+            intent.extras_len = len[FIELDS];
+            q += len[FIELDS];
+        }
+        lumi_intent_send(&intent);
+        lane->pos += ALIGN((size_t)(q - p));
+        n++;
+    }
+    if (lane->pos >= lane->len) {
+        lane->len = lane->pos = 0;
+        lane->count = 0;
+    }
+    return n;
+}
+
+static int deliver_high(void) {
+    pthread_mutex_lock(&g_lock);
+    bool any = take(LUMI_INTENT_PRIORITY_HIGH);
+    pthread_mutex_unlock(&g_lock);
+    return any ? deliver(&g_draining[LUMI_INTENT_PRIORITY_HIGH], INT32_MAX) : 0;
+}
+
+int lumi_intent_poll(void) {
+    if (g_polling) return 0;            /* a handler called back in */
+
+    pthread_mutex_lock(&g_lock);
+    bool any = false;
+    for (int i = 0; i < LANES; i++) any |= take(i);
+    pthread_mutex_unlock(&g_lock);
+    if (!any) return 0;
+
+    /* Apart from late high-priority ones, intents posted from here on
+     * wait for the next poll */
+    g_polling = true;
+    int n = deliver(&g_draining[LUMI_INTENT_PRIORITY_HIGH], INT32_MAX);
+    for (int i = LUMI_INTENT_PRIORITY_HIGH + 1; i < LANES; i++) {
+        while (g_draining[i].count) {
+            n += deliver(&g_draining[i], SLICE);
+            if (__atomic_load_n(&g_high_posted, __ATOMIC_RELAXED)) n += deliver_high();
+        }
+    }
+    g_polling = false;
+    return n;
+}
+
+int lumi_intent_pending(void) {
+    pthread_mutex_lock(&g_lock);
+    int n = 0;
+    for (int i = 0; i < LANES; i++) n += g_lanes[i].count;
+    pthread_mutex_unlock(&g_lock);
+    return n;
+}
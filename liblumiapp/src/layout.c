@@ -0,0 +1,200 @@
+/**
+ * layout.c — Box layout for view trees
+ * Copyright 2026 Lumi Team. Apache-2.0
+ *
+ * Single recursive pass: each node is sized against the space its parent
+ * offers, then its children are placed relative to its own origin.
+ * Columns (and scroll/card/list) stack children vertically, rows place
+ * them horizontally, stacks overlay them. Explicit width/height win over
+ * intrinsic sizes; containers fill the available width unless they sit
+ * inside a row, and always wrap their content height.
+ */
+
+#include "view_internal.h"
+#include "trace.h"
+#include <float.h>
+
+#define UNBOUNDED FLT_MAX
+
+static float clamp0(float f) { return f > 0.0f ? f : 0.0f; }
+
+static bool is_container(lumi_view_type_t type) {
+    switch (type) {
+        case LUMI_VIEW_COLUMN:
+        case LUMI_VIEW_ROW:
+        case LUMI_VIEW_STACK:
+        case LUMI_VIEW_SCROLL:
+        case LUMI_VIEW_LIST:
+        case LUMI_VIEW_CARD:
+        case LUMI_VIEW_CUSTOM:
+            return true;
+        default:
+            return false;
+    }
+}
+
+static void measure_text(const char *text, float font_size, float max_w, float *w, float *h) {
+    lumi_text_metrics_t m;
+    if (max_w == UNBOUNDED || max_w < 0.0f) max_w = 0.0f;
+    if (lumi_text_measure(text, font_size, max_w, &m, NULL, 0) != LUMI_OK) {
+        *w = *h = 0.0f;
+        return;
+    }
+    *w = m.width;
+    *h = m.height;
+}
+
+/* Stores a frame in the node (and its view, in pack walks); returns
+ * whether it changed. */
+static bool set_frame(view_pack_t *p, view_node_t n, float x, float y, float w, float h) {
+    if (view_node_x(p, n) == x && view_node_y(p, n) == y &&
+        view_node_w(p, n) == w && view_node_h(p, n) == h) {
+        return false;
+    }
+    if (p) {
+        p->x[n.i] = x; p->y[n.i] = y;
+        p->w[n.i] = w; p->h[n.i] = h;
+    }
+    lumi_view_t *v = view_node_view(p, n);
+    v->frame_x = x; v->frame_y = y;
+    v->frame_w = w; v->frame_h = h;
+    v->paint_dirty = true;
+    return true;
+}
+
+static bool layout_node(view_pack_t *p, view_node_t n, float avail_w, float avail_h,
+                        bool fill_w, bool fill_h);
+
+/* Lays out n's children inside its content box; returns the content size. */
+static bool layout_children(view_pack_t *p, view_node_t n, float content_w, float content_h,
+                            float *out_w, float *out_h) {
+    bool changed = false;
+    lumi_view_type_t type = view_node_type(p, n);
+    bool horizontal = type == LUMI_VIEW_ROW;
+    bool overlay = type == LUMI_VIEW_STACK || type == LUMI_VIEW_CUSTOM;
+    float child_avail_h = type == LUMI_VIEW_SCROLL ? UNBOUNDED : content_h;
+    const float *pad = view_node_style(p, n)->padding;
+    float cursor = 0.0f, cross = 0.0f;
+
+    for (view_node_t c = view_node_first_child(p, n); view_node_more(p, n, c);
+         c = view_node_next(p, n, c)) {
+        if (!view_node_visible(p, c)) {
+            if (set_frame(p, c, 0, 0, 0, 0)) changed = view_node_view(p, n)->hit_dirty = true;
+            continue;
+        }
+        float old_w = view_node_w(p, c), old_h = view_node_h(p, c);
+
+        const float *mar = view_node_style(p, c)->margin;
+        float mx = mar[3] + mar[1];
+        float my = mar[0] + mar[2];
+        float aw = content_w == UNBOUNDED ? UNBOUNDED : clamp0(content_w - mx - (horizontal ? cursor : 0));
+        float ah = child_avail_h == UNBOUNDED ? UNBOUNDED : clamp0(child_avail_h - my);
+
+        changed |= layout_node(p, c, aw, ah, !horizontal, false);
+
+        float cw = view_node_w(p, c), ch = view_node_h(p, c);
+        float x = pad[3] + mar[3];
+        float y = pad[0] + mar[0];
+        if (horizontal) {
+            x += cursor;
+            cursor += cw + mx;
+            if (ch + my > cross) cross = ch + my;
+        } else if (overlay) {
+            if (cw + mx > cross) cross = cw + mx;
+            if (ch + my > cursor) cursor = ch + my;
+        } else {
+            y += cursor;
+            cursor += ch + my;
+            if (cw + mx > cross) cross = cw + mx;
+        }
+        if (set_frame(p, c, x, y, cw, ch) || cw != old_w || ch != old_h) {
+            changed = view_node_view(p, n)->hit_dirty = true;
+        }
+    }
+
+    *out_w = horizontal ? cursor : cross;
+    *out_h = horizontal ? cross : cursor;
+    return changed;
+}
+
+/* Sizes n (frame_w/frame_h) and positions its subtree. The caller sets
+ * frame_x/frame_y. Returns true if any frame in the subtree changed. */
+static bool layout_node(view_pack_t *p, view_node_t n, float avail_w, float avail_h,
+                        bool fill_w, bool fill_h) {
+    const lumi_style_desc_t *st = view_node_style(p, n);
+    lumi_view_type_t type = view_node_type(p, n);
+    float pad_x = st->padding[3] + st->padding[1];
+    float pad_y = st->padding[0] + st->padding[2];
+    float w = st->width, h = st->height;
+    bool changed = false;
+
+    if (is_container(type)) {
+        bool wrap_w = w <= 0.0f && (!fill_w || avail_w == UNBOUNDED);
+        float cw = w > 0.0f ? clamp0(w - pad_x) : (wrap_w ? UNBOUNDED : clamp0(avail_w - pad_x));
+        float ch = h > 0.0f ? clamp0(h - pad_y) : (avail_h == UNBOUNDED ? UNBOUNDED : clamp0(avail_h - pad_y));
+        float content_w, content_h;
+
+        changed = layout_children(p, n, cw, ch, &content_w, &content_h);
+        if (w <= 0.0f) w = wrap_w ? content_w + pad_x : avail_w;
+        if (h <= 0.0f) h = content_h + pad_y;
+        if (fill_h && st->height <= 0.0f && avail_h != UNBOUNDED && h < avail_h) h = avail_h;
+    } else {
+        float tw = 0.0f, th = 0.0f;
+        switch (type) {
+            case LUMI_VIEW_TEXT:
+            case LUMI_VIEW_BUTTON:
+            case LUMI_VIEW_TEXT_FIELD:
+                measure_text(view_node_text(p, n), st->font_size,
+                             w > 0.0f ? w - pad_x : avail_w - pad_x, &tw, &th);
+                if (type == LUMI_VIEW_TEXT_FIELD && fill_w && avail_w != UNBOUNDED) {
+                    tw = clamp0(avail_w - pad_x);
+                }
+                break;
+            case LUMI_VIEW_DIVIDER:
+                tw = (fill_w && avail_w != UNBOUNDED) ? avail_w : 0.0f;
+                th = 1.0f;
+                break;
+            default:
+                break;
+        }
+        if (w <= 0.0f) w = tw + pad_x;
+        if (h <= 0.0f) h = th + pad_y;
+    }
+
+    w = clamp0(w);
+    h = clamp0(h);
+    if (view_node_w(p, n) != w || view_node_h(p, n) != h) {
+        if (p) {
+            p->w[n.i] = w;
+            p->h[n.i] = h;
+        }
+        lumi_view_t *v = view_node_view(p, n);
+        v->frame_w = w;
+        v->frame_h = h;
+        changed = true;
+    }
+    if (changed) view_node_view(p, n)->paint_dirty = true;
+    return changed;
+}
+
+/* A packed root is laid out from its arrays, which touches a view only to
+ * store a frame that changed; see view_node_t. */
+void lumi_view_layout(lumi_view_t *root, float width, float height) {
+    if (!root) return;
+
+    trace_begin("view.layout");
+    view_pack_t *pack = view_pack_prepare(root);
+    view_node_t n = view_node_root(pack, root);
+    const float *mar = view_style(root)->margin;
+    bool changed = layout_node(pack, n, width, height, true, true);
+    changed |= set_frame(pack, n, mar[3], mar[0], view_node_w(pack, n), view_node_h(pack, n));
+    if (changed) view_invalidate(root);
+    trace_end();
+}
+
+void lumi_view_get_frame(lumi_view_t *view, float *x, float *y, float *w, float *h) {
+    if (x) *x = view ? view->frame_x : 0.0f;
+    if (y) *y = view ? view->frame_y : 0.0f;
+    if (w) *w = view ? view->frame_w : 0.0f;
+    if (h) *h = view ? view->frame_h : 0.0f;
+}
@@ -1,14 +1,134 @@
 /**
  * log.c — LumiOS SDK logging subsystem
  * Copyright 2026 Lumi Team. Apache-2.0
+ *
+ * Lines are written on the caller's thread unless an async mode is set.
+ * Then every logging thread owns a single-producer ring: the caller
+ * formats "tag: message\n" straight into it behind a small header and
+ * publishes the record with one release store. A writer thread prefixes
+ * the timestamp and level and hands the text to writev() where it lies,
+ * releasing ring space only once it is written. Neither side locks on
+ * the hot path. A thread that exits leaves its ring to the next thread
+ * that logs.
+ *
+ * Deferred records hold a copy of the format and the encoded arguments
+ * (log_proto.h) instead of text, since the caller's format need not
+ * outlive the call. The writer formats them into a scratch buffer, or
+ * appends them unformatted to the binary log file, giving each distinct
+ * format an id the first time it shows up there.
+ *
+ * Per-tag levels live in a small open-addressed table that only grows,
+ * so lumi_log_enabled() probes it without a lock, and not at all while
+ * no tag has a level of its own.
  */
 
-#include "lumiapp.h"
-#include <stdio.h>
+#include "log_proto.h"
+#include "metrics.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
 #include <stdarg.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/uio.h>
 #include <time.h>
+#include <unistd.h>
+
+#define RING_SIZE   (64u * 1024)            /* per thread, a power of two */
+#define MAX_RECORD  (RING_SIZE / 4)         /* longer text is cut */
+#define MAX_TAG     64
+#define BATCH       256                     /* lines per writev() */
+#define INTERVAL_MS 50                      /* writer wakes at least this often */
+#define PREFIX_LEN  13                      /* "[HH:MM:SS] I/" */
+#define FILE_CHUNK  (64u * 1024)            /* binary log bytes per write() */
+#define TAG_SLOTS   128                     /* per-tag levels, a power of two */
+#define MAX_TAGS    (TAG_SLOTS / 2)
+
+enum { REC_TEXT, REC_ARGS };
+
+typedef struct {
+    uint32_t size;                  /* whole record, 8-byte aligned; 0: skip to the ring's end */
+    uint32_t len;                   /* bytes after the tag */
+    int64_t  ns;                    /* CLOCK_REALTIME */
+    uint32_t fmt_len;               /* REC_ARGS: format bytes after the tag, with its NUL */
+    uint8_t  level, kind, tag_len;
+} record_t;
+
+/* What goes after the tag (and the format): ": message\n" for REC_TEXT,
+ * the encoded arguments of fmt for REC_ARGS */
+typedef struct {
+    uint8_t     kind;
+    const char *fmt;
+    va_list    *args;                       /* lumi_log() */
+    const lumi_log_arg_t *array;            /* lumi_log_args() */
+    size_t      count;
+} line_t;
+
+typedef struct ring {
+    _Atomic size_t head;            /* advanced by the owning thread */
+    struct ring *next;
+    atomic_bool owned;
+    size_t read;                    /* writer only: end of the lines it has batched */
+    _Atomic size_t tail;            /* advanced by the writer once they are written */
+    _Alignas(8) uint8_t buf[RING_SIZE];
+} ring_t;
+
+typedef struct {
+    int   fd;
+    FILE *file;
+    int   lines;
+    struct iovec iov[2 * BATCH];
+    char  prefix[BATCH][PREFIX_LEN];
+} batch_t;
+
+typedef struct {
+    char    *fmt;                           /* copy */
+    uint32_t hash, id;
+} format_slot_t;
+
+/* Tags are only ever added, so readers probe without locking */
+typedef struct {
+    _Atomic(const char *) tag;              /* copy, set once */
+    atomic_int level;                       /* -1: the global level */
+} tag_slot_t;
 
 static lumi_log_level_t g_min_level = LUMI_LOG_INFO;
+static atomic_int  g_mode = LUMI_LOG_SYNC;
+static atomic_bool g_deferred;
+
+static pthread_once_t  g_once = PTHREAD_ONCE_INIT;
+static pthread_key_t   g_key;
+static pthread_mutex_t g_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t  g_wake;              /* writer: work, flush or stop */
+static pthread_cond_t  g_done = PTHREAD_COND_INITIALIZER;   /* a writer pass ended */
+static pthread_t g_writer;
+static bool      g_running, g_stopping;
+static uint64_t  g_flush_req, g_flush_done;
+static bool      g_file_change;             /* g_file_next waits for the writer */
+static int       g_file_next = -1;
+
+static _Atomic(ring_t *) g_rings;
+static _Thread_local ring_t *t_ring;
+static atomic_bool  g_kick;                 /* a ring is filling up */
+static atomic_size_t g_written, g_dropped, g_waited, g_writes, g_ring_count;
+
+/* Writer thread only (or whoever holds g_lock while it is not running) */
+static batch_t g_batch[2] = { { .fd = STDOUT_FILENO }, { .fd = STDERR_FILENO } };
+static size_t  g_reported;                  /* drops already logged */
+static char    g_drop_line[64];
+static char    g_text[64 * 1024];           /* deferred lines formatted for a batch */
+static size_t  g_text_used;
+static int     g_file = -1;                 /* binary log */
+static uint8_t *g_file_buf;
+static size_t  g_file_len, g_file_cap;
+static format_slot_t *g_formats;            /* format text -> id in g_file */
+static size_t  g_format_count, g_format_cap;
+
+static tag_slot_t  g_tags[TAG_SLOTS];
+static size_t      g_tag_count;             /* under g_lock */
+static atomic_int  g_tag_overrides;         /* slots with a level; 0 skips the lookup */
 
 static const char *level_str(lumi_log_level_t level) {
     switch (level) {
@@ -25,23 +145,638 @@ void lumi_log_set_level(lumi_log_level_t min_level) {
     g_min_level = min_level;
 }
 
-void lumi_log(lumi_log_level_t level, const char *tag, const char *fmt, ...) {
-    if (level < g_min_level) return;
+static uint32_t tag_hash(const char *tag) {
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < MAX_TAG && tag[i]; i++) h = (h ^ (uint8_t)tag[i]) * 16777619u;
+    return h;
+}
+
+/* The slot holding tag, or the empty slot where it would go (*found false) */
+static tag_slot_t *tag_find(const char *tag, bool *found) {
+    for (uint32_t i = tag_hash(tag);; i++) {
+        tag_slot_t *slot = &g_tags[i & (TAG_SLOTS - 1)];
+        const char *have = atomic_load_explicit(&slot->tag, memory_order_acquire);
+        *found = have != NULL;
+        if (!have || strncmp(have, tag, MAX_TAG) == 0) return slot;
+    }
+}
 
+bool lumi_log_enabled(lumi_log_level_t level, const char *tag) {
+    if (atomic_load_explicit(&g_tag_overrides, memory_order_relaxed) > 0) {
+        bool found;
+        tag_slot_t *slot = tag_find(tag ? tag : "lumi", &found);
+        int min = found ? atomic_load_explicit(&slot->level, memory_order_relaxed) : -1;
+        if (min >= 0) return (int)level >= min;
+    }
+    return level >= g_min_level;
+}
+
+static lumi_result_t tag_level(const char *tag, int level) {
+    if (!tag || !*tag) return LUMI_ERR_INVALID;
+    bool found;
+    pthread_mutex_lock(&g_lock);
+    tag_slot_t *slot = tag_find(tag, &found);
+    if (!found) {
+        char *copy = level >= 0 && g_tag_count < MAX_TAGS ? strndup(tag, MAX_TAG) : NULL;
+        if (!copy) {
+            pthread_mutex_unlock(&g_lock);
+            return level >= 0 ? LUMI_ERR_NOMEM : LUMI_OK;
+        }
+        atomic_store_explicit(&slot->level, -1, memory_order_relaxed);
+        atomic_store_explicit(&slot->tag, copy, memory_order_release);
+        g_tag_count++;
+    }
+    int old = atomic_exchange_explicit(&slot->level, level, memory_order_relaxed);
+    if ((old < 0) != (level < 0)) atomic_fetch_add(&g_tag_overrides, level < 0 ? -1 : 1);
+    pthread_mutex_unlock(&g_lock);
+    return LUMI_OK;
+}
+
+lumi_result_t lumi_log_set_tag_level(const char *tag, lumi_log_level_t level) {
+    if (level < LUMI_LOG_VERBOSE || level > LUMI_LOG_ERROR) return LUMI_ERR_INVALID;
+    return tag_level(tag, (int)level);
+}
+
+lumi_result_t lumi_log_clear_tag_level(const char *tag) {
+    return tag_level(tag, -1);
+}
+
+static void log_sync(lumi_log_level_t level, const char *tag, const char *fmt, va_list args) {
     time_t now = time(NULL);
-    struct tm *tm = localtime(&now);
+    struct tm tm;
+    localtime_r(&now, &tm);
     char timebuf[32];
-    strftime(timebuf, sizeof(timebuf), "%H:%M:%S", tm);
+    strftime(timebuf, sizeof(timebuf), "%H:%M:%S", &tm);
 
     FILE *out = (level >= LUMI_LOG_WARN) ? stderr : stdout;
-    fprintf(out, "[%s] %s/%s: ", timebuf, level_str(level), tag ? tag : "lumi");
+    flockfile(out);                         /* keep lines from threads whole */
+    fprintf(out, "[%s] %s/%s: ", timebuf, level_str(level), tag);
+    vfprintf(out, fmt, args);
+    fputc('\n', out);
+    funlockfile(out);
+}
+
+/* ── Writer ──────────────────────────────────────────────────────── */
+
+static const char *stamp(int64_t ns) {
+    static int64_t cached = -1;
+    static char buf[16];
+    int64_t sec = ns / 1000000000;
+    if (sec != cached) {
+        time_t t = (time_t)sec;
+        struct tm tm;
+        localtime_r(&t, &tm);
+        strftime(buf, sizeof(buf), "[%H:%M:%S] ", &tm);
+        cached = sec;
+    }
+    return buf;
+}
+
+static void write_all(int fd, struct iovec *iov, int count) {
+    while (count > 0) {
+        ssize_t n = writev(fd, iov, count);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return;                         /* nowhere to report it */
+        }
+        while (count > 0 && (size_t)n >= iov->iov_len) {
+            n -= (ssize_t)iov->iov_len;
+            iov++;
+            count--;
+        }
+        if (count > 0) {
+            iov->iov_base = (char *)iov->iov_base + n;
+            iov->iov_len -= (size_t)n;
+        }
+    }
+}
+
+static void file_flush(void) {
+    if (g_file_len == 0) return;
+    struct iovec iov = { g_file_buf, g_file_len };
+    write_all(g_file, &iov, 1);
+    atomic_fetch_add_explicit(&g_writes, 1, memory_order_relaxed);
+    g_file_len = 0;
+}
+
+/* Writes both batches and the binary log, then hands the ring space they
+ * used back */
+static void batch_flush(void) {
+    for (int i = 0; i < 2; i++) {
+        batch_t *b = &g_batch[i];
+        if (b->lines == 0) continue;
+        fflush(b->file);                    /* whatever stdio holds goes first */
+        write_all(b->fd, b->iov, 2 * b->lines);
+        atomic_fetch_add_explicit(&g_writes, 1, memory_order_relaxed);
+        b->lines = 0;
+    }
+    g_text_used = 0;
+    file_flush();
+    for (ring_t *r = atomic_load_explicit(&g_rings, memory_order_acquire); r; r = r->next) {
+        atomic_store_explicit(&r->tail, r->read, memory_order_release);
+    }
+}
+
+static void batch_add(int level, int64_t ns, const char *text, size_t len) {
+    batch_t *b = &g_batch[level >= LUMI_LOG_WARN];
+    if (b->lines == BATCH) batch_flush();
+    char *p = b->prefix[b->lines];
+    memcpy(p, stamp(ns), PREFIX_LEN - 2);
+    p[PREFIX_LEN - 2] = level_str((lumi_log_level_t)level)[0];
+    p[PREFIX_LEN - 1] = '/';
+    b->iov[2 * b->lines] = (struct iovec){ p, PREFIX_LEN };
+    b->iov[2 * b->lines + 1] = (struct iovec){ (void *)text, len };
+    b->lines++;
+}
+
+static const char *rec_fmt(const record_t *rec) {
+    return (const char *)(rec + 1) + rec->tag_len;
+}
+
+/* The text or encoded arguments after the tag and the format */
+static const uint8_t *rec_body(const record_t *rec) {
+    return (const uint8_t *)(rec + 1) + rec->tag_len + rec->fmt_len;
+}
+
+static void text_add(const record_t *rec, const char *tag) {
+    if (g_batch[rec->level >= LUMI_LOG_WARN].lines == BATCH ||
+        sizeof(g_text) - g_text_used < 1024) {
+        batch_flush();
+    }
+    char *p = g_text + g_text_used;
+    size_t room = sizeof(g_text) - g_text_used;
+    const uint8_t *args = rec_body(rec);
+    memcpy(p, tag, rec->tag_len);
+    memcpy(p + rec->tag_len, ": ", 2);
+    size_t n = rec->tag_len + 2;
+    n += log_format(p + n, room - n - 1, rec_fmt(rec), args, args + rec->len);
+    p[n++] = '\n';
+    g_text_used += n;
+    batch_add(rec->level, rec->ns, p, n);
+    atomic_fetch_add_explicit(&g_written, 1, memory_order_relaxed);
+}
+
+static uint8_t *file_frame(uint8_t type, size_t body) {
+    if (g_file_len + 5 + body > g_file_cap) {
+        size_t cap = g_file_cap ? g_file_cap : FILE_CHUNK;
+        while (cap < g_file_len + 5 + body) cap *= 2;
+        uint8_t *buf = realloc(g_file_buf, cap);
+        if (!buf) return NULL;
+        g_file_buf = buf;
+        g_file_cap = cap;
+    }
+    uint8_t *p = g_file_buf + g_file_len;
+    put_u32(p, (uint32_t)body + 1);
+    p[4] = type;
+    g_file_len += 5 + body;
+    return p + 5;
+}
+
+static uint8_t *put_tag(uint8_t *p, const char *tag, size_t len) {
+    p = put_u32(p, (uint32_t)len);
+    memcpy(p, tag, len);
+    p[len] = '\0';
+    return p + len + 1;
+}
+
+static uint32_t format_hash(const char *fmt) {
+    uint32_t h = 2166136261u;
+    for (; *fmt; fmt++) h = (h ^ (uint8_t)*fmt) * 16777619u;
+    return h;
+}
+
+/* Id of fmt in the binary log, defining it there first if it is new */
+static bool format_id(const char *fmt, uint32_t *id) {
+    if (2 * (g_format_count + 1) > g_format_cap) {
+        size_t cap = g_format_cap ? g_format_cap * 2 : 256;
+        format_slot_t *slots = calloc(cap, sizeof(*slots));
+        if (!slots) return false;
+        for (size_t i = 0; i < g_format_cap; i++) {
+            if (!g_formats[i].fmt) continue;
+            size_t j = g_formats[i].hash & (cap - 1);
+            while (slots[j].fmt) j = (j + 1) & (cap - 1);
+            slots[j] = g_formats[i];
+        }
+        free(g_formats);
+        g_formats = slots;
+        g_format_cap = cap;
+    }
+    uint32_t hash = format_hash(fmt);
+    size_t i = hash & (g_format_cap - 1);
+    for (; g_formats[i].fmt; i = (i + 1) & (g_format_cap - 1)) {
+        if (g_formats[i].hash == hash && strcmp(g_formats[i].fmt, fmt) == 0) {
+            *id = g_formats[i].id;
+            return true;
+        }
+    }
+    char *copy = strdup(fmt);
+    if (!copy) return false;
+    uint8_t *p = file_frame(LOG_FRAME_FORMAT, 4 + bus_str_size(fmt));
+    if (!p) {
+        free(copy);
+        return false;
+    }
+    *id = (uint32_t)g_format_count++;
+    bus_put_str(put_u32(p, *id), fmt);
+    g_formats[i] = (format_slot_t){ copy, hash, *id };
+    return true;
+}
+
+static void file_add(const record_t *rec, const char *tag) {
+    const char *body = (const char *)rec_body(rec);
+    uint32_t id = 0;
+    uint8_t *p;
+    if (rec->kind == REC_ARGS) {
+        if (!format_id(rec_fmt(rec), &id)) return;
+        p = file_frame(LOG_FRAME_LINE, 8 + 1 + 4 + 5 + rec->tag_len + rec->len);
+        if (!p) return;
+        p = put_u64(p, (uint64_t)rec->ns);
+        *p++ = rec->level;
+        p = put_u32(p, id);
+        p = put_tag(p, tag, rec->tag_len);
+        memcpy(p, body, rec->len);
+    } else {
+        size_t len = rec->len - 3;          /* without ": " and the newline */
+        p = file_frame(LOG_FRAME_TEXT, 8 + 1 + 5 + rec->tag_len + 5 + len);
+        if (!p) return;
+        p = put_u64(p, (uint64_t)rec->ns);
+        *p++ = rec->level;
+        p = put_tag(p, tag, rec->tag_len);
+        put_tag(p, body + 2, len);
+    }
+    atomic_fetch_add_explicit(&g_written, 1, memory_order_relaxed);
+    if (g_file_len >= FILE_CHUNK) batch_flush();
+}
+
+/* Takes over the file lumi_log_set_binary_file() opened (or -1) */
+static void file_switch(int fd) {
+    if (g_file >= 0) {
+        file_flush();
+        close(g_file);
+    }
+    g_file = fd;
+    g_format_count = 0;
+    for (size_t i = 0; i < g_format_cap; i++) free(g_formats[i].fmt);
+    if (g_formats) memset(g_formats, 0, g_format_cap * sizeof(*g_formats));
+}
+
+static void drain(void) {
+    for (ring_t *r = atomic_load_explicit(&g_rings, memory_order_acquire); r; r = r->next) {
+        size_t head = atomic_load_explicit(&r->head, memory_order_acquire);
+        while (r->read != head) {
+            size_t pos = r->read & (RING_SIZE - 1);
+            const record_t *rec = (const record_t *)(r->buf + pos);
+            if (rec->size == 0) {
+                r->read += RING_SIZE - pos;
+                continue;
+            }
+            const char *tag = (const char *)(rec + 1);
+            if (g_file >= 0) {
+                file_add(rec, tag);
+            } else if (rec->kind == REC_ARGS) {
+                text_add(rec, tag);
+            } else {
+                batch_add(rec->level, rec->ns, tag, rec->tag_len + rec->len);
+                atomic_fetch_add_explicit(&g_written, 1, memory_order_relaxed);
+            }
+            r->read += rec->size;
+        }
+    }
+
+    size_t dropped = atomic_load_explicit(&g_dropped, memory_order_relaxed);
+    if (dropped != g_reported) {
+        struct timespec ts;
+        clock_gettime(CLOCK_REALTIME, &ts);
+        int n = snprintf(g_drop_line, sizeof(g_drop_line), "log: %zu lines dropped\n",
+                         dropped - g_reported);
+        batch_add(LUMI_LOG_WARN, (int64_t)ts.tv_sec * 1000000000, g_drop_line, (size_t)n);
+        g_reported = dropped;
+    }
+    batch_flush();
+}
+
+static void *writer_main(void *arg) {
+    (void)arg;
+    g_batch[0].file = stdout;
+    g_batch[1].file = stderr;
+    pthread_mutex_lock(&g_lock);
+    for (;;) {
+        uint64_t req = g_flush_req;
+        bool stopping = g_stopping;
+        bool change = g_file_change;
+        int fd = g_file_next;
+        g_file_change = false;
+        pthread_mutex_unlock(&g_lock);
+
+        if (change) file_switch(fd);
+        atomic_store_explicit(&g_kick, false, memory_order_relaxed);
+        drain();
+
+        pthread_mutex_lock(&g_lock);
+        g_flush_done = req;
+        pthread_cond_broadcast(&g_done);
+        if (stopping) break;
+        if (g_flush_req == req && !g_stopping && !g_file_change &&
+            !atomic_load_explicit(&g_kick, memory_order_relaxed)) {
+            struct timespec until;
+            clock_gettime(CLOCK_MONOTONIC, &until);
+            until.tv_nsec += INTERVAL_MS * 1000000L;
+            if (until.tv_nsec >= 1000000000L) {
+                until.tv_sec++;
+                until.tv_nsec -= 1000000000L;
+            }
+            pthread_cond_timedwait(&g_wake, &g_lock, &until);
+        }
+    }
+    pthread_mutex_unlock(&g_lock);
+    return NULL;
+}
+
+/* ── Rings ───────────────────────────────────────────────────────── */
+
+static void ring_release(void *arg) {
+    ring_t *r = arg;
+    atomic_store_explicit(&r->owned, false, memory_order_release);
+}
+
+/* The writer does not survive fork(); the child starts out synchronous
+ * and forgets what the parent still had buffered. */
+static void before_fork(void) { pthread_mutex_lock(&g_lock); }
+static void after_fork(void) { pthread_mutex_unlock(&g_lock); }
+
+static void after_fork_child(void) {
+    atomic_store(&g_mode, LUMI_LOG_SYNC);
+    g_running = g_stopping = false;
+    g_flush_req = g_flush_done = 0;
+    for (ring_t *r = atomic_load(&g_rings); r; r = r->next) {
+        r->read = atomic_load(&r->head);
+        atomic_store(&r->tail, r->read);
+    }
+    pthread_mutex_unlock(&g_lock);
+}
+
+static void log_init(void) {
+    pthread_key_create(&g_key, ring_release);
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&g_wake, &attr);
+    pthread_condattr_destroy(&attr);
+    pthread_atfork(before_fork, after_fork, after_fork_child);
+}
+
+static ring_t *ring_get(void) {
+    if (t_ring) return t_ring;
+    ring_t *r = atomic_load_explicit(&g_rings, memory_order_acquire);
+    for (; r; r = r->next) {
+        bool free_ring = false;
+        if (atomic_compare_exchange_strong(&r->owned, &free_ring, true)) break;
+    }
+    if (!r) {
+        r = calloc(1, sizeof(*r));
+        if (!r) return NULL;
+        atomic_init(&r->owned, true);
+        r->next = atomic_load_explicit(&g_rings, memory_order_relaxed);
+        while (!atomic_compare_exchange_weak_explicit(&g_rings, &r->next, r, memory_order_release,
+                                                      memory_order_relaxed)) {
+        }
+        atomic_fetch_add_explicit(&g_ring_count, 1, memory_order_relaxed);
+    }
+    pthread_setspecific(g_key, r);
+    t_ring = r;
+    return r;
+}
+
+static size_t ring_free(ring_t *r, size_t head) {
+    return RING_SIZE - (head - atomic_load_explicit(&r->tail, memory_order_acquire));
+}
+
+/* True once `need` bytes from head are free; in the dropping mode, or
+ * without a writer, false if they are not. */
+static bool ring_room(ring_t *r, size_t head, size_t need) {
+    if (ring_free(r, head) >= need) return true;
+    if (atomic_load_explicit(&g_mode, memory_order_relaxed) != LUMI_LOG_ASYNC_BLOCK) return false;
+
+    atomic_fetch_add_explicit(&g_waited, 1, memory_order_relaxed);
+    pthread_mutex_lock(&g_lock);
+    bool room;
+    while (!(room = ring_free(r, head) >= need) && g_running) {
+        atomic_store_explicit(&g_kick, true, memory_order_relaxed);
+        pthread_cond_signal(&g_wake);
+        pthread_cond_wait(&g_done, &g_lock);
+    }
+    pthread_mutex_unlock(&g_lock);
+    return room;
+}
+
+/* Writes what goes after the tag into room bytes at dst and returns the
+ * size it needs; complete only when that fits, except that text given
+ * less room than it needs is cut to fill it exactly. */
+static size_t line_fill(const line_t *line, uint8_t *dst, size_t room) {
+    if (line->kind == REC_ARGS) {
+        if (line->array) return log_encode(dst, room, line->array, line->count);
+        return log_capture(dst, room, line->fmt, *line->args);
+    }
+    char *text = (char *)dst + 2;
+    size_t fits = room > 2 ? room - 2 : 0;  /* the newline takes the NUL's place */
+    va_list copy;
+    va_copy(copy, *line->args);
+    int n = vsnprintf(fits ? text : NULL, fits, line->fmt, copy);
+    va_end(copy);
+    if (n < 0) n = 0;
+    if (room >= 2) memcpy(dst, ": ", 2);
+    if (fits) text[(size_t)n < fits ? (size_t)n : fits - 1] = '\n';
+    return (size_t)n + 3;
+}
+
+static void ring_put(ring_t *r, lumi_log_level_t level, const char *tag, const line_t *line) {
+    size_t tag_len = strnlen(tag, MAX_TAG);
+    size_t fmt_len = line->kind == REC_ARGS ? strnlen(line->fmt, MAX_RECORD) + 1 : 0;
+    size_t head = atomic_load_explicit(&r->head, memory_order_relaxed);
+    size_t pos = head & (RING_SIZE - 1);
+    size_t fixed = sizeof(record_t) + tag_len + fmt_len;
+
+    /* Usually the line fits where it goes and is written only once */
+    size_t room = RING_SIZE - pos, avail = ring_free(r, head);
+    if (room > avail) room = avail;
+    size_t fits = room > fixed ? room - fixed : 0;
+    size_t len = line_fill(line, r->buf + pos + fixed, fits);
+
+    if (fixed + len > room) {
+        if (fixed + len > MAX_RECORD) {
+            if (line->kind != REC_TEXT) goto drop;
+            len = MAX_RECORD - fixed;
+        }
+        size_t need = (fixed + len + 7) & ~(size_t)7;
+        if (need > RING_SIZE - pos) {
+            /* Too close to the end: skip there and start over at 0 */
+            if (!ring_room(r, head, RING_SIZE - pos + need)) goto drop;
+            ((record_t *)(r->buf + pos))->size = 0;
+            head += RING_SIZE - pos;
+            pos = 0;
+        } else if (!ring_room(r, head, need)) {
+            goto drop;
+        }
+        line_fill(line, r->buf + pos + fixed, len);
+    }
+
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    record_t *rec = (record_t *)(r->buf + pos);
+    rec->size = (uint32_t)((fixed + len + 7) & ~(size_t)7);
+    rec->len = (uint32_t)len;
+    rec->ns = (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+    rec->fmt_len = (uint32_t)fmt_len;
+    rec->level = (uint8_t)level;
+    rec->kind = line->kind;
+    rec->tag_len = (uint8_t)tag_len;
+    memcpy(rec + 1, tag, tag_len);
+    memcpy((char *)(rec + 1) + tag_len, line->fmt, fmt_len);
+    head += rec->size;
+    atomic_store_explicit(&r->head, head, memory_order_release);
+
+    if (RING_SIZE - ring_free(r, head) > RING_SIZE / 2 &&
+        !atomic_exchange_explicit(&g_kick, true, memory_order_relaxed)) {
+        pthread_mutex_lock(&g_lock);
+        pthread_cond_signal(&g_wake);
+        pthread_mutex_unlock(&g_lock);
+    }
+    return;
+
+drop:
+    atomic_fetch_add_explicit(&g_dropped, 1, memory_order_relaxed);
+    metric_add(METRIC_LOG_DROPPED, 1);
+}
+
+static ring_t *async_ring(void) {
+    return atomic_load_explicit(&g_mode, memory_order_relaxed) != LUMI_LOG_SYNC ? ring_get() : NULL;
+}
+
+/* ── Public API ──────────────────────────────────────────────────── */
+
+void lumi_log(lumi_log_level_t level, const char *tag, const char *fmt, ...) {
+    if (!fmt) return;
+    if (!tag) tag = "lumi";
+    if (!lumi_log_enabled(level, tag)) return;
 
     va_list args;
     va_start(args, fmt);
-    vfprintf(out, fmt, args);
+    ring_t *r = async_ring();
+    if (r) {
+        bool deferred = atomic_load_explicit(&g_deferred, memory_order_relaxed);
+        line_t line = { .kind = deferred ? REC_ARGS : REC_TEXT, .fmt = fmt, .args = &args };
+        ring_put(r, level, tag, &line);
+    } else {
+        log_sync(level, tag, fmt, args);
+    }
     va_end(args);
+}
 
-    fputc('\n', out);
+void lumi_log_args(lumi_log_level_t level, const char *tag, const char *fmt,
+                   const lumi_log_arg_t *args, size_t count) {
+    if (!fmt || (count && !args)) return;
+    if (!tag) tag = "lumi";
+    if (!lumi_log_enabled(level, tag)) return;
+
+    ring_t *r = atomic_load_explicit(&g_deferred, memory_order_relaxed) ? async_ring() : NULL;
+    if (r) {
+        line_t line = { .kind = REC_ARGS, .fmt = fmt, .array = args, .count = count };
+        ring_put(r, level, tag, &line);
+        return;
+    }
+
+    uint8_t stack[512], *blob = stack;
+    size_t len = log_encode(stack, sizeof(stack), args, count);
+    if (len > sizeof(stack)) {
+        blob = malloc(len);
+        if (!blob) return;
+        log_encode(blob, len, args, count);
+    }
+    char text[4096];
+    log_format(text, sizeof(text), fmt, blob, blob + len);
+    if (blob != stack) free(blob);
+    lumi_log(level, tag, "%s", text);
+}
+
+lumi_result_t lumi_log_set_mode(lumi_log_mode_t mode) {
+    if (mode < LUMI_LOG_SYNC || mode > LUMI_LOG_ASYNC_BLOCK) return LUMI_ERR_INVALID;
+    pthread_once(&g_once, log_init);
+
+    pthread_mutex_lock(&g_lock);
+    if (mode != LUMI_LOG_SYNC && !g_running) {
+        if (pthread_create(&g_writer, NULL, writer_main, NULL) != 0) {
+            pthread_mutex_unlock(&g_lock);
+            return LUMI_ERR_NOMEM;
+        }
+        g_running = true;
+    }
+    atomic_store(&g_mode, mode);
+    bool stop = mode == LUMI_LOG_SYNC && g_running;
+    if (stop) {
+        g_stopping = true;
+        pthread_cond_signal(&g_wake);
+    }
+    pthread_mutex_unlock(&g_lock);
+
+    if (stop) {
+        pthread_join(g_writer, NULL);       /* its last pass writes what is left */
+        pthread_mutex_lock(&g_lock);
+        g_running = g_stopping = false;
+        pthread_cond_broadcast(&g_done);
+        pthread_mutex_unlock(&g_lock);
+    }
+    return LUMI_OK;
+}
+
+lumi_result_t lumi_log_set_deferred(bool deferred) {
+    atomic_store(&g_deferred, deferred);
+    return LUMI_OK;
+}
+
+lumi_result_t lumi_log_set_binary_file(const char *path) {
+    int fd = -1;
+    if (path) {
+        fd = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (fd < 0) return LUMI_ERR_IO;
+        if (write(fd, LOG_MAGIC, LOG_MAGIC_LEN) != LOG_MAGIC_LEN) {
+            close(fd);
+            return LUMI_ERR_IO;
+        }
+    }
+    lumi_log_flush();
+
+    pthread_mutex_lock(&g_lock);
+    if (g_running) {
+        if (g_file_change && g_file_next >= 0) close(g_file_next);
+        g_file_next = fd;
+        g_file_change = true;
+        pthread_cond_signal(&g_wake);
+    } else {
+        file_switch(fd);
+    }
+    pthread_mutex_unlock(&g_lock);
+    return LUMI_OK;
+}
+
+void lumi_log_flush(void) {
+    pthread_mutex_lock(&g_lock);
+    if (g_running) {
+        uint64_t req = ++g_flush_req;
+        pthread_cond_signal(&g_wake);
+        while (g_running && g_flush_done < req) pthread_cond_wait(&g_done, &g_lock);
+    }
+    pthread_mutex_unlock(&g_lock);
+    fflush(stdout);
+    fflush(stderr);
+}
+
+void lumi_log_get_stats(lumi_log_stats_t *out) {
+    if (!out) return;
+    out->written = atomic_load_explicit(&g_written, memory_order_relaxed);
+    out->dropped = atomic_load_explicit(&g_dropped, memory_order_relaxed);
+    out->waited = atomic_load_explicit(&g_waited, memory_order_relaxed);
+    out->writes = atomic_load_explicit(&g_writes, memory_order_relaxed);
+    out->rings = atomic_load_explicit(&g_ring_count, memory_order_relaxed);
 }
 
 const char *lumi_result_str(lumi_result_t code) {
@@ -0,0 +1,365 @@
+/**
+ * log_format.c — Capturing printf arguments and formatting them later
+ * Copyright 2026 Lumi Team. Apache-2.0
+ *
+ * Deferred log lines keep their arguments instead of the text. The call
+ * site walks the format once to learn what each conversion takes from
+ * the va_list and stores it by value (log_capture); the writer thread,
+ * or lumi-logdump reading a binary log, hands each conversion back to
+ * snprintf() with the stored value (log_format).
+ */
+
+#include "log_proto.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/types.h>
+
+enum { LEN_NONE, LEN_HH, LEN_H, LEN_L, LEN_LL, LEN_J, LEN_Z, LEN_T, LEN_BIG_L };
+
+typedef struct {
+    const char *start, *end;        /* the whole conversion */
+    const char *flags, *width, *prec;
+    int  flags_len, width_len, prec_len;
+    bool width_star, has_prec, prec_star;
+    int  length;
+    char conv;                      /* 0 for one we do not know */
+} spec_t;
+
+typedef struct {
+    uint8_t *out;
+    size_t   room, need;
+} enc_t;
+
+typedef struct {
+    uint8_t     type;
+    uint64_t    v;                  /* LUMI_LOG_ARG_STRING: the length */
+    const char *s;
+} arg_t;
+
+static bool is_digit(char c) { return c >= '0' && c <= '9'; }
+
+/* p points at the '%' */
+static const char *spec_parse(const char *p, spec_t *s) {
+    memset(s, 0, sizeof(*s));
+    s->start = p++;
+    s->flags = p;
+    while (*p == '-' || *p == '+' || *p == ' ' || *p == '#' || *p == '0') p++;
+    s->flags_len = (int)(p - s->flags);
+    if (*p == '*') {
+        s->width_star = true;
+        p++;
+    } else {
+        for (s->width = p; is_digit(*p); p++) {}
+        s->width_len = (int)(p - s->width);
+    }
+    if (*p == '.') {
+        s->has_prec = true;
+        if (*++p == '*') {
+            s->prec_star = true;
+            p++;
+        } else {
+            for (s->prec = p; is_digit(*p); p++) {}
+            s->prec_len = (int)(p - s->prec);
+        }
+    }
+    switch (*p) {
+        case 'h': s->length = p[1] == 'h' ? LEN_HH : LEN_H; p += s->length == LEN_HH ? 2 : 1; break;
+        case 'l': s->length = p[1] == 'l' ? LEN_LL : LEN_L; p += s->length == LEN_LL ? 2 : 1; break;
+        case 'q': s->length = LEN_LL; p++; break;
+        case 'j': s->length = LEN_J; p++; break;
+        case 'z': s->length = LEN_Z; p++; break;
+        case 't': s->length = LEN_T; p++; break;
+        case 'L': s->length = LEN_BIG_L; p++; break;
+        default: break;
+    }
+    if (*p && strchr("diouxXeEfFgGaAcspn%", *p)) s->conv = *p++;
+    s->end = p;
+    return p;
+}
+
+/* ── Encoding ────────────────────────────────────────────────────── */
+
+static void enc_value(enc_t *e, uint8_t type, uint64_t v) {
+    if (e->need + 9 <= e->room) {
+        e->out[e->need] = type;
+        put_u64(e->out + e->need + 1, v);
+    }
+    e->need += 9;
+}
+
+static void enc_double(enc_t *e, double d) {
+    uint64_t v;
+    memcpy(&v, &d, sizeof(v));
+    enc_value(e, LUMI_LOG_ARG_DOUBLE, v);
+}
+
+static void enc_string(enc_t *e, const char *s, size_t len) {
+    if (!s) {
+        s = "(null)";
+        len = 6;
+    }
+    if (len > LOG_MAX_STRING) len = LOG_MAX_STRING;
+    if (e->need + 6 + len <= e->room) {
+        uint8_t *p = e->out + e->need;
+        *p++ = LUMI_LOG_ARG_STRING;
+        p = put_u32(p, (uint32_t)len);
+        memcpy(p, s, len);
+        p[len] = '\0';
+    }
+    e->need += 6 + len;
+}
+
+static int64_t take_signed(va_list *args, int length) {
+    switch (length) {
+        case LEN_HH: return (signed char)va_arg(*args, int);
+        case LEN_H:  return (short)va_arg(*args, int);
+        case LEN_L:  return va_arg(*args, long);
+        case LEN_LL: return va_arg(*args, long long);
+        case LEN_J:  return va_arg(*args, intmax_t);
+        case LEN_Z:  return va_arg(*args, ssize_t);
+        case LEN_T:  return va_arg(*args, ptrdiff_t);
+        default:     return va_arg(*args, int);
+    }
+}
+
+static uint64_t take_unsigned(va_list *args, int length) {
+    switch (length) {
+        case LEN_HH: return (unsigned char)va_arg(*args, unsigned);
+        case LEN_H:  return (unsigned short)va_arg(*args, unsigned);
+        case LEN_L:  return va_arg(*args, unsigned long);
+        case LEN_LL: return va_arg(*args, unsigned long long);
+        case LEN_J:  return va_arg(*args, uintmax_t);
+        case LEN_Z:  return va_arg(*args, size_t);
+        case LEN_T:  return (uint64_t)va_arg(*args, ptrdiff_t);
+        default:     return va_arg(*args, unsigned);
+    }
+}
+
+size_t log_capture(uint8_t *out, size_t room, const char *fmt, va_list args) {
+    enc_t e = { out, room, 0 };
+    va_list ap;
+    va_copy(ap, args);
+    for (const char *p = fmt; *p;) {
+        if (*p != '%') {
+            p++;
+            continue;
+        }
+        spec_t s;
+        p = spec_parse(p, &s);
+        if (s.conv == '%') continue;
+        if (!s.conv) break;             /* cannot tell what it takes */
+        size_t max = LOG_MAX_STRING;    /* %.Ns reads no further */
+        if (s.width_star) enc_value(&e, LUMI_LOG_ARG_INT, (uint64_t)(int64_t)va_arg(ap, int));
+        if (s.prec_star) {
+            int prec = va_arg(ap, int);
+            if (prec >= 0 && (size_t)prec < max) max = (size_t)prec;
+            enc_value(&e, LUMI_LOG_ARG_INT, (uint64_t)(int64_t)prec);
+        } else if (s.has_prec) {
+            size_t prec = 0;
+            for (int i = 0; i < s.prec_len && prec < max; i++) {
+                prec = prec * 10 + (size_t)(s.prec[i] - '0');
+            }
+            if (prec < max) max = prec;
+        }
+        switch (s.conv) {
+            case 'd': case 'i':
+                enc_value(&e, LUMI_LOG_ARG_INT, (uint64_t)take_signed(&ap, s.length));
+                break;
+            case 'o': case 'u': case 'x': case 'X':
+                enc_value(&e, LUMI_LOG_ARG_UINT, take_unsigned(&ap, s.length));
+                break;
+            case 'c':
+                enc_value(&e, LUMI_LOG_ARG_INT, (uint64_t)(int64_t)va_arg(ap, int));
+                break;
+            case 's':
+                if (s.length == LEN_L) {        /* wide strings are not copied */
+                    enc_value(&e, LUMI_LOG_ARG_POINTER, (uintptr_t)va_arg(ap, void *));
+                } else {
+                    const char *str = va_arg(ap, const char *);
+                    enc_string(&e, str, str ? strnlen(str, max) : 0);
+                }
+                break;
+            case 'p':
+                enc_value(&e, LUMI_LOG_ARG_POINTER, (uintptr_t)va_arg(ap, void *));
+                break;
+            case 'n':
+                (void)va_arg(ap, void *);
+                break;
+            default:                            /* floating point */
+                enc_double(&e, s.length == LEN_BIG_L ? (double)va_arg(ap, long double)
+                                                     : va_arg(ap, double));
+                break;
+        }
+    }
+    va_end(ap);
+    return e.need;
+}
+
+size_t log_encode(uint8_t *out, size_t room, const lumi_log_arg_t *args, size_t count) {
+    enc_t e = { out, room, 0 };
+    for (size_t i = 0; i < count; i++) {
+        const lumi_log_arg_t *a = &args[i];
+        switch (a->type) {
+            case LUMI_LOG_ARG_INT:     enc_value(&e, LUMI_LOG_ARG_INT, (uint64_t)a->v.i); break;
+            case LUMI_LOG_ARG_UINT:    enc_value(&e, LUMI_LOG_ARG_UINT, a->v.u); break;
+            case LUMI_LOG_ARG_DOUBLE:  enc_double(&e, a->v.d); break;
+            case LUMI_LOG_ARG_STRING:  enc_string(&e, a->v.s, a->len); break;
+            case LUMI_LOG_ARG_POINTER: enc_value(&e, LUMI_LOG_ARG_POINTER, (uintptr_t)a->v.p); break;
+            default:                   enc_value(&e, LUMI_LOG_ARG_UINT, 0); break;
+        }
+    }
+    return e.need;
+}
+
+/* ── Formatting ──────────────────────────────────────────────────── */
+
+static bool next_arg(const uint8_t **p, const uint8_t *end, arg_t *a) {
+    if (end - *p < 1) return false;
+    a->type = **p;
+    if (a->type == LUMI_LOG_ARG_STRING) {
+        if (end - *p < 6) return false;
+        uint32_t n = get_u32(*p + 1);
+        if ((size_t)(end - *p - 5) <= n || (*p)[5 + n] != '\0') return false;
+        a->v = n;
+        a->s = (const char *)*p + 5;
+        *p += 6 + n;
+        return true;
+    }
+    if (end - *p < 9) return false;
+    a->v = get_u64(*p + 1);
+    *p += 9;
+    return true;
+}
+
+static double arg_double(const arg_t *a) {
+    switch (a->type) {
+        case LUMI_LOG_ARG_DOUBLE: { double d; memcpy(&d, &a->v, sizeof(d)); return d; }
+        case LUMI_LOG_ARG_INT:    return (double)(int64_t)a->v;
+        case LUMI_LOG_ARG_STRING: return 0.0;
+        default:                  return (double)a->v;
+    }
+}
+
+static int64_t arg_int(const arg_t *a) {
+    if (a->type == LUMI_LOG_ARG_STRING) return 0;
+    if (a->type != LUMI_LOG_ARG_DOUBLE) return (int64_t)a->v;
+    double d = arg_double(a);
+    if (d >= 9.2e18) return INT64_MAX;
+    return d > -9.2e18 ? (int64_t)d : INT64_MIN;
+}
+
+/* Appends what snprintf() produced at out + *n, keeping the NUL in size */
+static void advance(size_t *n, size_t size, int written) {
+    if (written <= 0) return;
+    size_t left = size - *n - 1;
+    *n += (size_t)written < left ? (size_t)written : left;
+}
+
+size_t log_format(char *out, size_t size, const char *fmt, const uint8_t *args,
+                  const uint8_t *end) {
+    if (size == 0) return 0;
+    size_t n = 0;
+    const uint8_t *p = args;
+    while (*fmt && n + 1 < size) {
+        if (*fmt != '%') {
+            out[n++] = *fmt++;
+            continue;
+        }
+        spec_t s;
+        const char *next = spec_parse(fmt, &s);
+        if (s.conv == '%') {
+            out[n++] = '%';
+            fmt = next;
+            continue;
+        }
+
+        /* Rebuild the conversion around the stored value */
+        char spec[48];
+        int k = 0;
+        arg_t width, prec, a;
+        bool ok = s.conv != 0 && s.conv != 'n' && s.flags_len < 8 && s.width_len < 10 &&
+                  s.prec_len < 10;
+        if (ok && s.width_star) ok = next_arg(&p, end, &width);
+        if (ok && s.prec_star) ok = next_arg(&p, end, &prec);
+        if (ok) ok = next_arg(&p, end, &a);
+        if (!ok) {
+            if (s.conv != 'n') {
+                advance(&n, size, snprintf(out + n, size - n, "%.*s", (int)(next - fmt), fmt));
+            }
+            fmt = next;
+            continue;
+        }
+
+        spec[k++] = '%';
+        memcpy(spec + k, s.flags, (size_t)s.flags_len);
+        k += s.flags_len;
+        if (s.width_star) {
+            k += snprintf(spec + k, sizeof(spec) - (size_t)k, "%d", (int)arg_int(&width));
+        } else {
+            memcpy(spec + k, s.width, (size_t)s.width_len);
+            k += s.width_len;
+        }
+        if (s.prec_star) {
+            int v = (int)arg_int(&prec);
+            if (v >= 0) k += snprintf(spec + k, sizeof(spec) - (size_t)k, ".%d", v);
+        } else if (s.has_prec) {
+            spec[k++] = '.';
+            memcpy(spec + k, s.prec, (size_t)s.prec_len);
+            k += s.prec_len;
+        }
+
+        char conv = s.conv;
+        char text[48];
+        const char *str = a.s;
+        if (a.type == LUMI_LOG_ARG_STRING && conv != 's') {
+            conv = 's';                 /* print the string as it is */
+        } else if (conv == 's' && a.type != LUMI_LOG_ARG_STRING) {
+            switch (a.type) {
+                case LUMI_LOG_ARG_INT:     snprintf(text, sizeof(text), "%lld", (long long)a.v); break;
+                case LUMI_LOG_ARG_DOUBLE:  snprintf(text, sizeof(text), "%g", arg_double(&a)); break;
+                case LUMI_LOG_ARG_POINTER: snprintf(text, sizeof(text), "%p", (void *)(uintptr_t)a.v); break;
+                default:                   snprintf(text, sizeof(text), "%llu", (unsigned long long)a.v); break;
+            }
+            str = text;
+        }
+
+        int written;
+        switch (conv) {
+            case 'd': case 'i':
+                memcpy(spec + k, "lld", 4);
+                written = snprintf(out + n, size - n, spec, (long long)arg_int(&a));
+                break;
+            case 'o': case 'u': case 'x': case 'X':
+                spec[k++] = 'l';
+                spec[k++] = 'l';
+                spec[k++] = conv;
+                spec[k] = '\0';
+                written = snprintf(out + n, size - n, spec,
+                                   a.type == LUMI_LOG_ARG_DOUBLE ? (unsigned long long)arg_int(&a)
+                                                                 : (unsigned long long)a.v);
+                break;
+            case 'c':
+                memcpy(spec + k, "c", 2);
+                written = snprintf(out + n, size - n, spec, (int)arg_int(&a));
+                break;
+            case 's':
+                memcpy(spec + k, "s", 2);
+                written = snprintf(out + n, size - n, spec, str);
+                break;
+            case 'p':
+                memcpy(spec + k, "p", 2);
+                written = snprintf(out + n, size - n, spec, (void *)(uintptr_t)a.v);
+                break;
+            default:                    /* floating point */
+                spec[k++] = conv;
+                spec[k] = '\0';
+                written = snprintf(out + n, size - n, spec, arg_double(&a));
+                break;
+        }
+        advance(&n, size, written);
+        fmt = next;
+    }
+    out[n] = '\0';
+    return n;
+}
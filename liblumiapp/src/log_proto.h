@@ -0,0 +1,53 @@
+/**
+ * log_proto.h — Deferred log arguments and the binary log file
+ * Copyright 2026 Lumi Team. Apache-2.0
+ *
+ * Not installed; shared by log.c, log_format.c and daemon/logdump.c.
+ * A deferred line keeps its format pointer and the arguments the format
+ * consumes, each encoded as
+ *
+ *   arg = u8 type (lumi_log_arg_type_t) | u64 value
+ *       | u8 LUMI_LOG_ARG_STRING | u32 length | bytes | NUL
+ *
+ * Strings are cut at LOG_MAX_STRING bytes. The binary log file is the
+ * magic followed by frames laid out as on the intent bus (bus_proto.h):
+ *
+ *   FORMAT = u32 id | string format          (before its first LINE)
+ *   LINE   = u64 ns | u8 level | u32 format id | string tag | args
+ *   TEXT   = u64 ns | u8 level | string tag | string message
+ *
+ * Timestamps are CLOCK_REALTIME nanoseconds. Format ids count from 0 in
+ * every file.
+ */
+
+#ifndef LUMI_LOG_PROTO_H
+#define LUMI_LOG_PROTO_H
+
+#include "bus_proto.h"
+#include "lumiapp.h"
+#include <stdarg.h>
+
+#define LOG_MAGIC      "LUMILOG1"
+#define LOG_MAGIC_LEN  8
+#define LOG_MAX_STRING 512
+
+enum {
+    LOG_FRAME_FORMAT = 1,
+    LOG_FRAME_LINE,
+    LOG_FRAME_TEXT,
+};
+
+/* Encodes the arguments fmt consumes from args into room bytes at out and
+ * returns the size they need; out is only complete when that fits. */
+size_t log_capture(uint8_t *out, size_t room, const char *fmt, va_list args);
+
+/* The same for arguments whose types are already known */
+size_t log_encode(uint8_t *out, size_t room, const lumi_log_arg_t *args, size_t count);
+
+/* snprintf() for a format and its encoded arguments. Conversions convert
+ * what they are given (%d of a double, %s of an int), and ones without
+ * an argument left are copied as they are. Returns the length written. */
+size_t log_format(char *out, size_t size, const char *fmt, const uint8_t *args,
+                  const uint8_t *end);
+
+#endif /* LUMI_LOG_PROTO_H */
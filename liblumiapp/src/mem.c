@@ -0,0 +1,265 @@
+/**
+ * mem.c — Memory accounting and budgets
+ * Copyright 2026 Lumi Team. Apache-2.0
+ *
+ * Every accounted allocation is charged first and rolled back if the
+ * allocation fails or a budget would be exceeded, so live bytes never
+ * overshoot a budget even with several threads allocating.
+ *
+ * g_active points at the allocator serving the SDK: g_process, or the
+ * copy of the current app's in g_app_alloc. It only moves while nothing
+ * accounted is live; a destroyed app's allocator stays in effect until
+ * then, and the next allocator change or app creation retires it.
+ */
+
+#include "mem.h"
+#include <pthread.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+static void *libc_alloc(void *ctx, size_t size) {
+    (void)ctx;
+    return malloc(size);
+}
+
+static void *libc_realloc(void *ctx, void *p, size_t old_size, size_t size) {
+    (void)ctx; (void)old_size;
+    return realloc(p, size);
+}
+
+static void libc_free(void *ctx, void *p, size_t size) {
+    (void)ctx; (void)size;
+    free(p);
+}
+
+static const lumi_allocator_t LIBC = { libc_alloc, libc_realloc, libc_free, NULL };
+
+static mem_account_t g_sys[LUMI_MEM_SUBSYSTEM_COUNT];
+static _Atomic(mem_account_t *) g_app;
+
+static pthread_mutex_t g_alloc_lock = PTHREAD_MUTEX_INITIALIZER;
+static lumi_allocator_t g_process = { libc_alloc, libc_realloc, libc_free, NULL };
+static lumi_allocator_t g_app_alloc;
+static bool g_app_owned;                /* g_app_alloc is the current app's */
+static _Atomic(const lumi_allocator_t *) g_active = &g_process;
+
+static inline const lumi_allocator_t *active(void) {
+    return atomic_load_explicit(&g_active, memory_order_acquire);
+}
+
+/* ── Allocators ──────────────────────────────────────────────────── */
+
+void *mem_raw_alloc(const lumi_allocator_t *a, size_t size) {
+    return a->alloc(a->ctx, size);
+}
+
+void mem_raw_free(const lumi_allocator_t *a, void *p, size_t size) {
+    if (p) a->free(a->ctx, p, size);
+}
+
+char *mem_raw_strdup(const lumi_allocator_t *a, const char *s) {
+    size_t size = strlen(s) + 1;
+    char *copy = a->alloc(a->ctx, size);
+    if (copy) memcpy(copy, s, size);
+    return copy;
+}
+
+static void *raw_realloc(const lumi_allocator_t *a, void *p, size_t old_size, size_t size) {
+    if (a->realloc) return a->realloc(a->ctx, p, old_size, size);
+    void *q = a->alloc(a->ctx, size);
+    if (!q) return NULL;
+    if (p) {
+        memcpy(q, p, old_size < size ? old_size : size);
+        a->free(a->ctx, p, old_size);
+    }
+    return q;
+}
+
+lumi_allocator_t mem_process_allocator(void) {
+    pthread_mutex_lock(&g_alloc_lock);
+    lumi_allocator_t a = g_process;
+    pthread_mutex_unlock(&g_alloc_lock);
+    return a;
+}
+
+static bool mem_idle(void) {
+    for (int i = 0; i < LUMI_MEM_SUBSYSTEM_COUNT; i++) {
+        if (atomic_load_explicit(&g_sys[i].live, memory_order_relaxed)) return false;
+    }
+    return true;
+}
+
+/* Retires a destroyed app's allocator once nothing it served is left.
+ * Called with g_alloc_lock held. */
+static void settle(void) {
+    if (!g_app_owned && active() != &g_process && mem_idle()) {
+        atomic_store_explicit(&g_active, &g_process, memory_order_release);
+    }
+}
+
+static bool allocator_valid(const lumi_allocator_t *a) {
+    return !a || (a->alloc && a->free);
+}
+
+static void peak_raise(mem_account_t *a, size_t live) {
+    size_t peak = atomic_load_explicit(&a->peak, memory_order_relaxed);
+    while (live > peak && !atomic_compare_exchange_weak_explicit(&a->peak, &peak, live,
+                                                                 memory_order_relaxed,
+                                                                 memory_order_relaxed)) {
+    }
+}
+
+static bool account_charge(mem_account_t *a, size_t size) {
+    size_t live = atomic_fetch_add_explicit(&a->live, size, memory_order_relaxed) + size;
+    size_t budget = atomic_load_explicit(&a->budget, memory_order_relaxed);
+    if (budget && live > budget) {
+        atomic_fetch_sub_explicit(&a->live, size, memory_order_relaxed);
+        atomic_fetch_add_explicit(&a->refused, 1, memory_order_relaxed);
+        return false;
+    }
+    peak_raise(a, live);
+    return true;
+}
+
+/* Frees may come after the app that allocated is gone, or from before it
+ * existed; its live count stops at zero then. */
+static void account_release(mem_account_t *a, size_t size) {
+    size_t live = atomic_load_explicit(&a->live, memory_order_relaxed);
+    while (!atomic_compare_exchange_weak_explicit(&a->live, &live, live > size ? live - size : 0,
+                                                  memory_order_relaxed, memory_order_relaxed)) {
+    }
+}
+
+static bool charge(lumi_mem_subsystem_t sys, size_t size) {
+    if (!account_charge(&g_sys[sys], size)) return false;
+    mem_account_t *app = atomic_load_explicit(&g_app, memory_order_acquire);
+    if (app && !account_charge(app, size)) {
+        account_release(&g_sys[sys], size);
+        atomic_fetch_add_explicit(&g_sys[sys].refused, 1, memory_order_relaxed);
+        return false;
+    }
+    return true;
+}
+
+static void release(lumi_mem_subsystem_t sys, size_t size) {
+    account_release(&g_sys[sys], size);
+    mem_account_t *app = atomic_load_explicit(&g_app, memory_order_acquire);
+    if (app) account_release(app, size);
+}
+
+/* ── Accounted allocation ────────────────────────────────────────── */
+
+void *mem_alloc(lumi_mem_subsystem_t sys, size_t size) {
+    if (!charge(sys, size)) return NULL;
+    void *p = mem_raw_alloc(active(), size);
+    if (!p) release(sys, size);
+    return p;
+}
+
+void *mem_calloc(lumi_mem_subsystem_t sys, size_t count, size_t size) {
+    if (size && count > SIZE_MAX / size) return NULL;
+    void *p = mem_alloc(sys, count * size);
+    if (p) memset(p, 0, count * size);
+    return p;
+}
+
+void *mem_realloc(lumi_mem_subsystem_t sys, void *p, size_t old_size, size_t size) {
+    if (size > old_size && !charge(sys, size - old_size)) return NULL;
+    void *q = raw_realloc(active(), p, old_size, size);
+    if (!q) {
+        if (size > old_size) release(sys, size - old_size);
+        return NULL;
+    }
+    if (size < old_size) release(sys, old_size - size);
+    return q;
+}
+
+void mem_free(lumi_mem_subsystem_t sys, void *p, size_t size) {
+    if (!p) return;
+    const lumi_allocator_t *a = active();
+    a->free(a->ctx, p, size);
+    release(sys, size);
+}
+
+char *mem_strdup(lumi_mem_subsystem_t sys, const char *s) {
+    size_t size = strlen(s) + 1;
+    char *copy = mem_alloc(sys, size);
+    if (copy) memcpy(copy, s, size);
+    return copy;
+}
+
+bool mem_charge(lumi_mem_subsystem_t sys, size_t size) {
+    return charge(sys, size);
+}
+
+void mem_uncharge(lumi_mem_subsystem_t sys, size_t size) {
+    release(sys, size);
+}
+
+/* ── Apps ────────────────────────────────────────────────────────── */
+
+void mem_app_attach(mem_account_t *app) {
+    pthread_mutex_lock(&g_alloc_lock);
+    atomic_store_explicit(&g_app, app, memory_order_release);
+    g_app_owned = false;
+    settle();
+    pthread_mutex_unlock(&g_alloc_lock);
+}
+
+void mem_app_detach(mem_account_t *app) {
+    pthread_mutex_lock(&g_alloc_lock);
+    if (atomic_compare_exchange_strong(&g_app, &app, NULL)) {
+        g_app_owned = false;
+        settle();
+    }
+    pthread_mutex_unlock(&g_alloc_lock);
+}
+
+lumi_result_t mem_app_set_allocator(mem_account_t *app, const lumi_allocator_t *allocator) {
+    if (!allocator_valid(allocator)) return LUMI_ERR_INVALID;
+    pthread_mutex_lock(&g_alloc_lock);
+    lumi_result_t rc = LUMI_ERR_INVALID;
+    if (atomic_load(&g_app) == app && mem_idle()) {
+        g_app_owned = allocator != NULL;
+        if (allocator) g_app_alloc = *allocator;
+        atomic_store_explicit(&g_active, allocator ? &g_app_alloc : &g_process,
+                              memory_order_release);
+        rc = LUMI_OK;
+    }
+    pthread_mutex_unlock(&g_alloc_lock);
+    return rc;
+}
+
+void mem_account_usage(const mem_account_t *a, lumi_mem_usage_t *out) {
+    out->live    = atomic_load_explicit(&a->live, memory_order_relaxed);
+    out->peak    = atomic_load_explicit(&a->peak, memory_order_relaxed);
+    out->budget  = atomic_load_explicit(&a->budget, memory_order_relaxed);
+    out->refused = atomic_load_explicit(&a->refused, memory_order_relaxed);
+}
+
+/* ── Public API ──────────────────────────────────────────────────── */
+
+lumi_result_t lumi_mem_get_usage(lumi_mem_subsystem_t sys, lumi_mem_usage_t *out) {
+    if ((unsigned)sys >= LUMI_MEM_SUBSYSTEM_COUNT || !out) return LUMI_ERR_INVALID;
+    mem_account_usage(&g_sys[sys], out);
+    return LUMI_OK;
+}
+
+lumi_result_t lumi_mem_set_budget(lumi_mem_subsystem_t sys, size_t bytes) {
+    if ((unsigned)sys >= LUMI_MEM_SUBSYSTEM_COUNT) return LUMI_ERR_INVALID;
+    atomic_store_explicit(&g_sys[sys].budget, bytes, memory_order_relaxed);
+    return LUMI_OK;
+}
+
+lumi_result_t lumi_set_allocator(const lumi_allocator_t *allocator) {
+    if (!allocator_valid(allocator)) return LUMI_ERR_INVALID;
+    pthread_mutex_lock(&g_alloc_lock);
+    lumi_result_t rc = LUMI_ERR_INVALID;
+    if (mem_idle()) {
+        g_process = allocator ? *allocator : LIBC;
+        settle();
+        rc = LUMI_OK;
+    }
+    pthread_mutex_unlock(&g_alloc_lock);
+    return rc;
+}
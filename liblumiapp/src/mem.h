@@ -0,0 +1,53 @@
+/**
+ * mem.h — Accounted allocation for the SDK's subsystems
+ * Copyright 2026 Lumi Team. Apache-2.0
+ *
+ * Not installed; shared by every module whose memory is accounted. Its
+ * allocations go through these instead of malloc() and friends. Frees
+ * take the size that was allocated, so blocks carry no header; a block
+ * must be freed with the subsystem and size it was allocated with.
+ * Allocations are charged to the subsystem and to the current app (the
+ * one created last), fail when that would exceed either budget, and are
+ * served by the allocator in effect (see lumi_set_allocator).
+ */
+
+#ifndef LUMI_MEM_H
+#define LUMI_MEM_H
+
+#include "lumiapp.h"
+#include <stdatomic.h>
+#include <string.h>
+
+typedef struct {
+    _Atomic size_t live, peak, budget, refused;
+} mem_account_t;
+
+void *mem_alloc(lumi_mem_subsystem_t sys, size_t size);
+void *mem_calloc(lumi_mem_subsystem_t sys, size_t count, size_t size);
+void *mem_realloc(lumi_mem_subsystem_t sys, void *p, size_t old_size, size_t size);
+void  mem_free(lumi_mem_subsystem_t sys, void *p, size_t size);
+char *mem_strdup(lumi_mem_subsystem_t sys, const char *s);
+
+/* Accounting alone, for memory that must come from malloc() because the
+ * caller frees it (lumi_file_read) */
+bool  mem_charge(lumi_mem_subsystem_t sys, size_t size);
+void  mem_uncharge(lumi_mem_subsystem_t sys, size_t size);
+
+/* Unaccounted allocation from a given allocator, for blocks that record
+ * the allocator they came from (apps) */
+lumi_allocator_t mem_process_allocator(void);
+void *mem_raw_alloc(const lumi_allocator_t *a, size_t size);
+void  mem_raw_free(const lumi_allocator_t *a, void *p, size_t size);
+char *mem_raw_strdup(const lumi_allocator_t *a, const char *s);
+
+static inline void mem_free_str(lumi_mem_subsystem_t sys, char *s) {
+    if (s) mem_free(sys, s, strlen(s) + 1);
+}
+
+/* app.c: an app's account becomes current when it is created */
+void mem_app_attach(mem_account_t *app);
+void mem_app_detach(mem_account_t *app);
+void mem_account_usage(const mem_account_t *account, lumi_mem_usage_t *out);
+lumi_result_t mem_app_set_allocator(mem_account_t *app, const lumi_allocator_t *allocator);
+
+#endif /* LUMI_MEM_H */
@@ -0,0 +1,363 @@
+/**
+ * metrics.c — Counters, gauges and latency histograms
+ * Copyright 2026 Lumi Team. Apache-2.0
+ *
+ * Counters and histograms are split into METRIC_SHARDS cache-line
+ * aligned shards; each thread sticks to the shard it was given first, so
+ * up to that many threads update without sharing a line, and readers add
+ * the shards up. Histograms bucket values HDR-style: exact below 64,
+ * then 32 linear buckets per power of two. Metrics live for the whole
+ * process; the registry only ever grows.
+ *
+ * lumi_metrics_write() uses the Prometheus text exposition format, with
+ * histograms as summaries:
+ *
+ *   # HELP lumi_intent_dispatch_ns Time to run local intent handlers
+ *   # TYPE lumi_intent_dispatch_ns summary
+ *   lumi_intent_dispatch_ns{quantile="0.5"} 1184
+ *   lumi_intent_dispatch_ns_sum 90211
+ *   lumi_intent_dispatch_ns_count 71
+ */
+
+#include "metrics.h"
+#include <errno.h>
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#define MAX_NAME 128
+
+static hist_shard_t g_hist[3][METRIC_SHARDS];
+
+#define COUNTER(id, n, h)   [id] = { .name = n, .help = h, .type = LUMI_METRIC_COUNTER }
+#define GAUGE(id, n, h)     [id] = { .name = n, .help = h, .type = LUMI_METRIC_GAUGE }
+#define HISTOGRAM(id, n, h, i) \
+    [id] = { .name = n, .help = h, .type = LUMI_METRIC_HISTOGRAM, .hist = g_hist[i] }
+
+lumi_metric_t metrics_sdk[METRIC_SDK_COUNT] = {
+    COUNTER(METRIC_STORAGE_HITS, "lumi_storage_hits_total", "Storage lookups that found their key"),
+    COUNTER(METRIC_STORAGE_MISSES, "lumi_storage_misses_total", "Storage lookups that did not"),
+    GAUGE(METRIC_STORAGE_ENTRIES, "lumi_storage_entries", "Keys in storage"),
+    GAUGE(METRIC_STORAGE_BYTES, "lumi_storage_bytes", "Bytes of keys and values in storage"),
+    COUNTER(METRIC_INTENT_SENT, "lumi_intent_sent_total", "Intents sent"),
+    HISTOGRAM(METRIC_INTENT_DISPATCH_NS, "lumi_intent_dispatch_ns",
+              "Time to run local intent handlers", 0),
+    COUNTER(METRIC_TIMER_FIRED, "lumi_timer_fired_total", "Timer callbacks run"),
+    HISTOGRAM(METRIC_TIMER_LATENESS_NS, "lumi_timer_lateness_ns",
+              "How long after its deadline a timer fired", 1),
+    GAUGE(METRIC_VIEW_NODES, "lumi_view_nodes", "Views alive"),
+    COUNTER(METRIC_LOG_DROPPED, "lumi_log_dropped_total", "Log lines lost to full rings"),
+    COUNTER(METRIC_FILE_READ_BYTES, "lumi_file_read_bytes_total", "Bytes read by lumi_file_read"),
+    COUNTER(METRIC_FILE_WRITTEN_BYTES, "lumi_file_written_bytes_total",
+            "Bytes written by lumi_file_write"),
+};
+
+static pthread_once_t  g_once = PTHREAD_ONCE_INIT;
+static pthread_mutex_t g_lock = PTHREAD_MUTEX_INITIALIZER;
+static lumi_metric_t  *g_first, *g_last;
+static atomic_uint     g_next_shard;
+static _Thread_local unsigned t_shard;      /* 1 + shard, 0 until the first update */
+
+static const double QUANTILES[] = { 0.5, 0.9, 0.99, 0.999 };
+
+uint64_t metric_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+static unsigned shard(void) {
+    if (!t_shard) {
+        t_shard = atomic_fetch_add_explicit(&g_next_shard, 1, memory_order_relaxed) % METRIC_SHARDS + 1;
+    }
+    return t_shard - 1;
+}
+
+/* Shards want their cache-line alignment, which calloc() does not promise */
+static void *zalloc(size_t size) {
+    void *p = aligned_alloc(64, size);  /* sizes are multiples of it */
+    if (p) memset(p, 0, size);
+    return p;
+}
+
+static void link_metric(lumi_metric_t *m) {
+    if (g_last) g_last->next = m;
+    else g_first = m;
+    g_last = m;
+}
+
+static void registry_init(void) {
+    pthread_mutex_lock(&g_lock);
+    for (int i = 0; i < METRIC_SDK_COUNT; i++) link_metric(&metrics_sdk[i]);
+    pthread_mutex_unlock(&g_lock);
+}
+
+/* ── Histograms ──────────────────────────────────────────────────── */
+
+static unsigned hist_index(uint64_t v) {
+    if (v < 2 * HIST_SUB) return (unsigned)v;
+    unsigned e = 63u - (unsigned)__builtin_clzll(v);
+    if (e >= HIST_MAX_BITS) return HIST_BUCKETS - 1;
+    return (e - HIST_SUB_BITS) * HIST_SUB + (unsigned)(v >> (e - HIST_SUB_BITS));
+}
+
+/* The middle of bucket i */
+static uint64_t hist_value(unsigned i) {
+    if (i < 2 * HIST_SUB) return i;
+    unsigned e = i / HIST_SUB + HIST_SUB_BITS - 1;
+    uint64_t width = 1ull << (e - HIST_SUB_BITS);
+    return (i % HIST_SUB + HIST_SUB) * width + width / 2;
+}
+
+static void hist_read(const lumi_metric_t *m, lumi_metric_value_t *out) {
+    uint64_t buckets[HIST_BUCKETS] = { 0 };
+    uint64_t min = UINT64_MAX;
+    for (int s = 0; s < METRIC_SHARDS; s++) {
+        hist_shard_t *h = &m->hist[s];
+        uint64_t count = atomic_load_explicit(&h->count, memory_order_relaxed);
+        if (!count) continue;
+        out->value += (int64_t)count;
+        out->sum += atomic_load_explicit(&h->sum, memory_order_relaxed);
+        uint64_t lo = ~atomic_load_explicit(&h->min_inv, memory_order_relaxed);
+        uint64_t hi = atomic_load_explicit(&h->max, memory_order_relaxed);
+        if (lo < min) min = lo;
+        if (hi > out->max) out->max = hi;
+        for (unsigned i = 0; i < HIST_BUCKETS; i++) {
+            buckets[i] += atomic_load_explicit(&h->buckets[i], memory_order_relaxed);
+        }
+    }
+    if (!out->value) return;
+    out->min = min;
+
+    /* Buckets may run a little ahead of the counts read above */
+    uint64_t total = 0;
+    for (unsigned i = 0; i < HIST_BUCKETS; i++) total += buckets[i];
+    uint64_t *q[] = { &out->p50, &out->p90, &out->p99, &out->p999 };
+    uint64_t seen = 0;
+    unsigned i = 0, k = 0;
+    for (; k < 4; k++) {
+        uint64_t rank = (uint64_t)(QUANTILES[k] * (double)total);
+        if (rank >= total) rank = total - 1;
+        while (i < HIST_BUCKETS && seen + buckets[i] <= rank) seen += buckets[i++];
+        uint64_t v = i < HIST_BUCKETS ? hist_value(i) : out->max;
+        *q[k] = v < out->min ? out->min : v > out->max ? out->max : v;
+    }
+}
+
+/* ── Registration ────────────────────────────────────────────────── */
+
+static bool valid_name(const char *name) {
+    size_t len = strnlen(name, MAX_NAME);
+    if (!len || len == MAX_NAME || (name[0] >= '0' && name[0] <= '9')) return false;
+    for (size_t i = 0; i < len; i++) {
+        char c = name[i];
+        if (!((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') ||
+              c == '_' || c == ':')) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static lumi_metric_t *metric_get(const char *name, const char *help, lumi_metric_type_t type) {
+    if (!name || !valid_name(name)) return NULL;
+    pthread_once(&g_once, registry_init);
+    pthread_mutex_lock(&g_lock);
+    lumi_metric_t *m = g_first;
+    while (m && strcmp(m->name, name) != 0) m = m->next;
+    if (m) {
+        pthread_mutex_unlock(&g_lock);
+        return m->type == type ? m : NULL;
+    }
+    m = zalloc(sizeof(*m));
+    char *own_name = strdup(name), *own_help = strdup(help ? help : "");
+    hist_shard_t *hist = NULL;
+    if (type == LUMI_METRIC_HISTOGRAM) hist = zalloc(METRIC_SHARDS * sizeof(*hist));
+    if (!m || !own_name || !own_help || (type == LUMI_METRIC_HISTOGRAM && !hist)) {
+        pthread_mutex_unlock(&g_lock);
+        free(m);
+        free(own_name);
+        free(own_help);
+        free(hist);
+        return NULL;
+    }
+    m->name = own_name;
+    m->help = own_help;
+    m->type = type;
+    m->hist = hist;
+    link_metric(m);
+    pthread_mutex_unlock(&g_lock);
+    return m;
+}
+
+/* ── Public API ──────────────────────────────────────────────────── */
+
+lumi_metric_t *lumi_metric_counter(const char *name, const char *help) {
+    return metric_get(name, help, LUMI_METRIC_COUNTER);
+}
+
+lumi_metric_t *lumi_metric_gauge(const char *name, const char *help) {
+    return metric_get(name, help, LUMI_METRIC_GAUGE);
+}
+
+lumi_metric_t *lumi_metric_histogram(const char *name, const char *help) {
+    return metric_get(name, help, LUMI_METRIC_HISTOGRAM);
+}
+
+void lumi_metric_add(lumi_metric_t *m, uint64_t n) {
+    if (!m) return;
+    if (m->type == LUMI_METRIC_COUNTER) {
+        atomic_fetch_add_explicit(&m->counts[shard()].value, n, memory_order_relaxed);
+    } else if (m->type == LUMI_METRIC_GAUGE) {
+        atomic_fetch_add_explicit(&m->gauge, (int64_t)n, memory_order_relaxed);
+    }
+}
+
+void lumi_metric_set(lumi_metric_t *m, int64_t value) {
+    if (m && m->type == LUMI_METRIC_GAUGE) {
+        atomic_store_explicit(&m->gauge, value, memory_order_relaxed);
+    }
+}
+
+void lumi_metric_record(lumi_metric_t *m, uint64_t value) {
+    if (!m || m->type != LUMI_METRIC_HISTOGRAM) return;
+    hist_shard_t *h = &m->hist[shard()];
+    atomic_fetch_add_explicit(&h->buckets[hist_index(value)], 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&h->sum, value, memory_order_relaxed);
+    atomic_fetch_add_explicit(&h->count, 1, memory_order_relaxed);
+    uint64_t inv = atomic_load_explicit(&h->min_inv, memory_order_relaxed);
+    while (~value > inv && !atomic_compare_exchange_weak_explicit(&h->min_inv, &inv, ~value,
+                                                                  memory_order_relaxed,
+                                                                  memory_order_relaxed)) {
+    }
+    uint64_t hi = atomic_load_explicit(&h->max, memory_order_relaxed);
+    while (value > hi && !atomic_compare_exchange_weak_explicit(&h->max, &hi, value,
+                                                                memory_order_relaxed,
+                                                                memory_order_relaxed)) {
+    }
+}
+
+lumi_result_t lumi_metric_read(const lumi_metric_t *m, lumi_metric_value_t *out) {
+    if (!m || !out) return LUMI_ERR_INVALID;
+    memset(out, 0, sizeof(*out));
+    out->name = m->name;
+    out->help = m->help;
+    out->type = m->type;
+    if (m->type == LUMI_METRIC_COUNTER) {
+        uint64_t total = 0;
+        for (int s = 0; s < METRIC_SHARDS; s++) {
+            total += atomic_load_explicit(&m->counts[s].value, memory_order_relaxed);
+        }
+        out->value = (int64_t)total;
+    } else if (m->type == LUMI_METRIC_GAUGE) {
+        out->value = atomic_load_explicit(&m->gauge, memory_order_relaxed);
+    } else {
+        hist_read(m, out);
+    }
+    return LUMI_OK;
+}
+
+size_t lumi_metrics_snapshot(lumi_metric_value_t *out, size_t max) {
+    pthread_once(&g_once, registry_init);
+    pthread_mutex_lock(&g_lock);
+    size_t n = 0;
+    for (lumi_metric_t *m = g_first; m; m = m->next, n++) {
+        if (out && n < max) lumi_metric_read(m, &out[n]);
+    }
+    pthread_mutex_unlock(&g_lock);
+    return n;
+}
+
+/* ── Exposition ──────────────────────────────────────────────────── */
+
+typedef struct {
+    char  *data;
+    size_t len, cap;
+    bool   failed;
+} text_t;
+
+static void text_add(text_t *t, const char *fmt, ...) __attribute__((format(printf, 2, 3)));
+
+static void text_add(text_t *t, const char *fmt, ...) {
+    for (;;) {
+        va_list args;
+        va_start(args, fmt);
+        int n = t->failed ? -1 : vsnprintf(t->data + t->len, t->cap - t->len, fmt, args);
+        va_end(args);
+        if (n < 0) {
+            t->failed = true;
+            return;
+        }
+        if ((size_t)n < t->cap - t->len) {
+            t->len += (size_t)n;
+            return;
+        }
+        size_t cap = t->cap * 2 + (size_t)n;
+        char *data = realloc(t->data, cap);
+        if (!data) {
+            t->failed = true;
+            return;
+        }
+        t->data = data;
+        t->cap = cap;
+    }
+}
+
+static void expose(text_t *t, const lumi_metric_value_t *v) {
+    static const char *TYPES[] = { "counter", "gauge", "summary" };
+    text_add(t, "# HELP %s %s\n# TYPE %s %s\n", v->name, v->help, v->name, TYPES[v->type]);
+    if (v->type != LUMI_METRIC_HISTOGRAM) {
+        text_add(t, "%s %lld\n", v->name, (long long)v->value);
+        return;
+    }
+    const uint64_t q[] = { v->p50, v->p90, v->p99, v->p999 };
+    for (int k = 0; k < 4; k++) {
+        text_add(t, "%s{quantile=\"%g\"} %llu\n", v->name, QUANTILES[k], (unsigned long long)q[k]);
+    }
+    text_add(t, "%s_sum %llu\n%s_count %lld\n", v->name, (unsigned long long)v->sum, v->name,
+             (long long)v->value);
+}
+
+lumi_result_t lumi_metrics_write(int fd) {
+    if (fd < 0) return LUMI_ERR_INVALID;
+    text_t t = { .cap = 4096 };
+    t.data = malloc(t.cap);
+    if (!t.data) return LUMI_ERR_NOMEM;
+
+    pthread_once(&g_once, registry_init);
+    pthread_mutex_lock(&g_lock);
+    for (lumi_metric_t *m = g_first; m; m = m->next) {
+        lumi_metric_value_t v;
+        lumi_metric_read(m, &v);
+        expose(&t, &v);
+    }
+    pthread_mutex_unlock(&g_lock);
+    if (t.failed) {
+        free(t.data);
+        return LUMI_ERR_NOMEM;
+    }
+
+    /* send() keeps a closed socket from raising SIGPIPE */
+    bool sock = true;
+    for (size_t off = 0; off < t.len;) {
+        ssize_t n = sock ? send(fd, t.data + off, t.len - off, MSG_NOSIGNAL)
+                         : write(fd, t.data + off, t.len - off);
+        if (n < 0 && sock && errno == ENOTSOCK) {
+            sock = false;
+            continue;
+        }
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) {
+            free(t.data);
+            return LUMI_ERR_IO;
+        }
+        off += (size_t)n;
+    }
+    free(t.data);
+    return LUMI_OK;
+}
@@ -0,0 +1,72 @@
+/**
+ * metrics.h — Metric layout and the SDK's own metrics
+ * Copyright 2026 Lumi Team. Apache-2.0
+ *
+ * Not installed; shared by metrics.c and the modules it measures.
+ */
+
+#ifndef LUMI_METRICS_H
+#define LUMI_METRICS_H
+
+#include "lumiapp.h"
+#include <stdatomic.h>
+
+#define METRIC_SHARDS   8                   /* threads spread over these */
+#define HIST_SUB_BITS   5                   /* 32 buckets per power of two, under 3.2% error */
+#define HIST_SUB        (1u << HIST_SUB_BITS)
+#define HIST_MAX_BITS   40                  /* larger values land in the top bucket */
+#define HIST_BUCKETS    ((HIST_MAX_BITS - HIST_SUB_BITS + 1) * HIST_SUB)
+
+typedef struct {
+    _Alignas(64) _Atomic uint64_t value;
+} counter_shard_t;
+
+typedef struct {
+    _Alignas(64) _Atomic uint64_t count;
+    _Atomic uint64_t sum, max;
+    _Atomic uint64_t min_inv;               /* ~min, so 0 until the first value */
+    _Atomic uint64_t buckets[HIST_BUCKETS];
+} hist_shard_t;
+
+struct lumi_metric {
+    const char *name, *help;
+    lumi_metric_type_t type;
+    struct lumi_metric *next;               /* registry */
+    _Atomic int64_t gauge;
+    counter_shard_t counts[METRIC_SHARDS];
+    hist_shard_t   *hist;                   /* METRIC_SHARDS of them */
+};
+
+typedef enum {
+    METRIC_STORAGE_HITS,
+    METRIC_STORAGE_MISSES,
+    METRIC_STORAGE_ENTRIES,
+    METRIC_STORAGE_BYTES,
+    METRIC_INTENT_SENT,
+    METRIC_INTENT_DISPATCH_NS,
+    METRIC_TIMER_FIRED,
+    METRIC_TIMER_LATENESS_NS,
+    METRIC_VIEW_NODES,
+    METRIC_LOG_DROPPED,
+    METRIC_FILE_READ_BYTES,
+    METRIC_FILE_WRITTEN_BYTES,
+    METRIC_SDK_COUNT
+} metric_id_t;
+
+extern lumi_metric_t metrics_sdk[METRIC_SDK_COUNT];
+
+uint64_t metric_now_ns(void);               /* CLOCK_MONOTONIC */
+
+static inline void metric_add(metric_id_t id, uint64_t n) {
+    lumi_metric_add(&metrics_sdk[id], n);
+}
+
+static inline void metric_gauge_add(metric_id_t id, int64_t delta) {
+    atomic_fetch_add_explicit(&metrics_sdk[id].gauge, delta, memory_order_relaxed);
+}
+
+static inline void metric_record(metric_id_t id, uint64_t value) {
+    lumi_metric_record(&metrics_sdk[id], value);
+}
+
+#endif /* LUMI_METRICS_H */
@@ -1,21 +1,338 @@
 /**
  * notify.c — Notification service
  * Copyright 2026 Lumi Team. Apache-2.0
+ *
+ * lumi_notify() copies the notification into a per-channel queue and
+ * returns; a sender thread delivers the queues to the notification daemon
+ * (daemon/notifyd.c) over an AF_UNIX SOCK_SEQPACKET socket. A keyed
+ * notification that is still waiting is updated in place, so a stream of
+ * progress updates for one download collapses into whatever is current
+ * when it goes out. Each channel spends tokens from a bucket that refills
+ * at its rate; what is over the limit waits, and keeps collapsing, until
+ * tokens come back. Everything one round can send leaves as one packet.
+ * Without a daemon, notifications are written to the log instead and the
+ * connection is retried once a second.
  */
 
 #include "lumiapp.h"
-#include <string.h>
+#include "notify_proto.h"
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <time.h>
+
+#define DEFAULT_RATE   5.0              /* notifications per second per channel */
+#define DEFAULT_BURST  5
+#define MAX_PENDING    1024
+#define RETRY_NS       1000000000ull
+#define SEND_TIMEOUT_S 1
+
+typedef struct notif {
+    const char   *key, *title, *body, *icon;    /* in block */
+    char         *block;
+    int           priority;
+    struct notif *next;
+} notif_t;
+
+typedef struct channel {
+    char           *name;
+    double          rate, tokens;
+    int             burst;
+    bool            custom;             /* rate set for this channel */
+    uint64_t        refilled_ns;
+    notif_t        *head, *tail;
+    struct channel *next;
+} channel_t;
+
+/* Everything below is guarded by g_lock, except g_sock and g_out which
+ * belong to the sender thread. */
+static pthread_mutex_t g_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t  g_wake;
+static pthread_t g_sender;
+static bool      g_running, g_stopping;
+static channel_t *g_channels;
+static double    g_rate = DEFAULT_RATE;
+static int       g_burst = DEFAULT_BURST;
+static char     *g_path;                /* NULL: notify_default_path() */
+static uint64_t  g_retry_at;
+static bool      g_reconnect;
+static lumi_notify_stats_t g_stats;
+
+static int     g_sock = -1;
+static uint8_t g_out[BUS_MAX_PACKET];
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static channel_t *channel_get(const char *name) {
+    for (channel_t *c = g_channels; c; c = c->next) {
+        if (strcmp(c->name, name) == 0) return c;
+    }
+    channel_t *c = calloc(1, sizeof(*c));
+    if (!c || !(c->name = strdup(name))) {
+        free(c);
+        return NULL;
+    }
+    c->rate = g_rate;
+    c->burst = g_burst;
+    c->tokens = g_burst;
+    c->refilled_ns = now_ns();
+    c->next = g_channels;
+    g_channels = c;
+    return c;
+}
+
+/* Copies the strings of n into one block hung off node. */
+static bool notif_fill(notif_t *node, const lumi_notification_t *n) {
+    const char *src[4] = { n->key, n->title, n->body, n->icon };
+    size_t size = 0;
+    for (int i = 0; i < 4; i++) size += src[i] ? strlen(src[i]) + 1 : 0;
+    char *block = malloc(size ? size : 1);
+    if (!block) return false;
+
+    const char **dst[4] = { &node->key, &node->title, &node->body, &node->icon };
+    char *p = block;
+    for (int i = 0; i < 4; i++) {
+        *dst[i] = NULL;
+        if (!src[i]) continue;
+        size_t len = strlen(src[i]) + 1;
+        memcpy(p, src[i], len);
+        *dst[i] = p;
+        p += len;
+    }
+    free(node->block);
+    node->block = block;
+    node->priority = n->priority;
+    return true;
+}
+
+/* Bytes of the NOTIFY_POST frame for these strings */
+static size_t frame_size(const char *const s[NOTIFY_STRINGS]) {
+    size_t frame = 5 + 4;
+    for (int i = 0; i < NOTIFY_STRINGS; i++) frame += bus_str_size(s[i]);
+    return frame;
+}
+
+/* ── Sender thread ─────────────────────────────────────────────── */
+
+/* Frames what the token buckets allow (everything when draining) into
+ * g_out, up to one packet. Returns its length and sets *wake to when a
+ * waiting channel gets its next token. */
+static size_t collect(bool drain, uint64_t *wake, size_t *count) {
+    uint64_t now = now_ns();
+    size_t len = 0;
+    *wake = UINT64_MAX;
+    *count = 0;
+    for (channel_t *c = g_channels; c; c = c->next) {
+        c->tokens += (double)(now - c->refilled_ns) / 1e9 * c->rate;
+        if (c->tokens > c->burst) c->tokens = c->burst;
+        c->refilled_ns = now;
+
+        while (c->head && (drain || c->tokens >= 1.0)) {
+            notif_t *n = c->head;
+            const char *s[NOTIFY_STRINGS] = { c->name, n->key, n->title, n->body, n->icon };
+            size_t frame = frame_size(s);
+            if (len && len + frame > sizeof(g_out)) {
+                *wake = now;            /* the packet is full: go again */
+                return len;
+            }
+            if (frame > sizeof(g_out)) {
+                /* lumi_notify() refuses these; never spin on one */
+                c->head = n->next;
+                if (!c->head) c->tail = NULL;
+                free(n->block);
+                free(n);
+                g_stats.pending--;
+                g_stats.dropped++;
+                continue;
+            }
+            uint8_t *p = put_u32(g_out + len, (uint32_t)frame - 4);
+            *p++ = NOTIFY_POST;
+            for (int i = 0; i < NOTIFY_STRINGS; i++) p = bus_put_str(p, s[i]);
+            put_u32(p, (uint32_t)n->priority);
+            len += frame;
+
+            c->head = n->next;
+            if (!c->head) c->tail = NULL;
+            free(n->block);
+            free(n);
+            c->tokens -= 1.0;
+            g_stats.pending--;
+            (*count)++;
+        }
+        if (c->head) {
+            uint64_t at = now + (uint64_t)((1.0 - c->tokens) / c->rate * 1e9);
+            if (at < *wake) *wake = at;
+        }
+    }
+    return len;
+}
+
+static bool try_connect(void) {
+    char path[sizeof(((struct sockaddr_un *)0)->sun_path)];
+    pthread_mutex_lock(&g_lock);
+    bool set = g_path != NULL;
+    if (set) snprintf(path, sizeof(path), "%s", g_path);
+    pthread_mutex_unlock(&g_lock);
+    if (!set) notify_default_path(path, sizeof(path));
+
+    struct sockaddr_un addr = { .sun_family = AF_UNIX };
+    memcpy(addr.sun_path, path, sizeof(addr.sun_path) - 1);
+    int fd = socket(AF_UNIX, SOCK_SEQPACKET, 0);
+    if (fd < 0) return false;
+    fcntl(fd, F_SETFD, FD_CLOEXEC);
+    struct timeval timeout = { .tv_sec = SEND_TIMEOUT_S };
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+    if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+        close(fd);
+        return false;
+    }
+    g_sock = fd;
+    lumi_log(LUMI_LOG_INFO, "notify", "Connected to %s", path);
+    return true;
+}
+
+/* Without a daemon: what lumi_notify() always did */
+static void log_frames(size_t len) {
+    const uint8_t *p = g_out, *end = g_out + len, *body, *body_end;
+    uint8_t type;
+    while (bus_next_frame(&p, end, &type, &body, &body_end)) {
+        const char *s[NOTIFY_STRINGS];
+        const uint8_t *q = body;
+        bool ok = type == NOTIFY_POST;
+        for (int i = 0; i < NOTIFY_STRINGS && ok; i++) ok = bus_get_str(&q, body_end, &s[i]);
+        if (!ok) continue;
+        lumi_log(LUMI_LOG_INFO, "notify", "[%s] %s: %s", s[0], s[2] ? s[2] : "",
+                 s[3] ? s[3] : "");
+    }
+}
+
+static void deliver(size_t len) {
+    pthread_mutex_lock(&g_lock);
+    bool reconnect = g_reconnect;
+    g_reconnect = false;
+    if (reconnect) g_retry_at = 0;
+    bool retry = now_ns() >= g_retry_at;
+    pthread_mutex_unlock(&g_lock);
+
+    if (reconnect && g_sock >= 0) {
+        close(g_sock);
+        g_sock = -1;
+    }
+    if (g_sock < 0 && retry && !try_connect()) {
+        pthread_mutex_lock(&g_lock);
+        g_retry_at = now_ns() + RETRY_NS;
+        pthread_mutex_unlock(&g_lock);
+    }
+    if (g_sock >= 0 && send(g_sock, g_out, len, MSG_NOSIGNAL) == (ssize_t)len) {
+        pthread_mutex_lock(&g_lock);
+        g_stats.writes++;
+        pthread_mutex_unlock(&g_lock);
+        return;
+    }
+    if (g_sock >= 0) {
+        lumi_log(LUMI_LOG_WARN, "notify", "Lost the notification daemon: %s", strerror(errno));
+        close(g_sock);
+        g_sock = -1;
+    }
+    log_frames(len);
+}
+
+static void *sender_main(void *arg) {
+    (void)arg;
+    pthread_mutex_lock(&g_lock);
+    for (;;) {
+        uint64_t wake;
+        size_t count;
+        size_t len = collect(g_stopping, &wake, &count);
+        if (len) {
+            g_stats.delivered += count;
+            pthread_mutex_unlock(&g_lock);
+            deliver(len);
+            pthread_mutex_lock(&g_lock);
+            continue;
+        }
+        if (g_stopping) break;
+        if (wake == UINT64_MAX) {
+            pthread_cond_wait(&g_wake, &g_lock);
+        } else {
+            struct timespec ts = { (time_t)(wake / 1000000000ull), (long)(wake % 1000000000ull) };
+            pthread_cond_timedwait(&g_wake, &g_lock, &ts);
+        }
+    }
+    pthread_mutex_unlock(&g_lock);
+
+    if (g_sock >= 0) close(g_sock);
+    g_sock = -1;
+    return NULL;
+}
+
+/* Starts the sender; the caller holds g_lock. */
+static bool start_sender(void) {
+    if (g_running) return true;
+    static bool cond_ready;
+    if (!cond_ready) {
+        pthread_condattr_t attr;
+        pthread_condattr_init(&attr);
+        pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+        pthread_cond_init(&g_wake, &attr);
+        pthread_condattr_destroy(&attr);
+        cond_ready = true;
+    }
+    g_stopping = false;
+    g_running = pthread_create(&g_sender, NULL, sender_main, NULL) == 0;
+    return g_running;
+}
+
+/* ── Public API ────────────────────────────────────────────────── */
 
 lumi_result_t lumi_notify(const lumi_notification_t *notif) {
     if (!notif || !notif->title) return LUMI_ERR_INVALID;
+    const char *channel = notif->channel ? notif->channel : "default";
+    const char *s[NOTIFY_STRINGS] = { channel, notif->key, notif->title, notif->body, notif->icon };
+    if (frame_size(s) > BUS_MAX_PACKET) return LUMI_ERR_INVALID;
 
-    lumi_log(LUMI_LOG_INFO, "notify", "[%s] %s: %s",
-             notif->channel ? notif->channel : "default",
-             notif->title,
-             notif->body ? notif->body : "");
+    pthread_mutex_lock(&g_lock);
+    lumi_result_t rc = LUMI_OK;
+    channel_t *c = start_sender() ? channel_get(channel) : NULL;
+    if (!c) {
+        rc = LUMI_ERR_NOMEM;
+        goto out;
+    }
 
-    /* TODO: send to LumiOS notification daemon via D-Bus or Unix socket */
-    return LUMI_OK;
+    /* A waiting notification with the same key takes the new content */
+    if (notif->key) {
+        for (notif_t *n = c->head; n; n = n->next) {
+            if (!n->key || strcmp(n->key, notif->key) != 0) continue;
+            if (!notif_fill(n, notif)) {
+                rc = LUMI_ERR_NOMEM;
+            } else {
+                g_stats.posted++;
+                g_stats.coalesced++;
+            }
+            goto out;
+        }
+    }
+
+    notif_t *n = g_stats.pending < MAX_PENDING ? calloc(1, sizeof(*n)) : NULL;
+    if (!n || !notif_fill(n, notif)) {
+        free(n);
+        g_stats.dropped++;
+        rc = LUMI_ERR_NOMEM;
+        goto out;
+    }
+    if (c->tail) c->tail->next = n; else c->head = n;
+    c->tail = n;
+    g_stats.posted++;
+    g_stats.pending++;
+    pthread_cond_signal(&g_wake);
+out:
+    pthread_mutex_unlock(&g_lock);
+    return rc;
 }
 
 lumi_result_t lumi_notify_simple(const char *title, const char *body) {
@@ -29,3 +346,80 @@ lumi_result_t lumi_notify_simple(const char *title, const char *body) {
     };
     return lumi_notify(&notif);
 }
+
+static void channel_limit(channel_t *c, double per_second, int burst, bool custom) {
+    c->rate = per_second;
+    c->burst = burst;
+    c->custom = custom;
+    if (c->tokens > burst) c->tokens = burst;
+}
+
+lumi_result_t lumi_notify_set_rate(const char *channel, double per_second, int burst) {
+    if (!(per_second > 0.0) || burst < 1) return LUMI_ERR_INVALID;
+    pthread_mutex_lock(&g_lock);
+    lumi_result_t rc = LUMI_OK;
+    if (channel) {
+        channel_t *c = channel_get(channel);
+        if (c) channel_limit(c, per_second, burst, true); else rc = LUMI_ERR_NOMEM;
+    } else {
+        g_rate = per_second;
+        g_burst = burst;
+        for (channel_t *c = g_channels; c; c = c->next) {
+            if (!c->custom) channel_limit(c, per_second, burst, false);
+        }
+    }
+    if (g_running) pthread_cond_signal(&g_wake);
+    pthread_mutex_unlock(&g_lock);
+    return rc;
+}
+
+lumi_result_t lumi_notify_set_socket(const char *socket_path) {
+    if (socket_path && strlen(socket_path) >= sizeof(((struct sockaddr_un *)0)->sun_path)) {
+        return LUMI_ERR_INVALID;
+    }
+    char *path = socket_path ? strdup(socket_path) : NULL;
+    if (socket_path && !path) return LUMI_ERR_NOMEM;
+    pthread_mutex_lock(&g_lock);
+    free(g_path);
+    g_path = path;
+    g_reconnect = true;                 /* the sender drops the old connection */
+    pthread_mutex_unlock(&g_lock);
+    return LUMI_OK;
+}
+
+void lumi_notify_get_stats(lumi_notify_stats_t *out) {
+    if (!out) return;
+    pthread_mutex_lock(&g_lock);
+    *out = g_stats;
+    pthread_mutex_unlock(&g_lock);
+}
+
+void lumi_notify_shutdown(void) {
+    pthread_mutex_lock(&g_lock);
+    bool running = g_running;
+    g_stopping = true;
+    if (running) pthread_cond_signal(&g_wake);
+    pthread_mutex_unlock(&g_lock);
+    if (running) pthread_join(g_sender, NULL);
+
+    pthread_mutex_lock(&g_lock);
+    g_running = g_stopping = false;
+    while (g_channels) {
+        channel_t *c = g_channels;
+        g_channels = c->next;
+        while (c->head) {               /* whatever the drain left behind */
+            notif_t *n = c->head;
+            c->head = n->next;
+            free(n->block);
+            free(n);
+            g_stats.pending--;
+        }
+        free(c->name);
+        free(c);
+    }
+    g_rate = DEFAULT_RATE;
+    g_burst = DEFAULT_BURST;
+    g_retry_at = 0;
+    g_reconnect = false;
+    pthread_mutex_unlock(&g_lock);
+}
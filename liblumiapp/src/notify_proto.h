@@ -0,0 +1,39 @@
+/**
+ * notify_proto.h — Wire protocol of the notification daemon
+ * Copyright 2026 Lumi Team. Apache-2.0
+ *
+ * Not installed; shared by notify.c (the client) and daemon/notifyd.c.
+ * Packets, frames and strings are as on the intent bus (bus_proto.h).
+ * POST carries the channel, key, title, body and icon strings followed by
+ * the priority as a u32 (two's complement). A POST whose channel and key
+ * match an earlier one from the same client replaces it; a NULL key
+ * always adds a new notification.
+ */
+
+#ifndef LUMI_NOTIFY_PROTO_H
+#define LUMI_NOTIFY_PROTO_H
+
+#include "bus_proto.h"
+
+#define NOTIFY_STRINGS 5
+
+enum {
+    NOTIFY_POST = 1,
+};
+
+/* $LUMI_NOTIFY_SOCKET, else lumi-notify.sock in $XDG_RUNTIME_DIR or /tmp */
+static inline void notify_default_path(char *buf, size_t size) {
+    const char *env = getenv("LUMI_NOTIFY_SOCKET");
+    if (env && *env) {
+        snprintf(buf, size, "%s", env);
+        return;
+    }
+    const char *dir = getenv("XDG_RUNTIME_DIR");
+    if (dir && *dir) {
+        snprintf(buf, size, "%s/lumi-notify.sock", dir);
+    } else {
+        snprintf(buf, size, "/tmp/lumi-notify-%u.sock", (unsigned)getuid());
+    }
+}
+
+#endif /* LUMI_NOTIFY_PROTO_H */
@@ -0,0 +1,163 @@
+/**
+ * pack.c — Packed (structure-of-arrays) storage for view trees
+ * Copyright 2026 Lumi Team. Apache-2.0
+ *
+ * A packed root keeps the fields layout and paint read on every node in
+ * contiguous arrays indexed in pre-order, so a full pass streams through
+ * them instead of visiting each heap-allocated view. The views stay the
+ * owners of everything: the pack mirrors them and the passes write frames
+ * back to a view only when they change.
+ *
+ * Style, text, visibility and boundary changes update a view's slot in
+ * place.
+ * Adding, removing or moving views marks the pack stale; it is rebuilt
+ * with one walk of the tree at the next layout or paint.
+ */
+
+#include "view_internal.h"
+#include <stdlib.h>
+#include <string.h>
+
+static int g_live_packs;
+
+/* One block: pointer arrays first, then 4-byte, then 1-byte fields */
+#define PACK_BYTES_PER_VIEW (3 * sizeof(void *) + 5 * sizeof(float) + 2)
+
+static uint8_t pack_flags(const lumi_view_t *v) {
+    return (v->visible ? PACK_VISIBLE : 0) | (v->repaint_boundary ? PACK_BOUNDARY : 0);
+}
+
+static bool pack_reserve(view_pack_t *p, uint32_t count) {
+    if (count <= p->cap) return true;
+    uint32_t cap = p->cap ? p->cap : 64;
+    while (cap < count) cap *= 2;
+
+    char *block = mem_alloc(LUMI_MEM_VIEWS, (size_t)cap * PACK_BYTES_PER_VIEW);
+    if (!block) return false;
+    mem_free(LUMI_MEM_VIEWS, p->view, (size_t)p->cap * PACK_BYTES_PER_VIEW);
+
+    char *q = block;
+    p->view  = (lumi_view_t **)q;              q += cap * sizeof(*p->view);
+    p->style = (const lumi_style_desc_t **)q;  q += cap * sizeof(*p->style);
+    p->text  = (const char **)q;               q += cap * sizeof(*p->text);
+    p->end   = (uint32_t *)q;                  q += cap * sizeof(*p->end);
+    p->x     = (float *)q;                     q += cap * sizeof(float);
+    p->y     = (float *)q;                     q += cap * sizeof(float);
+    p->w     = (float *)q;                     q += cap * sizeof(float);
+    p->h     = (float *)q;                     q += cap * sizeof(float);
+    p->type  = (uint8_t *)q;                   q += cap;
+    p->flags = (uint8_t *)q;
+    p->cap = cap;
+    return true;
+}
+
+size_t view_pack_bytes(const view_pack_t *p) {
+    return p ? sizeof(*p) + (size_t)p->cap * PACK_BYTES_PER_VIEW : 0;
+}
+
+static uint32_t count_views(const lumi_view_t *v) {
+    uint32_t n = 1;
+    for (int i = 0; i < v->child_count; i++) n += count_views(v->children[i]);
+    return n;
+}
+
+static uint32_t fill(view_pack_t *p, lumi_view_t *v, uint32_t i) {
+    v->pack_index = i;
+    p->view[i]  = v;
+    p->style[i] = view_style(v);
+    p->text[i]  = v->text;
+    p->type[i]  = (uint8_t)v->type;
+    p->flags[i] = pack_flags(v);
+    p->x[i] = v->frame_x;
+    p->y[i] = v->frame_y;
+    p->w[i] = v->frame_w;
+    p->h[i] = v->frame_h;
+
+    uint32_t next = i + 1;
+    for (int c = 0; c < v->child_count; c++) next = fill(p, v->children[c], next);
+    p->end[i] = next;
+    return next;
+}
+
+view_pack_t *view_pack_prepare(lumi_view_t *root) {
+    view_pack_t *p = root->pack;
+    if (!p || root->parent) return NULL;
+
+    if (p->stale) {
+        uint32_t n = count_views(root);
+        if (!pack_reserve(p, n)) return NULL;
+        p->style_epoch = view_style_epoch;
+        p->count = fill(p, root, 0);
+        p->stale = false;
+    } else if (p->style_epoch != view_style_epoch) {
+        /* A class was redefined: re-resolve the bound views */
+        p->style_epoch = view_style_epoch;
+        for (uint32_t i = 0; i < p->count; i++) p->style[i] = view_style(p->view[i]);
+    }
+    return p;
+}
+
+lumi_result_t lumi_view_set_packed(lumi_view_t *root, bool packed) {
+    if (!root || root->parent) return LUMI_ERR_INVALID;
+    if (!packed) {
+        view_pack_free(root);
+        return LUMI_OK;
+    }
+    if (root->pack) return LUMI_OK;
+
+    view_pack_t *p = mem_calloc(LUMI_MEM_VIEWS, 1, sizeof(*p));
+    if (!p) return LUMI_ERR_NOMEM;
+    p->stale = true;
+    root->pack = p;
+    g_live_packs++;
+    if (!view_pack_prepare(root)) {
+        view_pack_free(root);
+        return LUMI_ERR_NOMEM;
+    }
+    return LUMI_OK;
+}
+
+bool lumi_view_is_packed(lumi_view_t *root) {
+    return root && root->pack;
+}
+
+void view_pack_free(lumi_view_t *root) {
+    view_pack_t *p = root->pack;
+    if (!p) return;
+    mem_free(LUMI_MEM_VIEWS, p->view, (size_t)p->cap * PACK_BYTES_PER_VIEW);
+    mem_free(LUMI_MEM_VIEWS, p, sizeof(*p));
+    root->pack = NULL;
+    g_live_packs--;
+}
+
+/* ── Hooks called by view edits ────────────────────────────────── */
+
+static view_pack_t *pack_of(lumi_view_t *v) {
+    if (g_live_packs == 0) return NULL;
+    while (v->parent) v = v->parent;
+    return v->pack;
+}
+
+void view_pack_sync(lumi_view_t *view) {
+    view_pack_t *p = pack_of(view);
+    if (!p || p->stale) return;
+
+    uint32_t i = view->pack_index;
+    if (i >= p->count || p->view[i] != view) {
+        p->stale = true;
+        return;
+    }
+    p->style[i] = &view->style->desc;
+    p->text[i]  = view->text;
+    p->flags[i] = pack_flags(view);
+}
+
+void view_pack_restructure(lumi_view_t *view) {
+    view_pack_t *p = pack_of(view);
+    if (p) p->stale = true;
+}
+
+void view_pack_attached(lumi_view_t *child) {
+    view_pack_free(child);
+    view_pack_restructure(child);
+}
@@ -0,0 +1,373 @@
+/**
+ * paint.c — Display-list recording, caching and serialization
+ * Copyright 2026 Lumi Team. Apache-2.0
+ *
+ * A display list is a flat array of fixed-size draw ops plus one string
+ * blob. Ops refer to strings by offset, so a list can be appended to
+ * another (splice) or written to a byte buffer with plain copies.
+ *
+ * Views flagged as repaint boundaries keep the list of their subtree.
+ * While nothing below them is invalidated, painting splices that list
+ * instead of walking the subtree again.
+ */
+
+#include "view_internal.h"
+#include "trace.h"
+#include "wire.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define NO_STRING UINT32_MAX
+
+typedef struct {
+    uint8_t  type;
+    float    x, y, w, h;
+    uint32_t color;
+    float    radius;
+    float    font_size;
+    uint32_t str;       /* offset into strings, NO_STRING if none */
+} dl_op_t;
+
+struct lumi_display_list {
+    dl_op_t *ops;
+    size_t   count;
+    size_t   cap;
+    char    *strings;
+    size_t   str_len;
+    size_t   str_cap;
+};
+
+/* ── List storage ──────────────────────────────────────────────── */
+
+lumi_display_list_t *lumi_display_list_create(void) {
+    return calloc(1, sizeof(lumi_display_list_t));
+}
+
+void lumi_display_list_destroy(lumi_display_list_t *list) {
+    if (!list) return;
+    free(list->ops);
+    free(list->strings);
+    free(list);
+}
+
+size_t display_list_bytes(const lumi_display_list_t *list) {
+    if (!list) return 0;
+    return sizeof(*list) + list->cap * sizeof(dl_op_t) + list->str_cap;
+}
+
+void lumi_display_list_clear(lumi_display_list_t *list) {
+    if (!list) return;
+    list->count = 0;
+    list->str_len = 0;
+}
+
+size_t lumi_display_list_count(const lumi_display_list_t *list) {
+    return list ? list->count : 0;
+}
+
+static bool reserve_ops(lumi_display_list_t *list, size_t extra) {
+    if (list->count + extra <= list->cap) return true;
+    size_t cap = list->cap ? list->cap * 2 : 64;
+    while (cap < list->count + extra) cap *= 2;
+    dl_op_t *ops = realloc(list->ops, cap * sizeof(dl_op_t));
+    if (!ops) return false;
+    list->ops = ops;
+    list->cap = cap;
+    return true;
+}
+
+static bool reserve_strings(lumi_display_list_t *list, size_t extra) {
+    if (list->str_len + extra <= list->str_cap) return true;
+    size_t cap = list->str_cap ? list->str_cap * 2 : 256;
+    while (cap < list->str_len + extra) cap *= 2;
+    char *s = realloc(list->strings, cap);
+    if (!s) return false;
+    list->strings = s;
+    list->str_cap = cap;
+    return true;
+}
+
+/* Copies s into the blob and sets *off to it; false if out of memory. */
+static bool add_string(lumi_display_list_t *list, const char *s, uint32_t *off) {
+    size_t n = strlen(s) + 1;
+    if (!reserve_strings(list, n)) return false;
+    *off = (uint32_t)list->str_len;
+    memcpy(list->strings + *off, s, n);
+    list->str_len += n;
+    return true;
+}
+
+static dl_op_t *push_op(lumi_display_list_t *list, lumi_draw_op_type_t type,
+                        float x, float y, float w, float h) {
+    if (!reserve_ops(list, 1)) return NULL;
+    dl_op_t *op = &list->ops[list->count++];
+    memset(op, 0, sizeof(*op));
+    op->type = (uint8_t)type;
+    op->x = x; op->y = y; op->w = w; op->h = h;
+    op->str = NO_STRING;
+    return op;
+}
+
+/* Appends src to dst, shifting every op by (dx, dy). */
+static bool splice(lumi_display_list_t *dst, const lumi_display_list_t *src,
+                   float dx, float dy) {
+    if (!reserve_ops(dst, src->count) || !reserve_strings(dst, src->str_len)) {
+        return false;
+    }
+
+    uint32_t base = (uint32_t)dst->str_len;
+    if (src->str_len) memcpy(dst->strings + base, src->strings, src->str_len);
+    dst->str_len += src->str_len;
+
+    dl_op_t *out = dst->ops + dst->count;
+    if (src->count) memcpy(out, src->ops, src->count * sizeof(dl_op_t));
+    for (size_t i = 0; i < src->count; i++) {
+        out[i].x += dx;
+        out[i].y += dy;
+        if (out[i].str != NO_STRING) out[i].str += base;
+    }
+    dst->count += src->count;
+    return true;
+}
+
+void lumi_display_list_replay(const lumi_display_list_t *list, lumi_draw_cb cb, void *userdata) {
+    if (!list || !cb) return;
+    for (size_t i = 0; i < list->count; i++) {
+        const dl_op_t *op = &list->ops[i];
+        lumi_draw_op_t out = {
+            .type      = (lumi_draw_op_type_t)op->type,
+            .x         = op->x,
+            .y         = op->y,
+            .w         = op->w,
+            .h         = op->h,
+            .color     = op->color,
+            .radius    = op->radius,
+            .font_size = op->font_size,
+            .text      = op->str != NO_STRING ? list->strings + op->str : NULL,
+        };
+        cb(&out, userdata);
+    }
+}
+
+/* ── Serialization ─────────────────────────────────────────────── */
+
+/*
+ * Layout (all integers little-endian, floats as IEEE-754 bit patterns):
+ *   "LMDL" | u16 version | u16 reserved | u32 op_count | u32 string_bytes
+ *   op_count x { u8 type, u8 pad[3], f32 x, y, w, h, u32 color,
+ *                f32 radius, f32 font_size, u32 string_offset }
+ *   string_bytes of NUL-terminated strings
+ */
+
+#define DL_MAGIC    "LMDL"
+#define DL_VERSION  1
+#define DL_HEADER   16
+#define DL_OP_SIZE  36
+
+lumi_result_t lumi_display_list_serialize(const lumi_display_list_t *list,
+                                          uint8_t **out_data, size_t *out_len) {
+    if (!list || !out_data || !out_len) return LUMI_ERR_INVALID;
+
+    size_t len = DL_HEADER + list->count * DL_OP_SIZE + list->str_len;
+    uint8_t *buf = malloc(len);
+    if (!buf) return LUMI_ERR_NOMEM;
+
+    uint8_t *p = buf;
+    memcpy(p, DL_MAGIC, 4); p += 4;
+    *p++ = DL_VERSION & 0xFF; *p++ = DL_VERSION >> 8;
+    *p++ = 0; *p++ = 0;
+    p = put_u32(p, (uint32_t)list->count);
+    p = put_u32(p, (uint32_t)list->str_len);
+
+    for (size_t i = 0; i < list->count; i++) {
+        const dl_op_t *op = &list->ops[i];
+        *p++ = op->type; *p++ = 0; *p++ = 0; *p++ = 0;
+        p = put_f32(p, op->x);
+        p = put_f32(p, op->y);
+        p = put_f32(p, op->w);
+        p = put_f32(p, op->h);
+        p = put_u32(p, op->color);
+        p = put_f32(p, op->radius);
+        p = put_f32(p, op->font_size);
+        p = put_u32(p, op->str);
+    }
+    if (list->str_len) memcpy(p, list->strings, list->str_len);
+
+    *out_data = buf;
+    *out_len  = len;
+    return LUMI_OK;
+}
+
+lumi_result_t lumi_display_list_deserialize(lumi_display_list_t *list,
+                                            const uint8_t *data, size_t len) {
+    if (!list || !data) return LUMI_ERR_INVALID;
+    if (len < DL_HEADER || memcmp(data, DL_MAGIC, 4) != 0) return LUMI_ERR_INVALID;
+    if ((data[4] | (data[5] << 8)) != DL_VERSION) return LUMI_ERR_INVALID;
+
+    uint32_t count   = get_u32(data + 8);
+    uint32_t str_len = get_u32(data + 12);
+    if ((len - DL_HEADER) / DL_OP_SIZE < count) return LUMI_ERR_INVALID;
+    if (len - DL_HEADER - (size_t)count * DL_OP_SIZE != str_len) return LUMI_ERR_INVALID;
+
+    const uint8_t *strings = data + DL_HEADER + (size_t)count * DL_OP_SIZE;
+    if (str_len && strings[str_len - 1] != '\0') return LUMI_ERR_INVALID;
+
+    lumi_display_list_clear(list);
+    if (!reserve_ops(list, count) || !reserve_strings(list, str_len)) {
+        return LUMI_ERR_NOMEM;
+    }
+
+    const uint8_t *p = data + DL_HEADER;
+    for (uint32_t i = 0; i < count; i++, p += DL_OP_SIZE) {
+        dl_op_t *op = &list->ops[i];
+        op->type      = p[0];
+        op->x         = get_f32(p + 4);
+        op->y         = get_f32(p + 8);
+        op->w         = get_f32(p + 12);
+        op->h         = get_f32(p + 16);
+        op->color     = get_u32(p + 20);
+        op->radius    = get_f32(p + 24);
+        op->font_size = get_f32(p + 28);
+        op->str       = get_u32(p + 32);
+        if (op->type > LUMI_DRAW_CLIP_POP) return LUMI_ERR_INVALID;
+        if (op->str != NO_STRING && op->str >= str_len) return LUMI_ERR_INVALID;
+    }
+    if (str_len) memcpy(list->strings, strings, str_len);
+    list->count   = count;
+    list->str_len = str_len;
+    return LUMI_OK;
+}
+
+/* ── Recording ─────────────────────────────────────────────────── */
+
+static bool record_view(const view_pack_t *p, view_node_t n, lumi_display_list_t *out,
+                        float ox, float oy, float alpha);
+
+/* Scales the alpha byte of an RGBA color. */
+static uint32_t fade(uint32_t rgba, float alpha) {
+    if (alpha >= 1.0f) return rgba;
+    uint32_t a = (uint32_t)((float)(rgba & 0xFF) * alpha + 0.5f);
+    return (rgba & 0xFFFFFF00u) | a;
+}
+
+/* Draws one node's own content; (x, y, w, h) is its absolute frame and
+ * alpha the opacity it is drawn with, its own included. */
+static bool record_box(lumi_display_list_t *out, lumi_view_type_t type,
+                       const lumi_style_desc_t *st, const char *text,
+                       float x, float y, float w, float h, float alpha) {
+    dl_op_t *op;
+    float cx = x + st->padding[3], cy = y + st->padding[0];
+    float cw = w - st->padding[3] - st->padding[1];
+    float ch = h - st->padding[0] - st->padding[2];
+
+    if (st->background & 0xFF) {
+        op = push_op(out, LUMI_DRAW_RECT, x, y, w, h);
+        if (!op) return false;
+        op->color  = fade(st->background, alpha);
+        op->radius = st->border_radius;
+    }
+
+    switch (type) {
+        case LUMI_VIEW_TEXT:
+        case LUMI_VIEW_BUTTON:
+        case LUMI_VIEW_TEXT_FIELD:
+            if (!text || !text[0]) break;
+            op = push_op(out, LUMI_DRAW_TEXT, cx, cy, cw, ch);
+            if (!op || !add_string(out, text, &op->str)) return false;
+            op->color     = fade(st->foreground, alpha);
+            op->font_size = st->font_size;
+            break;
+        case LUMI_VIEW_IMAGE:
+            if (!text || !text[0]) break;
+            op = push_op(out, LUMI_DRAW_IMAGE, cx, cy, cw, ch);
+            if (!op || !add_string(out, text, &op->str)) return false;
+            op->color  = fade(0xFFFFFFFF, alpha);
+            op->radius = st->border_radius;
+            break;
+        case LUMI_VIEW_DIVIDER:
+            if (st->background & 0xFF) break;
+            op = push_op(out, LUMI_DRAW_RECT, x, y, w, h);
+            if (!op) return false;
+            op->color = fade(0xE0E0E0FF, alpha);
+            break;
+        default:
+            break;
+    }
+    return true;
+}
+
+static bool record_subtree(const view_pack_t *p, view_node_t n, lumi_display_list_t *out,
+                           float x, float y, float alpha) {
+    lumi_view_type_t type = view_node_type(p, n);
+    float w = view_node_w(p, n), h = view_node_h(p, n);
+    bool clip = type == LUMI_VIEW_SCROLL;
+
+    if (!record_box(out, type, view_node_style(p, n), view_node_text(p, n), x, y, w, h, alpha)) {
+        return false;
+    }
+    if (clip && !push_op(out, LUMI_DRAW_CLIP_PUSH, x, y, w, h)) return false;
+
+    float cx = x - (clip ? view_node_view(p, n)->scroll_x : 0.0f);
+    float cy = y - (clip ? view_node_view(p, n)->scroll_y : 0.0f);
+    for (view_node_t c = view_node_first_child(p, n); view_node_more(p, n, c);
+         c = view_node_next(p, n, c)) {
+        if (!record_view(p, c, out, cx, cy, alpha)) return false;
+    }
+
+    if (clip && !push_op(out, LUMI_DRAW_CLIP_POP, 0, 0, 0, 0)) return false;
+    return true;
+}
+
+/* (ox, oy) is the absolute origin of n's parent, alpha its opacity.
+ * Fully transparent subtrees record nothing. A pack walk leaves
+ * paint_dirty set on plain views: it is only ever read on boundaries,
+ * and clearing it would mean writing to every view. */
+static bool record_view(const view_pack_t *p, view_node_t n, lumi_display_list_t *out,
+                        float ox, float oy, float alpha) {
+    if (!view_node_visible(p, n)) return true;
+
+    float x = ox + view_node_x(p, n), y = oy + view_node_y(p, n);
+    float a = alpha * view_node_style(p, n)->opacity;
+    if (a <= 0.0f) return true;
+
+    if (!view_node_boundary(p, n)) {
+        if (!p) n.view->paint_dirty = false;
+        return record_subtree(p, n, out, x, y, a);
+    }
+
+    lumi_view_t *v = view_node_view(p, n);
+    if (v->paint_dirty || !v->paint_cache || v->cache_epoch != view_style_epoch ||
+        v->cache_alpha != alpha) {
+        if (!v->paint_cache && !(v->paint_cache = lumi_display_list_create())) return false;
+        lumi_display_list_clear(v->paint_cache);
+        if (!record_subtree(p, n, v->paint_cache, x, y, a)) return false;
+        v->cache_x = x;
+        v->cache_y = y;
+        v->cache_alpha = alpha;
+        v->cache_epoch = view_style_epoch;
+        v->paint_dirty = false;
+    }
+    return splice(out, v->paint_cache, x - v->cache_x, y - v->cache_y);
+}
+
+/* A packed root is recorded from its arrays; see view_node_t. */
+lumi_result_t lumi_view_paint(lumi_view_t *root, lumi_display_list_t *out) {
+    if (!root || !out) return LUMI_ERR_INVALID;
+    trace_begin("view.paint");
+    lumi_display_list_clear(out);
+
+    view_pack_t *pack = view_pack_prepare(root);
+    bool ok = record_view(pack, view_node_root(pack, root), out, 0.0f, 0.0f, 1.0f);
+    trace_end();
+    return ok ? LUMI_OK : LUMI_ERR_NOMEM;
+}
+
+void lumi_view_set_repaint_boundary(lumi_view_t *view, bool boundary) {
+    if (!view) return;
+    view->repaint_boundary = boundary;
+    view_pack_sync(view);
+    if (!boundary) {
+        lumi_display_list_destroy(view->paint_cache);
+        view->paint_cache = NULL;
+    }
+}
@@ -0,0 +1,285 @@
+/**
+ * reconcile.c — Keyed diffing of view trees
+ * Copyright 2026 Lumi Team. Apache-2.0
+ *
+ * Patches a mounted tree so it matches a freshly built one, keeping the
+ * mounted nodes (and their caches) wherever possible. Children are
+ * matched by id; children without an id are matched in order with the
+ * next unkeyed old child of the same type. Matched children that keep
+ * their relative order (longest increasing subsequence of old indices)
+ * are left in place, all others are reported as moves.
+ */
+
+#include "view_internal.h"
+#include "trace.h"
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct {
+    lumi_mutation_cb cb;
+    void *userdata;
+} reconcile_ctx_t;
+
+static void report(const reconcile_ctx_t *ctx, lumi_mutation_type_t type,
+                   lumi_view_t *view, lumi_view_t *parent, int index, uint32_t changed) {
+    if (!ctx->cb) return;
+    lumi_mutation_t m = {
+        .type    = type,
+        .view    = view,
+        .parent  = parent,
+        .index   = index,
+        .changed = changed,
+    };
+    ctx->cb(&m, ctx->userdata);
+}
+
+static bool str_eq(const char *a, const char *b) {
+    if (!a || !b) return a == b;
+    return strcmp(a, b) == 0;
+}
+
+static bool compatible(const lumi_view_t *a, const lumi_view_t *b) {
+    return a->type == b->type && str_eq(a->id, b->id);
+}
+
+/* Copies b's properties into a; returns the LUMI_PROP_* bits that changed. */
+static uint32_t patch_props(lumi_view_t *a, lumi_view_t *b) {
+    uint32_t changed = 0;
+
+    if (!str_eq(a->text, b->text)) {
+        view_free_string(a, a->text);
+        a->text = b->text ? mem_strdup(LUMI_MEM_STRINGS, b->text) : NULL;
+        view_pack_sync(a);
+        changed |= LUMI_PROP_TEXT;
+    }
+    if (a->visible != b->visible) {
+        a->visible = b->visible;
+        view_pack_sync(a);
+        view_invalidate_hits(a->parent);
+        changed |= LUMI_PROP_VISIBLE;
+    }
+    if (a->style != b->style || a->rule != b->rule || a->override_mask != b->override_mask) {
+        if (a->style != b->style) changed |= view_style_diff(view_style(a), view_style(b));
+        view_style_adopt(a, b);
+    }
+    if (a->on_click_cb != b->on_click_cb || a->on_click_data != b->on_click_data ||
+        a->on_long_click_cb != b->on_long_click_cb || a->on_long_click_data != b->on_long_click_data ||
+        a->on_text_change_cb != b->on_text_change_cb || a->on_text_change_data != b->on_text_change_data) {
+        a->on_click_cb = b->on_click_cb;
+        a->on_click_data = b->on_click_data;
+        a->on_long_click_cb = b->on_long_click_cb;
+        a->on_long_click_data = b->on_long_click_data;
+        a->on_text_change_cb = b->on_text_change_cb;
+        a->on_text_change_data = b->on_text_change_data;
+        changed |= LUMI_PROP_HANDLERS;
+    }
+    if (a->repaint_boundary != b->repaint_boundary) {
+        lumi_view_set_repaint_boundary(a, b->repaint_boundary);
+    }
+
+    if (changed & ~LUMI_PROP_HANDLERS) view_invalidate(a);
+    return changed;
+}
+
+/* ── Child matching ────────────────────────────────────────────── */
+
+static const lumi_view_t *const *g_sort_children;
+
+static int cmp_by_id(const void *pa, const void *pb) {
+    int a = *(const int *)pa, b = *(const int *)pb;
+    int c = strcmp(g_sort_children[a]->id, g_sort_children[b]->id);
+    return c ? c : a - b;
+}
+
+/* For each new child, the index of the old child it reuses, or -1. */
+static void match_children(const lumi_view_t *old, const lumi_view_t *next, int *match) {
+    int keyed[MAX_CHILDREN], nkeyed = 0;
+    bool used[MAX_CHILDREN] = { false };
+
+    for (int i = 0; i < old->child_count; i++) {
+        if (old->children[i]->id) keyed[nkeyed++] = i;
+    }
+    g_sort_children = (const lumi_view_t *const *)old->children;
+    qsort(keyed, (size_t)nkeyed, sizeof(int), cmp_by_id);
+
+    int unkeyed_cursor = 0;
+    for (int j = 0; j < next->child_count; j++) {
+        const lumi_view_t *n = next->children[j];
+        match[j] = -1;
+
+        if (n->id) {
+            int lo = 0, hi = nkeyed;
+            while (lo < hi) {
+                int mid = (lo + hi) / 2;
+                if (strcmp(old->children[keyed[mid]]->id, n->id) < 0) lo = mid + 1;
+                else hi = mid;
+            }
+            for (; lo < nkeyed && strcmp(old->children[keyed[lo]]->id, n->id) == 0; lo++) {
+                int i = keyed[lo];
+                if (!used[i] && old->children[i]->type == n->type) {
+                    match[j] = i;
+                    used[i] = true;
+                    break;
+                }
+            }
+            continue;
+        }
+
+        /* Old children skipped here stay available to later new children */
+        for (int i = unkeyed_cursor; i < old->child_count; i++) {
+            if (!used[i] && !old->children[i]->id && old->children[i]->type == n->type) {
+                match[j] = i;
+                used[i] = true;
+                break;
+            }
+        }
+        while (unkeyed_cursor < old->child_count &&
+               (used[unkeyed_cursor] || old->children[unkeyed_cursor]->id)) {
+            unkeyed_cursor++;
+        }
+    }
+}
+
+/* Marks in stay[] the new positions whose old index is part of a longest
+ * increasing subsequence; those children need no move. */
+static void mark_stable(const int *match, int n, bool *stay) {
+    int tails[MAX_CHILDREN], tail_pos[MAX_CHILDREN], prev[MAX_CHILDREN];
+    int len = 0;
+
+    for (int j = 0; j < n; j++) {
+        stay[j] = false;
+        prev[j] = -1;
+        if (match[j] < 0) continue;
+
+        int lo = 0, hi = len;
+        while (lo < hi) {
+            int mid = (lo + hi) / 2;
+            if (tails[mid] < match[j]) lo = mid + 1;
+            else hi = mid;
+        }
+        tails[lo] = match[j];
+        tail_pos[lo] = j;
+        if (lo > 0) prev[j] = tail_pos[lo - 1];
+        if (lo == len) len++;
+    }
+    for (int j = len ? tail_pos[len - 1] : -1; j >= 0; j = prev[j]) stay[j] = true;
+}
+
+/* ── Tree diff ─────────────────────────────────────────────────── */
+
+static void reconcile_node(lumi_view_t *old, lumi_view_t *next, int index,
+                           const reconcile_ctx_t *ctx);
+
+/* Frees a node of the new tree whose children were all taken over. */
+static void discard_shell(lumi_view_t *v) {
+    v->child_count = 0;
+    view_ids_detaching(v);
+    v->parent = NULL;
+    lumi_view_destroy(v);
+}
+
+static void reconcile_children(lumi_view_t *old, lumi_view_t *next, const reconcile_ctx_t *ctx) {
+    int match[MAX_CHILDREN];
+    bool stay[MAX_CHILDREN], kept[MAX_CHILDREN] = { false };
+    lumi_view_t *result[MAX_CHILDREN];
+    int n = next->child_count;
+    bool structural = n != old->child_count;
+
+    match_children(old, next, match);
+    mark_stable(match, n, stay);
+    for (int j = 0; j < n; j++) {
+        if (match[j] >= 0) kept[match[j]] = true;
+    }
+
+    /* Removals first, so indices reported afterwards are final positions */
+    for (int i = old->child_count - 1; i >= 0; i--) {
+        if (kept[i]) continue;
+        lumi_view_t *gone = old->children[i];
+        report(ctx, LUMI_MUTATION_REMOVE, gone, old, i, 0);
+        view_ids_detaching(gone);
+        gone->parent = NULL;
+        lumi_view_destroy(gone);
+        structural = true;
+    }
+
+    for (int j = 0; j < n; j++) {
+        lumi_view_t *nc = next->children[j];
+        if (match[j] < 0) {
+            view_ids_detaching(nc);
+            nc->parent = old;
+            view_ids_attached(nc);
+            view_pack_attached(nc);
+            result[j] = nc;
+            report(ctx, LUMI_MUTATION_INSERT, nc, old, j, 0);
+            structural = true;
+            continue;
+        }
+
+        lumi_view_t *oc = old->children[match[j]];
+        result[j] = oc;
+        if (!stay[j]) {
+            report(ctx, LUMI_MUTATION_MOVE, oc, old, j, 0);
+            structural = true;
+        }
+        reconcile_node(oc, nc, j, ctx);
+        discard_shell(nc);
+    }
+
+    memcpy(old->children, result, (size_t)n * sizeof(lumi_view_t *));
+    old->child_count = n;
+    next->child_count = 0;
+    if (structural) {
+        view_pack_restructure(old);
+        view_invalidate(old);
+        view_invalidate_hits(old);
+    }
+}
+
+static void reconcile_node(lumi_view_t *old, lumi_view_t *next, int index,
+                           const reconcile_ctx_t *ctx) {
+    uint32_t changed = patch_props(old, next);
+    if (changed) report(ctx, LUMI_MUTATION_UPDATE, old, old->parent, index, changed);
+    reconcile_children(old, next, ctx);
+}
+
+static lumi_view_t *reconcile_root(lumi_view_t *mounted, lumi_view_t *next,
+                                   lumi_mutation_cb cb, void *userdata) {
+    reconcile_ctx_t ctx = { cb, userdata };
+
+    if (!mounted) return next;
+    if (!next || next == mounted || next->parent) return mounted;
+
+    lumi_view_t *parent = mounted->parent;
+    int index = -1;
+    for (int i = 0; parent && i < parent->child_count; i++) {
+        if (parent->children[i] == mounted) { index = i; break; }
+    }
+
+    if (!compatible(mounted, next)) {
+        report(&ctx, LUMI_MUTATION_REPLACE, next, parent, index, 0);
+        if (parent) {
+            view_ids_detaching(mounted);
+            parent->children[index] = next;
+            next->parent = parent;
+            view_ids_attached(next);
+            view_pack_attached(next);
+            view_invalidate(parent);
+            view_invalidate_hits(parent);
+        }
+        mounted->parent = NULL;
+        lumi_view_destroy(mounted);
+        return next;
+    }
+
+    reconcile_node(mounted, next, index, &ctx);
+    discard_shell(next);
+    return mounted;
+}
+
+lumi_view_t *lumi_view_reconcile(lumi_view_t *mounted, lumi_view_t *next,
+                                 lumi_mutation_cb cb, void *userdata) {
+    trace_begin("view.reconcile");
+    lumi_view_t *root = reconcile_root(mounted, next, cb, userdata);
+    trace_end();
+    return root;
+}
@@ -0,0 +1,321 @@
+/**
+ * snapshot.c — Flat binary snapshots of view trees
+ * Copyright 2026 Lumi Team. Apache-2.0
+ *
+ * A snapshot holds a tree in pre-order with each node's child count, so
+ * the loader rebuilds it in one pass with an explicit stack. Styles are
+ * interned, so each distinct style is written once and nodes refer to it
+ * by index. Loading makes a single allocation for all nodes and strings
+ * (see view_arena_t) and interns each distinct style once.
+ */
+
+#include "view_internal.h"
+#include "metrics.h"
+#include "wire.h"
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * Layout (all integers little-endian, floats as IEEE-754 bit patterns):
+ *   "LMVT" | u16 version | u16 reserved | u32 node_count | u32 style_count
+ *          | u32 string_bytes
+ *   style_count x { f32 width, height, padding[4], margin[4],
+ *                   u32 background, foreground, f32 font_size, border_radius,
+ *                   opacity }
+ *   node_count x { u8 type, u8 flags, u16 child_count,
+ *                  u32 style_index, u32 id_offset, u32 text_offset }
+ *   string_bytes of NUL-terminated strings
+ */
+
+#define VT_MAGIC      "LMVT"
+#define VT_VERSION    2
+#define VT_HEADER     20
+#define VT_STYLE_SIZE 60
+#define VT_NODE_SIZE  16
+
+#define VT_VISIBLE    0x01
+#define VT_BOUNDARY   0x02
+
+#define NO_STRING UINT32_MAX
+
+/* ── Writing ───────────────────────────────────────────────────── */
+
+/* Open-addressed map from interned style pointer to its table index. */
+typedef struct {
+    const lumi_style_t **keys;
+    uint32_t *index;
+    size_t mask;
+    uint32_t count;
+} style_map_t;
+
+typedef struct {
+    style_map_t styles;
+    size_t nodes;
+    size_t str_len;
+    uint8_t *out;
+    char *str_out;
+    size_t str_pos;
+} writer_t;
+
+static uint32_t style_index(style_map_t *m, const lumi_style_t *s) {
+    size_t i = (((uintptr_t)s >> 4) * 0x9E3779B1u) & m->mask;
+    while (m->keys[i] && m->keys[i] != s) i = (i + 1) & m->mask;
+    if (!m->keys[i]) {
+        m->keys[i]  = s;
+        m->index[i] = m->count++;
+    }
+    return m->index[i];
+}
+
+static size_t count_nodes(lumi_view_t *v) {
+    size_t n = 1;
+    for (int i = 0; i < v->child_count; i++) n += count_nodes(v->children[i]);
+    return n;
+}
+
+/* Numbers the distinct styles in pre-order and sizes the string blob. */
+static void scan_tree(writer_t *w, lumi_view_t *v) {
+    style_index(&w->styles, v->style);
+    if (v->id)   w->str_len += strlen(v->id) + 1;
+    if (v->text) w->str_len += strlen(v->text) + 1;
+    for (int i = 0; i < v->child_count; i++) scan_tree(w, v->children[i]);
+}
+
+static uint32_t put_string(writer_t *w, const char *s) {
+    if (!s) return NO_STRING;
+    size_t n = strlen(s) + 1;
+    uint32_t off = (uint32_t)w->str_pos;
+    memcpy(w->str_out + off, s, n);
+    w->str_pos += n;
+    return off;
+}
+
+static void put_style(uint8_t *p, const lumi_style_desc_t *d) {
+    p = put_f32(p, d->width);
+    p = put_f32(p, d->height);
+    for (int i = 0; i < 4; i++) p = put_f32(p, d->padding[i]);
+    for (int i = 0; i < 4; i++) p = put_f32(p, d->margin[i]);
+    p = put_u32(p, d->background);
+    p = put_u32(p, d->foreground);
+    p = put_f32(p, d->font_size);
+    p = put_f32(p, d->border_radius);
+    put_f32(p, d->opacity);
+}
+
+static void write_tree(writer_t *w, lumi_view_t *v) {
+    uint8_t *p = w->out;
+    w->out += VT_NODE_SIZE;
+
+    *p++ = (uint8_t)v->type;
+    *p++ = (v->visible ? VT_VISIBLE : 0) | (v->repaint_boundary ? VT_BOUNDARY : 0);
+    p = put_u16(p, (uint16_t)v->child_count);
+    p = put_u32(p, style_index(&w->styles, v->style));
+    p = put_u32(p, put_string(w, v->id));
+    put_u32(p, put_string(w, v->text));
+
+    for (int i = 0; i < v->child_count; i++) write_tree(w, v->children[i]);
+}
+
+/* Resolves class-bound styles so the snapshot records what is shown. */
+static void resolve_tree(lumi_view_t *v) {
+    view_style(v);
+    for (int i = 0; i < v->child_count; i++) resolve_tree(v->children[i]);
+}
+
+lumi_result_t lumi_view_serialize(lumi_view_t *root, uint8_t **out_data, size_t *out_len) {
+    if (!root || !out_data || !out_len) return LUMI_ERR_INVALID;
+
+    resolve_tree(root);
+    writer_t w = { .nodes = count_nodes(root) };
+    if (w.nodes > UINT32_MAX / 2) return LUMI_ERR_INVALID;
+
+    size_t cap = 16;
+    while (cap < w.nodes * 2) cap <<= 1;
+    w.styles.mask  = cap - 1;
+    w.styles.keys  = calloc(cap, sizeof(*w.styles.keys));
+    w.styles.index = malloc(cap * sizeof(*w.styles.index));
+    if (!w.styles.keys || !w.styles.index) {
+        free(w.styles.keys);
+        free(w.styles.index);
+        return LUMI_ERR_NOMEM;
+    }
+    scan_tree(&w, root);
+
+    size_t style_bytes = (size_t)w.styles.count * VT_STYLE_SIZE;
+    size_t len = VT_HEADER + style_bytes + w.nodes * VT_NODE_SIZE + w.str_len;
+    uint8_t *buf = w.str_len < NO_STRING ? malloc(len) : NULL;
+    if (!buf) {
+        free(w.styles.keys);
+        free(w.styles.index);
+        return w.str_len < NO_STRING ? LUMI_ERR_NOMEM : LUMI_ERR_INVALID;
+    }
+
+    uint8_t *p = buf;
+    memcpy(p, VT_MAGIC, 4); p += 4;
+    p = put_u16(p, VT_VERSION);
+    p = put_u16(p, 0);
+    p = put_u32(p, (uint32_t)w.nodes);
+    p = put_u32(p, w.styles.count);
+    p = put_u32(p, (uint32_t)w.str_len);
+
+    for (size_t i = 0; i <= w.styles.mask; i++) {
+        if (w.styles.keys[i]) {
+            put_style(p + (size_t)w.styles.index[i] * VT_STYLE_SIZE, &w.styles.keys[i]->desc);
+        }
+    }
+    w.out     = p + style_bytes;
+    w.str_out = (char *)w.out + w.nodes * VT_NODE_SIZE;
+    write_tree(&w, root);
+
+    free(w.styles.keys);
+    free(w.styles.index);
+    *out_data = buf;
+    *out_len  = len;
+    return LUMI_OK;
+}
+
+/* ── Loading ───────────────────────────────────────────────────── */
+
+void view_arena_release(view_arena_t *arena) {
+    if (--arena->live == 0) mem_free(LUMI_MEM_VIEWS, arena, arena->size);
+}
+
+static void read_style(const uint8_t *p, lumi_style_desc_t *d) {
+    d->width  = get_f32(p);
+    d->height = get_f32(p + 4);
+    for (int i = 0; i < 4; i++) d->padding[i] = get_f32(p + 8 + 4 * i);
+    for (int i = 0; i < 4; i++) d->margin[i]  = get_f32(p + 24 + 4 * i);
+    d->background    = get_u32(p + 40);
+    d->foreground    = get_u32(p + 44);
+    d->font_size     = get_f32(p + 48);
+    d->border_radius = get_f32(p + 52);
+    d->opacity       = get_f32(p + 56);
+}
+
+/* An interior node whose children are still being read. */
+typedef struct {
+    lumi_view_t *view;
+    uint32_t pending;
+} open_node_t;
+
+/* Checks every record and that the child counts describe exactly one
+ * tree, so that building it afterwards cannot fail half-way. */
+static bool validate(const uint8_t *nodes, uint32_t count, uint32_t styles,
+                     uint32_t str_len, open_node_t *stack) {
+    int top = -1;
+    for (uint32_t i = 0; i < count; i++) {
+        const uint8_t *p = nodes + (size_t)i * VT_NODE_SIZE;
+        uint16_t children = get_u16(p + 2);
+        uint32_t id = get_u32(p + 8), text = get_u32(p + 12);
+
+        if (p[0] > LUMI_VIEW_CUSTOM || children > MAX_CHILDREN) return false;
+        if (get_u32(p + 4) >= styles) return false;
+        if (id != NO_STRING && id >= str_len) return false;
+        if (text != NO_STRING && text >= str_len) return false;
+
+        if (i > 0) {
+            if (top < 0) return false;              /* a second root */
+            if (--stack[top].pending == 0) top--;
+        }
+        if (children) stack[++top].pending = children;
+    }
+    return top < 0;
+}
+
+lumi_result_t lumi_view_deserialize(const uint8_t *data, size_t len, lumi_view_t **out_root) {
+    if (!data || !out_root) return LUMI_ERR_INVALID;
+    if (len < VT_HEADER || memcmp(data, VT_MAGIC, 4) != 0) return LUMI_ERR_INVALID;
+    if (get_u16(data + 4) != VT_VERSION) return LUMI_ERR_INVALID;
+
+    uint32_t count   = get_u32(data + 8);
+    uint32_t nstyles = get_u32(data + 12);
+    uint32_t str_len = get_u32(data + 16);
+    if (count == 0 || nstyles == 0 || nstyles > count) return LUMI_ERR_INVALID;
+
+    size_t body = len - VT_HEADER;
+    if (body / VT_STYLE_SIZE < nstyles) return LUMI_ERR_INVALID;
+    body -= (size_t)nstyles * VT_STYLE_SIZE;
+    if (body / VT_NODE_SIZE < count) return LUMI_ERR_INVALID;
+    body -= (size_t)count * VT_NODE_SIZE;
+    if (body != str_len) return LUMI_ERR_INVALID;
+
+    const uint8_t *style_rec = data + VT_HEADER;
+    const uint8_t *node_rec  = style_rec + (size_t)nstyles * VT_STYLE_SIZE;
+    const char    *strings   = (const char *)node_rec + (size_t)count * VT_NODE_SIZE;
+    if (str_len && strings[str_len - 1] != '\0') return LUMI_ERR_INVALID;
+
+    open_node_t *stack = malloc((size_t)count * sizeof(*stack));
+    const lumi_style_t **styles = calloc(nstyles, sizeof(*styles));
+    if (!stack || !styles) {
+        free(stack);
+        free(styles);
+        return LUMI_ERR_NOMEM;
+    }
+    if (!validate(node_rec, count, nstyles, str_len, stack)) {
+        free(stack);
+        free(styles);
+        return LUMI_ERR_INVALID;
+    }
+
+    view_arena_t *arena = NULL;
+    size_t arena_size = 0;
+    if ((SIZE_MAX - sizeof(*arena) - str_len) / sizeof(lumi_view_t) >= count) {
+        arena_size = sizeof(*arena) + (size_t)count * sizeof(lumi_view_t) + str_len;
+        arena = mem_alloc(LUMI_MEM_VIEWS, arena_size);
+    }
+    bool ok = arena != NULL;
+    for (uint32_t i = 0; ok && i < nstyles; i++) {
+        lumi_style_desc_t d;
+        read_style(style_rec + (size_t)i * VT_STYLE_SIZE, &d);
+        ok = (styles[i] = lumi_style_intern(&d)) != NULL;
+    }
+    if (!ok) {
+        for (uint32_t i = 0; i < nstyles; i++) lumi_style_release(styles[i]);
+        free(styles);
+        free(stack);
+        mem_free(LUMI_MEM_VIEWS, arena, arena_size);
+        return LUMI_ERR_NOMEM;
+    }
+
+    char *own = (char *)(arena->nodes + count);
+    memcpy(own, strings, str_len);
+    arena->size    = arena_size;
+    arena->live    = count;
+    arena->strings = own;
+    arena->str_len = str_len;
+    memset(arena->nodes, 0, (size_t)count * sizeof(lumi_view_t));
+    metric_gauge_add(METRIC_VIEW_NODES, count);
+
+    /* Pre-order: each node is the next child of the innermost open node. */
+    int top = -1;
+    for (uint32_t i = 0; i < count; i++) {
+        const uint8_t *p = node_rec + (size_t)i * VT_NODE_SIZE;
+        lumi_view_t *v = &arena->nodes[i];
+        uint16_t children = get_u16(p + 2);
+        uint32_t id = get_u32(p + 8), text = get_u32(p + 12);
+
+        v->type             = (lumi_view_type_t)p[0];
+        v->visible          = (p[1] & VT_VISIBLE) != 0;
+        v->repaint_boundary = (p[1] & VT_BOUNDARY) != 0;
+        v->style            = lumi_style_retain(styles[get_u32(p + 4)]);
+        v->id               = id   != NO_STRING ? own + id   : NULL;
+        v->text             = text != NO_STRING ? own + text : NULL;
+        v->paint_dirty      = true;
+        v->hit_dirty        = true;
+        v->arena            = arena;
+
+        if (top >= 0) {
+            lumi_view_t *parent = stack[top].view;
+            parent->children[parent->child_count++] = v;
+            v->parent = parent;
+            if (--stack[top].pending == 0) top--;
+        }
+        if (children) stack[++top] = (open_node_t){ v, children };
+    }
+
+    for (uint32_t i = 0; i < nstyles; i++) lumi_style_release(styles[i]);
+    free(styles);
+    free(stack);
+    *out_root = &arena->nodes[0];
+    return LUMI_OK;
+}
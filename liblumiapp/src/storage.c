@@ -3,7 +3,9 @@
  * Copyright 2026 Lumi Team. Apache-2.0
  */
 
-#include "lumiapp.h"
+#include "mem.h"
+#include "metrics.h"
+#include "trace.h"
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
@@ -18,6 +20,10 @@ typedef struct {
 static kv_entry_t g_store[MAX_ENTRIES];
 static int g_store_count = 0;
 
+static int64_t entry_bytes(const kv_entry_t *e) {
+    return (int64_t)(strlen(e->key) + (e->value ? strlen(e->value) : 0));
+}
+
 static int find_key(const char *key) {
     for (int i = 0; i < g_store_count; i++) {
         if (g_store[i].key && strcmp(g_store[i].key, key) == 0) {
@@ -27,42 +33,54 @@ static int find_key(const char *key) {
     return -1;
 }
 
-lumi_result_t lumi_storage_set(const char *key, const char *value) {
+static lumi_result_t storage_set(const char *key, const char *value) {
     if (!key || !value) return LUMI_ERR_INVALID;
 
     int idx = find_key(key);
     if (idx >= 0) {
-        free(g_store[idx].value);
-        g_store[idx].value = strdup(value);
-        return g_store[idx].value ? LUMI_OK : LUMI_ERR_NOMEM;
+        /* Copy first, so a refused copy leaves the old value in place */
+        char *copy = mem_strdup(LUMI_MEM_STORAGE, value);
+        if (!copy) return LUMI_ERR_NOMEM;
+        metric_gauge_add(METRIC_STORAGE_BYTES, -entry_bytes(&g_store[idx]));
+        mem_free_str(LUMI_MEM_STORAGE, g_store[idx].value);
+        g_store[idx].value = copy;
+        metric_gauge_add(METRIC_STORAGE_BYTES, entry_bytes(&g_store[idx]));
+        return LUMI_OK;
     }
 
     if (g_store_count >= MAX_ENTRIES) return LUMI_ERR_NOMEM;
 
-    g_store[g_store_count].key   = strdup(key);
-    g_store[g_store_count].value = strdup(value);
+    g_store[g_store_count].key   = mem_strdup(LUMI_MEM_STORAGE, key);
+    g_store[g_store_count].value = mem_strdup(LUMI_MEM_STORAGE, value);
     if (!g_store[g_store_count].key || !g_store[g_store_count].value) {
-        free(g_store[g_store_count].key);
-        free(g_store[g_store_count].value);
+        mem_free_str(LUMI_MEM_STORAGE, g_store[g_store_count].key);
+        mem_free_str(LUMI_MEM_STORAGE, g_store[g_store_count].value);
         return LUMI_ERR_NOMEM;
     }
+    metric_gauge_add(METRIC_STORAGE_ENTRIES, 1);
+    metric_gauge_add(METRIC_STORAGE_BYTES, entry_bytes(&g_store[g_store_count]));
     g_store_count++;
     return LUMI_OK;
 }
 
 const char *lumi_storage_get(const char *key) {
     if (!key) return NULL;
+    trace_begin("storage.get");
     int idx = find_key(key);
+    trace_end();
+    metric_add(idx >= 0 ? METRIC_STORAGE_HITS : METRIC_STORAGE_MISSES, 1);
     return (idx >= 0) ? g_store[idx].value : NULL;
 }
 
-lumi_result_t lumi_storage_remove(const char *key) {
+static lumi_result_t storage_remove(const char *key) {
     if (!key) return LUMI_ERR_INVALID;
     int idx = find_key(key);
     if (idx < 0) return LUMI_ERR_NOT_FOUND;
 
-    free(g_store[idx].key);
-    free(g_store[idx].value);
+    metric_gauge_add(METRIC_STORAGE_ENTRIES, -1);
+    metric_gauge_add(METRIC_STORAGE_BYTES, -entry_bytes(&g_store[idx]));
+    mem_free_str(LUMI_MEM_STORAGE, g_store[idx].key);
+    mem_free_str(LUMI_MEM_STORAGE, g_store[idx].value);
 
     for (int i = idx; i < g_store_count - 1; i++) {
         g_store[i] = g_store[i + 1];
@@ -71,11 +89,36 @@ lumi_result_t lumi_storage_remove(const char *key) {
     return LUMI_OK;
 }
 
-lumi_result_t lumi_storage_clear(void) {
+static lumi_result_t storage_clear(void) {
     for (int i = 0; i < g_store_count; i++) {
-        free(g_store[i].key);
-        free(g_store[i].value);
+        metric_gauge_add(METRIC_STORAGE_ENTRIES, -1);
+        metric_gauge_add(METRIC_STORAGE_BYTES, -entry_bytes(&g_store[i]));
+        mem_free_str(LUMI_MEM_STORAGE, g_store[i].key);
+        mem_free_str(LUMI_MEM_STORAGE, g_store[i].value);
     }
     g_store_count = 0;
     return LUMI_OK;
 }
+
+/* ── Public API ──────────────────────────────────────────────────── */
+
+lumi_result_t lumi_storage_set(const char *key, const char *value) {
+    trace_begin("storage.set");
+    lumi_result_t rc = storage_set(key, value);
+    trace_end();
+    return rc;
+}
+
+lumi_result_t lumi_storage_remove(const char *key) {
+    trace_begin("storage.remove");
+    lumi_result_t rc = storage_remove(key);
+    trace_end();
+    return rc;
+}
+
+lumi_result_t lumi_storage_clear(void) {
+    trace_begin("storage.clear");
+    lumi_result_t rc = storage_clear();
+    trace_end();
+    return rc;
+}
@@ -0,0 +1,307 @@
+/**
+ * style.c — Interned view styles and style sheets
+ * Copyright 2026 Lumi Team. Apache-2.0
+ *
+ * Every distinct style description exists once, in a global intern table,
+ * and is shared by all views that look alike. Styles are refcounted by the
+ * views and sheets that hold them and leave the table when the last
+ * reference goes. The default style is never freed.
+ *
+ * A view bound to a style-sheet class remembers the class rule and the
+ * rule generation it last resolved against; redefining the class only
+ * bumps the generation, and each view catches up the next time layout or
+ * paint reads its style.
+ */
+
+#include "view_internal.h"
+#include <stdlib.h>
+#include <string.h>
+
+uint32_t view_style_epoch = 0;
+
+typedef struct {
+    struct lumi_style **buckets;
+    size_t cap;                 /* power of two */
+    size_t count;
+} style_table_t;
+
+static style_table_t g_styles;
+static const lumi_style_t *g_default;
+
+struct lumi_style_sheet {
+    style_rule_t *rules;
+};
+
+static uint32_t hash_desc(const lumi_style_desc_t *d) {
+    const uint8_t *p = (const uint8_t *)d;
+    uint32_t h = 2166136261u;      /* FNV-1a */
+    for (size_t i = 0; i < sizeof(*d); i++) {
+        h ^= p[i];
+        h *= 16777619u;
+    }
+    return h;
+}
+
+static bool table_grow(void) {
+    size_t cap = g_styles.cap ? g_styles.cap * 2 : 64;
+    struct lumi_style **buckets = calloc(cap, sizeof(*buckets));
+    if (!buckets) return false;
+
+    for (size_t i = 0; i < g_styles.cap; i++) {
+        struct lumi_style *s = g_styles.buckets[i];
+        while (s) {
+            struct lumi_style *next = s->next;
+            size_t j = s->hash & (cap - 1);
+            s->next = buckets[j];
+            buckets[j] = s;
+            s = next;
+        }
+    }
+    free(g_styles.buckets);
+    g_styles.buckets = buckets;
+    g_styles.cap = cap;
+    return true;
+}
+
+void lumi_style_desc_init(lumi_style_desc_t *desc) {
+    if (!desc) return;
+    memset(desc, 0, sizeof(*desc));
+    desc->foreground = 0x000000FF;
+    desc->font_size  = 14.0f;
+    desc->opacity    = 1.0f;
+}
+
+const lumi_style_t *lumi_style_intern(const lumi_style_desc_t *desc) {
+    if (!desc) return NULL;
+
+    uint32_t h = hash_desc(desc);
+    if (g_styles.cap) {
+        for (struct lumi_style *s = g_styles.buckets[h & (g_styles.cap - 1)]; s; s = s->next) {
+            if (s->hash == h && memcmp(&s->desc, desc, sizeof(*desc)) == 0) {
+                s->refs++;
+                return s;
+            }
+        }
+    }
+
+    if (g_styles.count >= g_styles.cap && !table_grow() && !g_styles.cap) return NULL;
+
+    struct lumi_style *s = malloc(sizeof(*s));
+    if (!s) return NULL;
+    s->desc = *desc;
+    s->hash = h;
+    s->refs = 1;
+    size_t j = h & (g_styles.cap - 1);
+    s->next = g_styles.buckets[j];
+    g_styles.buckets[j] = s;
+    g_styles.count++;
+    return s;
+}
+
+const lumi_style_t *lumi_style_retain(const lumi_style_t *style) {
+    if (style) ((struct lumi_style *)style)->refs++;
+    return style;
+}
+
+void lumi_style_release(const lumi_style_t *style) {
+    struct lumi_style *s = (struct lumi_style *)style;
+    if (!s || --s->refs > 0) return;
+
+    struct lumi_style **pp = &g_styles.buckets[s->hash & (g_styles.cap - 1)];
+    while (*pp && *pp != s) pp = &(*pp)->next;
+    if (*pp) *pp = s->next;
+    g_styles.count--;
+    free(s);
+}
+
+void lumi_style_get(const lumi_style_t *style, lumi_style_desc_t *out) {
+    if (!out) return;
+    if (style) *out = style->desc;
+    else lumi_style_desc_init(out);
+}
+
+/* ── View binding ──────────────────────────────────────────────── */
+
+static const lumi_style_t *default_style(void) {
+    if (!g_default) {
+        lumi_style_desc_t d;
+        lumi_style_desc_init(&d);
+        g_default = lumi_style_intern(&d);      /* this reference is never dropped */
+    }
+    return g_default;
+}
+
+static void rule_release(style_rule_t *rule) {
+    if (!rule || --rule->refs > 0) return;
+    lumi_style_release(rule->style);
+    free(rule->name);
+    free(rule);
+}
+
+/* Points the view at style (taking a new reference); true if it changed. */
+static bool view_swap_style(lumi_view_t *v, const lumi_style_t *style) {
+    if (!style || style == v->style) return false;
+    lumi_style_retain(style);
+    lumi_style_release(v->style);
+    v->style = style;
+    view_pack_sync(v);
+    return true;
+}
+
+static void overlay(lumi_style_desc_t *d, const lumi_style_desc_t *src, uint32_t mask) {
+    if (mask & LUMI_PROP_SIZE) {
+        d->width  = src->width;
+        d->height = src->height;
+    }
+    if (mask & LUMI_PROP_PADDING)       memcpy(d->padding, src->padding, sizeof(d->padding));
+    if (mask & LUMI_PROP_MARGIN)        memcpy(d->margin, src->margin, sizeof(d->margin));
+    if (mask & LUMI_PROP_BACKGROUND)    d->background = src->background;
+    if (mask & LUMI_PROP_FOREGROUND)    d->foreground = src->foreground;
+    if (mask & LUMI_PROP_FONT_SIZE)     d->font_size = src->font_size;
+    if (mask & LUMI_PROP_BORDER_RADIUS) d->border_radius = src->border_radius;
+    if (mask & LUMI_PROP_OPACITY)       d->opacity = src->opacity;
+}
+
+uint32_t view_style_diff(const lumi_style_desc_t *a, const lumi_style_desc_t *b) {
+    uint32_t changed = 0;
+    if (a->width != b->width || a->height != b->height)            changed |= LUMI_PROP_SIZE;
+    if (memcmp(a->padding, b->padding, sizeof(a->padding)) != 0)   changed |= LUMI_PROP_PADDING;
+    if (memcmp(a->margin, b->margin, sizeof(a->margin)) != 0)      changed |= LUMI_PROP_MARGIN;
+    if (a->background != b->background)                            changed |= LUMI_PROP_BACKGROUND;
+    if (a->foreground != b->foreground)                            changed |= LUMI_PROP_FOREGROUND;
+    if (a->font_size != b->font_size)                              changed |= LUMI_PROP_FONT_SIZE;
+    if (a->border_radius != b->border_radius)                      changed |= LUMI_PROP_BORDER_RADIUS;
+    if (a->opacity != b->opacity)                                  changed |= LUMI_PROP_OPACITY;
+    return changed;
+}
+
+void view_style_init(lumi_view_t *v) {
+    v->style = lumi_style_retain(default_style());
+}
+
+void view_style_clear(lumi_view_t *v) {
+    lumi_style_release(v->style);
+    rule_release(v->rule);
+    v->style = NULL;
+    v->rule = NULL;
+}
+
+void view_style_resolve(lumi_view_t *v) {
+    style_rule_t *rule = v->rule;
+    v->rule_gen = rule->gen;
+
+    if (!v->override_mask) {
+        if (view_swap_style(v, rule->style)) v->paint_dirty = true;
+        return;
+    }
+
+    lumi_style_desc_t d = rule->style->desc;
+    overlay(&d, &v->style->desc, v->override_mask);
+    const lumi_style_t *s = lumi_style_intern(&d);
+    if (view_swap_style(v, s)) v->paint_dirty = true;
+    lumi_style_release(s);
+}
+
+void view_style_commit(lumi_view_t *v, const lumi_style_desc_t *desc, uint32_t props) {
+    const lumi_style_t *s = lumi_style_intern(desc);
+    if (!s) return;
+    if (v->rule) v->override_mask |= props;
+    if (view_swap_style(v, s)) view_invalidate(v);
+    lumi_style_release(s);
+}
+
+void view_style_adopt(lumi_view_t *v, const lumi_view_t *src) {
+    if (src->rule) src->rule->refs++;
+    rule_release(v->rule);
+    v->rule = src->rule;
+    v->rule_gen = src->rule_gen;
+    v->override_mask = src->override_mask;
+    if (view_swap_style(v, src->style)) view_invalidate(v);
+}
+
+void lumi_view_set_style(lumi_view_t *view, const lumi_style_t *style) {
+    if (!view) return;
+    rule_release(view->rule);
+    view->rule = NULL;
+    view->override_mask = 0;
+    if (view_swap_style(view, style ? style : default_style())) view_invalidate(view);
+}
+
+const lumi_style_t *lumi_view_get_style(lumi_view_t *view) {
+    if (!view) return NULL;
+    view_style(view);
+    return view->style;
+}
+
+/* ── Style sheets ──────────────────────────────────────────────── */
+
+static style_rule_t *sheet_find(lumi_style_sheet_t *sheet, const char *name) {
+    for (style_rule_t *r = sheet->rules; r; r = r->next) {
+        if (strcmp(r->name, name) == 0) return r;
+    }
+    return NULL;
+}
+
+lumi_style_sheet_t *lumi_style_sheet_create(void) {
+    return calloc(1, sizeof(lumi_style_sheet_t));
+}
+
+void lumi_style_sheet_destroy(lumi_style_sheet_t *sheet) {
+    if (!sheet) return;
+    style_rule_t *r = sheet->rules;
+    while (r) {
+        style_rule_t *next = r->next;
+        r->next = NULL;
+        rule_release(r);
+        r = next;
+    }
+    free(sheet);
+}
+
+lumi_result_t lumi_style_sheet_set(lumi_style_sheet_t *sheet, const char *name,
+                                   const lumi_style_t *style) {
+    if (!sheet || !name || !style) return LUMI_ERR_INVALID;
+
+    style_rule_t *r = sheet_find(sheet, name);
+    if (!r) {
+        r = calloc(1, sizeof(style_rule_t));
+        if (!r || !(r->name = strdup(name))) {
+            free(r);
+            return LUMI_ERR_NOMEM;
+        }
+        r->refs = 1;
+        r->next = sheet->rules;
+        sheet->rules = r;
+    } else if (r->style == style) {
+        return LUMI_OK;
+    }
+
+    lumi_style_retain(style);
+    lumi_style_release(r->style);
+    r->style = style;
+    r->gen++;
+    view_style_epoch++;
+    return LUMI_OK;
+}
+
+const lumi_style_t *lumi_style_sheet_get(lumi_style_sheet_t *sheet, const char *name) {
+    if (!sheet || !name) return NULL;
+    style_rule_t *r = sheet_find(sheet, name);
+    return r ? r->style : NULL;
+}
+
+lumi_result_t lumi_view_set_style_class(lumi_view_t *view, lumi_style_sheet_t *sheet,
+                                        const char *name) {
+    if (!view || !sheet || !name) return LUMI_ERR_INVALID;
+
+    style_rule_t *r = sheet_find(sheet, name);
+    if (!r) return LUMI_ERR_NOT_FOUND;
+
+    r->refs++;
+    rule_release(view->rule);
+    view->rule = r;
+    view->override_mask = 0;
+    view_style_resolve(view);
+    view_invalidate(view);
+    return LUMI_OK;
+}
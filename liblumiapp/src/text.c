@@ -0,0 +1,391 @@
+/**
+ * text.c — Text measurement and line breaking
+ * Copyright 2026 Lumi Team. Apache-2.0
+ *
+ * Advances come from the metrics of the bundled UI sans (Helvetica-
+ * compatible widths, 1/1000 em). Lines break greedily at spaces, or
+ * between characters when a single word is wider than the line.
+ *
+ * Results are kept in an LRU cache keyed by (text, font size, max
+ * width), since the same labels are measured on every layout pass.
+ * Single-line ASCII text takes a fast path that looks up and sums 16
+ * advances at a time with SSSE3 when the CPU has it.
+ */
+
+#include "lumiapp.h"
+#include <stdlib.h>
+#include <string.h>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#include <tmmintrin.h>
+#define TEXT_HAVE_SSSE3 1
+#endif
+
+#define LINE_HEIGHT     1.25f       /* em */
+#define ADVANCE_DEFAULT 556         /* unknown Latin / symbols */
+#define ADVANCE_WIDE    1000        /* CJK, Hangul, full-width forms */
+#define CACHE_ENTRIES   512         /* power of two */
+
+/* ASCII advances, 1/1000 em; controls are zero-width. */
+static const uint16_t g_ascii_advance[128] = {
+    [' '] = 278, ['!'] = 278, ['"'] = 355, ['#'] = 556, ['$'] = 556, ['%'] = 889,
+    ['&'] = 667, ['\''] = 191, ['('] = 333, [')'] = 333, ['*'] = 389, ['+'] = 584,
+    [','] = 278, ['-'] = 333, ['.'] = 278, ['/'] = 278,
+    ['0'] = 556, ['1'] = 556, ['2'] = 556, ['3'] = 556, ['4'] = 556,
+    ['5'] = 556, ['6'] = 556, ['7'] = 556, ['8'] = 556, ['9'] = 556,
+    [':'] = 278, [';'] = 278, ['<'] = 584, ['='] = 584, ['>'] = 584, ['?'] = 556,
+    ['@'] = 1015,
+    ['A'] = 667, ['B'] = 667, ['C'] = 722, ['D'] = 722, ['E'] = 667, ['F'] = 611,
+    ['G'] = 778, ['H'] = 722, ['I'] = 278, ['J'] = 500, ['K'] = 667, ['L'] = 556,
+    ['M'] = 833, ['N'] = 722, ['O'] = 778, ['P'] = 667, ['Q'] = 778, ['R'] = 722,
+    ['S'] = 667, ['T'] = 611, ['U'] = 722, ['V'] = 667, ['W'] = 944, ['X'] = 667,
+    ['Y'] = 667, ['Z'] = 611,
+    ['['] = 278, ['\\'] = 278, [']'] = 278, ['^'] = 469, ['_'] = 556, ['`'] = 333,
+    ['a'] = 556, ['b'] = 556, ['c'] = 500, ['d'] = 556, ['e'] = 556, ['f'] = 278,
+    ['g'] = 556, ['h'] = 556, ['i'] = 222, ['j'] = 222, ['k'] = 500, ['l'] = 222,
+    ['m'] = 833, ['n'] = 556, ['o'] = 556, ['p'] = 556, ['q'] = 556, ['r'] = 333,
+    ['s'] = 500, ['t'] = 278, ['u'] = 556, ['v'] = 500, ['w'] = 722, ['x'] = 500,
+    ['y'] = 500, ['z'] = 500,
+    ['{'] = 334, ['|'] = 260, ['}'] = 334, ['~'] = 584,
+};
+
+static uint32_t advance_of(uint32_t cp) {
+    if (cp < 128) return g_ascii_advance[cp];
+    if ((cp >= 0x1100 && cp <= 0x115F) || (cp >= 0x2E80 && cp <= 0xA4CF) ||
+        (cp >= 0xAC00 && cp <= 0xD7A3) || (cp >= 0xF900 && cp <= 0xFAFF) ||
+        (cp >= 0xFF00 && cp <= 0xFF60) || (cp >= 0x20000 && cp <= 0x3FFFD)) {
+        return ADVANCE_WIDE;
+    }
+    return ADVANCE_DEFAULT;
+}
+
+/* Decodes one UTF-8 sequence at s[*i], advancing *i; malformed bytes
+ * decode as U+FFFD one byte at a time. */
+static uint32_t next_codepoint(const uint8_t *s, size_t len, size_t *i) {
+    uint8_t b = s[*i];
+    int n = b >= 0xF0 ? 3 : b >= 0xE0 ? 2 : b >= 0xC0 ? 1 : 0;
+    uint32_t cp = n == 3 ? b & 0x07u : n == 2 ? b & 0x0Fu : n == 1 ? b & 0x1Fu : b;
+
+    if (b >= 0x80 && (n == 0 || *i + (size_t)n >= len)) {
+        (*i)++;
+        return 0xFFFD;
+    }
+    for (int k = 1; k <= n; k++) {
+        uint8_t c = s[*i + (size_t)k];
+        if ((c & 0xC0) != 0x80) {
+            (*i)++;
+            return 0xFFFD;
+        }
+        cp = (cp << 6) | (c & 0x3Fu);
+    }
+    *i += (size_t)n + 1;
+    return cp;
+}
+
+/* ── ASCII fast path ───────────────────────────────────────────── */
+
+/* Sums the advances of s[0..n) if it is all ASCII without newlines;
+ * returns false otherwise. */
+static bool ascii_advance_scalar(const uint8_t *s, size_t n, uint32_t *sum) {
+    uint32_t total = 0;
+    for (size_t i = 0; i < n; i++) {
+        if (s[i] >= 0x80 || s[i] == '\n') return false;
+        total += g_ascii_advance[s[i]];
+    }
+    *sum = total;
+    return true;
+}
+
+#ifdef TEXT_HAVE_SSSE3
+/* The advance table split into low bytes and high bits, as 8 rows of
+ * 16 so a pshufb per row looks up a block of 16 characters. */
+static uint8_t g_adv_lo[128] __attribute__((aligned(16)));
+static uint8_t g_adv_hi[128] __attribute__((aligned(16)));
+static int g_simd = -1;
+
+__attribute__((target("ssse3")))
+static bool ascii_advance_ssse3(const uint8_t *s, size_t n, uint32_t *sum) {
+    const __m128i nib = _mm_set1_epi8(0x0F);
+    const __m128i nl  = _mm_set1_epi8('\n');
+    const __m128i zero = _mm_setzero_si128();
+    __m128i acc_lo = zero, acc_hi = zero;
+    size_t i = 0;
+
+    for (; i + 16 <= n; i += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i *)(s + i));
+        if (_mm_movemask_epi8(_mm_or_si128(v, _mm_cmpeq_epi8(v, nl)))) return false;
+
+        __m128i col = _mm_and_si128(v, nib);
+        __m128i row = _mm_and_si128(_mm_srli_epi16(v, 4), nib);
+        __m128i lo = zero, hi = zero;
+        for (int r = 0; r < 8; r++) {
+            __m128i sel = _mm_cmpeq_epi8(row, _mm_set1_epi8((char)r));
+            __m128i tlo = _mm_load_si128((const __m128i *)(g_adv_lo + r * 16));
+            __m128i thi = _mm_load_si128((const __m128i *)(g_adv_hi + r * 16));
+            lo = _mm_or_si128(lo, _mm_and_si128(sel, _mm_shuffle_epi8(tlo, col)));
+            hi = _mm_or_si128(hi, _mm_and_si128(sel, _mm_shuffle_epi8(thi, col)));
+        }
+        acc_lo = _mm_add_epi64(acc_lo, _mm_sad_epu8(lo, zero));
+        acc_hi = _mm_add_epi64(acc_hi, _mm_sad_epu8(hi, zero));
+    }
+
+    uint32_t tail;
+    if (!ascii_advance_scalar(s + i, n - i, &tail)) return false;
+    uint64_t lo64[2], hi64[2];
+    _mm_storeu_si128((__m128i *)lo64, acc_lo);
+    _mm_storeu_si128((__m128i *)hi64, acc_hi);
+    *sum = (uint32_t)(lo64[0] + lo64[1] + ((hi64[0] + hi64[1]) << 8)) + tail;
+    return true;
+}
+#endif
+
+static bool ascii_advance(const uint8_t *s, size_t n, uint32_t *sum) {
+#ifdef TEXT_HAVE_SSSE3
+    if (g_simd < 0) {
+        for (int c = 0; c < 128; c++) {
+            g_adv_lo[c] = (uint8_t)(g_ascii_advance[c] & 0xFF);
+            g_adv_hi[c] = (uint8_t)(g_ascii_advance[c] >> 8);
+        }
+        __builtin_cpu_init();
+        g_simd = __builtin_cpu_supports("ssse3") ? 1 : 0;
+    }
+    if (g_simd && n >= 16) return ascii_advance_ssse3(s, n, sum);
+#endif
+    return ascii_advance_scalar(s, n, sum);
+}
+
+/* ── Line breaking ─────────────────────────────────────────────── */
+
+typedef struct {
+    uint32_t width;             /* widest line, 1/1000 em x font units */
+    int      lines;
+    uint32_t *breaks;           /* start offsets of lines 2..n */
+    int      cap;
+} layout_result_t;
+
+static bool push_break(layout_result_t *r, size_t at) {
+    if (r->lines - 1 == r->cap) {
+        int cap = r->cap ? r->cap * 2 : 4;
+        uint32_t *b = realloc(r->breaks, (size_t)cap * sizeof(uint32_t));
+        if (!b) return false;
+        r->breaks = b;
+        r->cap = cap;
+    }
+    r->breaks[r->lines - 1] = (uint32_t)at;
+    r->lines++;
+    return true;
+}
+
+/* Greedy breaking; limit is the max line width in advance units, 0 for
+ * none. Spaces at a soft break count towards neither line. */
+static bool break_lines(const uint8_t *s, size_t len, uint64_t limit, layout_result_t *r) {
+    uint64_t line_w = 0;        /* current line including trailing spaces */
+    uint64_t ink_w = 0;         /* current line up to its last non-space */
+    uint64_t break_ink = 0;     /* ink_w before the last run of spaces */
+    uint64_t word_w0 = 0;       /* line_w where the current word began */
+    size_t   word_start = 0;
+    bool     have_space = false;
+    uint64_t widest = 0;
+
+    r->lines = 1;
+    for (size_t i = 0; i < len;) {
+        size_t at = i;
+        uint32_t cp = next_codepoint(s, len, &i);
+
+        if (cp == '\n') {
+            if (ink_w > widest) widest = ink_w;
+            if (!push_break(r, i)) return false;
+            line_w = ink_w = break_ink = 0;
+            have_space = false;
+            continue;
+        }
+
+        uint32_t adv = advance_of(cp);
+        if (cp == ' ') {
+            if (line_w == ink_w) break_ink = ink_w;
+            line_w += adv;
+            word_start = i;
+            word_w0 = line_w;
+            have_space = true;
+            continue;
+        }
+
+        if (limit && line_w + adv > limit && ink_w > 0) {
+            if (have_space && break_ink > 0) {
+                /* Carry the current word over to the next line */
+                if (break_ink > widest) widest = break_ink;
+                if (!push_break(r, word_start)) return false;
+                line_w -= word_w0;
+            } else {
+                if (ink_w > widest) widest = ink_w;
+                if (!push_break(r, at)) return false;
+                line_w = 0;
+            }
+            have_space = false;
+        }
+        line_w += adv;
+        ink_w = line_w;
+    }
+    if (ink_w > widest) widest = ink_w;
+    r->width = widest;
+    return true;
+}
+
+/* ── Cache ─────────────────────────────────────────────────────── */
+
+typedef struct text_entry {
+    uint64_t hash;
+    float    font_size;
+    float    max_width;
+    char    *text;
+    size_t   len;
+    lumi_text_metrics_t metrics;
+    uint32_t *breaks;
+    struct text_entry *chain;               /* bucket */
+    struct text_entry *prev, *next;         /* LRU, most recent first */
+} text_entry_t;
+
+static text_entry_t *g_buckets[CACHE_ENTRIES];
+static text_entry_t *g_lru_head, *g_lru_tail;
+static size_t g_entries;
+static size_t g_hits, g_misses;
+
+static uint64_t hash_key(const char *s, size_t len, float font_size, float max_width) {
+    uint64_t h = 14695981039346656037ull;  /* FNV-1a */
+    for (size_t i = 0; i < len; i++) {
+        h ^= (uint8_t)s[i];
+        h *= 1099511628211ull;
+    }
+    uint32_t bits[2];
+    memcpy(&bits[0], &font_size, sizeof(float));
+    memcpy(&bits[1], &max_width, sizeof(float));
+    h ^= ((uint64_t)bits[0] << 32 | bits[1]) * 0x9E3779B97F4A7C15ull;
+    return h ^ (h >> 29);
+}
+
+static void lru_unlink(text_entry_t *e) {
+    if (e->prev) e->prev->next = e->next; else g_lru_head = e->next;
+    if (e->next) e->next->prev = e->prev; else g_lru_tail = e->prev;
+    e->prev = e->next = NULL;
+}
+
+static void lru_push_front(text_entry_t *e) {
+    e->next = g_lru_head;
+    if (g_lru_head) g_lru_head->prev = e;
+    g_lru_head = e;
+    if (!g_lru_tail) g_lru_tail = e;
+}
+
+static void entry_free(text_entry_t *e) {
+    text_entry_t **pp = &g_buckets[e->hash & (CACHE_ENTRIES - 1)];
+    while (*pp != e) pp = &(*pp)->chain;
+    *pp = e->chain;
+    lru_unlink(e);
+    free(e->breaks);
+    free(e->text);
+    free(e);
+    g_entries--;
+}
+
+static text_entry_t *cache_find(uint64_t h, const char *text, size_t len,
+                                float font_size, float max_width) {
+    for (text_entry_t *e = g_buckets[h & (CACHE_ENTRIES - 1)]; e; e = e->chain) {
+        if (e->hash == h && e->len == len && e->font_size == font_size &&
+            e->max_width == max_width && memcmp(e->text, text, len) == 0) {
+            return e;
+        }
+    }
+    return NULL;
+}
+
+/* Takes ownership of breaks. Failing to cache is not an error. */
+static void cache_insert(uint64_t h, const char *text, size_t len, float font_size,
+                         float max_width, const lumi_text_metrics_t *m, uint32_t *breaks) {
+    text_entry_t *e = calloc(1, sizeof(text_entry_t));
+    if (!e || !(e->text = malloc(len + 1))) {
+        free(e);
+        free(breaks);
+        return;
+    }
+    if (g_entries >= CACHE_ENTRIES) entry_free(g_lru_tail);
+
+    memcpy(e->text, text, len);
+    e->text[len] = '\0';
+    e->hash = h;
+    e->len = len;
+    e->font_size = font_size;
+    e->max_width = max_width;
+    e->metrics = *m;
+    e->breaks = breaks;
+    e->chain = g_buckets[h & (CACHE_ENTRIES - 1)];
+    g_buckets[h & (CACHE_ENTRIES - 1)] = e;
+    lru_push_front(e);
+    g_entries++;
+}
+
+static void copy_breaks(const uint32_t *src, int lines, uint32_t *breaks, int max_breaks) {
+    if (!breaks || !src) return;
+    int n = lines - 1 < max_breaks ? lines - 1 : max_breaks;
+    if (n > 0) memcpy(breaks, src, (size_t)n * sizeof(uint32_t));
+}
+
+/* ── Public API ────────────────────────────────────────────────── */
+
+lumi_result_t lumi_text_measure(const char *text, float font_size, float max_width,
+                                lumi_text_metrics_t *out, uint32_t *breaks, int max_breaks) {
+    if (!out || font_size <= 0.0f) return LUMI_ERR_INVALID;
+    if (!text) text = "";
+    if (max_width < 0.0f) max_width = 0.0f;
+
+    float scale = font_size / 1000.0f;
+    size_t len = strlen(text);
+    uint64_t h = hash_key(text, len, font_size, max_width);
+
+    text_entry_t *e = cache_find(h, text, len, font_size, max_width);
+    if (e) {
+        g_hits++;
+        if (e != g_lru_head) {
+            lru_unlink(e);
+            lru_push_front(e);
+        }
+        *out = e->metrics;
+        copy_breaks(e->breaks, e->metrics.line_count, breaks, max_breaks);
+        return LUMI_OK;
+    }
+    g_misses++;
+
+    out->line_height = font_size * LINE_HEIGHT;
+
+    uint32_t sum;
+    if (ascii_advance((const uint8_t *)text, len, &sum) &&
+        (max_width == 0.0f || (float)sum * scale <= max_width)) {
+        out->width = (float)sum * scale;
+        out->line_count = 1;
+        out->height = out->line_height;
+        cache_insert(h, text, len, font_size, max_width, out, NULL);
+        return LUMI_OK;
+    }
+
+    layout_result_t r = { 0 };
+    uint64_t limit = max_width > 0.0f ? (uint64_t)(max_width / scale) : 0;
+    if (!break_lines((const uint8_t *)text, len, limit, &r)) {
+        free(r.breaks);
+        return LUMI_ERR_NOMEM;
+    }
+    out->width = (float)r.width * scale;
+    out->line_count = r.lines;
+    out->height = out->line_height * (float)r.lines;
+    copy_breaks(r.breaks, r.lines, breaks, max_breaks);
+    cache_insert(h, text, len, font_size, max_width, out, r.breaks);
+    return LUMI_OK;
+}
+
+void lumi_text_cache_clear(void) {
+    while (g_lru_tail) entry_free(g_lru_tail);
+    g_hits = g_misses = 0;
+}
+
+void lumi_text_cache_stats(size_t *hits, size_t *misses) {
+    if (hits) *hits = g_hits;
+    if (misses) *misses = g_misses;
+}
@@ -3,7 +3,7 @@
  * Copyright 2026 Lumi Team. Apache-2.0
  */
 
-#include "lumiapp.h"
+#include "metrics.h"
 #include <stdlib.h>
 
 #define MAX_TIMERS 256
@@ -15,6 +15,7 @@ typedef struct {
     bool           active;
     lumi_timer_cb  callback;
     void          *userdata;
+    uint64_t       due_ns;          /* CLOCK_MONOTONIC */
 } timer_entry_t;
 
 static timer_entry_t g_timers[MAX_TIMERS];
@@ -31,6 +32,7 @@ int lumi_timer_set(uint32_t delay_ms, bool repeat, lumi_timer_cb cb, void *userd
             g_timers[i].active   = true;
             g_timers[i].callback = cb;
             g_timers[i].userdata = userdata;
+            g_timers[i].due_ns   = metric_now_ns() + (uint64_t)delay_ms * 1000000u;
 
             lumi_log(LUMI_LOG_DEBUG, "timer", "Set timer %d: %ums %s",
                      g_timers[i].id, delay_ms, repeat ? "(repeat)" : "(once)");
@@ -49,3 +51,26 @@ void lumi_timer_cancel(int timer_id) {
         }
     }
 }
+
+int lumi_timer_poll(void) {
+    uint64_t now = metric_now_ns();
+    int fired = 0;
+    for (int i = 0; i < MAX_TIMERS; i++) {
+        timer_entry_t *t = &g_timers[i];
+        if (!t->active || t->due_ns > now) continue;
+        uint64_t late = now - t->due_ns;
+        lumi_timer_cb cb = t->callback;
+        void *userdata = t->userdata;
+        if (t->repeat) {
+            uint64_t period = (uint64_t)t->delay_ms * 1000000u;
+            t->due_ns = late < period ? t->due_ns + period : now + period;
+        } else {
+            t->active = false;      /* the callback may set a new timer here */
+        }
+        metric_record(METRIC_TIMER_LATENESS_NS, late);
+        metric_add(METRIC_TIMER_FIRED, 1);
+        cb(userdata);
+        fired++;
+    }
+    return fired;
+}
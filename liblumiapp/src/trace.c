@@ -0,0 +1,206 @@
+/**
+ * trace.c — Tracing spans and Chrome trace-event export
+ * Copyright 2026 Lumi Team. Apache-2.0
+ *
+ * Every thread that traces owns a fixed buffer of begin/end events with
+ * CLOCK_MONOTONIC timestamps, appended without locks and published with
+ * one release store. lumi_trace_start() starts a new generation, which
+ * each thread notices on its next event and rewinds its buffer for. A
+ * full buffer drops new spans but keeps room for the ends of the ones
+ * already open, so the export stays balanced. As with the log rings, a
+ * thread that exits leaves its buffer to the next thread that traces.
+ */
+
+#include "trace.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#define EVENTS  32768                       /* per thread */
+#define RESERVE 64                          /* kept for ends of open spans */
+
+typedef struct {
+    uint64_t    ns;
+    const char *name;                       /* NULL for an end */
+} event_t;
+
+typedef struct tbuf {
+    struct tbuf *next;
+    atomic_bool  owned;
+    uint32_t     tid;
+    atomic_uint  gen;
+    uint32_t     open, skipped;             /* owner only: spans begun, begins dropped */
+    _Atomic size_t count;
+    event_t      events[EVENTS];
+} tbuf_t;
+
+atomic_bool trace_on;
+
+static pthread_once_t g_once = PTHREAD_ONCE_INIT;
+static pthread_key_t  g_key;
+static pthread_mutex_t g_lock = PTHREAD_MUTEX_INITIALIZER;   /* start/stop/export */
+static _Atomic(tbuf_t *) g_bufs;
+static _Thread_local tbuf_t *t_buf;
+static atomic_uint   g_gen;
+static atomic_uint   g_tids;
+static atomic_size_t g_dropped;
+static uint64_t      g_origin;              /* ns at lumi_trace_start() */
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+static void buf_release(void *arg) {
+    tbuf_t *b = arg;
+    atomic_store_explicit(&b->owned, false, memory_order_release);
+}
+
+static void trace_init(void) {
+    pthread_key_create(&g_key, buf_release);
+}
+
+static tbuf_t *buf_get(void) {
+    if (t_buf) return t_buf;
+    pthread_once(&g_once, trace_init);
+    tbuf_t *b = atomic_load_explicit(&g_bufs, memory_order_acquire);
+    for (; b; b = b->next) {
+        bool free_buf = false;
+        if (atomic_compare_exchange_strong(&b->owned, &free_buf, true)) break;
+    }
+    if (!b) {
+        b = calloc(1, sizeof(*b));
+        if (!b) return NULL;
+        atomic_init(&b->owned, true);
+        b->tid = atomic_fetch_add(&g_tids, 1) + 1;
+        b->next = atomic_load_explicit(&g_bufs, memory_order_relaxed);
+        while (!atomic_compare_exchange_weak_explicit(&g_bufs, &b->next, b, memory_order_release,
+                                                      memory_order_relaxed)) {
+        }
+    }
+    b->open = b->skipped = 0;
+    pthread_setspecific(g_key, b);
+    t_buf = b;
+    return b;
+}
+
+void trace_record(const char *name, char phase) {
+    tbuf_t *b = buf_get();
+    if (!b) {
+        atomic_fetch_add_explicit(&g_dropped, 1, memory_order_relaxed);
+        return;
+    }
+    unsigned gen = atomic_load_explicit(&g_gen, memory_order_acquire);
+    if (atomic_load_explicit(&b->gen, memory_order_relaxed) != gen) {
+        atomic_store_explicit(&b->count, 0, memory_order_relaxed);
+        atomic_store_explicit(&b->gen, gen, memory_order_release);
+        b->open = b->skipped = 0;
+    }
+    size_t n = atomic_load_explicit(&b->count, memory_order_relaxed);
+    if (phase == 'B') {
+        if (n >= EVENTS - RESERVE || b->skipped) {
+            b->skipped++;
+            atomic_fetch_add_explicit(&g_dropped, 1, memory_order_relaxed);
+            return;
+        }
+        b->open++;
+    } else if (b->skipped) {
+        b->skipped--;
+        return;
+    } else if (b->open && n < EVENTS) {
+        b->open--;
+    } else {
+        return;                             /* began before this generation */
+    }
+    b->events[n] = (event_t){ now_ns(), name };
+    atomic_store_explicit(&b->count, n + 1, memory_order_release);
+}
+
+/* ── Export ──────────────────────────────────────────────────────── */
+
+static void put_name(FILE *f, const char *s) {
+    fputc('"', f);
+    for (; *s; s++) {
+        unsigned char c = (unsigned char)*s;
+        if (c == '"' || c == '\\') {
+            fputc('\\', f);
+            fputc(c, f);
+        } else if (c < 0x20) {
+            fprintf(f, "\\u%04x", c);
+        } else {
+            fputc(c, f);
+        }
+    }
+    fputc('"', f);
+}
+
+static void put_event(FILE *f, const event_t *e, uint32_t tid, int pid, bool *first) {
+    uint64_t us = e->ns > g_origin ? e->ns - g_origin : 0;
+    fprintf(f, "%s\n{\"ph\":\"%c\",\"ts\":%llu.%03u,\"pid\":%d,\"tid\":%u", *first ? "" : ",",
+            e->name ? 'B' : 'E', (unsigned long long)(us / 1000), (unsigned)(us % 1000), pid,
+            (unsigned)tid);
+    if (e->name) {
+        fputs(",\"cat\":\"lumi\",\"name\":", f);
+        put_name(f, e->name);
+    }
+    fputc('}', f);
+    *first = false;
+}
+
+/* ── Public API ──────────────────────────────────────────────────── */
+
+void lumi_trace_start(void) {
+    pthread_mutex_lock(&g_lock);
+    g_origin = now_ns();
+    atomic_store(&g_dropped, 0);
+    atomic_fetch_add_explicit(&g_gen, 1, memory_order_release);
+    atomic_store_explicit(&trace_on, true, memory_order_release);
+    pthread_mutex_unlock(&g_lock);
+}
+
+void lumi_trace_stop(void) {
+    atomic_store_explicit(&trace_on, false, memory_order_release);
+}
+
+bool lumi_trace_enabled(void) {
+    return atomic_load_explicit(&trace_on, memory_order_relaxed);
+}
+
+void lumi_trace_begin(const char *name) {
+    if (name) trace_begin(name);
+}
+
+void lumi_trace_end(void) {
+    trace_end();
+}
+
+lumi_result_t lumi_trace_export(const char *path) {
+    if (!path) return LUMI_ERR_INVALID;
+    FILE *f = fopen(path, "w");
+    if (!f) return LUMI_ERR_IO;
+
+    pthread_mutex_lock(&g_lock);
+    unsigned gen = atomic_load_explicit(&g_gen, memory_order_acquire);
+    int pid = (int)getpid();
+    bool first = true;
+    fputs("{\"traceEvents\":[", f);
+    for (tbuf_t *b = atomic_load_explicit(&g_bufs, memory_order_acquire); b; b = b->next) {
+        if (atomic_load_explicit(&b->gen, memory_order_acquire) != gen) continue;
+        size_t n = atomic_load_explicit(&b->count, memory_order_acquire);
+        if (!n) continue;
+        fprintf(f, "%s\n{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":%d,\"tid\":%u,"
+                   "\"args\":{\"name\":\"thread %u\"}}",
+                first ? "" : ",", pid, (unsigned)b->tid, (unsigned)b->tid);
+        first = false;
+        for (size_t i = 0; i < n; i++) put_event(f, &b->events[i], b->tid, pid, &first);
+    }
+    fprintf(f, "\n],\"displayTimeUnit\":\"ns\",\"otherData\":{\"dropped\":\"%zu\"}}\n",
+            atomic_load(&g_dropped));
+    pthread_mutex_unlock(&g_lock);
+
+    bool ok = !ferror(f);
+    return fclose(f) == 0 && ok ? LUMI_OK : LUMI_ERR_IO;
+}
@@ -0,0 +1,27 @@
+/**
+ * trace.h — Private tracing hooks for the SDK's own code paths
+ * Copyright 2026 Lumi Team. Apache-2.0
+ *
+ * Not installed. trace_begin()/trace_end() are lumi_trace_begin()/end()
+ * inlined down to one relaxed load while tracing is off.
+ */
+
+#ifndef LUMI_TRACE_H
+#define LUMI_TRACE_H
+
+#include "lumiapp.h"
+#include <stdatomic.h>
+
+extern atomic_bool trace_on;
+
+void trace_record(const char *name, char phase);
+
+static inline void trace_begin(const char *name) {
+    if (atomic_load_explicit(&trace_on, memory_order_relaxed)) trace_record(name, 'B');
+}
+
+static inline void trace_end(void) {
+    if (atomic_load_explicit(&trace_on, memory_order_relaxed)) trace_record(NULL, 'E');
+}
+
+#endif /* LUMI_TRACE_H */
@@ -3,52 +3,34 @@
  * Copyright 2026 Lumi Team. Apache-2.0
  */
 
-#include "lumiapp.h"
+#include "view_internal.h"
+#include "mem.h"
+#include "metrics.h"
 #include <stdlib.h>
 #include <string.h>
 
-#define MAX_CHILDREN 256
-
-struct lumi_view {
-    lumi_view_type_t type;
-    char *id;
-    char *text;         /* for text/button/text_field */
-    bool visible;
-
-    /* Style */
-    float width, height;
-    float pad_top, pad_right, pad_bottom, pad_left;
-    float mar_top, mar_right, mar_bottom, mar_left;
-    uint32_t background;
-    uint32_t foreground;
-    float font_size;
-    float border_radius;
-
-    /* Tree */
-    lumi_view_t *children[MAX_CHILDREN];
-    int child_count;
-    lumi_view_t *parent;
-
-    /* Callbacks */
-    lumi_click_cb  on_click_cb;
-    void          *on_click_data;
-    lumi_click_cb  on_long_click_cb;
-    void          *on_long_click_data;
-    lumi_text_cb   on_text_change_cb;
-    void          *on_text_change_data;
-};
-
 static lumi_view_t *view_alloc(lumi_view_type_t type) {
-    lumi_view_t *v = calloc(1, sizeof(lumi_view_t));
+    lumi_view_t *v = mem_calloc(LUMI_MEM_VIEWS, 1, sizeof(lumi_view_t));
     if (!v) return NULL;
     v->type = type;
     v->visible = true;
-    v->font_size = 14.0f;
-    v->foreground = 0x000000FF;
-    v->background = 0x00000000;
+    view_style_init(v);
+    if (!v->style) {
+        mem_free(LUMI_MEM_VIEWS, v, sizeof(lumi_view_t));
+        return NULL;
+    }
+    v->paint_dirty = true;
+    v->hit_dirty = true;
+    metric_gauge_add(METRIC_VIEW_NODES, 1);
     return v;
 }
 
+void view_invalidate(lumi_view_t *view) {
+    for (lumi_view_t *v = view; v; v = v->parent) {
+        v->paint_dirty = true;
+    }
+}
+
 /* ── Constructors ──────────────────────────────────────────────── */
 
 lumi_view_t *lumi_column(void)  { return view_alloc(LUMI_VIEW_COLUMN); }
@@ -61,25 +43,25 @@ lumi_view_t *lumi_card(void)    { return view_alloc(LUMI_VIEW_CARD); }
 
 lumi_view_t *lumi_text(const char *content) {
     lumi_view_t *v = view_alloc(LUMI_VIEW_TEXT);
-    if (v && content) v->text = strdup(content);
+    if (v && content) v->text = mem_strdup(LUMI_MEM_STRINGS, content);
     return v;
 }
 
 lumi_view_t *lumi_button(const char *label) {
     lumi_view_t *v = view_alloc(LUMI_VIEW_BUTTON);
-    if (v && label) v->text = strdup(label);
+    if (v && label) v->text = mem_strdup(LUMI_MEM_STRINGS, label);
     return v;
 }
 
 lumi_view_t *lumi_image(const char *source) {
     lumi_view_t *v = view_alloc(LUMI_VIEW_IMAGE);
-    if (v && source) v->text = strdup(source);
+    if (v && source) v->text = mem_strdup(LUMI_MEM_STRINGS, source);
     return v;
 }
 
 lumi_view_t *lumi_text_field(const char *placeholder) {
     lumi_view_t *v = view_alloc(LUMI_VIEW_TEXT_FIELD);
-    if (v && placeholder) v->text = strdup(placeholder);
+    if (v && placeholder) v->text = mem_strdup(LUMI_MEM_STRINGS, placeholder);
     return v;
 }
 
@@ -90,38 +72,93 @@ void lumi_view_add_child(lumi_view_t *parent, lumi_view_t *child) {
     if (parent->child_count >= MAX_CHILDREN) return;
     parent->children[parent->child_count++] = child;
     child->parent = parent;
+    view_ids_attached(child);
+    view_pack_attached(child);
+    view_invalidate(parent);
+    view_invalidate_hits(parent);
 }
 
 void lumi_view_remove_child(lumi_view_t *parent, lumi_view_t *child) {
     if (!parent || !child) return;
     for (int i = 0; i < parent->child_count; i++) {
         if (parent->children[i] == child) {
+            view_ids_detaching(child);
             child->parent = NULL;
             for (int j = i; j < parent->child_count - 1; j++) {
                 parent->children[j] = parent->children[j + 1];
             }
             parent->child_count--;
+            view_pack_restructure(parent);
+            view_invalidate(parent);
+            view_invalidate_hits(parent);
             return;
         }
     }
 }
 
+static void view_free(lumi_view_t *view) {
+    for (int i = 0; i < view->child_count; i++) {
+        view_free(view->children[i]);
+    }
+    view_index_free(view);
+    view_pack_free(view);
+    lumi_anim_cancel_view(view);
+    view_style_clear(view);
+    lumi_display_list_destroy(view->paint_cache);
+    mem_free(LUMI_MEM_VIEWS, view->hit_index, (size_t)view->hit_cap * sizeof(view_hit_entry_t));
+    view_free_string(view, view->id);
+    view_free_string(view, view->text);
+    metric_gauge_add(METRIC_VIEW_NODES, -1);
+    if (view->arena) view_arena_release(view->arena);
+    else mem_free(LUMI_MEM_VIEWS, view, sizeof(*view));
+}
+
 void lumi_view_destroy(lumi_view_t *view) {
     if (!view) return;
+    if (view->parent) lumi_view_remove_child(view->parent, view);
+    view_free(view);
+}
+
+int lumi_view_get_child_count(lumi_view_t *view) {
+    return view ? view->child_count : 0;
+}
+
+lumi_view_t *lumi_view_get_child(lumi_view_t *view, int index) {
+    if (!view || index < 0 || index >= view->child_count) return NULL;
+    return view->children[index];
+}
+
+lumi_view_t *lumi_view_get_parent(lumi_view_t *view) {
+    return view ? view->parent : NULL;
+}
+
+/* Strings still in a snapshot's block are not any one node's */
+static size_t string_bytes(const lumi_view_t *view, const char *s) {
+    const view_arena_t *a = view->arena;
+    if (!s || (a && (uintptr_t)s - (uintptr_t)a->strings < a->str_len)) return 0;
+    return strlen(s) + 1;
+}
+
+size_t lumi_view_get_footprint(const lumi_view_t *view) {
+    if (!view) return 0;
+    size_t bytes = sizeof(*view) + string_bytes(view, view->id) + string_bytes(view, view->text) +
+                   (size_t)view->hit_cap * sizeof(view_hit_entry_t) +
+                   display_list_bytes(view->paint_cache) + view_index_bytes(view->id_index) +
+                   view_pack_bytes(view->pack);
     for (int i = 0; i < view->child_count; i++) {
-        lumi_view_destroy(view->children[i]);
+        bytes += lumi_view_get_footprint(view->children[i]);
     }
-    free(view->id);
-    free(view->text);
-    free(view);
+    return bytes;
 }
 
 /* ── Properties ────────────────────────────────────────────────── */
 
 void lumi_view_set_id(lumi_view_t *view, const char *id) {
     if (!view) return;
-    free(view->id);
-    view->id = id ? strdup(id) : NULL;
+    char *old = view->id;
+    view->id = id ? mem_strdup(LUMI_MEM_STRINGS, id) : NULL;
+    view_ids_rekey(view, old);
+    view_free_string(view, old);
 }
 
 const char *lumi_view_get_id(lumi_view_t *view) {
@@ -133,7 +170,11 @@ lumi_view_type_t lumi_view_get_type(lumi_view_t *view) {
 }
 
 void lumi_view_set_visible(lumi_view_t *view, bool visible) {
-    if (view) view->visible = visible;
+    if (!view || view->visible == visible) return;
+    view->visible = visible;
+    view_pack_sync(view);
+    view_invalidate(view);
+    view_invalidate_hits(view->parent);
 }
 
 bool lumi_view_get_visible(lumi_view_t *view) {
@@ -142,25 +183,73 @@ bool lumi_view_get_visible(lumi_view_t *view) {
 
 /* ── Styling ───────────────────────────────────────────────────── */
 
-void lumi_view_set_width(lumi_view_t *view, float w) { if (view) view->width = w; }
-void lumi_view_set_height(lumi_view_t *view, float h) { if (view) view->height = h; }
+/* Setters copy the view's current style, change one property and intern
+ * the result, so views that end up alike still share one style. */
+
+void lumi_view_set_width(lumi_view_t *view, float w) {
+    if (!view) return;
+    lumi_style_desc_t d = *view_style(view);
+    d.width = w;
+    view_style_commit(view, &d, LUMI_PROP_SIZE);
+}
+
+void lumi_view_set_height(lumi_view_t *view, float h) {
+    if (!view) return;
+    lumi_style_desc_t d = *view_style(view);
+    d.height = h;
+    view_style_commit(view, &d, LUMI_PROP_SIZE);
+}
 
 void lumi_view_set_padding(lumi_view_t *view, float top, float right, float bottom, float left) {
     if (!view) return;
-    view->pad_top = top; view->pad_right = right;
-    view->pad_bottom = bottom; view->pad_left = left;
+    lumi_style_desc_t d = *view_style(view);
+    d.padding[0] = top; d.padding[1] = right;
+    d.padding[2] = bottom; d.padding[3] = left;
+    view_style_commit(view, &d, LUMI_PROP_PADDING);
 }
 
 void lumi_view_set_margin(lumi_view_t *view, float top, float right, float bottom, float left) {
     if (!view) return;
-    view->mar_top = top; view->mar_right = right;
-    view->mar_bottom = bottom; view->mar_left = left;
+    lumi_style_desc_t d = *view_style(view);
+    d.margin[0] = top; d.margin[1] = right;
+    d.margin[2] = bottom; d.margin[3] = left;
+    view_style_commit(view, &d, LUMI_PROP_MARGIN);
+}
+
+void lumi_view_set_background(lumi_view_t *view, uint32_t rgba) {
+    if (!view) return;
+    lumi_style_desc_t d = *view_style(view);
+    d.background = rgba;
+    view_style_commit(view, &d, LUMI_PROP_BACKGROUND);
+}
+
+void lumi_view_set_foreground(lumi_view_t *view, uint32_t rgba) {
+    if (!view) return;
+    lumi_style_desc_t d = *view_style(view);
+    d.foreground = rgba;
+    view_style_commit(view, &d, LUMI_PROP_FOREGROUND);
+}
+
+void lumi_view_set_font_size(lumi_view_t *view, float size) {
+    if (!view) return;
+    lumi_style_desc_t d = *view_style(view);
+    d.font_size = size;
+    view_style_commit(view, &d, LUMI_PROP_FONT_SIZE);
 }
 
-void lumi_view_set_background(lumi_view_t *view, uint32_t rgba)  { if (view) view->background = rgba; }
-void lumi_view_set_foreground(lumi_view_t *view, uint32_t rgba)  { if (view) view->foreground = rgba; }
-void lumi_view_set_font_size(lumi_view_t *view, float size)      { if (view) view->font_size = size; }
-void lumi_view_set_border_radius(lumi_view_t *view, float r)     { if (view) view->border_radius = r; }
+void lumi_view_set_border_radius(lumi_view_t *view, float r) {
+    if (!view) return;
+    lumi_style_desc_t d = *view_style(view);
+    d.border_radius = r;
+    view_style_commit(view, &d, LUMI_PROP_BORDER_RADIUS);
+}
+
+void lumi_view_set_opacity(lumi_view_t *view, float opacity) {
+    if (!view) return;
+    lumi_style_desc_t d = *view_style(view);
+    d.opacity = opacity < 0.0f ? 0.0f : opacity > 1.0f ? 1.0f : opacity;
+    view_style_commit(view, &d, LUMI_PROP_OPACITY);
+}
 
 /* ── Event handlers ────────────────────────────────────────────── */
 
@@ -186,8 +275,10 @@ void lumi_view_on_text_change(lumi_view_t *view, lumi_text_cb cb, void *ud) {
 
 void lumi_text_set_content(lumi_view_t *view, const char *text) {
     if (!view) return;
-    free(view->text);
-    view->text = text ? strdup(text) : NULL;
+    view_free_string(view, view->text);
+    view->text = text ? mem_strdup(LUMI_MEM_STRINGS, text) : NULL;
+    view_pack_sync(view);
+    view_invalidate(view);
 }
 
 const char *lumi_text_get_content(lumi_view_t *view) {
@@ -200,9 +291,26 @@ const char *lumi_text_field_get_value(lumi_view_t *view) {
 
 void lumi_text_field_set_value(lumi_view_t *view, const char *value) {
     if (!view) return;
-    free(view->text);
-    view->text = value ? strdup(value) : NULL;
+    view_free_string(view, view->text);
+    view->text = value ? mem_strdup(LUMI_MEM_STRINGS, value) : NULL;
+    view_pack_sync(view);
+    view_invalidate(view);
     if (view->on_text_change_cb) {
         view->on_text_change_cb(view, view->text, view->on_text_change_data);
     }
 }
+
+/* ── Scroll-specific ───────────────────────────────────────────── */
+
+void lumi_scroll_set_offset(lumi_view_t *view, float x, float y) {
+    if (!view) return;
+    if (view->scroll_x == x && view->scroll_y == y) return;
+    view->scroll_x = x;
+    view->scroll_y = y;
+    view_invalidate(view);
+}
+
+void lumi_scroll_get_offset(lumi_view_t *view, float *x, float *y) {
+    if (x) *x = view ? view->scroll_x : 0.0f;
+    if (y) *y = view ? view->scroll_y : 0.0f;
+}
@@ -0,0 +1,209 @@
+/**
+ * view_index.c — Per-root id → view hash index
+ * Copyright 2026 Lumi Team. Apache-2.0
+ *
+ * The index lives on the root of a tree and is built on the first
+ * lumi_view_find_by_id() against that tree. From then on tree edits keep
+ * it current: attaching a subtree inserts its ids, detaching or
+ * destroying one removes them, and lumi_view_set_id() re-keys a node.
+ * Trees nobody searched never pay for an index.
+ *
+ * Open addressing with linear probing; keys point at the views' own id
+ * strings, which is safe because entries are removed before an id is
+ * freed or replaced.
+ */
+
+#include "view_internal.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define TOMBSTONE ((lumi_view_t *)1)
+
+typedef struct {
+    uint32_t     hash;
+    lumi_view_t *view;      /* NULL = empty, TOMBSTONE = deleted */
+} id_slot_t;
+
+struct view_id_index {
+    id_slot_t *slots;
+    size_t cap;             /* power of two */
+    size_t count;
+    size_t used;            /* count + tombstones */
+};
+
+static int g_live_indexes = 0;
+
+static uint32_t hash_str(const char *s) {
+    uint32_t h = 2166136261u;      /* FNV-1a */
+    while (*s) {
+        h ^= (uint8_t)*s++;
+        h *= 16777619u;
+    }
+    return h;
+}
+
+static bool index_resize(view_id_index_t *idx, size_t cap) {
+    id_slot_t *slots = mem_calloc(LUMI_MEM_VIEWS, cap, sizeof(id_slot_t));
+    if (!slots) return false;
+
+    for (size_t i = 0; i < idx->cap; i++) {
+        id_slot_t *s = &idx->slots[i];
+        if (!s->view || s->view == TOMBSTONE) continue;
+        size_t j = s->hash & (cap - 1);
+        while (slots[j].view) j = (j + 1) & (cap - 1);
+        slots[j] = *s;
+    }
+    mem_free(LUMI_MEM_VIEWS, idx->slots, idx->cap * sizeof(id_slot_t));
+    idx->slots = slots;
+    idx->cap   = cap;
+    idx->used  = idx->count;
+    return true;
+}
+
+/* Fails only if the table must grow, cannot, and has no room left beyond
+ * the empty slot that ends every probe; the caller then drops the index. */
+static bool index_insert(view_id_index_t *idx, lumi_view_t *v) {
+    if ((idx->used + 1) * 10 > idx->cap * 7) {
+        size_t cap = idx->cap;
+        while ((idx->count + 1) * 10 > cap * 5) cap *= 2;
+        if (!index_resize(idx, cap) && idx->used + 2 > idx->cap) return false;
+    }
+
+    uint32_t h = hash_str(v->id);
+    size_t j = h & (idx->cap - 1);
+    while (idx->slots[j].view && idx->slots[j].view != TOMBSTONE) {
+        j = (j + 1) & (idx->cap - 1);
+    }
+    if (!idx->slots[j].view) idx->used++;
+    idx->slots[j].hash = h;
+    idx->slots[j].view = v;
+    idx->count++;
+    return true;
+}
+
+static void index_remove(view_id_index_t *idx, lumi_view_t *v) {
+    uint32_t h = hash_str(v->id);
+    for (size_t j = h & (idx->cap - 1); idx->slots[j].view; j = (j + 1) & (idx->cap - 1)) {
+        if (idx->slots[j].view == v) {
+            idx->slots[j].view = TOMBSTONE;
+            idx->count--;
+            return;
+        }
+    }
+}
+
+static bool index_add_subtree(view_id_index_t *idx, lumi_view_t *v) {
+    if (v->id && !index_insert(idx, v)) return false;
+    for (int i = 0; i < v->child_count; i++) {
+        if (!index_add_subtree(idx, v->children[i])) return false;
+    }
+    return true;
+}
+
+static void index_remove_subtree(view_id_index_t *idx, lumi_view_t *v) {
+    if (v->id) index_remove(idx, v);
+    for (int i = 0; i < v->child_count; i++) index_remove_subtree(idx, v->children[i]);
+}
+
+/* Root of the tree containing v if that tree has an index, else NULL. */
+static lumi_view_t *indexed_root(lumi_view_t *v) {
+    if (g_live_indexes == 0) return NULL;
+    while (v->parent) v = v->parent;
+    return v->id_index ? v : NULL;
+}
+
+size_t view_index_bytes(const view_id_index_t *idx) {
+    return idx ? sizeof(*idx) + idx->cap * sizeof(id_slot_t) : 0;
+}
+
+void view_index_free(lumi_view_t *root) {
+    view_id_index_t *idx = root->id_index;
+    if (!idx) return;
+    mem_free(LUMI_MEM_VIEWS, idx->slots, idx->cap * sizeof(id_slot_t));
+    mem_free(LUMI_MEM_VIEWS, idx, sizeof(*idx));
+    root->id_index = NULL;
+    g_live_indexes--;
+}
+
+/* ── Hooks called by tree edits ────────────────────────────────── */
+
+/* An index that missed an insert would hide that view from lookups, so
+ * it is dropped instead; the next lookup rebuilds it. */
+void view_ids_attached(lumi_view_t *child) {
+    view_index_free(child);
+    lumi_view_t *root = indexed_root(child);
+    if (root && !index_add_subtree(root->id_index, child)) view_index_free(root);
+}
+
+void view_ids_detaching(lumi_view_t *child) {
+    lumi_view_t *root = child->parent ? indexed_root(child) : NULL;
+    if (root) index_remove_subtree(root->id_index, child);
+}
+
+void view_ids_rekey(lumi_view_t *view, const char *old_id) {
+    lumi_view_t *root = indexed_root(view);
+    if (!root) return;
+    view_id_index_t *idx = root->id_index;
+
+    if (old_id) {
+        uint32_t h = hash_str(old_id);
+        for (size_t j = h & (idx->cap - 1); idx->slots[j].view; j = (j + 1) & (idx->cap - 1)) {
+            if (idx->slots[j].view == view) {
+                idx->slots[j].view = TOMBSTONE;
+                idx->count--;
+                break;
+            }
+        }
+    }
+    if (view->id && !index_insert(idx, view)) view_index_free(root);
+}
+
+/* ── Lookup ────────────────────────────────────────────────────── */
+
+static bool is_within(const lumi_view_t *v, const lumi_view_t *ancestor) {
+    for (; v; v = v->parent) {
+        if (v == ancestor) return true;
+    }
+    return false;
+}
+
+/* Without an index (out of memory): a plain walk of the subtree */
+static lumi_view_t *find_in_subtree(lumi_view_t *v, const char *id) {
+    if (v->id && strcmp(v->id, id) == 0) return v;
+    for (int i = 0; i < v->child_count; i++) {
+        lumi_view_t *found = find_in_subtree(v->children[i], id);
+        if (found) return found;
+    }
+    return NULL;
+}
+
+lumi_view_t *lumi_view_find_by_id(lumi_view_t *view, const char *id) {
+    if (!view || !id) return NULL;
+
+    lumi_view_t *root = view;
+    while (root->parent) root = root->parent;
+
+    view_id_index_t *idx = root->id_index;
+    if (!idx) {
+        idx = mem_calloc(LUMI_MEM_VIEWS, 1, sizeof(view_id_index_t));
+        if (!idx || !(idx->slots = mem_calloc(LUMI_MEM_VIEWS, 16, sizeof(id_slot_t)))) {
+            mem_free(LUMI_MEM_VIEWS, idx, sizeof(view_id_index_t));
+            return find_in_subtree(view, id);
+        }
+        idx->cap = 16;
+        root->id_index = idx;
+        g_live_indexes++;
+        if (!index_add_subtree(idx, root)) {
+            view_index_free(root);
+            return find_in_subtree(view, id);
+        }
+    }
+
+    uint32_t h = hash_str(id);
+    for (size_t j = h & (idx->cap - 1); idx->slots[j].view; j = (j + 1) & (idx->cap - 1)) {
+        lumi_view_t *v = idx->slots[j].view;
+        if (v == TOMBSTONE || idx->slots[j].hash != h || strcmp(v->id, id) != 0) continue;
+        if (view == root || is_within(v, view)) return v;
+    }
+    return NULL;
+}
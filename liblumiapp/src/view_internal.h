@@ -0,0 +1,258 @@
+/**
+ * view_internal.h — Private view tree definitions shared by view modules
+ * Copyright 2026 Lumi Team. Apache-2.0
+ *
+ * Not installed; shared by the view modules (view, layout, paint, ...).
+ */
+
+#ifndef LUMI_VIEW_INTERNAL_H
+#define LUMI_VIEW_INTERNAL_H
+
+#include "lumiapp.h"
+#include "mem.h"
+#include <stdint.h>
+#include <stdlib.h>
+
+#define MAX_CHILDREN 256
+
+typedef struct view_id_index view_id_index_t;
+typedef struct view_arena view_arena_t;
+typedef struct view_pack view_pack_t;
+
+struct lumi_style {
+    lumi_style_desc_t desc;
+    uint32_t hash;
+    int refs;
+    struct lumi_style *next;            /* intern table chain */
+};
+
+/* A named class of a style sheet. Refcounted by the sheet and by every
+ * view bound to it, so views may outlive their sheet. */
+typedef struct style_rule {
+    char *name;
+    const lumi_style_t *style;
+    uint32_t gen;                       /* bumped when the class is redefined */
+    int refs;
+    struct style_rule *next;
+} style_rule_t;
+
+/* One child in a container's hit-test index, sorted by start on the
+ * container's main axis; max_end is the running maximum of child ends. */
+typedef struct {
+    float start;
+    float max_end;
+    int   child;
+} view_hit_entry_t;
+
+struct lumi_view {
+    lumi_view_type_t type;
+    char *id;
+    char *text;         /* for text/button/text_field */
+    bool visible;
+
+    /* Style: a counted reference to an interned style. Views bound to a
+     * style class re-resolve when the rule's generation moves on,
+     * keeping the properties in override_mask from their own style. */
+    const lumi_style_t *style;
+    style_rule_t *rule;
+    uint32_t rule_gen;
+    uint32_t override_mask;             /* LUMI_PROP_* */
+
+    /* Layout results (frame is relative to the parent's origin) */
+    float frame_x, frame_y, frame_w, frame_h;
+    float scroll_x, scroll_y;
+
+    /* Paint state */
+    bool paint_dirty;
+    bool repaint_boundary;
+    lumi_display_list_t *paint_cache;   /* boundary subtree, recorded at cache_x/y */
+    float cache_x, cache_y;
+    float cache_alpha;                  /* inherited opacity at recording */
+    uint32_t cache_epoch;               /* view_style_epoch at recording */
+
+    /* Hit-test index over children, rebuilt lazily when hit_dirty */
+    view_hit_entry_t *hit_index;
+    int  hit_count, hit_cap;
+    bool hit_dirty;
+
+    /* Tree */
+    lumi_view_t *children[MAX_CHILDREN];
+    int child_count;
+    lumi_view_t *parent;
+    view_id_index_t *id_index;          /* roots only, built on first lookup */
+    view_arena_t *arena;                /* block this view lives in, NULL if malloc'd */
+    view_pack_t *pack;                  /* roots only, see lumi_view_set_packed */
+    uint32_t pack_index;                /* slot in the root's pack */
+    uint8_t anim_count;                 /* running animations (animate.c) */
+
+    /* Callbacks */
+    lumi_click_cb  on_click_cb;
+    void          *on_click_data;
+    lumi_click_cb  on_long_click_cb;
+    void          *on_long_click_data;
+    lumi_text_cb   on_text_change_cb;
+    void          *on_text_change_data;
+};
+
+/* Mark a view and all of its ancestors as needing repaint. */
+void view_invalidate(lumi_view_t *view);
+
+/* Mark a container's hit-test index stale. */
+static inline void view_invalidate_hits(lumi_view_t *view) {
+    if (view) view->hit_dirty = true;
+}
+
+/* Id index maintenance (view_index.c). Call attached() after setting
+ * child->parent, detaching() before clearing it. */
+void view_ids_attached(lumi_view_t *child);
+void view_ids_detaching(lumi_view_t *child);
+void view_ids_rekey(lumi_view_t *view, const char *old_id);
+void view_index_free(lumi_view_t *root);
+size_t view_index_bytes(const view_id_index_t *idx);
+
+/* Snapshot arenas (snapshot.c). A deserialized tree lives in one block:
+ * the nodes, then the id/text strings. The block is freed with its last
+ * node; strings replaced by setters are simply abandoned in it. */
+struct view_arena {
+    size_t size;                        /* of the whole block */
+    size_t live;                        /* nodes not yet freed */
+    const char *strings;
+    size_t str_len;
+    lumi_view_t nodes[];
+};
+
+void view_arena_release(view_arena_t *arena);
+
+/* Free an id or text string of view unless it points into its arena. */
+static inline void view_free_string(lumi_view_t *view, char *s) {
+    const view_arena_t *a = view->arena;
+    if (a && (uintptr_t)s - (uintptr_t)a->strings < a->str_len) return;
+    mem_free_str(LUMI_MEM_STRINGS, s);
+}
+
+/* Packed storage (pack.c): the hot fields of a root's views in pre-order.
+ * The subtree of node i spans [i, end[i]); its first child is i + 1 and
+ * each next sibling starts at the previous one's end. */
+#define PACK_VISIBLE  0x01
+#define PACK_BOUNDARY 0x02
+
+struct view_pack {
+    uint32_t count, cap;
+    bool stale;                         /* tree changed shape; rebuild before use */
+    uint32_t style_epoch;               /* view_style_epoch at last refresh */
+    lumi_view_t **view;
+    const lumi_style_desc_t **style;
+    const char **text;
+    uint32_t *end;
+    float *x, *y, *w, *h;               /* mirrors of the views' frames */
+    uint8_t *type;
+    uint8_t *flags;                     /* PACK_* */
+};
+
+/* The up-to-date pack of root, or NULL if it is not packed (or the pack
+ * could not be rebuilt, in which case callers walk the views). */
+view_pack_t *view_pack_prepare(lumi_view_t *root);
+void view_pack_free(lumi_view_t *root);
+/* Call after a view's style, text, visibility or boundary flag changed. */
+void view_pack_sync(lumi_view_t *view);
+/* Call after view's children were added, removed or reordered. */
+void view_pack_restructure(lumi_view_t *view);
+/* Call after setting child->parent; drops a pack child had as a root. */
+void view_pack_attached(lumi_view_t *child);
+size_t view_pack_bytes(const view_pack_t *pack);
+
+/* Heap bytes of a display list (paint.c), for lumi_view_get_footprint */
+size_t display_list_bytes(const lumi_display_list_t *list);
+
+/* Styles (style.c). view_style_epoch moves whenever a style class is
+ * redefined, which invalidates every cached boundary recording. */
+extern uint32_t view_style_epoch;
+
+void view_style_init(lumi_view_t *view);
+void view_style_clear(lumi_view_t *view);
+void view_style_resolve(lumi_view_t *view);
+/* Intern desc as the view's own style; props are the LUMI_PROP_* bits
+ * the caller changed, kept as overrides if the view has a class. */
+void view_style_commit(lumi_view_t *view, const lumi_style_desc_t *desc, uint32_t props);
+/* Adopt src's style and class binding (reconciliation). */
+void view_style_adopt(lumi_view_t *view, const lumi_view_t *src);
+uint32_t view_style_diff(const lumi_style_desc_t *a, const lumi_style_desc_t *b);
+
+static inline const lumi_style_desc_t *view_style(lumi_view_t *view) {
+    if (view->rule && view->rule_gen != view->rule->gen) view_style_resolve(view);
+    return &view->style->desc;
+}
+
+/* A node as the layout and paint passes see it. With a pack (p non-NULL)
+ * it is slot i, read from the arrays without touching the view; without
+ * one it is view, and i its index among its siblings. The passes take p
+ * and a node, so one body serves both walks. */
+typedef struct {
+    lumi_view_t *view;                  /* NULL in pack walks */
+    uint32_t i;
+} view_node_t;
+
+static inline view_node_t view_node_root(const view_pack_t *p, lumi_view_t *root) {
+    return (view_node_t){ p ? NULL : root, 0 };
+}
+
+static inline view_node_t view_node_at(const lumi_view_t *parent, uint32_t k) {
+    return (view_node_t){ k < (uint32_t)parent->child_count ? parent->children[k] : NULL, k };
+}
+
+/* Children: for (c = first_child(n); view_node_more(n, c); c = next(n, c)) */
+static inline view_node_t view_node_first_child(const view_pack_t *p, view_node_t n) {
+    return p ? (view_node_t){ NULL, n.i + 1 } : view_node_at(n.view, 0);
+}
+
+static inline view_node_t view_node_next(const view_pack_t *p, view_node_t parent,
+                                         view_node_t c) {
+    return p ? (view_node_t){ NULL, p->end[c.i] } : view_node_at(parent.view, c.i + 1);
+}
+
+static inline bool view_node_more(const view_pack_t *p, view_node_t parent, view_node_t c) {
+    return p ? c.i < p->end[parent.i] : c.view != NULL;
+}
+
+/* The view behind a node, for what the pack does not mirror */
+static inline lumi_view_t *view_node_view(const view_pack_t *p, view_node_t n) {
+    return p ? p->view[n.i] : n.view;
+}
+
+static inline lumi_view_type_t view_node_type(const view_pack_t *p, view_node_t n) {
+    return p ? (lumi_view_type_t)p->type[n.i] : n.view->type;
+}
+
+static inline const lumi_style_desc_t *view_node_style(const view_pack_t *p, view_node_t n) {
+    return p ? p->style[n.i] : view_style(n.view);
+}
+
+static inline const char *view_node_text(const view_pack_t *p, view_node_t n) {
+    return p ? p->text[n.i] : n.view->text;
+}
+
+static inline bool view_node_visible(const view_pack_t *p, view_node_t n) {
+    return p ? (p->flags[n.i] & PACK_VISIBLE) != 0 : n.view->visible;
+}
+
+static inline bool view_node_boundary(const view_pack_t *p, view_node_t n) {
+    return p ? (p->flags[n.i] & PACK_BOUNDARY) != 0 : n.view->repaint_boundary;
+}
+
+static inline float view_node_x(const view_pack_t *p, view_node_t n) {
+    return p ? p->x[n.i] : n.view->frame_x;
+}
+
+static inline float view_node_y(const view_pack_t *p, view_node_t n) {
+    return p ? p->y[n.i] : n.view->frame_y;
+}
+
+static inline float view_node_w(const view_pack_t *p, view_node_t n) {
+    return p ? p->w[n.i] : n.view->frame_w;
+}
+
+static inline float view_node_h(const view_pack_t *p, view_node_t n) {
+    return p ? p->h[n.i] : n.view->frame_h;
+}
+
+#endif /* LUMI_VIEW_INTERNAL_H */
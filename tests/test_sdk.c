@@ -4,9 +4,21 @@
  */
 
 #include "lumiapp.h"
+#include "lumi_toolkit.h"
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <assert.h>
+#include <time.h>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <pthread.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
 
 static int tests_run = 0;
 static int tests_passed = 0;
@@ -39,6 +51,506 @@ static void test_log(void) {
     /* If we get here without crash, logging works */
 }
 
+/* Four threads log through the async writer into a file; every line must
+ * arrive, in order per thread. A burst in the dropping mode is either
+ * written or counted. */
+#ifndef _WIN32
+#define LOG_THREADS 4
+#define LOG_LINES   5000
+
+static void *log_worker(void *arg) {
+    int id = (int)(intptr_t)arg;
+    for (int i = 0; i < LOG_LINES; i++) lumi_log(LUMI_LOG_INFO, "worker", "%d %d", id, i);
+    return NULL;
+}
+#endif
+
+static void test_log_async(void) {
+#ifndef _WIN32
+    assert(lumi_log_set_mode((lumi_log_mode_t)7) == LUMI_ERR_INVALID);
+    char path[64];
+    snprintf(path, sizeof(path), "/tmp/lumi-test-log-%d.out", (int)getpid());
+    fflush(stdout);
+    fflush(stderr);
+    int saved[2] = { dup(STDOUT_FILENO), dup(STDERR_FILENO) };
+    int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0600);
+    dup2(fd, STDOUT_FILENO);
+    dup2(fd, STDERR_FILENO);
+    close(fd);
+
+    lumi_log_stats_t before, mid, after;
+    lumi_log_get_stats(&before);
+    assert(lumi_log_set_mode(LUMI_LOG_ASYNC_BLOCK) == LUMI_OK);
+    pthread_t threads[LOG_THREADS];
+    for (int i = 0; i < LOG_THREADS; i++) {
+        pthread_create(&threads[i], NULL, log_worker, (void *)(intptr_t)i);
+    }
+    for (int i = 0; i < LOG_THREADS; i++) pthread_join(threads[i], NULL);
+    lumi_log_flush();
+    lumi_log_get_stats(&mid);
+
+    assert(lumi_log_set_mode(LUMI_LOG_ASYNC_DROP) == LUMI_OK);
+    for (int i = 0; i < LOG_LINES; i++) lumi_log(LUMI_LOG_INFO, "burst", "%d", i);
+    assert(lumi_log_set_mode(LUMI_LOG_SYNC) == LUMI_OK);     /* writes what is left */
+    lumi_log_get_stats(&after);
+
+    dup2(saved[0], STDOUT_FILENO);
+    dup2(saved[1], STDERR_FILENO);
+    close(saved[0]);
+    close(saved[1]);
+
+    assert(mid.written - before.written == LOG_THREADS * LOG_LINES);
+    assert(mid.dropped == before.dropped && mid.writes - before.writes < LOG_THREADS * LOG_LINES);
+    assert(after.written - mid.written + after.dropped - mid.dropped >= LOG_LINES);
+    assert(after.rings >= 2);
+
+    char *text = NULL;
+    size_t len = 0;
+    int next[LOG_THREADS] = { 0 };
+    assert(lumi_file_read(path, &text, &len) == LUMI_OK);
+    for (char *line = text; (line = strstr(line, "I/worker: ")); line++) {
+        int id = -1, i = -1;
+        assert(sscanf(line, "I/worker: %d %d", &id, &i) == 2);
+        assert(id >= 0 && id < LOG_THREADS && i == next[id]);
+        next[id]++;
+    }
+    for (int i = 0; i < LOG_THREADS; i++) assert(next[i] == LOG_LINES);
+    free(text);
+    unlink(path);
+#endif
+}
+
+/* Deferred lines keep their arguments until the writer formats them, or
+ * until lumi-logdump reads them back from a binary log. */
+static void test_log_deferred(void) {
+#ifndef _WIN32
+    char path[64], bin[64];
+    snprintf(path, sizeof(path), "/tmp/lumi-test-log-%d.out", (int)getpid());
+    snprintf(bin, sizeof(bin), "/tmp/lumi-test-log-%d.bin", (int)getpid());
+    fflush(stdout);
+    int saved = dup(STDOUT_FILENO);
+    int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0600);
+    dup2(fd, STDOUT_FILENO);
+    close(fd);
+
+    char name[16] = "first";
+    lumi_log_arg_t typed[] = {
+        { .type = LUMI_LOG_ARG_UINT, .v.u = 12 },
+        { .type = LUMI_LOG_ARG_STRING, .v.s = "abcdef", .len = 3 },
+        { .type = LUMI_LOG_ARG_DOUBLE, .v.d = 2.5 },
+    };
+    assert(lumi_log_set_mode(LUMI_LOG_ASYNC_BLOCK) == LUMI_OK);
+    assert(lumi_log_set_deferred(true) == LUMI_OK);
+    for (int pass = 0; pass < 2; pass++) {
+        if (pass == 1) assert(lumi_log_set_binary_file(bin) == LUMI_OK);
+        lumi_log(LUMI_LOG_INFO, "defer", "n=%d s=%s f=%.2f x=%#x z=%zu c=%c 100%% w=[%*d] l=%lld",
+                 -5, name, 3.14159, 255u, (size_t)7, 'Q', 4, 9, 1LL << 40);
+        strcpy(name, "later");          /* the line kept its own copy */
+        lumi_log_args(LUMI_LOG_INFO, "defer", "typed %d %s %.1f", typed, 3);
+        lumi_log_args(LUMI_LOG_INFO, "defer", "missing %d %d", typed, 1);
+        strcpy(name, "first");
+        /* Formats are copied too; a new one at a freed one's address is new */
+        for (int i = 0; i < 2; i++) {
+            char *fmt = strdup(i ? "heap %d!" : "heap %d.");
+            lumi_log(LUMI_LOG_INFO, "defer", fmt, i);
+            memset(fmt, 'x', strlen(fmt));
+            free(fmt);
+        }
+    }
+    assert(lumi_log_set_deferred(false) == LUMI_OK);
+    lumi_log(LUMI_LOG_WARN, "plain", "text %d", 5);
+    assert(lumi_log_set_binary_file(NULL) == LUMI_OK);
+    assert(lumi_log_set_mode(LUMI_LOG_SYNC) == LUMI_OK);
+    assert(lumi_log_set_binary_file("/nonexistent/dir/log.bin") == LUMI_ERR_IO);
+
+    dup2(saved, STDOUT_FILENO);
+    close(saved);
+
+    const char *expect[] = {
+        "I/defer: n=-5 s=first f=3.14 x=0xff z=7 c=Q 100% w=[   9] l=1099511627776\n",
+        "I/defer: typed 12 abc 2.5\n",
+        "I/defer: missing 12 %d\n",
+        "I/defer: heap 0.\n",
+        "I/defer: heap 1!\n",
+        "W/plain: text 5\n",
+    };
+    char *text = NULL;
+    size_t len = 0;
+    assert(lumi_file_read(path, &text, &len) == LUMI_OK);
+    for (int i = 0; i < 5; i++) assert(strstr(text, expect[i]));
+    assert(!strstr(text, "plain"));     /* went to the binary log */
+    free(text);
+    unlink(path);
+
+    const char *dump = getenv("LUMI_LOGDUMP");
+    if (dump) {                         /* set by `make test` */
+        char cmd[256], line[256];
+        snprintf(cmd, sizeof(cmd), "%s %s", dump, bin);
+        FILE *out = popen(cmd, "r");
+        int found = 0;
+        while (out && fgets(line, sizeof(line), out)) {
+            for (int i = 0; i < 6; i++) found += strstr(line, expect[i]) != NULL;
+        }
+        assert(out && pclose(out) == 0 && found == 6);
+    }
+    unlink(bin);
+#endif
+}
+
+/* A tag's own level wins over the global one both ways; the macros skip
+ * their arguments when the line is filtered out. */
+static int log_arg_calls;
+
+static int log_arg(void) {
+    return ++log_arg_calls;
+}
+
+static void test_log_levels(void) {
+    assert(lumi_log_set_tag_level(NULL, LUMI_LOG_DEBUG) == LUMI_ERR_INVALID);
+    assert(lumi_log_set_tag_level("noisy", (lumi_log_level_t)9) == LUMI_ERR_INVALID);
+    assert(lumi_log_clear_tag_level("never-set") == LUMI_OK);
+
+    lumi_log_set_level(LUMI_LOG_INFO);
+    assert(!lumi_log_enabled(LUMI_LOG_DEBUG, "noisy"));
+    assert(lumi_log_set_tag_level("noisy", LUMI_LOG_DEBUG) == LUMI_OK);
+    assert(lumi_log_set_tag_level("quiet", LUMI_LOG_ERROR) == LUMI_OK);
+    assert(lumi_log_enabled(LUMI_LOG_DEBUG, "noisy"));
+    assert(!lumi_log_enabled(LUMI_LOG_VERBOSE, "noisy"));
+    assert(!lumi_log_enabled(LUMI_LOG_WARN, "quiet"));
+    assert(lumi_log_enabled(LUMI_LOG_ERROR, "quiet"));
+    assert(!lumi_log_enabled(LUMI_LOG_DEBUG, "other"));
+    assert(lumi_log_enabled(LUMI_LOG_INFO, "other"));
+
+    LUMI_LOGD("other", "skipped %d", log_arg());
+    LUMI_LOGW("quiet", "skipped %d", log_arg());
+    assert(log_arg_calls == 0);
+#if LUMI_LOG_COMPILE_LEVEL <= 1
+    LUMI_LOGD("noisy", "logged %d", log_arg());
+    assert(log_arg_calls == 1);
+#endif
+
+    assert(lumi_log_clear_tag_level("noisy") == LUMI_OK);
+    assert(lumi_log_clear_tag_level("quiet") == LUMI_OK);
+    assert(!lumi_log_enabled(LUMI_LOG_DEBUG, "noisy"));
+    assert(lumi_log_enabled(LUMI_LOG_WARN, "quiet"));
+}
+
+/* ── Tracing ───────────────────────────────────────────────────── */
+
+static size_t count_str(const char *text, const char *needle) {
+    size_t n = 0;
+    for (const char *p = text; (p = strstr(p, needle)); p += strlen(needle)) n++;
+    return n;
+}
+
+#ifndef _WIN32
+static void *trace_worker(void *arg) {
+    (void)arg;
+    for (int i = 0; i < 40000; i++) {   /* more than a thread's buffer holds */
+        lumi_trace_begin("worker");
+        lumi_trace_begin("inner");
+        lumi_trace_end();
+        lumi_trace_end();
+    }
+    return NULL;
+}
+#endif
+
+/* Spans from the app, the SDK and a second thread end up in one
+ * balanced trace; nothing is recorded while tracing is stopped. */
+static void test_trace(void) {
+#ifndef _WIN32
+    char path[64], file[64];
+    snprintf(path, sizeof(path), "/tmp/lumi-test-trace-%d.json", (int)getpid());
+    snprintf(file, sizeof(file), "/tmp/lumi-test-trace-%d.txt", (int)getpid());
+    assert(lumi_trace_export(NULL) == LUMI_ERR_INVALID);
+    assert(lumi_trace_export("/nonexistent/dir/trace.json") == LUMI_ERR_IO);
+
+    lumi_trace_begin("before");
+    assert(!lumi_trace_enabled());
+    lumi_trace_start();
+    assert(lumi_trace_enabled());
+    lumi_trace_end();                   /* of a span that began before the start */
+    lumi_trace_begin("outer \"quoted\"");
+    assert(lumi_storage_set("trace", "1") == LUMI_OK);
+    assert(lumi_file_write(file, "x", 1) == LUMI_OK);
+    pthread_t t;
+    pthread_create(&t, NULL, trace_worker, NULL);
+    pthread_join(t, NULL);
+    lumi_trace_end();
+    lumi_trace_stop();
+    lumi_trace_begin("after");
+    lumi_trace_end();
+    assert(lumi_trace_export(path) == LUMI_OK);
+    lumi_storage_remove("trace");
+    unlink(file);
+
+    char *text = NULL;
+    size_t len = 0;
+    assert(lumi_file_read(path, &text, &len) == LUMI_OK);
+    assert(strncmp(text, "{\"traceEvents\":[", 16) == 0);
+    assert(strstr(text, "\"name\":\"outer \\\"quoted\\\"\""));
+    assert(strstr(text, "\"name\":\"storage.set\""));
+    assert(strstr(text, "\"name\":\"file.write\""));
+    assert(strstr(text, "\"name\":\"worker\""));
+    assert(!strstr(text, "before") && !strstr(text, "after"));
+    assert(count_str(text, "\"ph\":\"B\"") == count_str(text, "\"ph\":\"E\""));
+    assert(count_str(text, "\"thread_name\"") == 2);
+    assert(!strstr(text, "\"dropped\":\"0\""));
+    free(text);
+    unlink(path);
+#endif
+}
+
+/* ── Metrics ───────────────────────────────────────────────────── */
+
+static int64_t metric_value(const char *name) {
+    lumi_metric_value_t v;
+    lumi_metric_t *m = lumi_metric_counter(name, NULL);
+    if (!m) m = lumi_metric_gauge(name, NULL);
+    if (!m) m = lumi_metric_histogram(name, NULL);
+    assert(m && lumi_metric_read(m, &v) == LUMI_OK);
+    return v.value;
+}
+
+#ifndef _WIN32
+static void *metric_worker(void *arg) {
+    lumi_metric_t *m = lumi_metric_counter("test_events_total", "Events");
+    for (int i = 0; i < 10000; i++) lumi_metric_add(m, 1);
+    lumi_metric_record(arg, 7);
+    return NULL;
+}
+#endif
+
+static void timer_count_cb(void *ud) { (*(int *)ud)++; }
+
+static void test_metrics(void) {
+    assert(!lumi_metric_counter("2bad", NULL) && !lumi_metric_counter("bad-name", NULL));
+    lumi_metric_t *hist = lumi_metric_histogram("test_latency_ns", "Latency");
+    assert(hist && lumi_metric_histogram("test_latency_ns", NULL) == hist);
+    assert(!lumi_metric_counter("test_latency_ns", NULL));
+    for (uint64_t v = 1; v <= 10000; v++) lumi_metric_record(hist, v);
+#ifndef _WIN32
+    pthread_t threads[4];
+    for (int i = 0; i < 4; i++) pthread_create(&threads[i], NULL, metric_worker, hist);
+    for (int i = 0; i < 4; i++) pthread_join(threads[i], NULL);
+    assert(metric_value("test_events_total") == 40000);
+#endif
+    lumi_metric_value_t v;
+    assert(lumi_metric_read(hist, &v) == LUMI_OK);
+    assert(v.type == LUMI_METRIC_HISTOGRAM && v.min == 1 && v.max == 10000);
+    assert(v.p50 > 4800 && v.p50 < 5200 && v.p99 > 9600 && v.p99 <= 10000);
+
+    /* The SDK's own */
+    int64_t hits = metric_value("lumi_storage_hits_total");
+    int64_t misses = metric_value("lumi_storage_misses_total");
+    int64_t entries = metric_value("lumi_storage_entries");
+    assert(lumi_storage_set("metric", "12345") == LUMI_OK);
+    assert(lumi_storage_get("metric") && !lumi_storage_get("no-such-key"));
+    assert(metric_value("lumi_storage_hits_total") == hits + 1);
+    assert(metric_value("lumi_storage_misses_total") == misses + 1);
+    assert(metric_value("lumi_storage_entries") == entries + 1);
+    lumi_storage_remove("metric");
+    assert(metric_value("lumi_storage_entries") == entries);
+
+    int64_t nodes = metric_value("lumi_view_nodes");
+    lumi_view_t *col = lumi_column();
+    lumi_view_add_child(col, lumi_text("a"));
+    assert(metric_value("lumi_view_nodes") == nodes + 2);
+    lumi_view_destroy(col);
+    assert(metric_value("lumi_view_nodes") == nodes);
+
+    int fired = 0;
+    int64_t timers = metric_value("lumi_timer_fired_total");
+    int id = lumi_timer_set(0, false, timer_count_cb, &fired);
+    assert(lumi_timer_poll() == 1 && fired == 1 && lumi_timer_poll() == 0);
+    lumi_timer_cancel(id);
+    assert(metric_value("lumi_timer_fired_total") == timers + 1);
+    assert(metric_value("lumi_timer_lateness_ns") >= 1);
+
+    size_t count = lumi_metrics_snapshot(NULL, 0);
+    lumi_metric_value_t all[64];
+    assert(count >= 14 && count <= 64 && lumi_metrics_snapshot(all, 64) == count);
+    assert(strcmp(all[0].name, "lumi_storage_hits_total") == 0);
+
+#ifndef _WIN32
+    int sv[2];
+    assert(socketpair(AF_UNIX, SOCK_STREAM, 0, sv) == 0);
+    assert(lumi_metrics_write(sv[0]) == LUMI_OK);
+    close(sv[0]);
+    static char text[64 * 1024];
+    size_t len = 0;
+    ssize_t n;
+    while ((n = read(sv[1], text + len, sizeof(text) - 1 - len)) > 0) len += (size_t)n;
+    close(sv[1]);
+    text[len] = '\0';
+    assert(strstr(text, "# TYPE lumi_storage_hits_total counter\n"));
+    assert(strstr(text, "\ntest_events_total 40000\n"));
+    assert(strstr(text, "# TYPE test_latency_ns summary\n"));
+    assert(strstr(text, "test_latency_ns{quantile=\"0.99\"} "));
+    assert(strstr(text, "\ntest_latency_ns_count 10004\n"));
+    assert(lumi_metrics_write(-1) == LUMI_ERR_INVALID);
+#endif
+}
+
+/* ── Memory accounting ─────────────────────────────────────────── */
+
+static size_t mem_live(lumi_mem_subsystem_t sys) {
+    lumi_mem_usage_t u;
+    assert(lumi_mem_get_usage(sys, &u) == LUMI_OK);
+    return u.live;
+}
+
+static void mem_intent_cb(const lumi_intent_t *intent, void *ud) {
+    (void)intent; (void)ud;
+}
+
+static void test_mem(void) {
+    size_t views = mem_live(LUMI_MEM_VIEWS), strings = mem_live(LUMI_MEM_STRINGS);
+    lumi_view_t *col = lumi_column();
+    lumi_view_t *text = lumi_text("hello");
+    lumi_view_add_child(col, text);
+    lumi_view_set_id(col, "root");
+    assert(mem_live(LUMI_MEM_VIEWS) > views);
+    assert(mem_live(LUMI_MEM_STRINGS) == strings + sizeof("hello") + sizeof("root"));
+    size_t footprint = lumi_view_get_footprint(col);
+    assert(footprint == mem_live(LUMI_MEM_VIEWS) - views + mem_live(LUMI_MEM_STRINGS) - strings);
+    assert(lumi_view_get_footprint(text) < footprint && lumi_view_get_footprint(NULL) == 0);
+    lumi_view_destroy(col);
+    assert(mem_live(LUMI_MEM_VIEWS) == views && mem_live(LUMI_MEM_STRINGS) == strings);
+
+    lumi_mem_usage_t u;
+    size_t storage = mem_live(LUMI_MEM_STORAGE);
+    assert(lumi_storage_set("mem", "0123456789") == LUMI_OK);
+    assert(lumi_mem_get_usage(LUMI_MEM_STORAGE, &u) == LUMI_OK);
+    assert(u.live == storage + sizeof("mem") + sizeof("0123456789") && u.peak >= u.live);
+
+    /* A budget refuses growth and leaves the old value */
+    assert(lumi_mem_set_budget(LUMI_MEM_STORAGE, u.live + 8) == LUMI_OK);
+    assert(lumi_storage_set("mem", "01234567890123456789") == LUMI_ERR_NOMEM);
+    assert(strcmp(lumi_storage_get("mem"), "0123456789") == 0);
+    assert(lumi_storage_set("mem", "short") == LUMI_OK);
+    assert(lumi_mem_get_usage(LUMI_MEM_STORAGE, &u) == LUMI_OK && u.refused >= 1);
+    assert(lumi_mem_set_budget(LUMI_MEM_STORAGE, 0) == LUMI_OK);
+    lumi_storage_remove("mem");
+    assert(mem_live(LUMI_MEM_STORAGE) == storage);
+
+    size_t intents = mem_live(LUMI_MEM_INTENTS);
+    assert(lumi_intent_register("test.mem.ping", mem_intent_cb, NULL) == LUMI_OK);
+    assert(mem_live(LUMI_MEM_INTENTS) > intents);
+    assert(lumi_intent_unregister("test.mem.ping", mem_intent_cb, NULL) == LUMI_OK);
+    assert(mem_live(LUMI_MEM_INTENTS) <= intents + 64 * sizeof(void *));  /* buckets stay */
+
+    /* File buffers count until handed over */
+    const char *path = "/tmp/lumi_test_mem.txt";
+    char data[4096];
+    memset(data, 'x', sizeof(data));
+    assert(lumi_file_write(path, data, sizeof(data)) == LUMI_OK);
+    size_t files = mem_live(LUMI_MEM_FILES);
+    char *buf = NULL;
+    size_t len = 0;
+    assert(lumi_file_read(path, &buf, &len) == LUMI_OK && len == sizeof(data));
+    free(buf);
+    assert(lumi_mem_get_usage(LUMI_MEM_FILES, &u) == LUMI_OK);
+    assert(u.live == files && u.peak >= sizeof(data) + 1);
+    assert(lumi_mem_set_budget(LUMI_MEM_FILES, 1024) == LUMI_OK);
+    assert(lumi_file_read(path, &buf, &len) == LUMI_ERR_NOMEM);
+    assert(lumi_mem_set_budget(LUMI_MEM_FILES, 0) == LUMI_OK);
+    lumi_file_remove(path);
+
+    /* The newest app is charged too, against its own budget */
+    lumi_manifest_t manifest = { .app_id = "com.test.mem", .name = "MemTest", .version = "1.0.0" };
+    lumi_lifecycle_t lc = { 0 };
+    lumi_app_t *app = lumi_app_create(&manifest, &lc, NULL);
+    assert(app);
+    lumi_view_t *v = lumi_text("charged");
+    assert(lumi_app_get_mem_usage(app, &u) == LUMI_OK && u.live == lumi_view_get_footprint(v));
+    assert(lumi_app_set_mem_budget(app, u.live + 16) == LUMI_OK);
+    assert(lumi_column() == NULL);
+    assert(lumi_app_get_mem_usage(app, &u) == LUMI_OK && u.refused == 1 && u.budget);
+    lumi_view_destroy(v);
+    assert(lumi_app_get_mem_usage(app, &u) == LUMI_OK && u.live == 0 && u.peak > 0);
+    lumi_app_destroy(app);
+
+    assert(lumi_mem_get_usage(LUMI_MEM_SUBSYSTEM_COUNT, &u) == LUMI_ERR_INVALID);
+    assert(lumi_mem_get_usage(LUMI_MEM_VIEWS, NULL) == LUMI_ERR_INVALID);
+    assert(lumi_mem_set_budget((lumi_mem_subsystem_t)-1, 1) == LUMI_ERR_INVALID);
+    assert(lumi_app_get_mem_usage(NULL, &u) == LUMI_ERR_INVALID);
+    assert(lumi_app_set_mem_budget(NULL, 1) == LUMI_ERR_INVALID);
+}
+
+typedef struct {
+    size_t live, allocs, frees;
+} tracker_t;
+
+static void *tracker_alloc(void *ctx, size_t size) {
+    tracker_t *t = ctx;
+    void *p = malloc(size);
+    if (p) {
+        t->live += size;
+        t->allocs++;
+    }
+    return p;
+}
+
+static void tracker_free(void *ctx, void *p, size_t size) {
+    tracker_t *t = ctx;
+    t->live -= size;
+    t->frees++;
+    free(p);
+}
+
+static size_t mem_live_total(void) {
+    size_t total = 0;
+    for (int i = 0; i < LUMI_MEM_SUBSYSTEM_COUNT; i++) total += mem_live((lumi_mem_subsystem_t)i);
+    return total;
+}
+
+static void test_allocator(void) {
+    assert(mem_live_total() == 0);
+    lumi_allocator_t bad = { .alloc = tracker_alloc };
+    assert(lumi_set_allocator(&bad) == LUMI_ERR_INVALID);
+
+    /* No realloc: the SDK moves hit-test indexes itself */
+    tracker_t t = { 0 };
+    lumi_allocator_t tracking = { tracker_alloc, NULL, tracker_free, &t };
+    assert(lumi_set_allocator(&tracking) == LUMI_OK);
+    lumi_view_t *row = lumi_row();
+    for (int i = 0; i < 8; i++) lumi_view_add_child(row, lumi_button("ok"));
+    lumi_view_layout(row, 320, 48);
+    assert(lumi_view_hit_test(row, 1, 1) != NULL);
+    assert(lumi_storage_set("alloc", "tracked") == LUMI_OK);
+    assert(lumi_intent_register("test.alloc", mem_intent_cb, NULL) == LUMI_OK);
+    assert(t.allocs > 10 && t.live == mem_live_total());
+    assert(lumi_set_allocator(NULL) == LUMI_ERR_INVALID);   /* blocks are live */
+
+    lumi_view_destroy(row);
+    lumi_storage_remove("alloc");
+    lumi_intent_unregister("test.alloc", mem_intent_cb, NULL);
+    assert(t.live == 0 && t.frees == t.allocs);
+    assert(lumi_set_allocator(NULL) == LUMI_OK);
+
+    /* An app's allocator outlives the app while its blocks do */
+    tracker_t at = { 0 };
+    lumi_allocator_t app_tracking = { tracker_alloc, NULL, tracker_free, &at };
+    lumi_manifest_t manifest = { .app_id = "com.test.alloc", .name = "AllocTest", .version = "1.0.0" };
+    lumi_lifecycle_t lc = { 0 };
+    lumi_app_t *old = lumi_app_create(&manifest, &lc, NULL);
+    lumi_app_t *app = lumi_app_create(&manifest, &lc, NULL);
+    assert(lumi_app_set_allocator(old, &app_tracking) == LUMI_ERR_INVALID);
+    assert(lumi_app_set_allocator(app, &app_tracking) == LUMI_OK);
+    assert(lumi_storage_set("alloc", "app") == LUMI_OK && at.live > 0);
+    lumi_app_destroy(app);
+    lumi_app_destroy(old);
+    size_t live = at.live;
+    assert(lumi_set_allocator(NULL) == LUMI_ERR_INVALID);
+    assert(lumi_storage_set("alloc", "app, longer") == LUMI_OK && at.live > live);
+    lumi_storage_remove("alloc");
+    assert(at.live == 0 && at.allocs == at.frees);
+    assert(lumi_set_allocator(NULL) == LUMI_OK);
+    assert(lumi_app_set_allocator(NULL, NULL) == LUMI_ERR_INVALID);
+}
+
 /* ── App lifecycle ─────────────────────────────────────────────── */
 
 static int create_called = 0;
@@ -169,6 +681,891 @@ static void test_view_callbacks(void) {
     lumi_view_destroy(btn);
 }
 
+static void test_view_layout(void) {
+    lumi_view_t *col = lumi_column();
+    lumi_view_set_padding(col, 10, 10, 10, 10);
+    lumi_view_t *bar = lumi_row();
+    lumi_view_set_height(bar, 56.0f);
+    lumi_view_t *icon = lumi_image("icon.png");
+    lumi_view_set_width(icon, 24.0f);
+    lumi_view_set_height(icon, 24.0f);
+    lumi_view_t *body = lumi_text("Body");
+    lumi_view_set_margin(body, 4, 0, 0, 0);
+
+    lumi_view_add_child(bar, icon);
+    lumi_view_add_child(col, bar);
+    lumi_view_add_child(col, body);
+    lumi_view_layout(col, 320.0f, 480.0f);
+
+    float x, y, w, h;
+    lumi_view_get_frame(col, &x, &y, &w, &h);
+    assert(x == 0.0f && y == 0.0f && w == 320.0f && h == 480.0f);
+    lumi_view_get_frame(bar, &x, &y, &w, &h);
+    assert(x == 10.0f && y == 10.0f && w == 300.0f && h == 56.0f);
+    lumi_view_get_frame(icon, &x, &y, &w, &h);
+    assert(x == 0.0f && y == 0.0f && w == 24.0f && h == 24.0f);
+    lumi_view_get_frame(body, &x, &y, &w, &h);
+    assert(x == 10.0f && y == 70.0f && w > 0.0f && h > 0.0f);
+
+    lumi_view_destroy(col);
+}
+
+static int replay_rects = 0, replay_texts = 0;
+static uint32_t last_color;
+static void count_op(const lumi_draw_op_t *op, void *ud) {
+    (void)ud;
+    last_color = op->color;
+    if (op->type == LUMI_DRAW_RECT) replay_rects++;
+    if (op->type == LUMI_DRAW_TEXT) {
+        assert(op->text != NULL);
+        replay_texts++;
+    }
+}
+
+static void test_display_list(void) {
+    lumi_view_t *root = lumi_column();
+    lumi_view_t *bar = lumi_row();
+    lumi_view_set_background(bar, 0x2196F3FF);
+    lumi_view_set_repaint_boundary(bar, true);
+    lumi_view_t *title = lumi_text("Title");
+    lumi_view_add_child(bar, title);
+    lumi_view_add_child(root, bar);
+    lumi_view_t *label = lumi_text("Label");
+    lumi_view_add_child(root, label);
+    lumi_view_layout(root, 320.0f, 480.0f);
+
+    lumi_display_list_t *dl = lumi_display_list_create();
+    assert(lumi_view_paint(root, dl) == LUMI_OK);
+    assert(lumi_display_list_count(dl) == 3);
+
+    /* Clean boundary is spliced, dirty leaf re-recorded */
+    lumi_text_set_content(label, "Changed");
+    assert(lumi_view_paint(root, dl) == LUMI_OK);
+    assert(lumi_display_list_count(dl) == 3);
+
+    uint8_t *buf = NULL;
+    size_t len = 0;
+    assert(lumi_display_list_serialize(dl, &buf, &len) == LUMI_OK);
+    lumi_display_list_t *copy = lumi_display_list_create();
+    assert(lumi_display_list_deserialize(copy, buf, len) == LUMI_OK);
+    assert(lumi_display_list_count(copy) == 3);
+    replay_rects = replay_texts = 0;
+    lumi_display_list_replay(copy, count_op, NULL);
+    assert(replay_rects == 1 && replay_texts == 2);
+
+    buf[0] = 'X';
+    assert(lumi_display_list_deserialize(copy, buf, len) == LUMI_ERR_INVALID);
+    assert(lumi_display_list_deserialize(copy, buf, 4) == LUMI_ERR_INVALID);
+    free(buf);
+
+    lumi_display_list_destroy(copy);
+    lumi_display_list_destroy(dl);
+    lumi_view_destroy(root);
+}
+
+static lumi_view_t *build_settings(void) {
+    lumi_view_t *root = lumi_column();
+    lumi_view_set_padding(root, 8, 8, 8, 8);
+    lumi_view_t *scroll = lumi_scroll();
+    lumi_view_set_id(scroll, "scroll");
+    for (int i = 0; i < 6; i++) {
+        lumi_view_t *row = lumi_row();
+        lumi_view_set_margin(row, 4, 0, 4, 0);
+        lumi_view_add_child(row, lumi_image("icon.png"));
+        lumi_view_add_child(row, lumi_text(i % 2 ? "Wi-Fi" : "Bluetooth devices"));
+        lumi_view_add_child(row, lumi_spacer());
+        lumi_view_add_child(row, lumi_button("On"));
+        if (i == 2) lumi_view_set_repaint_boundary(row, true);
+        if (i == 4) lumi_view_set_visible(row, false);
+        lumi_view_add_child(scroll, row);
+    }
+    lumi_view_add_child(root, lumi_text("Settings"));
+    lumi_view_add_child(root, lumi_divider());
+    lumi_view_add_child(root, scroll);
+    return root;
+}
+
+static bool same_paint(lumi_view_t *a, lumi_view_t *b) {
+    lumi_display_list_t *la = lumi_display_list_create();
+    lumi_display_list_t *lb = lumi_display_list_create();
+    uint8_t *da, *db;
+    size_t na, nb;
+    lumi_view_layout(a, 320.0f, 480.0f);
+    lumi_view_layout(b, 320.0f, 480.0f);
+    assert(lumi_view_paint(a, la) == LUMI_OK && lumi_view_paint(b, lb) == LUMI_OK);
+    assert(lumi_display_list_serialize(la, &da, &na) == LUMI_OK);
+    assert(lumi_display_list_serialize(lb, &db, &nb) == LUMI_OK);
+    bool same = na == nb && memcmp(da, db, na) == 0;
+    free(da);
+    free(db);
+    lumi_display_list_destroy(la);
+    lumi_display_list_destroy(lb);
+    return same;
+}
+
+static void test_view_packed(void) {
+    lumi_view_t *plain = build_settings();
+    lumi_view_t *packed = build_settings();
+    assert(lumi_view_set_packed(packed, true) == LUMI_OK);
+    assert(lumi_view_is_packed(packed) && !lumi_view_is_packed(plain));
+    assert(lumi_view_set_packed(lumi_view_get_child(packed, 0), true) == LUMI_ERR_INVALID);
+    assert(same_paint(plain, packed));
+
+    /* Frames are written back to the views */
+    float x, y, w, h, px, py, pw, ph;
+    lumi_view_t *row = lumi_view_get_child(lumi_view_find_by_id(packed, "scroll"), 1);
+    lumi_view_get_frame(row, &x, &y, &w, &h);
+    lumi_view_get_frame(lumi_view_get_child(lumi_view_find_by_id(plain, "scroll"), 1),
+                        &px, &py, &pw, &ph);
+    assert(x == px && y == py && w == pw && h == ph && h > 0.0f);
+    assert(lumi_view_hit_test(packed, x + 1, y + 8 + 1) != NULL);
+
+    /* In-place edits, structural edits and class changes all carry over */
+    lumi_view_t *trees[2] = { plain, packed };
+    lumi_style_sheet_t *sheet = lumi_style_sheet_create();
+    lumi_style_desc_t d;
+    lumi_style_desc_init(&d);
+    const lumi_style_t *big = lumi_style_intern(&d);
+    assert(lumi_style_sheet_set(sheet, "title", big) == LUMI_OK);
+    for (int t = 0; t < 2; t++) {
+        lumi_view_t *scroll = lumi_view_find_by_id(trees[t], "scroll");
+        lumi_view_set_padding(lumi_view_get_child(scroll, 0), 10, 10, 10, 10);
+        lumi_view_set_visible(lumi_view_get_child(scroll, 4), true);
+        lumi_text_set_content(lumi_view_get_child(trees[t], 0), "Preferences");
+    }
+    assert(same_paint(plain, packed));
+    for (int t = 0; t < 2; t++) {
+        lumi_view_t *scroll = lumi_view_find_by_id(trees[t], "scroll");
+        lumi_view_destroy(lumi_view_get_child(scroll, 5));
+        lumi_view_add_child(scroll, lumi_text("About"));
+        lumi_view_set_style_class(lumi_view_get_child(trees[t], 0), sheet, "title");
+    }
+    assert(same_paint(plain, packed));
+    lumi_style_release(big);
+    d.font_size = 28.0f;
+    big = lumi_style_intern(&d);
+    assert(lumi_style_sheet_set(sheet, "title", big) == LUMI_OK);
+    assert(same_paint(plain, packed));
+    lumi_style_release(big);
+    lumi_style_sheet_destroy(sheet);
+
+    assert(lumi_view_set_packed(packed, false) == LUMI_OK);
+    assert(same_paint(plain, packed));
+    lumi_view_destroy(plain);
+    lumi_view_destroy(packed);
+}
+
+/* Deterministic trees mixing every container and leaf type with margins,
+ * fixed sizes, opacity, hidden views, scroll offsets and boundaries */
+static uint32_t tree_rand(uint32_t *seed) {
+    *seed = *seed * 1103515245u + 12345u;
+    return *seed >> 16;
+}
+
+static lumi_view_t *build_random(uint32_t *seed, int depth) {
+    static const char *words[] = { "", "OK", "Bluetooth devices", "A longer line of text to wrap" };
+    lumi_view_t *v;
+    uint32_t kind = depth > 0 ? tree_rand(seed) % 11 : 5 + tree_rand(seed) % 6;
+    switch (kind) {
+        case 0:  v = lumi_column(); break;
+        case 1:  v = lumi_row(); break;
+        case 2:  v = lumi_stack(); break;
+        case 3:  v = lumi_scroll(); break;
+        case 4:  v = lumi_card(); break;
+        case 5:  v = lumi_text(words[tree_rand(seed) % 4]); break;
+        case 6:  v = lumi_button(words[tree_rand(seed) % 4]); break;
+        case 7:  v = lumi_image(tree_rand(seed) % 2 ? "icon.png" : ""); break;
+        case 8:  v = lumi_text_field(words[tree_rand(seed) % 4]); break;
+        case 9:  v = lumi_spacer(); break;
+        default: v = lumi_divider(); break;
+    }
+    uint32_t r = tree_rand(seed);
+    if (r & 1) lumi_view_set_padding(v, r % 7, r % 5, r % 3, r % 9);
+    if (r & 2) lumi_view_set_margin(v, r % 4, r % 6, r % 2, r % 3);
+    if (r & 4) lumi_view_set_width(v, (float)(20 + r % 200));
+    if (r & 8) lumi_view_set_height(v, (float)(10 + r % 90));
+    if (r & 16) lumi_view_set_background(v, 0x20406080u | (r & 0xFF));
+    if (r & 32) lumi_view_set_opacity(v, (r & 64) ? 0.5f : 0.0f);
+    if ((r & 0x300) == 0x300) lumi_view_set_visible(v, false);
+    if ((r & 0xC00) == 0xC00) lumi_view_set_repaint_boundary(v, true);
+    if (r & 0x1000) lumi_view_set_font_size(v, 11.0f + (float)(r % 13));
+    if (kind < 5) {
+        int n = 1 + (int)(tree_rand(seed) % 5);
+        for (int i = 0; i < n; i++) lumi_view_add_child(v, build_random(seed, depth - 1));
+        if (kind == 3) lumi_scroll_set_offset(v, 0.0f, (float)(tree_rand(seed) % 40));
+    }
+    return v;
+}
+
+static void same_frames(lumi_view_t *a, lumi_view_t *b) {
+    float ax, ay, aw, ah, bx, by, bw, bh;
+    lumi_view_get_frame(a, &ax, &ay, &aw, &ah);
+    lumi_view_get_frame(b, &bx, &by, &bw, &bh);
+    assert(ax == bx && ay == by && aw == bw && ah == bh);
+    assert(lumi_view_get_child_count(a) == lumi_view_get_child_count(b));
+    for (int i = 0; i < lumi_view_get_child_count(a); i++) {
+        same_frames(lumi_view_get_child(a, i), lumi_view_get_child(b, i));
+    }
+}
+
+/* Packed and pointer walks agree frame for frame and byte for byte */
+static void test_view_packed_trees(void) {
+    for (uint32_t s = 1; s <= 24; s++) {
+        uint32_t seed_a = s, seed_b = s;
+        lumi_view_t *plain = lumi_column(), *packed = lumi_column();
+        for (uint32_t i = 0; i < 1 + s % 4; i++) {
+            lumi_view_add_child(plain, build_random(&seed_a, 4));
+            lumi_view_add_child(packed, build_random(&seed_b, 4));
+        }
+        assert(lumi_view_set_packed(packed, true) == LUMI_OK);
+        assert(same_paint(plain, packed));
+        same_frames(plain, packed);
+
+        /* Edits in place and in shape, then a second pass over the caches */
+        lumi_view_t *trees[2] = { plain, packed };
+        for (int t = 0; t < 2; t++) {
+            lumi_view_t *first = lumi_view_get_child(trees[t], 0);
+            if (first) lumi_view_set_visible(first, !lumi_view_get_visible(first));
+            lumi_view_set_padding(trees[t], 3, 1, 4, 1);
+            lumi_view_add_child(trees[t], lumi_text("appended"));
+        }
+        assert(same_paint(plain, packed));
+        same_frames(plain, packed);
+        assert(same_paint(plain, packed));
+        lumi_view_destroy(plain);
+        lumi_view_destroy(packed);
+    }
+}
+
+static void test_hit_test(void) {
+    lumi_view_t *root = lumi_column();
+    lumi_view_t *row = lumi_row();
+    lumi_view_set_height(row, 40.0f);
+    lumi_view_t *btns[3];
+    for (int i = 0; i < 3; i++) {
+        btns[i] = lumi_button("B");
+        lumi_view_set_width(btns[i], 50.0f);
+        lumi_view_set_height(btns[i], 40.0f);
+        lumi_view_add_child(row, btns[i]);
+    }
+    lumi_view_on_click(btns[1], on_click, NULL);
+    lumi_view_add_child(root, row);
+
+    lumi_view_t *scroll = lumi_scroll();
+    lumi_view_set_height(scroll, 100.0f);
+    lumi_view_t *list = lumi_column();
+    lumi_view_t *items[10];
+    for (int i = 0; i < 10; i++) {
+        items[i] = lumi_text("item");
+        lumi_view_set_height(items[i], 50.0f);
+        lumi_view_add_child(list, items[i]);
+    }
+    lumi_view_add_child(scroll, list);
+    lumi_view_add_child(root, scroll);
+
+    lumi_view_t *stack = lumi_stack();
+    lumi_view_t *under = lumi_spacer();
+    lumi_view_t *over = lumi_spacer();
+    lumi_view_set_width(under, 100.0f); lumi_view_set_height(under, 30.0f);
+    lumi_view_set_width(over, 100.0f);  lumi_view_set_height(over, 30.0f);
+    lumi_view_add_child(stack, under);
+    lumi_view_add_child(stack, over);
+    lumi_view_add_child(root, stack);
+    lumi_view_layout(root, 320.0f, 480.0f);
+
+    assert(lumi_view_hit_test(root, 75.0f, 20.0f) == btns[1]);
+    assert(lumi_view_hit_test(root, 175.0f, 20.0f) == row);
+    assert(lumi_view_hit_test(root, 10.0f, 60.0f) == items[0]);
+    assert(lumi_view_hit_test(root, 10.0f, 150.0f) == over);
+    assert(lumi_view_hit_test(root, 400.0f, 10.0f) == NULL);
+
+    lumi_scroll_set_offset(scroll, 0.0f, 120.0f);
+    assert(lumi_view_hit_test(root, 10.0f, 60.0f) == items[2]);
+
+    click_count = 0;
+    assert(lumi_view_dispatch_click(root, 75.0f, 20.0f) == true);
+    assert(click_count == 1);
+    assert(lumi_view_dispatch_click(root, 25.0f, 20.0f) == false);
+
+    lumi_view_set_visible(over, false);
+    assert(lumi_view_hit_test(root, 10.0f, 150.0f) == under);
+
+    lumi_view_destroy(root);
+}
+
+static void test_view_find_by_id(void) {
+    lumi_view_t *root = lumi_column();
+    lumi_view_t *card = lumi_card();
+    lumi_view_t *title = lumi_text("Title");
+    lumi_view_set_id(card, "card");
+    lumi_view_set_id(title, "title");
+    lumi_view_add_child(card, title);
+    lumi_view_add_child(root, card);
+
+    assert(lumi_view_find_by_id(root, "title") == title);
+    assert(lumi_view_find_by_id(root, "missing") == NULL);
+    assert(lumi_view_find_by_id(card, "card") == card);
+
+    /* Index follows re-keying and later additions */
+    lumi_view_set_id(title, "heading");
+    assert(lumi_view_find_by_id(root, "title") == NULL);
+    assert(lumi_view_find_by_id(root, "heading") == title);
+    lumi_view_t *late = lumi_button("OK");
+    lumi_view_set_id(late, "ok");
+    lumi_view_add_child(card, late);
+    assert(lumi_view_find_by_id(root, "ok") == late);
+
+    /* Detached subtrees leave the index and get their own */
+    lumi_view_remove_child(root, card);
+    assert(lumi_view_find_by_id(root, "heading") == NULL);
+    assert(lumi_view_find_by_id(card, "heading") == title);
+    lumi_view_add_child(root, card);
+    assert(lumi_view_find_by_id(root, "ok") == late);
+
+    lumi_view_destroy(late);   /* still attached: detaches first */
+    assert(lumi_view_get_child_count(card) == 1);
+    assert(lumi_view_find_by_id(root, "ok") == NULL);
+    assert(lumi_view_find_by_id(root, "heading") == title);
+
+    /* An index that cannot grow is dropped, not left missing views */
+    lumi_view_t *list = lumi_column(), *items[40];
+    char id[16];
+    for (int i = 0; i < 40; i++) {
+        items[i] = lumi_text("item");
+        snprintf(id, sizeof(id), "item%d", i);
+        lumi_view_set_id(items[i], id);
+        lumi_view_add_child(list, items[i]);
+    }
+    lumi_mem_usage_t u;
+    lumi_mem_get_usage(LUMI_MEM_VIEWS, &u);
+    assert(lumi_mem_set_budget(LUMI_MEM_VIEWS, u.live + 64) == LUMI_OK);
+    lumi_view_add_child(root, list);
+    assert(lumi_view_find_by_id(root, "item39") == items[39]);     /* by walking */
+    assert(lumi_mem_set_budget(LUMI_MEM_VIEWS, 0) == LUMI_OK);
+    assert(lumi_view_find_by_id(root, "item39") == items[39]);
+    assert(lumi_view_find_by_id(root, "item0") == items[0]);
+    assert(lumi_view_find_by_id(root, "heading") == title);
+
+    lumi_view_destroy(root);
+}
+
+static int mut_counts[5];
+static void count_mutation(const lumi_mutation_t *m, void *ud) {
+    (void)ud;
+    mut_counts[m->type]++;
+}
+
+static lumi_view_t *build_feed(const char **ids, int n, const char *title) {
+    lumi_view_t *root = lumi_column();
+    lumi_view_t *header = lumi_text(title);
+    lumi_view_set_id(header, "header");
+    lumi_view_add_child(root, header);
+    lumi_view_t *list = lumi_column();
+    lumi_view_set_id(list, "list");
+    for (int i = 0; i < n; i++) {
+        lumi_view_t *item = lumi_text(ids[i]);
+        lumi_view_set_id(item, ids[i]);
+        lumi_view_add_child(list, item);
+    }
+    lumi_view_add_child(root, list);
+    return root;
+}
+
+static void test_view_reconcile(void) {
+    const char *before[] = { "a", "b", "c" };
+    const char *after[]  = { "c", "a", "b", "d" };
+    lumi_view_t *mounted = build_feed(before, 3, "Inbox");
+    lumi_view_t *list = lumi_view_get_child(mounted, 1);
+    lumi_view_t *a = lumi_view_get_child(list, 0);
+    lumi_view_t *c = lumi_view_get_child(list, 2);
+
+    memset(mut_counts, 0, sizeof(mut_counts));
+    lumi_view_t *root = lumi_view_reconcile(mounted, build_feed(after, 4, "Inbox (1)"),
+                                            count_mutation, NULL);
+    assert(root == mounted);
+    assert(mut_counts[LUMI_MUTATION_UPDATE] == 1);
+    assert(mut_counts[LUMI_MUTATION_MOVE] == 1);
+    assert(mut_counts[LUMI_MUTATION_INSERT] == 1);
+    assert(mut_counts[LUMI_MUTATION_REMOVE] == 0);
+    assert(strcmp(lumi_text_get_content(lumi_view_get_child(root, 0)), "Inbox (1)") == 0);
+    assert(lumi_view_get_child_count(list) == 4);
+    assert(lumi_view_get_child(list, 0) == c);
+    assert(lumi_view_get_child(list, 1) == a);
+    assert(strcmp(lumi_view_get_id(lumi_view_get_child(list, 3)), "d") == 0);
+    assert(lumi_view_find_by_id(root, "d") == lumi_view_get_child(list, 3));
+
+    /* Dropping keys removes them; an incompatible root is replaced */
+    memset(mut_counts, 0, sizeof(mut_counts));
+    root = lumi_view_reconcile(root, build_feed(before + 1, 1, "Inbox (1)"), count_mutation, NULL);
+    assert(mut_counts[LUMI_MUTATION_REMOVE] == 3);
+    assert(lumi_view_find_by_id(root, "d") == NULL);
+    assert(lumi_view_get_child_count(list) == 1);
+
+    /* Reconciling the mounted tree with itself changes nothing */
+    memset(mut_counts, 0, sizeof(mut_counts));
+    assert(lumi_view_reconcile(root, root, count_mutation, NULL) == root);
+    assert(mut_counts[LUMI_MUTATION_UPDATE] + mut_counts[LUMI_MUTATION_REMOVE] == 0);
+    assert(lumi_view_get_child(root, 1) == list && lumi_view_get_child_count(list) == 1);
+
+    /* Unkeyed children find the next old child of their type past a
+     * dropped sibling of another type */
+    lumi_view_t *form = lumi_column(), *next = lumi_column();
+    lumi_view_add_child(form, lumi_button("Retry"));
+    lumi_view_t *line1 = lumi_text("one"), *line2 = lumi_text("two");
+    lumi_view_add_child(form, line1);
+    lumi_view_add_child(form, line2);
+    lumi_view_add_child(next, lumi_text("one"));
+    lumi_view_add_child(next, lumi_text("two!"));
+    memset(mut_counts, 0, sizeof(mut_counts));
+    assert(lumi_view_reconcile(form, next, count_mutation, NULL) == form);
+    assert(mut_counts[LUMI_MUTATION_REMOVE] == 1);
+    assert(mut_counts[LUMI_MUTATION_INSERT] == 0);
+    assert(mut_counts[LUMI_MUTATION_UPDATE] == 1);
+    assert(lumi_view_get_child(form, 0) == line1 && lumi_view_get_child(form, 1) == line2);
+    lumi_view_destroy(form);
+
+    lumi_view_t *replacement = lumi_row();
+    assert(lumi_view_reconcile(root, replacement, count_mutation, NULL) == replacement);
+    assert(mut_counts[LUMI_MUTATION_REPLACE] == 1);
+    lumi_view_destroy(replacement);
+}
+
+static void test_text_measure(void) {
+    lumi_text_metrics_t m;
+    uint32_t breaks[4];
+
+    lumi_text_cache_clear();
+    assert(lumi_text_measure("OK", 0.0f, 0.0f, &m, NULL, 0) == LUMI_ERR_INVALID);
+    assert(lumi_text_measure("Hello world foo bar", 10.0f, 0.0f, &m, NULL, 0) == LUMI_OK);
+    assert(m.line_count == 1);
+    assert(m.width > 83.0f && m.width < 84.0f);
+
+    /* Wraps at spaces; the space at the break belongs to neither line */
+    assert(lumi_text_measure("Hello world foo bar", 10.0f, 50.0f, &m, breaks, 4) == LUMI_OK);
+    assert(m.line_count == 2);
+    assert(breaks[0] == 12);
+    assert(m.width <= 50.0f);
+    assert(m.height == m.line_height * 2);
+
+    assert(lumi_text_measure("a\nb", 10.0f, 0.0f, &m, breaks, 4) == LUMI_OK);
+    assert(m.line_count == 2 && breaks[0] == 2);
+
+    /* Long ASCII labels (SIMD path) and repeats served from the cache */
+    const char *label = "The quick brown fox jumps over the lazy dog";
+    lumi_text_metrics_t again;
+    size_t hits, misses;
+    assert(lumi_text_measure(label, 14.0f, 0.0f, &m, NULL, 0) == LUMI_OK);
+    assert(lumi_text_measure(label, 14.0f, 0.0f, &again, NULL, 0) == LUMI_OK);
+    assert(again.width == m.width);
+    lumi_text_cache_stats(&hits, &misses);
+    assert(hits == 1 && misses == 4);
+    lumi_text_cache_clear();
+}
+
+static void test_view_styles(void) {
+    lumi_view_t *a = lumi_text("a");
+    lumi_view_t *b = lumi_text("b");
+    assert(lumi_view_get_style(a) == lumi_view_get_style(b));
+
+    /* Copy-on-write: equal edits converge on one interned style */
+    lumi_view_set_padding(a, 4, 4, 4, 4);
+    assert(lumi_view_get_style(a) != lumi_view_get_style(b));
+    lumi_view_set_padding(b, 4, 4, 4, 4);
+    assert(lumi_view_get_style(a) == lumi_view_get_style(b));
+
+    lumi_style_desc_t d;
+    lumi_style_desc_init(&d);
+    d.background = 0x2196F3FF;
+    d.font_size = 12.0f;
+    const lumi_style_t *blue = lumi_style_intern(&d);
+    d.background = 0xF44336FF;
+    const lumi_style_t *red = lumi_style_intern(&d);
+    assert(lumi_style_intern(&d) == red);
+    lumi_style_release(red);
+
+    lumi_style_sheet_t *sheet = lumi_style_sheet_create();
+    assert(lumi_view_set_style_class(a, sheet, "badge") == LUMI_ERR_NOT_FOUND);
+    assert(lumi_style_sheet_set(sheet, "badge", blue) == LUMI_OK);
+    assert(lumi_view_set_style_class(a, sheet, "badge") == LUMI_OK);
+    assert(lumi_view_set_style_class(b, sheet, "badge") == LUMI_OK);
+    assert(lumi_view_get_style(a) == blue);
+    lumi_view_set_font_size(b, 20.0f);     /* override survives restyling */
+
+    /* Redefining the class restyles every bound view */
+    assert(lumi_style_sheet_set(sheet, "badge", red) == LUMI_OK);
+    assert(lumi_view_get_style(a) == red);
+    lumi_style_get(lumi_view_get_style(b), &d);
+    assert(d.background == 0xF44336FF && d.font_size == 20.0f);
+
+    lumi_style_release(blue);
+    lumi_style_release(red);
+    lumi_style_sheet_destroy(sheet);       /* views keep their class */
+    lumi_style_get(lumi_view_get_style(a), &d);
+    assert(d.background == 0xF44336FF);
+    lumi_view_destroy(a);
+    lumi_view_destroy(b);
+}
+
+static void test_view_snapshot(void) {
+    const char *ids[] = { "a", "b", "c" };
+    lumi_view_t *src = build_feed(ids, 3, "Inbox");
+    lumi_view_t *list = lumi_view_find_by_id(src, "list");
+    lumi_view_set_padding(list, 8, 8, 8, 8);
+    lumi_view_set_repaint_boundary(list, true);
+    lumi_view_set_visible(lumi_view_find_by_id(src, "b"), false);
+
+    uint8_t *data = NULL;
+    size_t len = 0;
+    assert(lumi_view_serialize(src, &data, &len) == LUMI_OK);
+
+    lumi_view_t *copy = NULL;
+    assert(lumi_view_deserialize(data, len, &copy) == LUMI_OK);
+    assert(lumi_view_get_child_count(copy) == 2);
+    lumi_view_t *copy_list = lumi_view_find_by_id(copy, "list");
+    assert(lumi_view_get_parent(copy_list) == copy);
+    assert(lumi_view_get_child_count(copy_list) == 3);
+    assert(lumi_view_get_style(copy_list) == lumi_view_get_style(list));
+    assert(!lumi_view_get_visible(lumi_view_find_by_id(copy, "b")));
+    assert(strcmp(lumi_text_get_content(lumi_view_get_child(copy, 0)), "Inbox") == 0);
+
+    /* Identical trees paint identically */
+    lumi_display_list_t *want = lumi_display_list_create();
+    lumi_display_list_t *got = lumi_display_list_create();
+    lumi_view_layout(src, 320, 480);
+    lumi_view_layout(copy, 320, 480);
+    lumi_view_paint(src, want);
+    lumi_view_paint(copy, got);
+    assert(lumi_display_list_count(got) == lumi_display_list_count(want));
+    lumi_display_list_destroy(want);
+    lumi_display_list_destroy(got);
+
+    /* Views of the block behave like any other: edit, detach, destroy */
+    lumi_text_set_content(lumi_view_get_child(copy, 0), "Inbox (1)");
+    lumi_view_t *c = lumi_view_find_by_id(copy, "c");
+    lumi_view_remove_child(copy_list, c);
+    lumi_view_add_child(list, c);
+    lumi_view_destroy(copy);
+    assert(strcmp(lumi_view_get_id(c), "c") == 0);
+    lumi_view_destroy(src);
+
+    /* Truncated or inconsistent input is rejected */
+    assert(lumi_view_deserialize(data, len - 1, &copy) == LUMI_ERR_INVALID);
+    data[20 + 60 * 2 + 2] = 3;          /* root claims a third child */
+    assert(lumi_view_deserialize(data, len, &copy) == LUMI_ERR_INVALID);
+    free(data);
+}
+
+static int anim_ended;
+static void on_anim_end(lumi_view_t *view, void *ud) {
+    (void)view;
+    anim_ended += *(int *)ud;
+}
+
+static void test_animation(void) {
+    uint64_t t = 1000000;
+    lumi_anim_step(t);
+    lumi_view_t *root = lumi_column();
+    lumi_view_t *box = lumi_card();
+    lumi_view_set_background(box, 0x000000FF);
+    lumi_view_add_child(root, box);
+
+    int one = 1;
+    int w = lumi_animate(box, LUMI_ANIM_WIDTH, 200.0f, 100, LUMI_EASE_LINEAR);
+    int bg = lumi_animate_color(box, LUMI_ANIM_BACKGROUND, 0xFF0000FF, 100, LUMI_EASE_LINEAR);
+    assert(w > 0 && bg > 0 && w != bg);
+    assert(lumi_animate(box, LUMI_ANIM_BACKGROUND, 1.0f, 100, LUMI_EASE_LINEAR) == -1);
+    lumi_anim_on_end(w, on_anim_end, &one);
+
+    /* Time starts at the first step; values land in the view's style */
+    lumi_style_desc_t d;
+    assert(lumi_anim_step(t += 16) == 2);
+    lumi_style_get(lumi_view_get_style(box), &d);
+    assert(d.width == 0.0f && d.background == 0x000000FF);
+    assert(lumi_anim_step(t += 50) == 2);
+    lumi_style_get(lumi_view_get_style(box), &d);
+    assert(d.width == 100.0f && d.background == 0x800000FF);
+    assert(lumi_anim_step(t += 50) == 0);
+    lumi_style_get(lumi_view_get_style(box), &d);
+    assert(d.width == 200.0f && d.background == 0xFF0000FF && anim_ended == 1);
+
+    /* Opacity fades the subtree's ops; a spring settles on its target */
+    lumi_view_set_opacity(box, 0.5f);
+    lumi_view_layout(root, 320.0f, 480.0f);
+    lumi_display_list_t *dl = lumi_display_list_create();
+    replay_rects = 0;
+    lumi_view_paint(root, dl);
+    lumi_display_list_replay(dl, count_op, NULL);
+    assert(replay_rects == 1 && last_color == 0xFF000080);
+
+    int s = lumi_animate_spring(box, LUMI_ANIM_OPACITY, 0.0f, 170.0f, 26.0f);
+    assert(lumi_animate_spring(box, LUMI_ANIM_OPACITY, 0.0f, 170.0f, 26.0f) == s);
+    int frames = 0;
+    while (lumi_anim_step(t += 16) > 0) assert(++frames < 200);
+    lumi_style_get(lumi_view_get_style(box), &d);
+    assert(d.opacity == 0.0f && frames > 10);
+    lumi_view_paint(root, dl);
+    assert(lumi_display_list_count(dl) == 0);
+
+    /* Destroying a view ends its animations without callbacks */
+    lumi_animate(box, LUMI_ANIM_HEIGHT, 40.0f, 100, LUMI_EASE_OUT);
+    lumi_anim_on_end(lumi_animate(box, LUMI_ANIM_BORDER_RADIUS, 8.0f, 100, LUMI_EASE_IN),
+                     on_anim_end, &one);
+    lumi_anim_step(t += 16);
+    lumi_view_destroy(root);
+    assert(lumi_anim_step(t += 200) == 0 && anim_ended == 1);
+    lumi_display_list_destroy(dl);
+}
+
+/* ── Images ────────────────────────────────────────────────────── */
+
+static const uint8_t PNG_2X2[] = {       /* RGBA, second row Up-filtered */
+    0x89, 0x50, 0x4E, 0x47, 0x0D, 0x0A, 0x1A, 0x0A, 0x00, 0x00, 0x00, 0x0D,
+    0x49, 0x48, 0x44, 0x52, 0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00, 0x02,
+    0x08, 0x06, 0x00, 0x00, 0x00, 0x72, 0xB6, 0x0D, 0x24, 0x00, 0x00, 0x00,
+    0x15, 0x49, 0x44, 0x41, 0x54, 0x78, 0xDA, 0x63, 0xF8, 0xCF, 0xC0, 0xF0,
+    0x1F, 0x08, 0x1B, 0x98, 0x80, 0x34, 0x08, 0x30, 0x00, 0x00, 0x43, 0xE5,
+    0x08, 0x7B, 0xC1, 0xC7, 0xEC, 0x5D, 0x00, 0x00, 0x00, 0x00, 0x49, 0x45,
+    0x4E, 0x44, 0xAE, 0x42, 0x60, 0x82,
+};
+
+static void test_image_decode(void) {
+    lumi_bitmap_t *bmp = NULL;
+    assert(lumi_image_decode(PNG_2X2, sizeof(PNG_2X2), 0, 0, &bmp) == LUMI_OK);
+    assert(lumi_bitmap_width(bmp) == 2 && lumi_bitmap_height(bmp) == 2);
+    const uint8_t expect[16] = { 255, 0, 0, 255,  0, 255, 0, 128,
+                                 255, 0, 255, 254,  255, 254, 255, 128 };
+    assert(memcmp(lumi_bitmap_pixels(bmp), expect, sizeof(expect)) == 0);
+    lumi_bitmap_release(bmp);
+
+    /* PPM, box-filtered down to fit 1x1 */
+    const char *ppm = "P3\n# comment\n2 2\n255\n"
+                      "0 0 0  200 200 200\n100 100 100  100 100 100\n";
+    assert(lumi_image_decode((const uint8_t *)ppm, strlen(ppm), 1, 1, &bmp) == LUMI_OK);
+    assert(lumi_bitmap_width(bmp) == 1 && lumi_bitmap_pixels(bmp)[0] == 100);
+    lumi_bitmap_release(bmp);
+
+    assert(lumi_image_decode(PNG_2X2, 20, 0, 0, &bmp) == LUMI_ERR_INVALID);
+    assert(lumi_image_decode((const uint8_t *)"GIF89a", 6, 0, 0, &bmp) == LUMI_ERR_INVALID);
+
+    /* Headers promising more than the data holds, or more pixels than the
+     * limit, are refused without allocating for them */
+    const char *huge[] = {
+        "P5\n16384 16384\n255\n",        /* each side fits, the area does not */
+        "P5\n8192 8192\n255\n\x01\x02\x03",
+        "P2\n4000 4000\n255\n1 2 3\n",
+        "P6\n2 2\n255\n\x01\x02\x03",
+    };
+    for (size_t i = 0; i < sizeof(huge) / sizeof(huge[0]); i++) {
+        assert(lumi_image_decode((const uint8_t *)huge[i], strlen(huge[i]), 0, 0, &bmp) ==
+               LUMI_ERR_INVALID);
+    }
+    uint8_t png[sizeof(PNG_2X2)];
+    memcpy(png, PNG_2X2, sizeof(png));
+    png[19] = png[23] = 0;
+    png[18] = png[22] = 0x3E;                       /* 15872 x 15872 */
+    assert(lumi_image_decode(png, sizeof(png), 0, 0, &bmp) == LUMI_ERR_INVALID);
+    png[18] = png[22] = 0x10;                       /* 4096 x 4096 from 21 bytes */
+    assert(lumi_image_decode(png, sizeof(png), 0, 0, &bmp) == LUMI_ERR_INVALID);
+}
+
+static int image_cb_count;
+static void count_image(const char *source, lumi_bitmap_t *bmp, lumi_result_t rc, void *ud) {
+    (void)source; (void)ud;
+    if (rc == LUMI_OK && lumi_bitmap_width(bmp) == 32) image_cb_count++;
+}
+
+static void test_image_pipeline(void) {
+    char paths[5][64], ppm[64 * 64 * 3 + 32];
+    for (int i = 0; i < 5; i++) {
+        int n = snprintf(ppm, sizeof(ppm), "P6\n64 64\n255\n");
+        memset(ppm + n, 40 * i, 64 * 64 * 3);
+        snprintf(paths[i], sizeof(paths[i]), "/tmp/lumi_test_avatar%d.ppm", i);
+        assert(lumi_file_write(paths[i], ppm, (size_t)n + 64 * 64 * 3) == LUMI_OK);
+    }
+
+    /* 500 avatars over 5 sources decode each source once */
+    lumi_view_t *list = lumi_column();
+    for (int r = 0; r < 50; r++) {
+        lumi_view_t *row = lumi_row();
+        for (int i = 0; i < 10; i++) {
+            lumi_view_t *avatar = lumi_image(paths[(r * 10 + i) % 5]);
+            lumi_view_set_width(avatar, 32.0f);
+            lumi_view_set_height(avatar, 32.0f);
+            lumi_view_add_child(row, avatar);
+        }
+        lumi_view_add_child(list, row);
+    }
+    lumi_view_layout(list, 320.0f, 480.0f);
+    lumi_view_load_images(list);
+    assert(lumi_image_request(paths[0], 32, 32, count_image, NULL) == LUMI_OK);
+
+    lumi_image_stats_t st;
+    struct timespec nap = { 0, 1000000 };
+    for (int spins = 0; spins < 5000; spins++) {
+        lumi_image_poll();
+        lumi_image_get_stats(&st);
+        if (st.pending == 0) break;
+        nanosleep(&nap, NULL);
+    }
+    assert(st.pending == 0 && st.decodes == 5 && st.entries == 5);
+    assert(image_cb_count == 1);
+
+    lumi_bitmap_t *bmp = lumi_image_lookup(paths[2], 32, 32);
+    assert(bmp && lumi_bitmap_width(bmp) == 32 && lumi_bitmap_pixels(bmp)[0] == 80);
+    lumi_bitmap_release(bmp);
+    assert(lumi_image_lookup(paths[2], 64, 64) == NULL);
+
+    /* Cached: delivered synchronously */
+    assert(lumi_image_request(paths[3], 32, 32, count_image, NULL) == LUMI_OK);
+    assert(image_cb_count == 2);
+
+    lumi_image_cache_set_limit(2 * 32 * 32 * 4);
+    lumi_image_get_stats(&st);
+    assert(st.entries == 2 && st.bytes <= st.limit);
+
+    lumi_image_shutdown();
+    lumi_image_cache_set_limit(64u * 1024 * 1024);
+    lumi_view_destroy(list);
+}
+
+/* ── Toolkit ───────────────────────────────────────────────────── */
+
+typedef struct {
+    int created[2];
+    int bound;
+    int limit;                  /* rows create() makes before failing; 0: no limit */
+} vlist_rec_t;
+
+static int vlist_type_of(int index, void *ud) {
+    (void)ud;
+    return index % 3 == 0;
+}
+
+static lumi_view_t *vlist_create_row(int type, void *ud) {
+    vlist_rec_t *rec = ud;
+    if (rec->limit && rec->created[0] + rec->created[1] == rec->limit) return NULL;
+    rec->created[type]++;
+    lumi_view_t *row = lumi_text("");
+    lumi_view_set_id(row, type ? "header" : "item");
+    return row;
+}
+
+static void vlist_bind_row(lumi_view_t *row, int index, void *ud) {
+    assert(strcmp(lumi_view_get_id(row), vlist_type_of(index, ud) ? "header" : "item") == 0);
+    ((vlist_rec_t *)ud)->bound++;
+}
+
+/* The materialized rows sit between the two spacers, in index order */
+static void vlist_check_window(lumi_tk_vlist_t *list) {
+    lumi_view_t *content = lumi_view_get_child(lumi_tk_vlist_view(list), 0);
+    int first, last;
+    lumi_tk_vlist_visible_range(list, &first, &last);
+    assert(lumi_view_get_child_count(content) == last - first + 3);
+    for (int i = first; i <= last; i++) {
+        const char *id = lumi_view_get_id(lumi_view_get_child(content, i - first + 1));
+        assert(strcmp(id, i % 3 == 0 ? "header" : "item") == 0);
+    }
+}
+
+static float vlist_laid_out_height(lumi_tk_vlist_t *list) {
+    lumi_view_t *scroll = lumi_tk_vlist_view(list);
+    float h;
+    lumi_view_layout(scroll, 320.0f, 200.0f);
+    lumi_view_get_frame(lumi_view_get_child(scroll, 0), NULL, NULL, NULL, &h);
+    return h;
+}
+
+static void test_vlist(void) {
+    vlist_rec_t rec = { { 0, 0 }, 0, 0 };
+    lumi_vlist_config_t cfg = {
+        .count = 500, .row_height = 20.0f, .viewport_height = 200.0f, .overscan = 40.0f,
+        .type_of = vlist_type_of, .create = vlist_create_row, .bind = vlist_bind_row,
+        .userdata = &rec,
+    };
+    lumi_tk_vlist_t *list = lumi_tk_vlist_create(&cfg);
+    assert(list);
+    int first, last;
+
+    /* Window: the viewport plus overscan on either side */
+    lumi_tk_vlist_visible_range(list, &first, &last);
+    assert(first == 0 && last == 12);
+    lumi_tk_vlist_scroll_to(list, 1000.0f);
+    lumi_tk_vlist_visible_range(list, &first, &last);
+    assert(first == 48 && last == 62);
+    vlist_check_window(list);
+    assert(lumi_tk_vlist_content_height(list) == 10000.0f);
+    assert(vlist_laid_out_height(list) == 10000.0f);
+
+    /* Scrolling rebinds pooled rows of the right type instead of creating */
+    int created = rec.created[0] + rec.created[1];
+    for (float y = 1000.0f; y <= 3000.0f; y += 7.0f) {
+        lumi_tk_vlist_scroll_to(list, y);
+        vlist_check_window(list);
+    }
+    assert(rec.bound > 100);
+    assert(rec.created[0] + rec.created[1] - created <= 2);
+
+    /* scroll_to_index puts the row at the top, clamped to the end */
+    lumi_tk_vlist_scroll_to_index(list, 100);
+    assert(lumi_tk_vlist_get_offset(list) == 2000.0f);
+    assert(lumi_tk_vlist_offset_of(list, 100) == 2000.0f);
+    assert(lumi_tk_vlist_index_at(list, lumi_tk_vlist_get_offset(list)) == 100);
+    lumi_tk_vlist_scroll_to_index(list, 499);
+    assert(lumi_tk_vlist_get_offset(list) == 9800.0f);
+    lumi_tk_vlist_visible_range(list, &first, &last);
+    assert(last == 499);
+
+    /* A row outside the window changes height: the spacers follow */
+    lumi_tk_vlist_scroll_to(list, 0.0f);
+    lumi_tk_vlist_set_row_height(list, 400, 510.0f);
+    lumi_tk_vlist_visible_range(list, &first, &last);
+    assert(first == 0 && last == 12);
+    assert(lumi_tk_vlist_content_height(list) == 10490.0f);
+    assert(vlist_laid_out_height(list) == 10490.0f);
+    lumi_tk_vlist_scroll_to(list, 5000.0f);
+    lumi_tk_vlist_set_row_height(list, 10, 510.0f);
+    assert(vlist_laid_out_height(list) == 10980.0f);
+    vlist_check_window(list);
+
+    /* set_count shrinks the window and clamps the offset */
+    lumi_tk_vlist_set_count(list, 5);
+    lumi_tk_vlist_visible_range(list, &first, &last);
+    assert(first == 0 && last == 4);
+    assert(lumi_tk_vlist_get_offset(list) == 0.0f);
+    assert(vlist_laid_out_height(list) == 100.0f);
+    vlist_check_window(list);
+    lumi_tk_vlist_set_count(list, 0);
+    lumi_tk_vlist_visible_range(list, &first, &last);
+    assert(last < first);
+    assert(vlist_laid_out_height(list) == 0.0f);
+    lumi_tk_vlist_set_count(list, 300);
+    lumi_tk_vlist_scroll_to(list, 6000.0f);
+    assert(lumi_tk_vlist_get_offset(list) == 5800.0f);
+    vlist_check_window(list);
+
+    lumi_view_destroy(lumi_tk_vlist_view(list));
+    lumi_tk_vlist_destroy(list);
+
+    /* Rows that cannot be created end the window; a later refresh fills it */
+    vlist_rec_t short_rec = { { 0, 0 }, 0, 5 };
+    cfg.userdata = &short_rec;
+    list = lumi_tk_vlist_create(&cfg);
+    assert(list);
+    lumi_tk_vlist_visible_range(list, &first, &last);
+    assert(first == 0 && last == 4);
+    vlist_check_window(list);
+    assert(vlist_laid_out_height(list) == 10000.0f);
+    short_rec.limit = 0;
+    lumi_tk_vlist_scroll_to(list, 0.0f);
+    lumi_tk_vlist_visible_range(list, &first, &last);
+    assert(first == 0 && last == 12);
+    vlist_check_window(list);
+    assert(vlist_laid_out_height(list) == 10000.0f);
+
+    lumi_view_destroy(lumi_tk_vlist_view(list));
+    lumi_tk_vlist_destroy(list);
+}
+
 /* ── Storage ───────────────────────────────────────────────────── */
 
 static void test_storage(void) {
@@ -219,6 +1616,89 @@ static void test_notify(void) {
     };
     assert(lumi_notify(&n) == LUMI_OK);
     assert(lumi_notify(NULL) == LUMI_ERR_INVALID);
+    assert(lumi_notify_set_rate("alerts", 0, 1) == LUMI_ERR_INVALID);
+
+    /* Too big for one packet: refused, and the queue still drains */
+    char *big = malloc(70 * 1024);
+    assert(big);
+    memset(big, 'x', 70 * 1024 - 1);
+    big[70 * 1024 - 1] = '\0';
+    lumi_notify_stats_t before, after;
+    lumi_notify_get_stats(&before);
+    assert(lumi_notify_simple("Huge", big) == LUMI_ERR_INVALID);
+    n.key = "huge";
+    n.body = big;
+    assert(lumi_notify(&n) == LUMI_ERR_INVALID);
+    assert(lumi_notify_simple("After", "small") == LUMI_OK);
+    free(big);
+    lumi_notify_shutdown();             /* no daemon: logged instead */
+    lumi_notify_get_stats(&after);
+    assert(after.posted == before.posted + 1);
+    assert(after.pending == 0);
+}
+
+/* A burst of progress updates to lumi-notifyd collapses into a few
+ * packets, and the last update is the one left on screen. */
+static void test_notify_daemon(void) {
+#ifndef _WIN32
+    const char *notifyd = getenv("LUMI_NOTIFYD");
+    if (!notifyd) return;               /* set by `make test` */
+
+    char path[64], out_path[64];
+    snprintf(path, sizeof(path), "/tmp/lumi-test-notify-%d.sock", (int)getpid());
+    snprintf(out_path, sizeof(out_path), "/tmp/lumi-test-notify-%d.out", (int)getpid());
+    fflush(stdout);
+    pid_t daemon = fork();
+    if (daemon == 0) {
+        int fd = open(out_path, O_WRONLY | O_CREAT | O_TRUNC, 0600);
+        dup2(fd, STDOUT_FILENO);
+        execl(notifyd, notifyd, "-s", path, (char *)NULL);
+        _exit(127);
+    }
+    struct sockaddr_un addr = { .sun_family = AF_UNIX };
+    snprintf(addr.sun_path, sizeof(addr.sun_path), "%s", path);
+    bool up = false;
+    for (int t = 0; t < 5000 && !up; t++) {
+        int fd = socket(AF_UNIX, SOCK_SEQPACKET, 0);
+        up = connect(fd, (struct sockaddr *)&addr, sizeof(addr)) == 0;
+        close(fd);
+        if (!up) nanosleep(&(struct timespec){ 0, 1000000L }, NULL);
+    }
+    assert(up);
+
+    lumi_notify_stats_t before, after;
+    lumi_notify_get_stats(&before);
+    assert(lumi_notify_set_socket(path) == LUMI_OK);
+    char body[16];
+    lumi_notification_t progress = { .title = "report.pdf", .body = body,
+                                     .channel = "downloads", .key = "dl" };
+    for (int i = 0; i <= 2000; i++) {
+        snprintf(body, sizeof(body), "%d%%", i / 20);
+        assert(lumi_notify(&progress) == LUMI_OK);
+        if (i % 1000 == 0) assert(lumi_notify_simple("Alert", "unkeyed") == LUMI_OK);
+    }
+    lumi_notify_shutdown();
+    lumi_notify_get_stats(&after);
+    size_t posted = after.posted - before.posted;
+    size_t coalesced = after.coalesced - before.coalesced;
+    assert(posted == 2004 && after.dropped == before.dropped && after.pending == 0);
+    assert(after.delivered - before.delivered + coalesced == posted);
+    assert(coalesced > 1900 && after.writes - before.writes < 50);
+
+    kill(daemon, SIGTERM);
+    waitpid(daemon, NULL, 0);
+    assert(lumi_notify_set_socket(NULL) == LUMI_OK);
+
+    char *shown = NULL;
+    size_t shown_len = 0;
+    assert(lumi_file_read(out_path, &shown, &shown_len) == LUMI_OK);
+    const char *last = NULL;
+    for (const char *p = strstr(shown, "[downloads]"); p; p = strstr(p + 1, "[downloads]")) last = p;
+    assert(last && strncmp(last, "[downloads] report.pdf: 100%\n", 29) == 0);
+    assert(strstr(shown, " new [downloads]") && strstr(shown, "unkeyed"));
+    free(shown);
+    unlink(out_path);
+#endif
 }
 
 /* ── Intent / IPC ──────────────────────────────────────────────── */
@@ -246,6 +1726,353 @@ static void test_intent(void) {
     assert(lumi_intent_register(NULL, intent_cb, NULL) == LUMI_ERR_INVALID);
 }
 
+/* Appends the handler's tag to a trace so dispatch order is checkable */
+static char intent_trace[64];
+static void trace_cb(const lumi_intent_t *intent, void *ud) {
+    (void)intent;
+    strcat(intent_trace, (const char *)ud);
+}
+
+static void self_removing_cb(const lumi_intent_t *intent, void *ud) {
+    strcat(intent_trace, "x");
+    lumi_intent_unregister(intent->action, self_removing_cb, ud);
+    lumi_intent_register(intent->action, trace_cb, "n");
+}
+
+static void test_intent_dispatch(void) {
+    assert(lumi_intent_register("com.lumios.media.PLAY", trace_cb, "e") == LUMI_OK);
+    assert(lumi_intent_register("com.lumios.media.*", trace_cb, "m") == LUMI_OK);
+    assert(lumi_intent_register("com.lumios.*", trace_cb, "l") == LUMI_OK);
+    assert(lumi_intent_register("*", trace_cb, "a") == LUMI_OK);
+    assert(lumi_intent_register("com.lumios.media.PLAY", trace_cb, "f") == LUMI_OK);
+
+    lumi_intent_t play = { .action = "com.lumios.media.PLAY" };
+    lumi_intent_t other = { .action = "com.lumios.media" };
+    intent_trace[0] = '\0';
+    lumi_intent_send(&play);
+    assert(strcmp(intent_trace, "almef") == 0);
+    intent_trace[0] = '\0';
+    lumi_intent_send(&other);           /* a prefix alone is not under itself */
+    assert(strcmp(intent_trace, "al") == 0);
+
+    assert(lumi_intent_unregister("com.lumios.media.PLAY", trace_cb, "e") == LUMI_OK);
+    assert(lumi_intent_unregister("com.lumios.media.PLAY", trace_cb, "e") == LUMI_ERR_NOT_FOUND);
+    assert(lumi_intent_unregister("*", trace_cb, "a") == LUMI_OK);
+    assert(lumi_intent_unregister("com.lumios.*", trace_cb, "l") == LUMI_OK);
+    assert(lumi_intent_unregister("com.lumios.media.*", trace_cb, "m") == LUMI_OK);
+    intent_trace[0] = '\0';
+    lumi_intent_send(&play);
+    assert(strcmp(intent_trace, "f") == 0);
+    assert(lumi_intent_unregister("com.lumios.media.PLAY", trace_cb, "f") == LUMI_OK);
+
+    /* A handler may swap itself out while it runs */
+    lumi_intent_t once = { .action = "com.test.ONCE" };
+    assert(lumi_intent_register("com.test.ONCE", self_removing_cb, NULL) == LUMI_OK);
+    intent_trace[0] = '\0';
+    lumi_intent_send(&once);
+    lumi_intent_send(&once);
+    assert(strcmp(intent_trace, "xn") == 0);
+    assert(lumi_intent_unregister("com.test.ONCE", trace_cb, "n") == LUMI_OK);
+
+    assert(lumi_intent_register("com.*.PLAY", trace_cb, NULL) == LUMI_ERR_INVALID);
+    assert(lumi_intent_register("com.lumios*", trace_cb, NULL) == LUMI_ERR_INVALID);
+    assert(lumi_intent_register("", trace_cb, NULL) == LUMI_ERR_INVALID);
+}
+
+static void queue_cb(const lumi_intent_t *intent, void *ud) {
+    (void)ud;
+    assert(lumi_intent_poll() == 0);    /* no nested drain */
+    strcat(intent_trace, intent->data);
+}
+
+static void echo_cb(const lumi_intent_t *intent, void *ud) {
+    (void)ud;
+    strcat(intent_trace, "r");
+    lumi_intent_send(intent);
+}
+
+static void test_intent_queue(void) {
+    assert(lumi_intent_register("com.test.QUEUED", queue_cb, NULL) == LUMI_OK);
+
+    char data[8] = "l";
+    lumi_intent_t q = { .action = "com.test.QUEUED", .data = data };
+    assert(lumi_intent_post(&q, LUMI_INTENT_PRIORITY_LOW) == LUMI_OK);
+    strcpy(data, "n");                  /* posting copied the strings */
+    assert(lumi_intent_post(&q, LUMI_INTENT_PRIORITY_NORMAL) == LUMI_OK);
+    q.data = "h";
+    assert(lumi_intent_post(&q, LUMI_INTENT_PRIORITY_HIGH) == LUMI_OK);
+    q.data = "m";
+    assert(lumi_intent_post(&q, LUMI_INTENT_PRIORITY_NORMAL) == LUMI_OK);
+    assert(lumi_intent_post(&q, 7) == LUMI_ERR_INVALID);
+
+    intent_trace[0] = '\0';
+    assert(lumi_intent_pending() == 4);
+    assert(strcmp(intent_trace, "") == 0);
+    assert(lumi_intent_poll() == 4);
+    assert(strcmp(intent_trace, "hnml") == 0);
+    assert(lumi_intent_pending() == 0 && lumi_intent_poll() == 0);
+    assert(lumi_intent_unregister("com.test.QUEUED", queue_cb, NULL) == LUMI_OK);
+
+    /* A handler that re-sends its own intent recurses a bounded depth */
+    lumi_intent_t echo = { .action = "com.test.ECHO" };
+    assert(lumi_intent_register("com.test.ECHO", echo_cb, NULL) == LUMI_OK);
+    intent_trace[0] = '\0';
+    assert(lumi_intent_send(&echo) == LUMI_OK);
+    assert(strcmp(intent_trace, "rrrrrrrr") == 0);
+    assert(lumi_intent_pending() == 1);
+    assert(lumi_intent_unregister("com.test.ECHO", echo_cb, NULL) == LUMI_OK);
+    assert(lumi_intent_poll() == 1);
+}
+
+static void extras_cb(const lumi_intent_t *intent, void *ud) {
+    lumi_extras_view_t v;
+    int64_t n = 0;
+    assert(lumi_extras_open(&v, intent->extras, intent->extras_len) == LUMI_OK);
+    assert(lumi_extras_get_int(&v, "n", &n) == LUMI_OK);
+    *(int64_t *)ud += n;
+}
+
+static void test_intent_extras(void) {
+    lumi_extras_t *inner = lumi_extras_create();
+    assert(lumi_extras_put_string(inner, "title", "Song") == LUMI_OK);
+    assert(lumi_extras_put_float(inner, "gain", -1.5) == LUMI_OK);
+
+    lumi_extras_t *ex = lumi_extras_create();
+    assert(lumi_extras_put_int(ex, "track", 3) == LUMI_OK);
+    assert(lumi_extras_put_int(ex, "pos", INT64_MIN) == LUMI_OK);
+    assert(lumi_extras_put_bytes(ex, "raw", "\0\1\2", 3) == LUMI_OK);
+    assert(lumi_extras_put_map(ex, "meta", inner) == LUMI_OK);
+    lumi_extras_destroy(inner);         /* the map was copied in */
+    assert(lumi_extras_put_int(ex, "track", 4) == LUMI_OK);     /* replaces 3 */
+    assert(lumi_extras_put_int(ex, NULL, 1) == LUMI_ERR_INVALID);
+
+    const void *data;
+    size_t len;
+    assert(lumi_extras_encode(ex, &data, &len) == LUMI_OK);
+    lumi_extras_view_t v, meta;
+    assert(lumi_extras_open(&v, data, len) == LUMI_OK);
+    assert(v.count == 4);
+
+    int64_t i;
+    double f;
+    const char *s;
+    const void *b;
+    size_t n;
+    assert(lumi_extras_get_int(&v, "track", &i) == LUMI_OK && i == 4);
+    assert(lumi_extras_get_int(&v, "pos", &i) == LUMI_OK && i == INT64_MIN);
+    assert(lumi_extras_get_bytes(&v, "raw", &b, &n) == LUMI_OK && n == 3 && memcmp(b, "\0\1\2", 3) == 0);
+    assert(lumi_extras_get_map(&v, "meta", &meta) == LUMI_OK);
+    assert(lumi_extras_get_string(&meta, "title", &s) == LUMI_OK && strcmp(s, "Song") == 0);
+    assert(lumi_extras_get_float(&meta, "gain", &f) == LUMI_OK && f == -1.5);
+    assert(lumi_extras_get_float(&v, "track", &f) == LUMI_ERR_INVALID);
+    assert(lumi_extras_get_int(&v, "missing", &i) == LUMI_ERR_NOT_FOUND);
+    assert(lumi_extras_type(&v, "meta") == LUMI_EXTRA_MAP);
+
+    /* Entries come back in key order */
+    const char *keys[4];
+    for (uint32_t k = 0; k < v.count; k++) assert(lumi_extras_at(&v, k, &keys[k]) != LUMI_EXTRA_NONE);
+    assert(strcmp(keys[0], "meta") == 0 && strcmp(keys[1], "pos") == 0);
+    assert(strcmp(keys[2], "raw") == 0 && strcmp(keys[3], "track") == 0);
+
+    lumi_extra_field_t schema[] = {
+        { "track", LUMI_EXTRA_INT, true },
+        { "meta", LUMI_EXTRA_MAP, true },
+        { "volume", LUMI_EXTRA_FLOAT, false },
+    };
+    assert(lumi_extras_validate(&v, schema, 3) == LUMI_OK);
+    schema[2].required = true;
+    assert(lumi_extras_validate(&v, schema, 3) == LUMI_ERR_NOT_FOUND);
+    schema[0].type = LUMI_EXTRA_STRING;
+    assert(lumi_extras_validate(&v, schema, 2) == LUMI_ERR_INVALID);
+
+    /* Truncated data: the header is refused, values cut off read as absent */
+    assert(lumi_extras_open(&v, data, 4) == LUMI_ERR_INVALID);
+    uint8_t *cut = malloc(len);
+    memcpy(cut, data, len);
+    cut[0] = (uint8_t)(len - 3);
+    assert(lumi_extras_open(&v, cut, len) == LUMI_OK);
+    assert(lumi_extras_type(&v, "track") == LUMI_EXTRA_NONE);
+    assert(lumi_extras_get_int(&v, "pos", &i) == LUMI_OK && i == INT64_MIN);
+    free(cut);
+    assert(lumi_extras_open(&v, NULL, 0) == LUMI_OK && v.count == 0);
+
+    /* Posting copies the extras along with the strings */
+    lumi_extras_t *small = lumi_extras_create();
+    assert(lumi_extras_put_int(small, "n", 5) == LUMI_OK);
+    assert(lumi_extras_encode(small, &data, &len) == LUMI_OK);
+    int64_t total = 0;
+    lumi_intent_t in = { .action = "com.test.EXTRAS", .extras = data, .extras_len = len };
+    assert(lumi_intent_register("com.test.EXTRAS", extras_cb, &total) == LUMI_OK);
+    assert(lumi_intent_send(&in) == LUMI_OK);
+    assert(lumi_intent_post(&in, LUMI_INTENT_PRIORITY_NORMAL) == LUMI_OK);
+    lumi_extras_destroy(small);
+    assert(lumi_intent_poll() == 1 && total == 10);
+    assert(lumi_intent_unregister("com.test.EXTRAS", extras_cb, &total) == LUMI_OK);
+
+    /* A cleared builder starts over */
+    lumi_extras_clear(ex);
+    assert(lumi_extras_put_string(ex, "k", "v") == LUMI_OK);
+    assert(lumi_extras_encode(ex, &data, &len) == LUMI_OK);
+    assert(lumi_extras_open(&v, data, len) == LUMI_OK && v.count == 1);
+    assert(lumi_extras_get_string(&v, "k", &s) == LUMI_OK && strcmp(s, "v") == 0);
+    lumi_extras_destroy(ex);
+}
+
+/* Several processes on one intent bus: the test process sends, a forked
+ * child receives, and the broker is restarted halfway through. */
+#ifndef _WIN32
+static int bus_seen[4];                 /* PING, DIRECT, AFTER, BIG */
+static int bus_ready[4];                /* READY messages by phase */
+#define BUS_BIG_SIZE (256 * 1024)       /* too large for one packet: goes as a memfd */
+
+static char *bus_big_payload(void) {
+    char *big = malloc(BUS_BIG_SIZE + 1);
+    for (int i = 0; i < BUS_BIG_SIZE; i++) big[i] = (char)('a' + i % 26);
+    big[BUS_BIG_SIZE] = '\0';
+    return big;
+}
+
+static void bus_sleep_ms(long ms) {
+    struct timespec ts = { 0, ms * 1000000L };
+    nanosleep(&ts, NULL);
+}
+
+static void bus_ready_send(const char *phase) {
+    lumi_intent_t ready = { .action = "com.test.ready", .data = phase };
+    lumi_intent_send(&ready);
+}
+
+static void bus_rx_cb(const lumi_intent_t *intent, void *ud) {
+    (void)ud;
+    if (strcmp(intent->action, "com.test.bus.PING") == 0) bus_seen[0]++;
+    lumi_extras_view_t extras;
+    int64_t seq = 0;
+    assert(lumi_extras_open(&extras, intent->extras, intent->extras_len) == LUMI_OK);
+    if (strcmp(intent->action, "com.test.direct") == 0) {
+        if (lumi_extras_get_int(&extras, "seq", &seq) == LUMI_OK && seq == 42) bus_seen[1]++;
+        bus_ready_send("2");            /* both phase one intents are in */
+    }
+    if (strcmp(intent->action, "com.test.bus.AFTER") == 0) bus_seen[2]++;
+    if (strcmp(intent->action, "com.test.bus.BIG") == 0) {
+        char *expect = bus_big_payload();
+        if (strcmp(intent->data, expect) == 0 && strcmp(intent->mime_type, "text/plain") == 0 &&
+            lumi_extras_get_int(&extras, "seq", &seq) == LUMI_OK && seq == 7) {
+            bus_seen[3]++;
+        }
+        free(expect);
+    }
+}
+
+static void bus_ready_cb(const lumi_intent_t *intent, void *ud) {
+    (void)ud;
+    int phase = intent->data ? atoi(intent->data) : 0;
+    if (phase > 0 && phase < 4) bus_ready[phase]++;
+}
+
+/* Child process: announces itself until the parent's intents arrive,
+ * and again once it is back on the restarted broker. */
+static int bus_receiver(const char *path) {
+    lumi_intent_register("com.test.bus.*", bus_rx_cb, NULL);
+    lumi_intent_register("com.test.direct", bus_rx_cb, NULL);
+    lumi_bus_connect(path, "com.test.rx");
+
+    bool was = false, reconnected = false;
+    for (int t = 0; t < 10000; t++) {
+        lumi_bus_poll();
+        bool is = lumi_bus_connected();
+        if (is && !was && bus_seen[1]) reconnected = true;
+        was = is;
+        if (bus_seen[2]) return bus_seen[0] == 1 && bus_seen[1] == 1 && bus_seen[3] == 1 ? 0 : 1;
+
+        const char *phase = !bus_seen[1] ? "1" : reconnected ? "3" : NULL;
+        if (phase && is && t % 100 == 0) bus_ready_send(phase);
+        bus_sleep_ms(1);
+    }
+    return 2;
+}
+
+static bool bus_wait(int phase) {
+    for (int t = 0; t < 10000 && !bus_ready[phase]; t++) {
+        lumi_bus_poll();
+        bus_sleep_ms(1);
+    }
+    return bus_ready[phase] > 0;
+}
+
+static pid_t bus_start_broker(const char *broker, const char *path) {
+    pid_t pid = fork();
+    if (pid == 0) {
+        execl(broker, broker, "-s", path, (char *)NULL);
+        _exit(127);
+    }
+    return pid;
+}
+#endif
+
+static void test_intent_bus(void) {
+#ifndef _WIN32
+    const char *broker = getenv("LUMI_INTENTD");
+    if (!broker) return;                /* set by `make test` */
+
+    char path[64];
+    snprintf(path, sizeof(path), "/tmp/lumi-test-bus-%d.sock", (int)getpid());
+    fflush(stdout);
+    pid_t daemon = bus_start_broker(broker, path);
+    pid_t rx = fork();
+    if (rx == 0) _exit(bus_receiver(path));
+
+    assert(lumi_intent_register("com.test.ready", bus_ready_cb, NULL) == LUMI_OK);
+    lumi_bus_connect(path, "com.test.tx");      /* the broker may still be starting */
+    assert(bus_wait(1));
+
+    /* One packet: a broadcast, a large payload passed as a sealed memfd,
+     * and two targeted intents of which only one is for rx. The last two
+     * intents for rx carry extras. */
+    char *big = bus_big_payload();
+    const void *extras[2];
+    size_t extras_len[2];
+    lumi_extras_t *ex[2] = { lumi_extras_create(), lumi_extras_create() };
+    for (int i = 0; i < 2; i++) {
+        assert(lumi_extras_put_int(ex[i], "seq", i ? 42 : 7) == LUMI_OK);
+        assert(lumi_extras_encode(ex[i], &extras[i], &extras_len[i]) == LUMI_OK);
+    }
+    lumi_intent_t ping = { .action = "com.test.bus.PING", .data = "x" };
+    lumi_intent_t large = { .action = "com.test.bus.BIG", .data = big, .mime_type = "text/plain",
+                            .extras = extras[0], .extras_len = extras_len[0] };
+    lumi_intent_t other = { .action = "com.test.direct", .target_app = "com.test.other" };
+    lumi_intent_t direct = { .action = "com.test.direct", .target_app = "com.test.rx",
+                             .extras = extras[1], .extras_len = extras_len[1] };
+    assert(lumi_intent_send(&ping) == LUMI_OK);
+    assert(lumi_intent_send(&large) == LUMI_OK);
+    free(big);
+    assert(lumi_intent_send(&other) == LUMI_OK);
+    assert(lumi_intent_send(&direct) == LUMI_OK);
+    lumi_extras_destroy(ex[0]);
+    lumi_extras_destroy(ex[1]);
+    assert(bus_wait(2));
+
+    /* Both sides reconnect to a new broker on their own */
+    kill(daemon, SIGTERM);
+    waitpid(daemon, NULL, 0);
+    daemon = bus_start_broker(broker, path);
+    assert(bus_wait(3));
+    assert(lumi_bus_connected());
+    lumi_intent_t after = { .action = "com.test.bus.AFTER" };
+    assert(lumi_intent_send(&after) == LUMI_OK);
+    lumi_bus_poll();
+
+    int status = 0;
+    waitpid(rx, &status, 0);
+    assert(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+
+    lumi_bus_disconnect();
+    assert(!lumi_bus_connected() && lumi_bus_fd() < 0);
+    assert(lumi_intent_unregister("com.test.ready", bus_ready_cb, NULL) == LUMI_OK);
+    kill(daemon, SIGTERM);
+    waitpid(daemon, NULL, 0);
+#endif
+}
+
 /* ── File utilities ────────────────────────────────────────────── */
 
 static void test_file(void) {
@@ -301,6 +2128,19 @@ int main(void) {
 
     printf("\nLogging:\n");
     TEST(log);
+    TEST(log_async);
+    TEST(log_deferred);
+    TEST(log_levels);
+
+    printf("\nTracing:\n");
+    TEST(trace);
+
+    printf("\nMetrics:\n");
+    TEST(metrics);
+
+    printf("\nMemory accounting:\n");
+    TEST(mem);
+    TEST(allocator);
 
     printf("\nApp lifecycle:\n");
     TEST(app_lifecycle);
@@ -311,6 +2151,24 @@ int main(void) {
     TEST(view_tree);
     TEST(view_properties);
     TEST(view_callbacks);
+    TEST(view_layout);
+    TEST(text_measure);
+    TEST(display_list);
+    TEST(view_packed);
+    TEST(view_packed_trees);
+    TEST(hit_test);
+    TEST(view_find_by_id);
+    TEST(view_reconcile);
+    TEST(view_styles);
+    TEST(view_snapshot);
+    TEST(animation);
+
+    printf("\nImages:\n");
+    TEST(image_decode);
+    TEST(image_pipeline);
+
+    printf("\nToolkit:\n");
+    TEST(vlist);
 
     printf("\nStorage:\n");
     TEST(storage);
@@ -318,9 +2176,14 @@ int main(void) {
 
     printf("\nNotifications:\n");
     TEST(notify);
+    TEST(notify_daemon);
 
     printf("\nIntent/IPC:\n");
     TEST(intent);
+    TEST(intent_dispatch);
+    TEST(intent_queue);
+    TEST(intent_extras);
+    TEST(intent_bus);
 
     printf("\nFile utilities:\n");
     TEST(file);
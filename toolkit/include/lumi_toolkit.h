@@ -29,9 +29,57 @@ lumi_view_t *lumi_tk_appbar(const lumi_appbar_config_t *config);
 
 typedef lumi_view_t *(*lumi_list_builder_cb)(int index, void *item, void *userdata);
 
+/* Eager: builds every row up front. Prefer lumi_tk_vlist for long lists. */
 lumi_view_t *lumi_tk_list(void **items, int count,
                            lumi_list_builder_cb builder, void *userdata);
 
+/* ── Virtualized list ────────────────────────────────────────────── */
+
+typedef struct lumi_tk_vlist lumi_tk_vlist_t;
+
+typedef int          (*lumi_vlist_type_cb)(int index, void *userdata);
+typedef lumi_view_t *(*lumi_vlist_create_cb)(int view_type, void *userdata);
+typedef void         (*lumi_vlist_bind_cb)(lumi_view_t *row, int index, void *userdata);
+
+typedef struct {
+    int   count;
+    float row_height;       /* fixed row height, or the estimate if estimated */
+    bool  estimated;        /* refine with lumi_tk_vlist_set_row_height/_measure */
+    float viewport_height;
+    float overscan;         /* px materialized above and below the viewport */
+    lumi_vlist_type_cb   type_of;   /* optional; all rows are type 0 if NULL */
+    lumi_vlist_create_cb create;    /* makes an unbound row of a given type */
+    lumi_vlist_bind_cb   bind;      /* fills a (possibly recycled) row for index */
+    void *userdata;
+} lumi_vlist_config_t;
+
+/* Only rows intersecting the viewport plus overscan exist as views; rows
+ * that scroll out are parked in a per-type pool and rebound on reuse.
+ * The scroll view returned by lumi_tk_vlist_view() belongs to the tree it
+ * is added to; lumi_tk_vlist_destroy() frees the pool and the list state. */
+lumi_tk_vlist_t *lumi_tk_vlist_create(const lumi_vlist_config_t *config);
+void         lumi_tk_vlist_destroy(lumi_tk_vlist_t *list);
+lumi_view_t *lumi_tk_vlist_view(lumi_tk_vlist_t *list);
+
+void  lumi_tk_vlist_scroll_to(lumi_tk_vlist_t *list, float offset);
+void  lumi_tk_vlist_scroll_to_index(lumi_tk_vlist_t *list, int index);
+float lumi_tk_vlist_get_offset(lumi_tk_vlist_t *list);
+void  lumi_tk_vlist_set_viewport(lumi_tk_vlist_t *list, float height);
+void  lumi_tk_vlist_set_count(lumi_tk_vlist_t *list, int count);
+void  lumi_tk_vlist_set_row_height(lumi_tk_vlist_t *list, int index, float height);
+void  lumi_tk_vlist_measure(lumi_tk_vlist_t *list);  /* after lumi_view_layout */
+float lumi_tk_vlist_content_height(lumi_tk_vlist_t *list);
+float lumi_tk_vlist_offset_of(lumi_tk_vlist_t *list, int index);
+int   lumi_tk_vlist_index_at(lumi_tk_vlist_t *list, float offset);
+void  lumi_tk_vlist_visible_range(lumi_tk_vlist_t *list, int *first, int *last); /* incl. overscan */
+
+/* ── Theme ───────────────────────────────────────────────────────── */
+
+/* Shared sheet behind the widgets below; classes "tk.badge", "tk.toast",
+ * "tk.switch.on" and "tk.switch.off". Redefine a class with
+ * lumi_style_sheet_set() to restyle every widget built from it. */
+lumi_style_sheet_t *lumi_tk_theme(void);
+
 /* ── Common widgets ──────────────────────────────────────────────── */
 
 lumi_view_t *lumi_tk_icon_button(const char *icon_path, const char *label,
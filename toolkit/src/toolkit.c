@@ -7,6 +7,40 @@
 #include <stdlib.h>
 #include <string.h>
 
+/* ── Theme ───────────────────────────────────────────────────────── */
+
+static lumi_style_sheet_t *g_theme;
+
+static void theme_define(const char *name, uint32_t bg, uint32_t fg, float font_size,
+                         float radius, float pad_y, float pad_x, float w, float h) {
+    lumi_style_desc_t d;
+    lumi_style_desc_init(&d);
+    d.background = bg;
+    d.foreground = fg;
+    d.font_size = font_size;
+    d.border_radius = radius;
+    d.padding[0] = d.padding[2] = pad_y;
+    d.padding[1] = d.padding[3] = pad_x;
+    d.width = w;
+    d.height = h;
+
+    const lumi_style_t *style = lumi_style_intern(&d);
+    if (!style) return;
+    lumi_style_sheet_set(g_theme, name, style);
+    lumi_style_release(style);
+}
+
+lumi_style_sheet_t *lumi_tk_theme(void) {
+    if (g_theme) return g_theme;
+    if (!(g_theme = lumi_style_sheet_create())) return NULL;
+
+    theme_define("tk.badge",      0x2196F3FF, 0xFFFFFFFF, 10.0f,  8.0f,  2.0f,  6.0f,  0.0f,  0.0f);
+    theme_define("tk.toast",      0x323232E6, 0xFFFFFFFF, 14.0f, 20.0f, 12.0f, 24.0f,  0.0f,  0.0f);
+    theme_define("tk.switch.on",  0x4CAF50FF, 0xFFFFFFFF, 14.0f, 16.0f,  0.0f,  0.0f, 52.0f, 28.0f);
+    theme_define("tk.switch.off", 0x9E9E9EFF, 0xFFFFFFFF, 14.0f, 16.0f,  0.0f,  0.0f, 52.0f, 28.0f);
+    return g_theme;
+}
+
 /* ── Scaffold ──────────────────────────────────────────────────── */
 
 lumi_view_t *lumi_tk_appbar(const lumi_appbar_config_t *config) {
@@ -16,6 +50,7 @@ lumi_view_t *lumi_tk_appbar(const lumi_appbar_config_t *config) {
     lumi_view_set_height(bar, 56.0f);
     lumi_view_set_background(bar, config ? config->background : 0x2196F3FF);
     lumi_view_set_padding(bar, 0, 16, 0, 16);
+    lumi_view_set_repaint_boundary(bar, true);
 
     if (config && config->show_back) {
         lumi_view_t *back = lumi_button("<");
@@ -71,6 +106,309 @@ lumi_view_t *lumi_tk_list(void **items, int count,
     return scroll;
 }
 
+/* ── Virtualized list ──────────────────────────────────────────── */
+
+#define VLIST_MAX_ROWS 254   /* a column holds 256 children, two are spacers */
+#define VLIST_POOL_MAX 32
+
+typedef struct {
+    lumi_view_t **views;
+    int count, cap;
+} vlist_pool_t;
+
+typedef struct {
+    lumi_view_t *view;
+    int type;
+} vlist_row_t;
+
+struct lumi_tk_vlist {
+    lumi_vlist_config_t cfg;
+    lumi_view_t *scroll, *content, *top, *bottom;
+
+    /* Row heights and a Fenwick tree over them for O(log n) offsets */
+    float  *heights;
+    double *tree;       /* 1-based */
+    int     top_bit;    /* highest power of two <= count */
+
+    float  offset;
+    int    first, last; /* materialized window; empty when last < first */
+    vlist_row_t *rows;  /* rows[i - first] */
+
+    vlist_pool_t *pools;
+    int pool_types;
+};
+
+static void fw_add(lumi_tk_vlist_t *l, int i, double delta) {
+    for (i++; i <= l->cfg.count; i += i & -i) l->tree[i] += delta;
+}
+
+/* Sum of heights of rows [0, i). */
+static double fw_prefix(const lumi_tk_vlist_t *l, int i) {
+    double sum = 0.0;
+    for (; i > 0; i -= i & -i) sum += l->tree[i];
+    return sum;
+}
+
+/* Index of the row containing offset, clamped to the last row. */
+static int fw_find(const lumi_tk_vlist_t *l, double offset) {
+    int pos = 0;
+    for (int step = l->top_bit; step; step >>= 1) {
+        if (pos + step <= l->cfg.count && l->tree[pos + step] <= offset) {
+            pos += step;
+            offset -= l->tree[pos];
+        }
+    }
+    return pos < l->cfg.count ? pos : l->cfg.count - 1;
+}
+
+static bool fw_build(lumi_tk_vlist_t *l, int old_count) {
+    int n = l->cfg.count;
+    float *heights = realloc(l->heights, (size_t)(n ? n : 1) * sizeof(float));
+    if (!heights) return false;
+    l->heights = heights;
+    double *tree = realloc(l->tree, (size_t)(n + 1) * sizeof(double));
+    if (!tree) return false;
+    l->tree = tree;
+
+    for (int i = old_count; i < n; i++) l->heights[i] = l->cfg.row_height;
+    tree[0] = 0.0;
+    for (int i = 1; i <= n; i++) tree[i] = l->heights[i - 1];
+    for (int i = 1; i <= n; i++) {
+        int j = i + (i & -i);
+        if (j <= n) tree[j] += tree[i];
+    }
+    l->top_bit = 1;
+    while (l->top_bit * 2 <= n) l->top_bit *= 2;
+    return true;
+}
+
+static void vlist_recycle(lumi_tk_vlist_t *l, vlist_row_t *row) {
+    if (!row->view) return;
+    if (row->type >= l->pool_types) {
+        vlist_pool_t *pools = realloc(l->pools, (size_t)(row->type + 1) * sizeof(vlist_pool_t));
+        if (!pools) { lumi_view_destroy(row->view); row->view = NULL; return; }
+        memset(pools + l->pool_types, 0, (size_t)(row->type + 1 - l->pool_types) * sizeof(vlist_pool_t));
+        l->pools = pools;
+        l->pool_types = row->type + 1;
+    }
+
+    vlist_pool_t *pool = &l->pools[row->type];
+    if (pool->count == pool->cap && pool->cap < VLIST_POOL_MAX) {
+        int cap = pool->cap ? pool->cap * 2 : 4;
+        lumi_view_t **views = realloc(pool->views, (size_t)cap * sizeof(lumi_view_t *));
+        if (views) { pool->views = views; pool->cap = cap; }
+    }
+    if (pool->count < pool->cap) {
+        pool->views[pool->count++] = row->view;
+    } else {
+        lumi_view_destroy(row->view);
+    }
+    row->view = NULL;
+}
+
+static lumi_view_t *vlist_obtain(lumi_tk_vlist_t *l, int type) {
+    if (type >= 0 && type < l->pool_types && l->pools[type].count > 0) {
+        return l->pools[type].views[--l->pools[type].count];
+    }
+    return l->cfg.create(type, l->cfg.userdata);
+}
+
+static void vlist_detach_all(lumi_tk_vlist_t *l) {
+    lumi_view_remove_child(l->content, l->top);
+    for (int i = l->first; i <= l->last; i++) {
+        lumi_view_remove_child(l->content, l->rows[i - l->first].view);
+    }
+    lumi_view_remove_child(l->content, l->bottom);
+}
+
+/* Recomputes the window for the current offset, recycling rows that left
+ * it and binding rows that entered it. The spacers are resized even when
+ * the window stays, since a row outside it may have changed height. A
+ * row that cannot be created ends the window early, the bottom spacer
+ * standing in for the rest until a later refresh gets it. */
+static void vlist_refresh(lumi_tk_vlist_t *l, bool rebind) {
+    int n = l->cfg.count;
+    float total = (float)fw_prefix(l, n);
+    float max_offset = total > l->cfg.viewport_height ? total - l->cfg.viewport_height : 0.0f;
+
+    if (l->offset > max_offset) l->offset = max_offset;
+    if (l->offset < 0.0f) l->offset = 0.0f;
+    lumi_scroll_set_offset(l->scroll, 0.0f, l->offset);
+
+    int first = 0, last = -1;
+    if (n > 0) {
+        float top = l->offset - l->cfg.overscan;
+        first = fw_find(l, top > 0.0f ? top : 0.0f);
+        last  = fw_find(l, l->offset + l->cfg.viewport_height + l->cfg.overscan);
+        if (last - first + 1 > VLIST_MAX_ROWS) last = first + VLIST_MAX_ROWS - 1;
+    }
+    lumi_view_set_height(l->top, (float)fw_prefix(l, first));
+    lumi_view_set_height(l->bottom, total - (float)fw_prefix(l, last + 1));
+    if (!rebind && first == l->first && last == l->last) return;
+
+    vlist_row_t *rows = calloc((size_t)(last >= first ? last - first + 1 : 1), sizeof(vlist_row_t));
+    if (!rows) return;
+
+    vlist_detach_all(l);
+    for (int i = l->first; i <= l->last; i++) {
+        vlist_row_t *r = &l->rows[i - l->first];
+        if (!rebind && i >= first && i <= last) rows[i - first] = *r;
+        else vlist_recycle(l, r);
+    }
+    free(l->rows);
+    l->rows  = rows;
+    l->first = first;
+    l->last  = last;
+
+    lumi_view_add_child(l->content, l->top);
+    for (int i = first; i <= last; i++) {
+        vlist_row_t *r = &rows[i - first];
+        if (!r->view) {
+            r->type = l->cfg.type_of ? l->cfg.type_of(i, l->cfg.userdata) : 0;
+            r->view = vlist_obtain(l, r->type);
+            if (!r->view) {
+                for (int j = i + 1; j <= last; j++) vlist_recycle(l, &rows[j - first]);
+                l->last = i - 1;
+                lumi_view_set_height(l->bottom, total - (float)fw_prefix(l, i));
+                break;
+            }
+            if (!l->cfg.estimated) lumi_view_set_height(r->view, l->heights[i]);
+            l->cfg.bind(r->view, i, l->cfg.userdata);
+        }
+        lumi_view_add_child(l->content, r->view);
+    }
+    lumi_view_add_child(l->content, l->bottom);
+}
+
+lumi_tk_vlist_t *lumi_tk_vlist_create(const lumi_vlist_config_t *config) {
+    if (!config || !config->create || !config->bind) return NULL;
+    if (config->count < 0 || config->row_height <= 0.0f) return NULL;
+
+    lumi_tk_vlist_t *l = calloc(1, sizeof(lumi_tk_vlist_t));
+    if (!l) return NULL;
+    l->cfg   = *config;
+    l->first = 0;
+    l->last  = -1;
+
+    l->scroll  = lumi_scroll();
+    l->content = lumi_column();
+    l->top     = lumi_spacer();
+    l->bottom  = lumi_spacer();
+    if (!l->scroll || !l->content || !l->top || !l->bottom || !fw_build(l, 0)) {
+        lumi_view_destroy(l->scroll);
+        lumi_view_destroy(l->content);
+        lumi_view_destroy(l->top);
+        lumi_view_destroy(l->bottom);
+        free(l->heights);
+        free(l->tree);
+        free(l);
+        return NULL;
+    }
+
+    lumi_view_set_height(l->scroll, l->cfg.viewport_height);
+    lumi_view_add_child(l->scroll, l->content);
+    vlist_refresh(l, true);
+    return l;
+}
+
+void lumi_tk_vlist_destroy(lumi_tk_vlist_t *list) {
+    if (!list) return;
+    for (int t = 0; t < list->pool_types; t++) {
+        for (int i = 0; i < list->pools[t].count; i++) {
+            lumi_view_destroy(list->pools[t].views[i]);
+        }
+        free(list->pools[t].views);
+    }
+    free(list->pools);
+    free(list->rows);
+    free(list->heights);
+    free(list->tree);
+    free(list);
+}
+
+lumi_view_t *lumi_tk_vlist_view(lumi_tk_vlist_t *list) {
+    return list ? list->scroll : NULL;
+}
+
+void lumi_tk_vlist_scroll_to(lumi_tk_vlist_t *list, float offset) {
+    if (!list) return;
+    list->offset = offset;
+    vlist_refresh(list, false);
+}
+
+void lumi_tk_vlist_scroll_to_index(lumi_tk_vlist_t *list, int index) {
+    if (!list || index < 0 || index >= list->cfg.count) return;
+    lumi_tk_vlist_scroll_to(list, (float)fw_prefix(list, index));
+}
+
+float lumi_tk_vlist_get_offset(lumi_tk_vlist_t *list) {
+    return list ? list->offset : 0.0f;
+}
+
+void lumi_tk_vlist_set_viewport(lumi_tk_vlist_t *list, float height) {
+    if (!list) return;
+    list->cfg.viewport_height = height;
+    lumi_view_set_height(list->scroll, height);
+    vlist_refresh(list, false);
+}
+
+void lumi_tk_vlist_set_count(lumi_tk_vlist_t *list, int count) {
+    if (!list || count < 0) return;
+    int old = list->cfg.count;
+    list->cfg.count = count;
+    if (!fw_build(list, old < count ? old : count)) {
+        list->cfg.count = old < count ? old : count;
+    }
+    vlist_refresh(list, true);
+}
+
+void lumi_tk_vlist_set_row_height(lumi_tk_vlist_t *list, int index, float height) {
+    if (!list || index < 0 || index >= list->cfg.count || height < 0.0f) return;
+    float delta = height - list->heights[index];
+    if (delta == 0.0f) return;
+    list->heights[index] = height;
+    fw_add(list, index, delta);
+    if (index >= list->first && index <= list->last && !list->cfg.estimated) {
+        lumi_view_set_height(list->rows[index - list->first].view, height);
+    }
+    vlist_refresh(list, false);
+}
+
+void lumi_tk_vlist_measure(lumi_tk_vlist_t *list) {
+    if (!list) return;
+    bool changed = false;
+    for (int i = list->first; i <= list->last; i++) {
+        float h;
+        lumi_view_get_frame(list->rows[i - list->first].view, NULL, NULL, NULL, &h);
+        if (h > 0.0f && h != list->heights[i]) {
+            fw_add(list, i, h - list->heights[i]);
+            list->heights[i] = h;
+            changed = true;
+        }
+    }
+    if (changed) vlist_refresh(list, false);
+}
+
+float lumi_tk_vlist_content_height(lumi_tk_vlist_t *list) {
+    return list ? (float)fw_prefix(list, list->cfg.count) : 0.0f;
+}
+
+float lumi_tk_vlist_offset_of(lumi_tk_vlist_t *list, int index) {
+    if (!list || index < 0) return 0.0f;
+    if (index > list->cfg.count) index = list->cfg.count;
+    return (float)fw_prefix(list, index);
+}
+
+int lumi_tk_vlist_index_at(lumi_tk_vlist_t *list, float offset) {
+    if (!list || list->cfg.count == 0) return -1;
+    return fw_find(list, offset > 0.0f ? offset : 0.0f);
+}
+
+void lumi_tk_vlist_visible_range(lumi_tk_vlist_t *list, int *first, int *last) {
+    if (first) *first = list ? list->first : 0;
+    if (last)  *last  = list ? list->last : -1;
+}
+
 /* ── Icon button ───────────────────────────────────────────────── */
 
 lumi_view_t *lumi_tk_icon_button(const char *icon_path, const char *label,
@@ -104,11 +442,8 @@ lumi_view_t *lumi_tk_icon_button(const char *icon_path, const char *label,
 
 lumi_view_t *lumi_tk_switch(bool initial, lumi_click_cb on_toggle, void *userdata) {
     lumi_view_t *btn = lumi_button(initial ? "ON" : "OFF");
-    lumi_view_set_background(btn, initial ? 0x4CAF50FF : 0x9E9E9EFF);
-    lumi_view_set_foreground(btn, 0xFFFFFFFF);
-    lumi_view_set_border_radius(btn, 16.0f);
-    lumi_view_set_width(btn, 52.0f);
-    lumi_view_set_height(btn, 28.0f);
+    if (!btn) return NULL;
+    lumi_view_set_style_class(btn, lumi_tk_theme(), initial ? "tk.switch.on" : "tk.switch.off");
     if (on_toggle) {
         lumi_view_on_click(btn, on_toggle, userdata);
     }
@@ -183,11 +518,8 @@ lumi_view_t *lumi_tk_dialog(const char *title, const char *message,
 
 lumi_view_t *lumi_tk_toast(const char *message) {
     lumi_view_t *v = lumi_text(message ? message : "");
-    lumi_view_set_background(v, 0x323232E6);
-    lumi_view_set_foreground(v, 0xFFFFFFFF);
-    lumi_view_set_font_size(v, 14.0f);
-    lumi_view_set_border_radius(v, 20.0f);
-    lumi_view_set_padding(v, 12, 24, 12, 24);
+    if (!v) return NULL;
+    lumi_view_set_style_class(v, lumi_tk_theme(), "tk.toast");
     return v;
 }
 
@@ -205,11 +537,9 @@ lumi_view_t *lumi_tk_avatar(const char *image_path, float size) {
 
 lumi_view_t *lumi_tk_badge(const char *text, uint32_t color) {
     lumi_view_t *v = lumi_text(text ? text : "");
-    lumi_view_set_background(v, color);
-    lumi_view_set_foreground(v, 0xFFFFFFFF);
-    lumi_view_set_font_size(v, 10.0f);
-    lumi_view_set_border_radius(v, 8.0f);
-    lumi_view_set_padding(v, 2, 6, 2, 6);
+    if (!v) return NULL;
+    lumi_view_set_style_class(v, lumi_tk_theme(), "tk.badge");
+    lumi_view_set_background(v, color);    /* badges of one color share a style */
     return v;
 }
 
@@ -220,6 +550,7 @@ lumi_view_t *lumi_tk_bottom_nav(const lumi_nav_item_t *items, int count,
     lumi_view_t *bar = lumi_row();
     lumi_view_set_height(bar, 56.0f);
     lumi_view_set_background(bar, 0xFFFFFFFF);
+    lumi_view_set_repaint_boundary(bar, true);
 
     for (int i = 0; i < count; i++) {
         lumi_view_t *item = lumi_tk_icon_button(
@@ -240,6 +571,7 @@ lumi_view_t *lumi_tk_tab_bar(const char **labels, int count, int active,
     lumi_view_t *bar = lumi_row();
     lumi_view_set_height(bar, 48.0f);
     lumi_view_set_background(bar, 0x2196F3FF);
+    lumi_view_set_repaint_boundary(bar, true);
 
     for (int i = 0; i < count; i++) {
         lumi_view_t *tab = lumi_button(labels[i]);